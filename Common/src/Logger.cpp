@@ -10,7 +10,11 @@ namespace Common
 		std::time_t currentTime;
 		std::time(&currentTime);
 		std::tm timeInfo;
+#ifdef _WIN32
 		localtime_s(&timeInfo, &currentTime);
+#else
+		localtime_r(&currentTime, &timeInfo);
+#endif
 		char timeBuffer[80];
 		std::strftime(timeBuffer, sizeof(timeBuffer), TIME_FORMAT, &timeInfo);
 
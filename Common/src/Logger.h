@@ -9,19 +9,19 @@
 #define STRINGIFY2(x) #x
 #define STRINGIFY(x) STRINGIFY2(x)
 
-#define LOG_INFO(message, ...) Common::LogInfo(message, __VA_ARGS__)
-#define LOG_WARNING(message, ...) Common::LogWarning(message, __VA_ARGS__)
-#define LOG_ERROR(message, ...) Common::LogError(__FILE__, STRINGIFY(__LINE__), message, __VA_ARGS__)
+#define LOG_INFO(message, ...) Common::LogInfo(message, ##__VA_ARGS__)
+#define LOG_WARNING(message, ...) Common::LogWarning(message, ##__VA_ARGS__)
+#define LOG_ERROR(message, ...) Common::LogError(__FILE__, STRINGIFY(__LINE__), message, ##__VA_ARGS__)
 #define TIME_FORMAT "%H:%M:%S"
 
-static constexpr char* INFO_PREFIX = "Info";
-static constexpr char* WARNING_PREFIX = "Warn";
-static constexpr char* ERROR_PREFIX = "Error";
+static constexpr const char* INFO_PREFIX = "Info";
+static constexpr const char* WARNING_PREFIX = "Warn";
+static constexpr const char* ERROR_PREFIX = "Error";
 
-static constexpr char* RESET_COLOR_CODE = "\033[0m";
-static constexpr char* INFO_COLOR_CODE = "\033[37m";
-static constexpr char* WARNING_COLOR_CODE = "\033[33m";
-static constexpr char* ERROR_COLOR_CODE = "\033[91m";
+static constexpr const char* RESET_COLOR_CODE = "\033[0m";
+static constexpr const char* INFO_COLOR_CODE = "\033[37m";
+static constexpr const char* WARNING_COLOR_CODE = "\033[33m";
+static constexpr const char* ERROR_COLOR_CODE = "\033[91m";
 
 namespace Common
 {
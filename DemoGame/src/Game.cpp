@@ -7,6 +7,8 @@
 
 #include "SceneInitializer.h"
 
+#include "global_components/network_peer_global_component.h"
+
 bool Game::Init()
 {
 	LOG_INFO( "Select:" );
@@ -77,6 +79,35 @@ void Game::GameLoop()
 		Update( timeClock.GetElapsedTimeSeconds() );
 		Render( timeClock.GetElapsedTimeSeconds() );
 		EndOfFrame();
+
+		WaitForNextTick( static_cast< float32 >( FIXED_FRAME_TARGET_DURATION - accumulator ) );
+	}
+}
+
+void Game::WaitForNextTick( float32 timeUntilNextTick )
+{
+	// Only the server sleeps between ticks. Clients keep rendering at full frame rate
+	NetworkPeerGlobalComponent& networkPeerComponent = _activeScene.GetGlobalComponent< NetworkPeerGlobalComponent >();
+	NetLib::Peer* peer = networkPeerComponent.peer;
+	if ( peer == nullptr || peer->GetPeerType() != NetLib::PeerType::SERVER )
+	{
+		return;
+	}
+
+	NetLib::TimeClock& timeClock = NetLib::TimeClock::GetInstance();
+	const float64 nextTickTime = timeClock.GetLocalTimeSeconds() + timeUntilNextTick;
+	float64 timeLeft = timeUntilNextTick;
+
+	while ( timeLeft > 0.0 && peer->GetConnectionState() != NetLib::PeerConnectionState::PCS_Disconnected )
+	{
+		// Wake up as soon as a datagram arrives and process it straight away. Otherwise the socket would stay readable
+		// and the wait would return immediately until the next tick
+		if ( peer->WaitForIncomingData( static_cast< float32 >( timeLeft ) ) )
+		{
+			peer->PreTick();
+		}
+
+		timeLeft = nextTickTime - timeClock.GetLocalTimeSeconds();
 	}
 }
 
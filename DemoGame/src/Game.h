@@ -28,6 +28,11 @@ class Game
 		void Update( float32 elapsedTime );
 		void Render( float32 elapsed_time );
 		void EndOfFrame();
+		/// <summary>
+		/// Sleeps until the next fixed tick instead of busy-looping. Incoming network data is processed as soon as it
+		/// arrives.
+		/// </summary>
+		void WaitForNextTick( float32 timeUntilNextTick );
 
 		SDL_Window* _window;
 		SDL_Renderer* _renderer;
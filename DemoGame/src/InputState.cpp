@@ -1,26 +1,44 @@
 #include "InputState.h"
 
+#include "core/bit_reader.h"
+#include "core/bit_writer.h"
 #include "core/buffer.h"
 
+//The movement is normalized, so each axis is within [-1, 1]
+static const float32 MOVEMENT_AXIS_MIN = -1.f;
+static const float32 MOVEMENT_AXIS_MAX = 1.f;
+static const float32 MOVEMENT_AXIS_RESOLUTION = 0.001f;
+
 int32 InputState::GetSize() const
 {
-    return (4 * sizeof(float));
+    const uint32 movementAxisBits =
+        NetLib::BitWriter::GetNumberOfBitsRequired(MOVEMENT_AXIS_MIN, MOVEMENT_AXIS_MAX, MOVEMENT_AXIS_RESOLUTION);
+    const uint32 numberOfBits = (2 * movementAxisBits) + 1 + (2 * 32);
+    return (numberOfBits + 7) / 8;
 }
 
 void InputState::Serialize(NetLib::Buffer& buffer) const
 {
-    buffer.WriteFloat(movement.X());
-    buffer.WriteFloat(movement.Y());
+    NetLib::BitWriter writer(buffer);
+    writer.WriteQuantizedFloat(movement.X(), MOVEMENT_AXIS_MIN, MOVEMENT_AXIS_MAX, MOVEMENT_AXIS_RESOLUTION);
+    writer.WriteQuantizedFloat(movement.Y(), MOVEMENT_AXIS_MIN, MOVEMENT_AXIS_MAX, MOVEMENT_AXIS_RESOLUTION);
+
+    writer.WriteBool(isShooting);
 
-    buffer.WriteFloat(virtualMousePosition.X());
-    buffer.WriteFloat(virtualMousePosition.Y());
+    writer.WriteFloat(virtualMousePosition.X());
+    writer.WriteFloat(virtualMousePosition.Y());
+    writer.Flush();
 }
 
 void InputState::Deserialize(NetLib::Buffer& buffer)
 {
-    movement.X(buffer.ReadFloat());
-    movement.Y(buffer.ReadFloat());
+    NetLib::BitReader reader(buffer);
+    movement.X(reader.ReadQuantizedFloat(MOVEMENT_AXIS_MIN, MOVEMENT_AXIS_MAX, MOVEMENT_AXIS_RESOLUTION));
+    movement.Y(reader.ReadQuantizedFloat(MOVEMENT_AXIS_MIN, MOVEMENT_AXIS_MAX, MOVEMENT_AXIS_RESOLUTION));
+
+    isShooting = reader.ReadBool();
 
-    virtualMousePosition.X(buffer.ReadFloat());
-    virtualMousePosition.Y(buffer.ReadFloat());
+    virtualMousePosition.X(reader.ReadFloat());
+    virtualMousePosition.Y(reader.ReadFloat());
+    reader.Finish();
 }
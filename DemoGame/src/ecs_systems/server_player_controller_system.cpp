@@ -9,6 +9,7 @@
 
 #include "components/player_controller_component.h"
 #include "components/network_entity_component.h"
+#include "components/transform_component.h"
 
 #include "global_components/network_peer_global_component.h"
 
@@ -36,6 +37,10 @@ void ServerPlayerControllerSystem::Execute( ECS::EntityContainer& entity_contain
 
 		const InputState* inputState = static_cast< const InputState* >( baseInputState );
 		PlayerSimulator::Simulate( *inputState, *it, elapsed_time );
+
+		// Keep interest management aware of where the player is
+		const Vec2f position = it->GetComponent< TransformComponent >().GetPosition();
+		serverPeer->SetNetworkEntityPosition( networkEntityComponent.networkEntityId, position.X(), position.Y() );
 	}
 }
 
@@ -6,35 +6,51 @@
 
 #include "components/transform_component.h"
 
+#include "core/bit_reader.h"
+#include "core/bit_writer.h"
 #include "core/buffer.h"
 
+// The transform keeps its rotation angle within (-360, 360) degrees. The position is not bounded by the world, so it is
+// sent with full precision
+static const float32 ROTATION_ANGLE_MIN = -360.f;
+static const float32 ROTATION_ANGLE_MAX = 360.f;
+static const float32 ROTATION_ANGLE_RESOLUTION = 0.1f;
+
+static void SerializeTransform( const TransformComponent& transform, NetLib::Buffer& buffer )
+{
+	NetLib::BitWriter writer( buffer );
+	const Vec2f position = transform.GetPosition();
+	writer.WriteFloat( position.X() );
+	writer.WriteFloat( position.Y() );
+	writer.WriteQuantizedFloat( transform.GetRotationAngle(), ROTATION_ANGLE_MIN, ROTATION_ANGLE_MAX,
+	                            ROTATION_ANGLE_RESOLUTION );
+	writer.Flush();
+}
+
 void SerializeForOwner( const ECS::GameEntity& entity, NetLib::Buffer& buffer )
 {
 	const TransformComponent& transform = entity.GetComponent< TransformComponent >();
-	const Vec2f position = transform.GetPosition();
-	buffer.WriteFloat( position.X() );
-	buffer.WriteFloat( position.Y() );
-	buffer.WriteFloat( transform.GetRotationAngle() );
+	SerializeTransform( transform, buffer );
 }
 
 void SerializeForNonOwner( const ECS::GameEntity& entity, NetLib::Buffer& buffer )
 {
 	const TransformComponent& transform = entity.GetComponent< TransformComponent >();
-	const Vec2f position = transform.GetPosition();
-	buffer.WriteFloat( position.X() );
-	buffer.WriteFloat( position.Y() );
-	buffer.WriteFloat( transform.GetRotationAngle() );
+	SerializeTransform( transform, buffer );
 }
 
 void DeserializeForOwner( ECS::GameEntity& entity, NetLib::Buffer& buffer )
 {
 	TransformComponent& transform = entity.GetComponent< TransformComponent >();
+	NetLib::BitReader reader( buffer );
 	Vec2f position;
-	position.X( buffer.ReadFloat() );
-	position.Y( buffer.ReadFloat() );
+	position.X( reader.ReadFloat() );
+	position.Y( reader.ReadFloat() );
 
-	transform.SetPosition( position );
+	const float32 rotation_angle =
+	    reader.ReadQuantizedFloat( ROTATION_ANGLE_MIN, ROTATION_ANGLE_MAX, ROTATION_ANGLE_RESOLUTION );
+	reader.Finish();
 
-	const float32 rotation_angle = buffer.ReadFloat();
+	transform.SetPosition( position );
 	transform.SetRotationAngle( rotation_angle );
 }
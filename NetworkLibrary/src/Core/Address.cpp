@@ -1,5 +1,7 @@
 #include "address.h"
 
+#include <cstring>
+
 #include "logger.h"
 
 namespace NetLib
@@ -8,18 +10,53 @@ namespace NetLib
 	// getaddrinfo and create a DNS petition which takes wayyyy longer than using just a normal IP. If so, do it in a
 	// separate thread.
 
+	static constexpr uint32 FNV_OFFSET_BASIS = 2166136261u;
+	static constexpr uint32 FNV_PRIME = 16777619u;
+
+	static uint32 HashBytes( uint32 hash, const void* data, uint32 size )
+	{
+		const uint8* bytes = static_cast< const uint8* >( data );
+		for ( uint32 i = 0; i < size; ++i )
+		{
+			hash ^= bytes[ i ];
+			hash *= FNV_PRIME;
+		}
+
+		return hash;
+	}
+
+	Address::Address()
+	    : _addressInfo()
+	    , _hash( 0 )
+	{
+		// An invalid address is 0.0.0.0:0
+		std::memset( &_addressInfo, 0, sizeof( _addressInfo ) );
+		_addressInfo.ipv4.sin_family = AF_INET;
+		UpdateHash();
+	}
+
 	Address::Address( const std::string& ip, uint32 port )
-	    : _ip( ip )
-	    , _ipVersion( IPVersion::IPV4 )
-	    , _port( port )
-	    , _addressInfo()
+	    : Address()
 	{
-		InitSockAddr();
+		InitSockAddr( ip, port );
 	}
 
 	bool Address::operator==( const Address& other ) const
 	{
-		return _ip == other._ip && _port == other._port && _ipVersion == other._ipVersion;
+		if ( _hash != other._hash || _addressInfo.base.sa_family != other._addressInfo.base.sa_family )
+		{
+			return false;
+		}
+
+		if ( _addressInfo.base.sa_family == AF_INET6 )
+		{
+			return _addressInfo.ipv6.sin6_port == other._addressInfo.ipv6.sin6_port &&
+			       std::memcmp( &_addressInfo.ipv6.sin6_addr, &other._addressInfo.ipv6.sin6_addr,
+			                    sizeof( _addressInfo.ipv6.sin6_addr ) ) == 0;
+		}
+
+		return _addressInfo.ipv4.sin_port == other._addressInfo.ipv4.sin_port &&
+		       _addressInfo.ipv4.sin_addr.s_addr == other._addressInfo.ipv4.sin_addr.s_addr;
 	}
 
 	bool Address::operator!=( const Address& other ) const
@@ -27,51 +64,135 @@ namespace NetLib
 		return !( *this == other );
 	}
 
+	uint32 Address::GetPort() const
+	{
+		const uint16 port =
+		    ( GetIPVersion() == IPVersion::IPV6 ) ? _addressInfo.ipv6.sin6_port : _addressInfo.ipv4.sin_port;
+		return ntohs( port );
+	}
+
+	std::string Address::GetIP() const
+	{
+		char ip[ INET6_ADDRSTRLEN ];
+		std::memset( ip, 0, sizeof( ip ) );
+
+		if ( GetIPVersion() == IPVersion::IPV6 )
+		{
+			inet_ntop( AF_INET6, &_addressInfo.ipv6.sin6_addr, ip, sizeof( ip ) );
+		}
+		else
+		{
+			inet_ntop( AF_INET, &_addressInfo.ipv4.sin_addr, ip, sizeof( ip ) );
+		}
+
+		return std::string( ip );
+	}
+
 	void Address::GetFull( std::string& buffer ) const
 	{
-		buffer.append( _ip.c_str() );
+		if ( GetIPVersion() == IPVersion::IPV6 )
+		{
+			buffer.append( "[" );
+			buffer.append( GetIP() );
+			buffer.append( "]" );
+		}
+		else
+		{
+			buffer.append( GetIP() );
+		}
+
 		buffer.append( ":" );
-		buffer.append( std::to_string( _port ) );
+		buffer.append( std::to_string( GetPort() ) );
 	}
 
-	void Address::InitSockAddr()
+	IPVersion Address::GetIPVersion() const
 	{
-		_addressInfo.sin_family = ( _ipVersion == IPVersion::IPV4 ) ? AF_INET : AF_INET6;
-		_addressInfo.sin_port = htons( _port );
-		const int32 iResult = inet_pton( _addressInfo.sin_family, _ip.c_str(), &_addressInfo.sin_addr );
+		return ( _addressInfo.base.sa_family == AF_INET6 ) ? IPVersion::IPV6 : IPVersion::IPV4;
+	}
+
+	void Address::InitSockAddr( const std::string& ip, uint32 port )
+	{
+		int32 iResult = 0;
+		if ( ip.find( ':' ) != std::string::npos )
+		{
+			_addressInfo.ipv6.sin6_family = AF_INET6;
+			_addressInfo.ipv6.sin6_port = htons( static_cast< uint16 >( port ) );
+			iResult = inet_pton( AF_INET6, ip.c_str(), &_addressInfo.ipv6.sin6_addr );
+		}
+		else
+		{
+			_addressInfo.ipv4.sin_family = AF_INET;
+			_addressInfo.ipv4.sin_port = htons( static_cast< uint16 >( port ) );
+			iResult = inet_pton( AF_INET, ip.c_str(), &_addressInfo.ipv4.sin_addr );
+		}
+
 		if ( iResult == -1 )
 		{
+#ifdef _WIN32
 			LOG_ERROR( "Error at converting IP string into address. Error code: %d", WSAGetLastError() );
+#else
+			LOG_ERROR( "Error at converting IP string into address. Error code: %d", errno );
+#endif
 		}
 		else if ( iResult == 0 )
 		{
-			LOG_ERROR( "The IP string: %s is not valid", _ip.c_str() );
+			LOG_ERROR( "The IP string: %s is not valid", ip.c_str() );
 		}
+
+		UpdateHash();
 	}
 
-	void Address::SetFromSockAddr( const sockaddr_in& addressInfo )
+	void Address::UpdateHash()
 	{
-		_addressInfo.sin_family = addressInfo.sin_family;
-		_addressInfo.sin_port = addressInfo.sin_port;
-		_addressInfo.sin_addr = addressInfo.sin_addr;
+		const uint16 family = _addressInfo.base.sa_family;
+		uint32 hash = HashBytes( FNV_OFFSET_BASIS, &family, sizeof( family ) );
 
-		// Check if input is an invalid address
-		if ( _addressInfo.sin_family == AF_UNSPEC )
+		if ( family == AF_INET6 )
 		{
-			_ip.assign( "0.0.0.0" );
-			_port = 0;
+			hash = HashBytes( hash, &_addressInfo.ipv6.sin6_port, sizeof( _addressInfo.ipv6.sin6_port ) );
+			hash = HashBytes( hash, &_addressInfo.ipv6.sin6_addr, sizeof( _addressInfo.ipv6.sin6_addr ) );
 		}
 		else
 		{
-			const uint32 IP_MAX_SIZE = 256;
-			char clientIp[ IP_MAX_SIZE ];
-			ZeroMemory( clientIp, IP_MAX_SIZE );
-			inet_ntop( _addressInfo.sin_family, &_addressInfo.sin_addr, clientIp, IP_MAX_SIZE );
-			std::string ipString( clientIp );
-			_ip.assign( clientIp );
-
-			_ipVersion = ( _addressInfo.sin_family == AF_INET ) ? IPVersion::IPV4 : IPVersion::IPV6;
-			_port = ntohs( _addressInfo.sin_port );
+			hash = HashBytes( hash, &_addressInfo.ipv4.sin_port, sizeof( _addressInfo.ipv4.sin_port ) );
+			hash = HashBytes( hash, &_addressInfo.ipv4.sin_addr, sizeof( _addressInfo.ipv4.sin_addr ) );
 		}
+
+		_hash = hash;
+	}
+
+	void Address::SetFromSockAddr( const sockaddr_in& addressInfo )
+	{
+		std::memset( &_addressInfo, 0, sizeof( _addressInfo ) );
+		_addressInfo.ipv4.sin_family = AF_INET;
+
+		// An AF_UNSPEC input means that there is no address, so leave it as the invalid one
+		if ( addressInfo.sin_family != AF_UNSPEC )
+		{
+			_addressInfo.ipv4.sin_port = addressInfo.sin_port;
+			_addressInfo.ipv4.sin_addr = addressInfo.sin_addr;
+		}
+
+		UpdateHash();
+	}
+
+	void Address::SetFromSockAddr( const sockaddr_in6& addressInfo )
+	{
+		std::memset( &_addressInfo, 0, sizeof( _addressInfo ) );
+		_addressInfo.ipv4.sin_family = AF_INET;
+
+		if ( addressInfo.sin6_family != AF_UNSPEC )
+		{
+			_addressInfo.ipv6.sin6_family = AF_INET6;
+			_addressInfo.ipv6.sin6_port = addressInfo.sin6_port;
+			_addressInfo.ipv6.sin6_addr = addressInfo.sin6_addr;
+		}
+
+		UpdateHash();
+	}
+
+	socklen_t Address::GetSockAddrSize() const
+	{
+		return ( GetIPVersion() == IPVersion::IPV6 ) ? sizeof( sockaddr_in6 ) : sizeof( sockaddr_in );
 	}
 } // namespace NetLib
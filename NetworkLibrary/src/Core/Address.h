@@ -1,14 +1,14 @@
 #pragma once
 #include "numeric_types.h"
 
-#include <winsock2.h>
-#include <ws2tcpip.h>
 #include <string>
 
+#include "core/socket_platform.h"
+
 namespace NetLib
 {
-	constexpr char* IPV4_ANY = "0.0.0.0";
-	constexpr char* IPV4_LOOPBACK = "127.0.0.1";
+	constexpr const char* IPV4_ANY = "0.0.0.0";
+	constexpr const char* IPV4_LOOPBACK = "127.0.0.1";
 
 	enum class IPVersion
 	{
@@ -16,36 +16,57 @@ namespace NetLib
 		IPV6 = 1
 	};
 
+	/// <summary>
+	/// Network address stored in its native binary form, so it can be copied, compared and hashed without any
+	/// allocations. The hash is computed once when the address is set. The IP string is only built on demand.
+	/// </summary>
 	class Address
 	{
 		public:
-			static Address GetInvalid() { return Address( "0.0.0.0", 0 ); }
+			static Address GetInvalid() { return Address(); }
 
+			/// <summary>
+			/// Creates an address from its IP string and port. Both IPv4 and IPv6 strings are supported
+			/// </summary>
 			Address( const std::string& ip, uint32 port );
 
 			Address( const Address& other ) = default;
 
+			Address& operator=( const Address& other ) = default;
+
 			bool operator==( const Address& other ) const;
 			bool operator!=( const Address& other ) const;
 
-			uint32 GetPort() const { return _port; }
-			const std::string& GetIP() const { return _ip; }
+			uint32 GetPort() const;
+			std::string GetIP() const;
 			void GetFull( std::string& buffer ) const;
+			IPVersion GetIPVersion() const;
+			uint32 GetHash() const { return _hash; }
 
 		private:
-			void InitSockAddr();
-			// This function is only called from socket class
+			Address();
+
+			void InitSockAddr( const std::string& ip, uint32 port );
+			void UpdateHash();
+
+			// These functions are only called from socket related classes
 			void SetFromSockAddr( const sockaddr_in& addressInfo );
-			// This function is only called from socket class
-			const sockaddr_in& GetSockAddr() const { return _addressInfo; }
+			void SetFromSockAddr( const sockaddr_in6& addressInfo );
+			const sockaddr* GetSockAddr() const { return &_addressInfo.base; }
+			socklen_t GetSockAddrSize() const;
 
-			std::string _ip;
-			IPVersion _ipVersion;
-			uint32 _port;
+			// Cache adress info into the native sockets struct for better performance
+			union
+			{
+					sockaddr base;
+					sockaddr_in ipv4;
+					sockaddr_in6 ipv6;
+			} _addressInfo;
 
-			// Cache adress info into winsocks struct for better performance
-			struct sockaddr_in _addressInfo;
+			uint32 _hash;
 
 			friend class Socket;
+			friend class IoUringEngine;
+			friend class SegmentationOffloadEngine;
 	};
 } // namespace NetLib
@@ -1,14 +1,66 @@
 #include "buffer.h"
 
 #include <cassert>
-#include <cmath>
 #include <cstring>
 
+#include "core/packet_buffer_pool.h"
+
 namespace NetLib
 {
+#if defined( __BYTE_ORDER__ ) && ( __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__ )
+	static uint16 ByteSwap( uint16 value )
+	{
+		return __builtin_bswap16( value );
+	}
+
+	static uint32 ByteSwap( uint32 value )
+	{
+		return __builtin_bswap32( value );
+	}
+
+	static uint64 ByteSwap( uint64 value )
+	{
+		return __builtin_bswap64( value );
+	}
+#endif
+
+	// Going through memcpy keeps unaligned accesses well defined. Compilers turn it into a single move
+	template < typename T >
+	static void StoreLittleEndian( uint8* destination, T value )
+	{
+#if defined( __BYTE_ORDER__ ) && ( __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__ )
+		value = ByteSwap( value );
+#endif
+		std::memcpy( destination, &value, sizeof( T ) );
+	}
+
+	template < typename T >
+	static T LoadLittleEndian( const uint8* source )
+	{
+		T value;
+		std::memcpy( &value, source, sizeof( T ) );
+#if defined( __BYTE_ORDER__ ) && ( __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__ )
+		value = ByteSwap( value );
+#endif
+		return value;
+	}
+
 	Buffer::Buffer( uint8* data, int32 size )
 	    : _data( data )
 	    , _size( size )
+	    , _packetBuffer( nullptr )
+	    , _isPacketBufferOnDemand( false )
+	    , _hasOverflowed( false )
+	{
+		_index = 0;
+	}
+
+	Buffer::Buffer( PacketBuffer& packetBuffer )
+	    : _data( packetBuffer.GetData() )
+	    , _size( static_cast< int32 >( packetBuffer.GetSize() ) )
+	    , _packetBuffer( &packetBuffer )
+	    , _isPacketBufferOnDemand( false )
+	    , _hasOverflowed( false )
 	{
 		_index = 0;
 	}
@@ -16,6 +68,30 @@ namespace NetLib
 	void Buffer::Clear()
 	{
 		_index = 0;
+		_hasOverflowed = false;
+	}
+
+	PacketBuffer* Buffer::AcquirePacketBuffer()
+	{
+		if ( _packetBuffer == nullptr && _isPacketBufferOnDemand )
+		{
+			_packetBuffer = PacketBufferPool::GetInstance().LendPacketBuffer( _data, static_cast< uint32 >( _size ) );
+			_data = _packetBuffer->GetData();
+		}
+
+		return _packetBuffer;
+	}
+
+	bool Buffer::CanWrite( uint32 size )
+	{
+		assert( static_cast< uint32 >( _index ) + size <= static_cast< uint32 >( _size ) );
+		if ( static_cast< uint32 >( _index ) + size > static_cast< uint32 >( _size ) )
+		{
+			_hasOverflowed = true;
+			return false;
+		}
+
+		return true;
 	}
 
 	void Buffer::CopyUsedData( uint8* dst, uint32 dst_size ) const
@@ -27,49 +103,106 @@ namespace NetLib
 
 	void Buffer::WriteLong( uint64 value )
 	{
-		assert( _index + 8 <= _size );
-		*( ( uint64* ) ( _data + _index ) ) = value;
+		if ( !CanWrite( 8 ) )
+		{
+			return;
+		}
+
+		StoreLittleEndian( _data + _index, value );
 
 		_index += 8;
 	}
 
 	void Buffer::WriteInteger( uint32 value )
 	{
-		assert( _index + 4 <= _size );
-		*( ( uint32* ) ( _data + _index ) ) = value;
+		if ( !CanWrite( 4 ) )
+		{
+			return;
+		}
+
+		StoreLittleEndian( _data + _index, value );
 
 		_index += 4;
 	}
 
 	void Buffer::WriteShort( uint16 value )
 	{
-		assert( _index + 2 <= _size );
-		*( ( uint16* ) ( _data + _index ) ) = value;
+		if ( !CanWrite( 2 ) )
+		{
+			return;
+		}
+
+		StoreLittleEndian( _data + _index, value );
 
 		_index += 2;
 	}
 
 	void Buffer::WriteByte( uint8 value )
 	{
-		assert( _index + 1 <= _size );
-		*( ( uint8* ) ( _data + _index ) ) = value;
+		if ( !CanWrite( 1 ) )
+		{
+			return;
+		}
+
+		_data[ _index ] = value;
 
 		++_index;
 	}
 
 	void Buffer::WriteFloat( float32 value )
 	{
-		assert( _index + 4 <= _size );
-		// This memcpy needs to be done using memcpy to keep the bits configuration too
-		std::memcpy( ( _data + _index ), &value, sizeof( uint32 ) );
-		_index += 4;
+		// This needs to be done using memcpy to keep the bits configuration too
+		uint32 bits;
+		std::memcpy( &bits, &value, sizeof( uint32 ) );
+		WriteInteger( bits );
+	}
+
+	void Buffer::WriteVarInteger( uint32 value )
+	{
+		if ( !CanWrite( GetVarIntegerSize( value ) ) )
+		{
+			return;
+		}
+
+		while ( value >= 0x80 )
+		{
+			_data[ _index ] = static_cast< uint8 >( value | 0x80 );
+			value >>= 7;
+			++_index;
+		}
+
+		_data[ _index ] = static_cast< uint8 >( value );
+		++_index;
+	}
+
+	void Buffer::WriteBytes( const uint8* data, uint32 size )
+	{
+		if ( !CanWrite( size ) )
+		{
+			return;
+		}
+
+		std::memcpy( ( _data + _index ), data, size );
+
+		_index += size;
+	}
+
+	void Buffer::WriteZeros( uint32 size )
+	{
+		if ( !CanWrite( size ) )
+		{
+			return;
+		}
+
+		std::memset( ( _data + _index ), 0, size );
+
+		_index += size;
 	}
 
 	uint64 Buffer::ReadLong()
 	{
 		assert( _index + 8 <= _size );
-		uint64 value;
-		value = *( ( uint64* ) ( _data + _index ) );
+		const uint64 value = LoadLittleEndian< uint64 >( _data + _index );
 
 		_index += 8;
 		return value;
@@ -78,8 +211,7 @@ namespace NetLib
 	uint32 Buffer::ReadInteger()
 	{
 		assert( _index + 4 <= _size );
-		uint32 value;
-		value = *( ( uint32* ) ( _data + _index ) );
+		const uint32 value = LoadLittleEndian< uint32 >( _data + _index );
 
 		_index += 4;
 		return value;
@@ -88,40 +220,182 @@ namespace NetLib
 	uint16 Buffer::ReadShort()
 	{
 		assert( _index + 2 <= _size );
-		uint16 value;
-
-		value = *( ( uint16* ) ( _data + _index ) );
+		const uint16 value = LoadLittleEndian< uint16 >( _data + _index );
 
 		_index += 2;
-
 		return value;
 	}
 
 	uint8 Buffer::ReadByte()
 	{
 		assert( _index + 1 <= _size );
-		uint8 value;
-
-		value = *( ( uint8* ) ( _data + _index ) );
+		const uint8 value = _data[ _index ];
 
 		++_index;
-
 		return value;
 	}
 
 	float32 Buffer::ReadFloat()
 	{
-		assert( _index + 4 <= _size );
+		// This needs to be done using memcpy to recover the bits configuration too
+		const uint32 bits = ReadInteger();
 		float32 value;
-		// This memcpy needs to be done using memcpy to recover the bits configuration too
-		std::memcpy( &value, ( _data + _index ), sizeof( float32 ) );
+		std::memcpy( &value, &bits, sizeof( float32 ) );
+		return value;
+	}
 
-		_index += 4;
+	uint32 Buffer::ReadVarInteger()
+	{
+		uint32 value = 0;
+		const bool isValid = TryReadVarInteger( value );
+		assert( isValid );
 		return value;
 	}
 
+	void Buffer::ReadBytes( uint8* data, uint32 size )
+	{
+		assert( _index + size <= static_cast< uint32 >( _size ) );
+		std::memcpy( data, ( _data + _index ), size );
+
+		_index += size;
+	}
+
+	uint8* Buffer::ReadDataView( uint32 size )
+	{
+		assert( _index + size <= static_cast< uint32 >( _size ) );
+		uint8* view = _data + _index;
+
+		_index += size;
+		return view;
+	}
+
+	bool Buffer::TryReadLong( uint64& value )
+	{
+		if ( GetRemainingSize() < 8 )
+		{
+			return false;
+		}
+
+		value = ReadLong();
+		return true;
+	}
+
+	bool Buffer::TryReadInteger( uint32& value )
+	{
+		if ( GetRemainingSize() < 4 )
+		{
+			return false;
+		}
+
+		value = ReadInteger();
+		return true;
+	}
+
+	bool Buffer::TryReadShort( uint16& value )
+	{
+		if ( GetRemainingSize() < 2 )
+		{
+			return false;
+		}
+
+		value = ReadShort();
+		return true;
+	}
+
+	bool Buffer::TryReadByte( uint8& value )
+	{
+		if ( GetRemainingSize() < 1 )
+		{
+			return false;
+		}
+
+		value = ReadByte();
+		return true;
+	}
+
+	bool Buffer::TryReadFloat( float32& value )
+	{
+		if ( GetRemainingSize() < 4 )
+		{
+			return false;
+		}
+
+		value = ReadFloat();
+		return true;
+	}
+
+	bool Buffer::TryReadVarInteger( uint32& value )
+	{
+		uint32 result = 0;
+		const uint32 remainingSize = GetRemainingSize();
+		for ( uint32 i = 0; i < MAX_VAR_INTEGER_SIZE_BYTES && i < remainingSize; ++i )
+		{
+			const uint8 byte = _data[ _index + i ];
+			result |= static_cast< uint32 >( byte & 0x7F ) << ( 7 * i );
+			if ( ( byte & 0x80 ) == 0 )
+			{
+				// The last byte only has room for the 4 highest bits
+				if ( i == MAX_VAR_INTEGER_SIZE_BYTES - 1 && byte > 0x0F )
+				{
+					return false;
+				}
+
+				value = result;
+				_index += i + 1;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	bool Buffer::TryReadBytes( uint8* data, uint32 size )
+	{
+		if ( GetRemainingSize() < size )
+		{
+			return false;
+		}
+
+		ReadBytes( data, size );
+		return true;
+	}
+
+	bool Buffer::TryReadDataView( uint32 size, uint8*& view )
+	{
+		if ( GetRemainingSize() < size )
+		{
+			return false;
+		}
+
+		view = ReadDataView( size );
+		return true;
+	}
+
+	bool Buffer::TryPeekByte( uint8& value ) const
+	{
+		if ( GetRemainingSize() < 1 )
+		{
+			return false;
+		}
+
+		value = _data[ _index ];
+		return true;
+	}
+
 	void Buffer::ResetAccessIndex()
 	{
 		_index = 0;
 	}
+
+	uint32 Buffer::GetVarIntegerSize( uint32 value )
+	{
+		uint32 size = 1;
+		while ( value >= 0x80 )
+		{
+			value >>= 7;
+			++size;
+		}
+
+		return size;
+	}
 } // namespace NetLib
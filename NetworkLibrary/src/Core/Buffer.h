@@ -3,10 +3,29 @@
 
 namespace NetLib
 {
+	class PacketBuffer;
+
+	// A var integer stores 7 bits per byte, so a uint32 takes up to 5 bytes
+	static constexpr uint32 MAX_VAR_INTEGER_SIZE_BYTES = 5;
+
+	/// <summary>
+	/// Reads and writes values at its access index. Values are stored in little-endian order regardless of the host,
+	/// and the access index does not need to be aligned to their size.
+	/// The regular reads assert the value is within the buffer, so they must only be used over data of a known size.
+	/// The TryRead variants return False instead when reading past the end, so untrusted data such as received
+	/// datagrams can be read safely. Nothing is read and the access index does not move if they fail.
+	/// Writes assert the value fits too. With asserts disabled, the ones that don't fit are dropped and HasOverflowed
+	/// returns True until the buffer is cleared, so data written by external code can still be discarded safely.
+	/// </summary>
 	class Buffer
 	{
 		public:
 			Buffer( uint8* data, int32 size );
+			/// <summary>
+			/// Creates a buffer for reading the datagram stored within a pooled packet buffer. Payloads read as views
+			/// from it can keep the packet buffer alive through AcquirePacketBuffer.
+			/// </summary>
+			Buffer( PacketBuffer& packetBuffer );
 			Buffer( const Buffer& ) = delete;
 
 			~Buffer() {}
@@ -14,6 +33,21 @@ namespace NetLib
 			int32 GetSize() const { return _size; }
 			uint8* GetData() const { return _data; }
 			uint32 GetAccessIndex() const { return _index; }
+			uint32 GetRemainingSize() const { return _size - _index; }
+			PacketBuffer* GetPacketBuffer() const { return _packetBuffer; }
+			/// <summary>
+			/// Meant for reading a datagram in place from memory that the next receive reuses. Instead of copying
+			/// every datagram up front, the first call to AcquirePacketBuffer copies it into a pooled packet buffer
+			/// and the buffer keeps reading from there. The caller owns the reference of that packet buffer.
+			/// </summary>
+			void EnablePacketBufferOnDemand() { _isPacketBufferOnDemand = true; }
+			/// <summary>
+			/// Returns the packet buffer that payloads read as views from now on can keep alive. It is null if the
+			/// data doesn't belong to a packet buffer and EnablePacketBufferOnDemand wasn't called. Views read before
+			/// the call might point to the previous memory.
+			/// </summary>
+			PacketBuffer* AcquirePacketBuffer();
+			bool HasOverflowed() const { return _hasOverflowed; }
 			void Clear();
 
 			void CopyUsedData( uint8* dst, uint32 dst_size ) const;
@@ -23,18 +57,57 @@ namespace NetLib
 			void WriteShort( uint16 value );
 			void WriteByte( uint8 value );
 			void WriteFloat( float32 value );
+			/// <summary>
+			/// Writes the value using only the bytes it needs, 7 bits per byte. Values below 128 take a single byte.
+			/// </summary>
+			void WriteVarInteger( uint32 value );
+			void WriteBytes( const uint8* data, uint32 size );
+			/// <summary>
+			/// Writes size bytes set to zero
+			/// </summary>
+			void WriteZeros( uint32 size );
 
 			uint64 ReadLong();
 			uint32 ReadInteger();
 			uint16 ReadShort();
 			uint8 ReadByte();
 			float32 ReadFloat();
+			uint32 ReadVarInteger();
+			void ReadBytes( uint8* data, uint32 size );
+			/// <summary>
+			/// Skips the next size bytes and returns a pointer to them instead of copying them. The pointer is only
+			/// valid as long as the memory of this buffer is.
+			/// </summary>
+			uint8* ReadDataView( uint32 size );
+
+			bool TryReadLong( uint64& value );
+			bool TryReadInteger( uint32& value );
+			bool TryReadShort( uint16& value );
+			bool TryReadByte( uint8& value );
+			bool TryReadFloat( float32& value );
+			bool TryReadVarInteger( uint32& value );
+			bool TryReadBytes( uint8* data, uint32 size );
+			bool TryReadDataView( uint32 size, uint8*& view );
+			/// <summary>
+			/// Gets the next byte without moving the access index
+			/// </summary>
+			bool TryPeekByte( uint8& value ) const;
 
 			void ResetAccessIndex();
 
+			/// <summary>
+			/// Number of bytes WriteVarInteger uses for the value
+			/// </summary>
+			static uint32 GetVarIntegerSize( uint32 value );
+
 		private:
+			bool CanWrite( uint32 size );
+
 			uint8* _data;
 			int32 _size;
 			int32 _index;
+			PacketBuffer* _packetBuffer;
+			bool _isPacketBufferOnDemand;
+			bool _hasOverflowed;
 	};
 } // namespace NetLib
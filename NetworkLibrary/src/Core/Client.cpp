@@ -10,13 +10,14 @@
 #include "inputs/i_input_state.h"
 
 #include "communication/message.h"
+#include "communication/inline_message.h"
 #include "communication/message_factory.h"
 #include "communication/network_packet.h"
 
 namespace NetLib
 {
 	Client::Client( float32 serverMaxInactivityTimeout )
-	    : Peer( PeerType::CLIENT, 1, 1024, 1024 )
+	    : Peer( PeerType::CLIENT, 1, MAX_DATAGRAM_SIZE_BYTES, MAX_DATAGRAM_SIZE_BYTES )
 	    , _serverAddress( "127.0.0.1", 54000 )
 	    , inGameMessageID( 0 )
 	    , _timeSinceLastTimeRequest( 0.0f )
@@ -150,7 +151,7 @@ namespace NetLib
 				if ( _currentState == ClientState::CS_Connected )
 				{
 					const ReplicationMessage& replicationMessage = static_cast< const ReplicationMessage& >( message );
-					ProcessReplicationAction( replicationMessage );
+					ProcessReplicationAction( replicationMessage, remotePeer );
 				}
 				break;
 			default:
@@ -174,7 +175,7 @@ namespace NetLib
 			{
 				LOG_ERROR( "Can't create new Connection Request Message because there is no remote peer corresponding "
 				           "to IP: %s",
-				           _serverAddress.GetIP() );
+				           _serverAddress.GetIP().c_str() );
 				return;
 			}
 
@@ -188,7 +189,7 @@ namespace NetLib
 			RemotePeer* remotePeer = _remotePeersHandler.GetRemotePeerFromAddress( _serverAddress );
 			if ( remotePeer == nullptr )
 			{
-				LOG_ERROR( "There is no Remote peer corresponding to IP: %s", _serverAddress.GetIP() );
+				LOG_ERROR( "There is no Remote peer corresponding to IP: %s", _serverAddress.GetIP().c_str() );
 				return;
 			}
 		}
@@ -197,6 +198,7 @@ namespace NetLib
 	bool Client::StopConcrete()
 	{
 		_currentState = ClientState::CS_Disconnected;
+		_replicationMessagesProcessor.ClearSnapshots();
 		return true;
 	}
 
@@ -323,72 +325,62 @@ namespace NetLib
 		          timeClock.GetServerTimeSeconds() );
 	}
 
-	void Client::ProcessReplicationAction( const ReplicationMessage& message )
+	void Client::ProcessReplicationAction( const ReplicationMessage& message, RemotePeer& remotePeer )
 	{
 		_replicationMessagesProcessor.Client_ProcessReceivedReplicationMessage( message );
-	}
-
-	void Client::CreateConnectionRequestMessage( RemotePeer& remotePeer )
-	{
-		// Get a connection request message
-		MessageFactory& messageFactory = MessageFactory::GetInstance();
-		std::unique_ptr< Message > message = messageFactory.LendMessage( MessageType::ConnectionRequest );
 
-		if ( message == nullptr )
+		uint16 snapshotSequenceNumber = 0;
+		if ( _replicationMessagesProcessor.Client_TryGetSnapshotToAck( snapshotSequenceNumber ) )
 		{
-			LOG_ERROR(
-			    "Can't create new Connection Request Message because the MessageFactory has returned a null message" );
-			return;
+			CreateSnapshotAckMessage( remotePeer, snapshotSequenceNumber );
 		}
+	}
 
-		std::unique_ptr< ConnectionRequestMessage > connectionRequestMessage(
-		    static_cast< ConnectionRequestMessage* >( message.release() ) );
+	void Client::CreateConnectionRequestMessage( RemotePeer& remotePeer )
+	{
+		InlineMessage connectionRequestMessage( MessageType::ConnectionRequest );
 
 		// Set connection request fields
-		connectionRequestMessage->clientSalt = remotePeer.GetClientSalt();
+		connectionRequestMessage.connectionRequest.clientSalt = remotePeer.GetClientSalt();
 
 		// Store message in server's pending connection in order to send it
-		remotePeer.AddMessage( std::move( connectionRequestMessage ) );
+		remotePeer.AddMessage( connectionRequestMessage );
 
 		LOG_INFO( "Connection request created." );
 	}
 
 	void Client::CreateConnectionChallengeResponse( RemotePeer& remotePeer )
 	{
-		// Get a connection challenge message
-		MessageFactory& messageFactory = MessageFactory::GetInstance();
-		std::unique_ptr< Message > message = messageFactory.LendMessage( MessageType::ConnectionChallengeResponse );
-		if ( message == nullptr )
-		{
-			LOG_ERROR( "Can't create new Connection Challenge Response Message because the MessageFactory has returned "
-			           "a null message" );
-			return;
-		}
-
-		std::unique_ptr< ConnectionChallengeResponseMessage > connectionChallengeResponseMessage(
-		    static_cast< ConnectionChallengeResponseMessage* >( message.release() ) );
+		InlineMessage connectionChallengeResponseMessage( MessageType::ConnectionChallengeResponse );
 
 		// Set connection challenge fields
-		connectionChallengeResponseMessage->prefix = remotePeer.GetDataPrefix();
+		connectionChallengeResponseMessage.connectionChallengeResponse.prefix = remotePeer.GetDataPrefix();
 
 		// Store message in server's pending connection in order to send it
-		remotePeer.AddMessage( std::move( connectionChallengeResponseMessage ) );
+		remotePeer.AddMessage( connectionChallengeResponseMessage );
 	}
 
 	void Client::CreateTimeRequestMessage( RemotePeer& remotePeer )
 	{
 		LOG_INFO( "TIME REQUEST CREATED" );
-		MessageFactory& messageFactory = MessageFactory::GetInstance();
-		std::unique_ptr< Message > lendMessage( messageFactory.LendMessage( MessageType::TimeRequest ) );
+		InlineMessage timeRequestMessage( MessageType::TimeRequest );
 
-		std::unique_ptr< TimeRequestMessage > timeRequestMessage(
-		    static_cast< TimeRequestMessage* >( lendMessage.release() ) );
-
-		timeRequestMessage->SetOrdered( true );
+		timeRequestMessage.SetOrdered( true );
 		TimeClock& timeClock = TimeClock::GetInstance();
-		timeRequestMessage->remoteTime = timeClock.GetLocalTimeMilliseconds();
+		timeRequestMessage.timeRequest.remoteTime = timeClock.GetLocalTimeMilliseconds();
+
+		remotePeer.AddMessage( timeRequestMessage );
+	}
+
+	void Client::CreateSnapshotAckMessage( RemotePeer& remotePeer, uint16 snapshotSequenceNumber )
+	{
+		// A lost ack only delays the baseline until the next snapshot is acked
+		InlineMessage snapshotAckMessage( MessageType::SnapshotAck );
+		snapshotAckMessage.SetOrdered( false );
+		snapshotAckMessage.SetReliability( false );
+		snapshotAckMessage.snapshotAck.snapshotSequenceNumber = snapshotSequenceNumber;
 
-		remotePeer.AddMessage( std::move( timeRequestMessage ) );
+		remotePeer.AddMessage( snapshotAckMessage );
 	}
 
 	void Client::UpdateTimeRequestsElapsedTime( float32 elapsedTime )
@@ -74,11 +74,12 @@ namespace NetLib
 			void ProcessConnectionRequestDenied( const ConnectionDeniedMessage& message );
 			void ProcessDisconnection( const DisconnectionMessage& message, RemotePeer& remotePeer );
 			void ProcessTimeResponse( const TimeResponseMessage& message );
-			void ProcessReplicationAction( const ReplicationMessage& message );
+			void ProcessReplicationAction( const ReplicationMessage& message, RemotePeer& remotePeer );
 
 			void CreateConnectionRequestMessage( RemotePeer& remotePeer );
 			void CreateConnectionChallengeResponse( RemotePeer& remotePeer );
 			void CreateTimeRequestMessage( RemotePeer& remotePeer );
+			void CreateSnapshotAckMessage( RemotePeer& remotePeer, uint16 snapshotSequenceNumber );
 
 			void UpdateTimeRequestsElapsedTime( float32 elapsedTime );
 
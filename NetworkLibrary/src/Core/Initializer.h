@@ -1,5 +1,6 @@
 #pragma once
 #include "core/time_clock.h"
+#include "core/packet_buffer_pool.h"
 
 #include "communication/message_factory.h"
 
@@ -8,16 +9,25 @@ namespace NetLib
 	class Initializer
 	{
 		public:
-			void static Initialize()
+			static constexpr uint32 DEFAULT_MESSAGE_POOL_SIZE = 3;
+
+			/// <summary>
+			/// The message pool size is per message type. Finalize logs the pools that fell short of it, together with
+			/// the size they would have needed.
+			/// </summary>
+			void static Initialize( uint32 messagePoolSize = DEFAULT_MESSAGE_POOL_SIZE )
 			{
 				TimeClock::CreateInstance();
-				MessageFactory::CreateInstance( 3 );
+				MessageFactory::CreateInstance( messagePoolSize );
+				PacketBufferPool::CreateInstance( 8 );
 			}
 
 			void static Finalize()
 			{
 				TimeClock::DeleteInstance();
+				// Messages may still reference packet buffers, so release them first
 				MessageFactory::DeleteInstance();
+				PacketBufferPool::DeleteInstance();
 			}
 	};
 }
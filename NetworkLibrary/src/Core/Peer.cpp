@@ -2,31 +2,82 @@
 
 #include <memory>
 #include <cassert>
+#include <algorithm>
 
 #include "communication/network_packet.h"
 #include "communication/message.h"
+#include "communication/inline_message.h"
 #include "communication/message_factory.h"
 
 #include "logger.h"
 
 #include "core/buffer.h"
+#include "core/packet_buffer_pool.h"
 #include "core/remote_peer.h"
+#include "core/socket_transport.h"
 
 namespace NetLib
 {
-	bool Peer::Start()
+	// Size of a datagram holding only the message, within an unreliable unordered section without ACKs
+	static uint32 GetSingleMessageDatagramSize( const InlineMessage& message )
 	{
+		const NetworkPacketHeader header( 0, 0, TransmissionChannelType::UnreliableUnordered );
+		return NetworkDatagramHeader::Size() + header.Size() + sizeof( uint8 ) + message.Size();
+	}
+
+	bool Peer::Start( SocketIOMode ioMode )
+	{
+		if ( _connectionState != PeerConnectionState::PCS_Disconnected )
+		{
+			LOG_WARNING( "You are trying to call Peer::Start on a Peer that has already started" );
+			return true;
+		}
+
+		_ioMode = ioMode;
+		if ( IsSharded() && !Socket::IsReusePortSupported() )
+		{
+			LOG_WARNING( "Socket shards are not supported on this platform. Falling back to a single socket..." );
+			_numberOfSocketShards = 1;
+		}
+
+		// When sharded, the sockets are owned by the shards and get started once the bind address is known
+		std::unique_ptr< Transport > transport = nullptr;
+		if ( !IsSharded() )
+		{
+			transport = std::make_unique< SocketTransport >( ioMode );
+		}
+
+		return StartInternal( std::move( transport ) );
+	}
+
+	bool Peer::Start( std::unique_ptr< Transport > transport )
+	{
+		assert( transport != nullptr );
+
 		if ( _connectionState != PeerConnectionState::PCS_Disconnected )
 		{
 			LOG_WARNING( "You are trying to call Peer::Start on a Peer that has already started" );
 			return true;
 		}
 
+		if ( IsSharded() )
+		{
+			LOG_WARNING( "Socket shards are only supported by the socket transport. Falling back to a single one..." );
+			_numberOfSocketShards = 1;
+		}
+
+		return StartInternal( std::move( transport ) );
+	}
+
+	bool Peer::StartInternal( std::unique_ptr< Transport > transport )
+	{
 		SetConnectionState( PeerConnectionState::PCS_Connecting );
 
-		if ( _socket.Start() != SocketResult::SOKT_SUCCESS )
+		_transport = std::move( transport );
+		if ( _transport != nullptr && !_transport->Start( _receiveBatch.GetDatagramMaxSize() ) )
 		{
 			LOG_ERROR( "Error while starting peer, aborting operation..." );
+			_transport.reset();
 			SetConnectionState( PeerConnectionState::PCS_Disconnected );
 			return false;
 		}
@@ -63,9 +114,11 @@ namespace NetLib
 			return false;
 		}
 
+		LockSocketShards();
 		TickRemotePeers( elapsedTime );
 		TickConcrete( elapsedTime );
 		FinishRemotePeersDisconnection();
+		UnlockSocketShards();
 
 		SendData();
 
@@ -85,6 +138,43 @@ namespace NetLib
 		return true;
 	}
 
+	bool Peer::WaitForIncomingData( float32 maxWaitSeconds ) const
+	{
+		if ( _connectionState == PeerConnectionState::PCS_Disconnected )
+		{
+			LOG_WARNING( "You are trying to call Peer::WaitForIncomingData on a Peer that is disconnected" );
+			return false;
+		}
+
+		if ( IsSharded() )
+		{
+			return _socketShardsDataSignal.WaitFor( maxWaitSeconds );
+		}
+
+		return _transport->WaitForIncomingData( maxWaitSeconds );
+	}
+
+	uint32 Peer::GetRemotePeerDatagramMaxSize( uint32 remotePeerId ) const
+	{
+		const RemotePeer* remotePeer = _remotePeersHandler.GetRemotePeerFromId( remotePeerId );
+		if ( remotePeer == nullptr )
+		{
+			return 0;
+		}
+
+		// Path MTU discovery runs within the worker of the shard that owns the remote peer
+		if ( !IsSharded() || _areSocketShardsLocked )
+		{
+			return remotePeer->GetDatagramMaxSize();
+		}
+
+		SocketShard& socketShard = *_socketShards[ remotePeer->GetSocketShardIndex() ];
+		socketShard.LockRemotePeers();
+		const uint32 datagramMaxSize = remotePeer->GetDatagramMaxSize();
+		socketShard.UnlockRemotePeers();
+		return datagramMaxSize;
+	}
+
 	void Peer::UnsubscribeToOnRemotePeerDisconnect( uint32 id )
 	{
 		_onRemotePeerDisconnect.DeleteSubscriber( id );
@@ -97,39 +187,158 @@ namespace NetLib
 
 	Peer::~Peer()
 	{
-		delete[] _receiveBuffer;
-		delete[] _sendBuffer;
+		// The shard workers call back into the peer, so they can't outlive it
+		StopSocketShards();
 	}
 
-	Peer::Peer( PeerType type, uint32 maxConnections, uint32 receiveBufferSize, uint32 sendBufferSize )
-	    : _type( type )
+	Peer::Peer( PeerType type, uint32 maxConnections, uint32 receiveBufferSize, uint32 sendBufferSize,
+	            uint32 numberOfSocketShards )
+	    : _remotePeersHandler( maxConnections )
+	    , _type( type )
 	    , _connectionState( PeerConnectionState::PCS_Disconnected )
-	    , _socket()
 	    , _address( Address::GetInvalid() )
-	    , _receiveBufferSize( receiveBufferSize )
-	    , _sendBufferSize( sendBufferSize )
-	    , _remotePeersHandler( maxConnections )
-	    , _onLocalPeerConnect()
-	    , _onLocalPeerDisconnect()
+	    , _transport( nullptr )
+	    , _receiveBatch( MAX_DATAGRAM_BATCH_SIZE, receiveBufferSize )
+	    , _sendBatch( MAX_DATAGRAM_BATCH_SIZE, sendBufferSize )
+	    , _packetBuilder()
+	    , _numberOfSocketShards( ( numberOfSocketShards > 0 ) ? numberOfSocketShards : 1 )
+	    , _ioMode( SocketIOMode::DEFAULT )
+	    , _socketShards()
+	    , _socketShardsOutgoingDatagrams()
+	    , _socketShardsUnknownPeerMessages()
+	    , _socketShardsRemotePeers()
+	    , _socketShardsDataSignal()
+	    , _currentSocketShardIndex( 0 )
+	    , _areSocketShardsLocked( false )
 	    , _isStopRequested( false )
 	    , _stopRequestShouldNotifyRemotePeers( false )
 	    , _stopRequestReason( ConnectionFailedReasonType::CFR_UNKNOWN )
+	    , _onLocalPeerConnect()
+	    , _onLocalPeerDisconnect()
 	{
-		_receiveBuffer = new uint8[ _receiveBufferSize ];
-		_sendBuffer = new uint8[ _sendBufferSize ];
 	}
 
-	void Peer::SendPacketToAddress( const NetworkPacket& packet, const Address& address ) const
+	void Peer::SendPacketToAddress( const NetworkPacket& packet, const Address& address )
 	{
-		Buffer buffer = Buffer( _sendBuffer, packet.Size() );
+		SendPacketToAddress( packet, address, _currentSocketShardIndex );
+	}
+
+	void Peer::SendPacketToAddress( const NetworkPacket& packet, const Address& address, uint32 socketShardIndex )
+	{
+		const uint32 packetSize = packet.Size();
+		if ( NetworkDatagramHeader::Size() + packetSize > _sendBatch.GetDatagramMaxSize() )
+		{
+			LOG_ERROR( "Trying to send a packet bigger than the send buffer size. Packet size: %u, Send buffer size: "
+			           "%u. Discarding it...",
+			           packetSize, _sendBatch.GetDatagramMaxSize() );
+			return;
+		}
+
+		// The packet goes as the only section of the datagram
+		const uint32 datagramSize = NetworkDatagramHeader::Size() + packetSize;
+		uint8* datagramData = BeginOutgoingDatagram( address, socketShardIndex );
+		Buffer buffer = Buffer( datagramData, datagramSize );
+		const NetworkDatagramHeader datagramHeader( 1 );
+		datagramHeader.Write( buffer );
 		packet.Write( buffer );
 
-		_socket.SendTo( _sendBuffer, packet.Size(), address );
+		CommitOutgoingDatagram( datagramSize, address, socketShardIndex );
+	}
+
+	void Peer::SendMessageToAddress( const InlineMessage& message, const Address& address )
+	{
+		SendMessageToAddress( message, address, _currentSocketShardIndex );
+	}
+
+	void Peer::SendMessageToAddress( const InlineMessage& message, const Address& address, uint32 socketShardIndex )
+	{
+		const uint32 datagramSize = GetSingleMessageDatagramSize( message );
+		if ( datagramSize > _sendBatch.GetDatagramMaxSize() )
+		{
+			LOG_ERROR( "Trying to send a message bigger than the send buffer size. Datagram size: %u, Send buffer "
+			           "size: %u. Discarding it...",
+			           datagramSize, _sendBatch.GetDatagramMaxSize() );
+			return;
+		}
+
+		// Same layout as a packet with a single message
+		const NetworkPacketHeader header( 0, 0, TransmissionChannelType::UnreliableUnordered );
+		uint8* datagramData = BeginOutgoingDatagram( address, socketShardIndex );
+		Buffer buffer = Buffer( datagramData, datagramSize );
+		const NetworkDatagramHeader datagramHeader( 1 );
+		datagramHeader.Write( buffer );
+		header.Write( buffer );
+		buffer.WriteByte( 1 );
+		message.Write( buffer );
+
+		CommitOutgoingDatagram( datagramSize, address, socketShardIndex );
+	}
+
+	uint8* Peer::BeginOutgoingDatagram( const Address& address, uint32 socketShardIndex )
+	{
+		if ( IsSharded() )
+		{
+			assert( socketShardIndex < _socketShards.size() );
+			SocketShard& socketShard = *_socketShards[ socketShardIndex ];
+			if ( socketShard.IsWorkerThread() )
+			{
+				return socketShard.BeginOutgoingDatagram();
+			}
+
+			// Push it with its maximum size. It gets shrunk to its real size when commited
+			DatagramQueue& outgoingDatagrams = _socketShardsOutgoingDatagrams[ socketShardIndex ];
+			return outgoingDatagrams.PushDatagram( _sendBatch.GetDatagramMaxSize(), address );
+		}
+
+		if ( _sendBatch.IsFull() )
+		{
+			FlushSendBatch();
+		}
+
+		return _sendBatch.GetNextFreeDatagramData();
+	}
+
+	void Peer::CommitOutgoingDatagram( uint32 size, const Address& address, uint32 socketShardIndex )
+	{
+		if ( IsSharded() )
+		{
+			assert( socketShardIndex < _socketShards.size() );
+			SocketShard& socketShard = *_socketShards[ socketShardIndex ];
+			if ( socketShard.IsWorkerThread() )
+			{
+				socketShard.CommitOutgoingDatagram( size, address );
+			}
+			else
+			{
+				_socketShardsOutgoingDatagrams[ socketShardIndex ].ShrinkLastDatagram( size );
+			}
+
+			return;
+		}
+
+		_sendBatch.CommitDatagram( size, address );
+	}
+
+	uint32 Peer::GetOutgoingDatagramMaxSize() const
+	{
+		return std::min( _sendBatch.GetDatagramMaxSize(), MAX_DATAGRAM_SIZE_BYTES );
 	}
 
 	bool Peer::AddRemotePeer( const Address& addressInfo, uint16 id, uint64 clientSalt, uint64 serverSalt )
 	{
 		bool addedSuccesfully = _remotePeersHandler.AddRemotePeer( addressInfo, id, clientSalt, serverSalt );
+		if ( addedSuccesfully )
+		{
+			// Keep answering through the shard that received its first datagram
+			RemotePeer* remotePeer = _remotePeersHandler.GetRemotePeerFromAddress( addressInfo );
+			assert( remotePeer != nullptr );
+			remotePeer->SetSocketShardIndex( _currentSocketShardIndex );
+			remotePeer->SetMaxDatagramSize( GetOutgoingDatagramMaxSize() );
+			if ( IsSharded() )
+			{
+				_socketShardsRemotePeers[ _currentSocketShardIndex ].push_back( remotePeer );
+			}
+		}
 
 		return addedSuccesfully;
 	}
@@ -140,15 +349,14 @@ namespace NetLib
 		ExecuteOnRemotePeerConnect( remotePeer.GetClientIndex() );
 	}
 
-	bool Peer::BindSocket( const Address& address ) const
+	bool Peer::BindSocket( const Address& address )
 	{
-		SocketResult result = _socket.Bind( address );
-		if ( result != SocketResult::SOKT_SUCCESS )
+		if ( IsSharded() )
 		{
-			return false;
+			return StartSocketShards( address );
 		}
 
-		return true;
+		return _transport->Bind( address );
 	}
 
 	void Peer::DisconnectAllRemotePeers( bool shouldNotify, ConnectionFailedReasonType reason )
@@ -166,6 +374,10 @@ namespace NetLib
 		}
 
 		_remotePeersHandler.RemoveAllRemotePeers();
+		for ( uint32 i = 0; i < _socketShardsRemotePeers.size(); ++i )
+		{
+			_socketShardsRemotePeers[ i ].clear();
+		}
 	}
 
 	void Peer::DisconnectRemotePeer( const RemotePeer& remotePeer, bool shouldNotify,
@@ -176,6 +388,16 @@ namespace NetLib
 			CreateDisconnectionPacket( remotePeer, reason );
 		}
 
+		if ( IsSharded() )
+		{
+			std::vector< RemotePeer* >& socketShardRemotePeers =
+			    _socketShardsRemotePeers[ remotePeer.GetSocketShardIndex() ];
+			auto it = std::find( socketShardRemotePeers.begin(), socketShardRemotePeers.end(), &remotePeer );
+			assert( it != socketShardRemotePeers.end() );
+			*it = socketShardRemotePeers.back();
+			socketShardRemotePeers.pop_back();
+		}
+
 		const uint32 id = remotePeer.GetClientIndex();
 		bool removedSuccesfully = _remotePeersHandler.RemoveRemotePeer( id );
 		assert( removedSuccesfully );
@@ -184,21 +406,29 @@ namespace NetLib
 
 	void Peer::CreateDisconnectionPacket( const RemotePeer& remotePeer, ConnectionFailedReasonType reason )
 	{
-		NetworkPacket packet;
-		packet.SetHeaderChannelType( TransmissionChannelType::UnreliableUnordered );
+		InlineMessage disconnectionMessage( MessageType::Disconnection );
+		disconnectionMessage.disconnection.prefix = remotePeer.GetDataPrefix();
+		disconnectionMessage.disconnection.reason = reason;
 
-		MessageFactory& messageFactory = MessageFactory::GetInstance();
-		std::unique_ptr< Message > message = messageFactory.LendMessage( MessageType::Disconnection );
+		SendMessageToAddress( disconnectionMessage, remotePeer.GetAddress(), remotePeer.GetSocketShardIndex() );
+	}
+
+	void Peer::SendPathMTUProbe( RemotePeer& remotePeer )
+	{
+		PathMTUDiscovery& pathMTUDiscovery = remotePeer.GetPathMTUDiscovery();
 
-		std::unique_ptr< DisconnectionMessage > disconenctionMessage(
-		    static_cast< DisconnectionMessage* >( message.release() ) );
-		disconenctionMessage->SetOrdered( false );
-		disconenctionMessage->SetReliability( false );
-		disconenctionMessage->prefix = remotePeer.GetDataPrefix();
-		disconenctionMessage->reason = reason;
+		InlineMessage probeMessage( MessageType::PathMTUProbe );
 
-		packet.AddMessage( std::move( disconenctionMessage ) );
-		SendPacketToAddress( packet, remotePeer.GetAddress() );
+		// Pad the probe until the whole datagram has the size being probed
+		const uint32 probeSizeWithoutPadding = GetSingleMessageDatagramSize( probeMessage );
+		assert( pathMTUDiscovery.GetProbeSize() >= probeSizeWithoutPadding );
+
+		probeMessage.pathMTUProbe.probeId = pathMTUDiscovery.GetProbeId();
+		probeMessage.pathMTUProbe.paddingSize =
+		    static_cast< uint16 >( pathMTUDiscovery.GetProbeSize() - probeSizeWithoutPadding );
+
+		SendMessageToAddress( probeMessage, remotePeer.GetAddress(), remotePeer.GetSocketShardIndex() );
+		pathMTUDiscovery.OnProbeSent();
 	}
 
 	void Peer::ExecuteOnLocalPeerConnect()
@@ -224,20 +454,38 @@ namespace NetLib
 
 	void Peer::ProcessReceivedData()
 	{
+		if ( IsSharded() )
+		{
+			// The shard workers have already processed the received datagrams. Only the messages for the game are
+			// left. Consume before it so data notified meanwhile is not lost for the next wait
+			LockSocketShards();
+			_socketShardsDataSignal.Consume();
+			ProcessSocketShardsUnknownPeerMessages();
+			ProcessNewRemotePeerMessages();
+			UnlockSocketShards();
+			return;
+		}
+
 		Address remoteAddress = Address::GetInvalid();
-		uint32 numberOfBytesRead = 0;
 		bool arePendingDatagramsToRead = true;
 
 		do
 		{
-			SocketResult result =
-			    _socket.ReceiveFrom( _receiveBuffer, _receiveBufferSize, remoteAddress, numberOfBytesRead );
+			_receiveBatch.Clear();
+			SocketResult result = _transport->ReceiveFromBatch( _receiveBatch, remoteAddress );
+
+			// Datagrams read before an error are still valid, so process them first
+			const uint32 numberOfDatagrams = _receiveBatch.GetNumberOfDatagrams();
+			for ( uint32 i = 0; i < numberOfDatagrams; ++i )
+			{
+				ProcessDatagram( _receiveBatch.GetDatagramData( i ), _receiveBatch.GetDatagramSize( i ),
+				                 _receiveBatch.GetDatagramAddress( i ), 0 );
+			}
 
 			if ( result == SocketResult::SOKT_SUCCESS )
 			{
-				// Data read succesfully. Keep going!
-				Buffer buffer = Buffer( _receiveBuffer, numberOfBytesRead );
-				ProcessDatagram( buffer, remoteAddress );
+				// Data read succesfully. If the batch didn't get filled there is no more data to read atm
+				arePendingDatagramsToRead = _receiveBatch.IsFull();
 			}
 			else if ( result == SocketResult::SOKT_ERR || result == SocketResult::SOKT_WOULDBLOCK )
 			{
@@ -259,13 +507,75 @@ namespace NetLib
 		ProcessNewRemotePeerMessages();
 	}
 
-	void Peer::ProcessDatagram( Buffer& buffer, const Address& address )
+	void Peer::ProcessSocketShardsUnknownPeerMessages()
+	{
+		MessageFactory& messageFactory = MessageFactory::GetInstance();
+		for ( uint32 i = 0; i < _socketShardsUnknownPeerMessages.size(); ++i )
+		{
+			// Remote peers added while processing them belong to the shard that received them
+			_currentSocketShardIndex = i;
+
+			std::vector< UnknownPeerMessage >& unknownPeerMessages = _socketShardsUnknownPeerMessages[ i ];
+			for ( uint32 j = 0; j < unknownPeerMessages.size(); ++j )
+			{
+				ProcessMessageFromUnknownPeer( *unknownPeerMessages[ j ].message, unknownPeerMessages[ j ].address );
+				messageFactory.ReleaseMessage( std::move( unknownPeerMessages[ j ].message ) );
+			}
+
+			unknownPeerMessages.clear();
+		}
+	}
+
+	void Peer::ProcessDatagram( uint8* data, uint32 size, const Address& address, uint32 socketShardIndex )
 	{
-		// Read incoming packet
-		NetworkPacket packet = NetworkPacket();
-		packet.Read( buffer );
+		// The datagram is parsed where it was received. That memory gets reused on the next read, so it is only copied
+		// into a pooled packet buffer once a message keeps a view of its payload. Messages reference the packet buffer
+		// instead of copying their payloads, and it goes back to the pool once all of them are freed
+		Buffer buffer = Buffer( data, static_cast< int32 >( size ) );
+		buffer.EnablePacketBufferOnDemand();
 
 		RemotePeer* remotePeer = _remotePeersHandler.GetRemotePeerFromAddress( address );
+		if ( remotePeer != nullptr && remotePeer->GetSocketShardIndex() != socketShardIndex )
+		{
+			// Another shard owns it and might be accessing it right now. SO_REUSEPORT keeps each flow within the same
+			// socket, so this only happens if the kernel rebalances them
+			LOG_WARNING(
+			    "Received a datagram through a socket shard that doesn't own its remote peer. Ignoring it..." );
+			return;
+		}
+
+		// Process the packet of each transmission channel section
+		NetworkDatagramHeader datagramHeader;
+		if ( !datagramHeader.Read( buffer ) )
+		{
+			LOG_WARNING( "Received an empty datagram or one using another wire format version. Ignoring it..." );
+			datagramHeader.numberOfSections = 0;
+		}
+
+		for ( uint32 i = 0; i < datagramHeader.numberOfSections; ++i )
+		{
+			NetworkPacket packet = NetworkPacket();
+			if ( !packet.Read( buffer ) )
+			{
+				// Drop the malformed section and what follows it. Reliable messages within it will be resent
+				LOG_WARNING( "Received a malformed datagram. Ignoring the rest of it..." );
+				break;
+			}
+
+			ProcessPacket( packet, remotePeer, address, socketShardIndex );
+		}
+
+		// Messages that need it have already added their own references
+		PacketBuffer* packetBuffer = buffer.GetPacketBuffer();
+		if ( packetBuffer != nullptr )
+		{
+			packetBuffer->RemoveReference();
+		}
+	}
+
+	void Peer::ProcessPacket( NetworkPacket& packet, RemotePeer* remotePeer, const Address& address,
+	                          uint32 socketShardIndex )
+	{
 		bool isPacketFromRemotePeer = ( remotePeer != nullptr );
 
 		// Process packet ACKs
@@ -283,10 +593,22 @@ namespace NetLib
 		while ( packet.GetNumberOfMessages() > 0 )
 		{
 			std::unique_ptr< Message > message = packet.GetMessages();
-			if ( isPacketFromRemotePeer )
+			const MessageType messageType = message->GetHeader().type;
+			if ( isPacketFromRemotePeer &&
+			     ( messageType == MessageType::PathMTUProbe || messageType == MessageType::PathMTUProbeResponse ) )
+			{
+				ProcessPathMTUMessage( *message, *remotePeer );
+				messageFactory.ReleaseMessage( std::move( message ) );
+			}
+			else if ( isPacketFromRemotePeer )
 			{
 				remotePeer->AddReceivedMessage( std::move( message ) );
 			}
+			else if ( IsSharded() )
+			{
+				// Leave it for the main thread
+				_socketShardsUnknownPeerMessages[ socketShardIndex ].push_back( { std::move( message ), address } );
+			}
 			else
 			{
 				ProcessMessageFromUnknownPeer( *message, address );
@@ -295,6 +617,25 @@ namespace NetLib
 		}
 	}
 
+	void Peer::ProcessPathMTUMessage( const Message& message, RemotePeer& remotePeer )
+	{
+		if ( message.GetHeader().type == MessageType::PathMTUProbeResponse )
+		{
+			const PathMTUProbeResponseMessage& responseMessage =
+			    static_cast< const PathMTUProbeResponseMessage& >( message );
+			remotePeer.GetPathMTUDiscovery().OnProbeResponse( responseMessage.probeId );
+			return;
+		}
+
+		// Getting the probe is all it takes. Let the remote peer know
+		const PathMTUProbeMessage& probeMessage = static_cast< const PathMTUProbeMessage& >( message );
+
+		InlineMessage responseMessage( MessageType::PathMTUProbeResponse );
+		responseMessage.pathMTUProbeResponse.probeId = probeMessage.probeId;
+
+		SendMessageToAddress( responseMessage, remotePeer.GetAddress(), remotePeer.GetSocketShardIndex() );
+	}
+
 	void Peer::ProcessNewRemotePeerMessages()
 	{
 		auto validRemotePeersIt = _remotePeersHandler.GetValidRemotePeersIterator();
@@ -325,6 +666,12 @@ namespace NetLib
 			RemotePeer& remotePeer = **validRemotePeersIt;
 			remotePeer.Tick( elapsedTime );
 
+			if ( remotePeer.GeturrentState() == RemotePeerState::Connected &&
+			     remotePeer.GetPathMTUDiscovery().IsProbePending() )
+			{
+				SendPathMTUProbe( remotePeer );
+			}
+
 			// Start the disconnection process for those ones who are inactive
 			if ( remotePeer.IsInactive() )
 			{
@@ -336,7 +683,20 @@ namespace NetLib
 
 	void Peer::SendData()
 	{
+		if ( IsSharded() )
+		{
+			// Each shard worker serializes the data of its own remote peers
+			FlushSendBatch();
+			for ( uint32 i = 0; i < _socketShards.size(); ++i )
+			{
+				_socketShards[ i ]->RequestSendData();
+			}
+
+			return;
+		}
+
 		SendDataToRemotePeers();
+		FlushSendBatch();
 	}
 
 	void Peer::SendDataToRemotePeers()
@@ -352,76 +712,146 @@ namespace NetLib
 
 	void Peer::SendDataToRemotePeer( RemotePeer& remotePeer )
 	{
-		// Send one packet per Remote peer transmission channel
-		std::vector< TransmissionChannelType > channelTypes = remotePeer.GetAvailableTransmissionChannelTypes();
-		std::vector< TransmissionChannelType >::const_iterator cit = channelTypes.cbegin();
-		for ( cit; cit != channelTypes.cend(); ++cit )
+		// All the transmission channels share the same datagram. Only if some messages didn't fit, more datagrams are
+		// sent. At most one per transmission channel, as it was the case before coalescing them, and only while the
+		// send rate of the remote peer allows it. The rest stay queued for the next ticks
+		const uint32 numberOfTransmissionChannels = remotePeer.GetNumberOfTransmissionChannels();
+		bool isThereDataToSend = true;
+		for ( uint32 i = 0; i < numberOfTransmissionChannels && isThereDataToSend && remotePeer.CanSendDatagram(); ++i )
 		{
-			TransmissionChannelType channelType = *cit;
-			SendPacketToRemotePeer( remotePeer, channelType );
+			isThereDataToSend = SendDatagramToRemotePeer( remotePeer );
 		}
 
 		remotePeer.FreeSentMessages();
 	}
 
-	void Peer::SendPacketToRemotePeer( RemotePeer& remotePeer, TransmissionChannelType type )
+	bool Peer::SendDatagramToRemotePeer( RemotePeer& remotePeer )
 	{
-		if ( !remotePeer.ArePendingMessages( type ) && !remotePeer.AreUnsentACKs( type ) )
+		const uint32 numberOfTransmissionChannels = remotePeer.GetNumberOfTransmissionChannels();
+
+		// Datagrams get as big as the path to the remote peer allows. However, messages queued before the path MTU
+		// shrank might not fit anymore. Send those as before discovering it instead of blocking their channel forever
+		uint32 datagramMaxSize = remotePeer.GetDatagramMaxSize();
+		bool isThereDataToSend = false;
+		for ( uint32 i = 0; i < numberOfTransmissionChannels; ++i )
 		{
-			return;
+			TransmissionChannelType channelType = remotePeer.GetTransmissionChannelType( i );
+			const bool arePendingMessages = remotePeer.ArePendingMessages( channelType );
+			isThereDataToSend = isThereDataToSend || arePendingMessages || remotePeer.AreUnsentACKs( channelType );
+
+			if ( arePendingMessages &&
+			     remotePeer.GetSizeOfNextUnsentMessage( channelType ) > remotePeer.GetMaxMessageSize() )
+			{
+				datagramMaxSize = GetOutgoingDatagramMaxSize();
+			}
+		}
+
+		if ( !isThereDataToSend )
+		{
+			return false;
 		}
 
-		NetworkPacket packet = NetworkPacket();
+		// Serialize the datagram straight into the outgoing datagram memory
+		const Address& address = remotePeer.GetAddress();
+		const uint32 socketShardIndex = remotePeer.GetSocketShardIndex();
+		PacketBuilder& packetBuilder =
+		    IsSharded() ? _socketShards[ socketShardIndex ]->GetPacketBuilder() : _packetBuilder;
+		uint8* datagramData = BeginOutgoingDatagram( address, socketShardIndex );
+		packetBuilder.Begin( datagramData, datagramMaxSize );
+
+		bool arePendingMessages = false;
+		for ( uint32 i = 0; i < numberOfTransmissionChannels; ++i )
+		{
+			TransmissionChannelType channelType = remotePeer.GetTransmissionChannelType( i );
+			if ( !remotePeer.ArePendingMessages( channelType ) && !remotePeer.AreUnsentACKs( channelType ) )
+			{
+				continue;
+			}
+
+			if ( packetBuilder.CanSectionFit() )
+			{
+				WriteChannelSection( remotePeer, channelType, packetBuilder );
+			}
+
+			arePendingMessages = arePendingMessages || remotePeer.ArePendingMessages( channelType );
+		}
+
+		const uint32 datagramSize = packetBuilder.Finish();
+		CommitOutgoingDatagram( datagramSize, address, socketShardIndex );
+		remotePeer.OnDatagramSent( datagramSize );
+
+		// Avoid looping forever if the next message doesn't fit within an empty datagram
+		return arePendingMessages && packetBuilder.GetNumberOfMessages() > 0;
+	}
+
+	void Peer::WriteChannelSection( RemotePeer& remotePeer, TransmissionChannelType type,
+	                                PacketBuilder& packetBuilder )
+	{
+		// Set section header fields
+		NetworkPacketHeader header;
+		header.SetACKs( remotePeer.GenerateACKs( type ) );
+		header.SetHeaderLastAcked( remotePeer.GetLastMessageSequenceNumberAcked( type ) );
+		header.SetChannelType( type );
+
+		packetBuilder.BeginSection( header );
 
-		// TODO Check somewhere if there is a message larger than the maximum packet size. Log a warning saying that the
-		// message will never get sent and delete it.
 		// TODO Include data prefix in packet's header and check if the data prefix is correct when receiving a packet
 
-		// Check if we should include a message to the packet
+		// Check if we should include a message to the section
 		bool arePendingMessages = remotePeer.ArePendingMessages( type );
-		bool isThereCapacityLeft = packet.CanMessageFit( remotePeer.GetSizeOfNextUnsentMessage( type ) );
+		bool isThereCapacityLeft = packetBuilder.CanMessageFit( remotePeer.GetSizeOfNextUnsentMessage( type ) );
 
 		while ( arePendingMessages && isThereCapacityLeft )
 		{
-			// Configure and add message to packet
-			std::unique_ptr< Message > message = remotePeer.GetPendingMessage( type );
+			QueuedMessage message = remotePeer.GetPendingMessage( type );
 
-			if ( message->GetHeader().isReliable )
+			if ( message.GetHeader().isReliable )
 			{
 				LOG_INFO( "Reliable message sequence number: %hu, Message type: %hhu",
-				          message->GetHeader().messageSequenceNumber, message->GetHeader().type );
+				          message.GetHeader().messageSequenceNumber, message.GetHeader().type );
+			}
+
+			// Fixed-size messages are serialized by value, with no virtual calls
+			if ( message.IsInline() )
+			{
+				packetBuilder.AddMessage( message.GetInlineMessage() );
+			}
+			else
+			{
+				packetBuilder.AddMessage( message.GetMessage() );
 			}
 
-			packet.AddMessage( std::move( message ) );
+			// Once serialized, send message ownership back to remote peer
+			remotePeer.AddSentMessage( std::move( message ), type );
 
-			// Check if we should include another message to the packet
+			// Check if we should include another message to the section
 			arePendingMessages = remotePeer.ArePendingMessages( type );
-			isThereCapacityLeft = packet.CanMessageFit( remotePeer.GetSizeOfNextUnsentMessage( type ) );
+			isThereCapacityLeft = packetBuilder.CanMessageFit( remotePeer.GetSizeOfNextUnsentMessage( type ) );
 		}
 
-		// Set packet header fields
-		uint32 acks = remotePeer.GenerateACKs( type );
-		packet.SetHeaderACKs( acks );
-
-		uint16 lastAckedMessageSequenceNumber = remotePeer.GetLastMessageSequenceNumberAcked( type );
-		packet.SetHeaderLastAcked( lastAckedMessageSequenceNumber );
+		packetBuilder.EndSection();
+		remotePeer.SeUnsentACKsToFalse( type );
+	}
 
-		packet.SetHeaderChannelType( type );
+	void Peer::FlushSendBatch()
+	{
+		if ( IsSharded() )
+		{
+			for ( uint32 i = 0; i < _socketShards.size(); ++i )
+			{
+				_socketShards[ i ]->SendDatagrams( _socketShardsOutgoingDatagrams[ i ] );
+			}
 
-		SendPacketToAddress( packet, remotePeer.GetAddress() );
-		remotePeer.SeUnsentACKsToFalse( type );
+			return;
+		}
 
-		// Send messages ownership back to remote peer
-		while ( packet.GetNumberOfMessages() > 0 )
+		if ( _sendBatch.IsEmpty() )
 		{
-			std::unique_ptr< Message > message = packet.GetMessages();
-			remotePeer.AddSentMessage( std::move( message ), type );
+			return;
 		}
-	}
 
-	void Peer::SendDataToAddress( const Buffer& buffer, const Address& address ) const
-	{
-		_socket.SendTo( buffer.GetData(), buffer.GetSize(), address );
+		_transport->SendToBatch( _sendBatch );
+		_sendBatch.Clear();
 	}
 
 	void Peer::StartDisconnectingRemotePeer( uint32 id, bool shouldNotify, ConnectionFailedReasonType reason )
@@ -500,6 +930,101 @@ namespace NetLib
 		_onRemotePeerConnect.Execute( remotePeerId );
 	}
 
+	bool Peer::StartSocketShards( const Address& address )
+	{
+		const uint32 datagramMaxSize = std::max( _receiveBatch.GetDatagramMaxSize(), _sendBatch.GetDatagramMaxSize() );
+
+		// Create all of them before starting any, as the workers access the shards' containers
+		_socketShards.reserve( _numberOfSocketShards );
+		_socketShardsOutgoingDatagrams.resize( _numberOfSocketShards );
+		_socketShardsUnknownPeerMessages.resize( _numberOfSocketShards );
+		_socketShardsRemotePeers.resize( _numberOfSocketShards );
+		ISocketShardHandler& socketShardHandler = *this;
+		for ( uint32 i = 0; i < _numberOfSocketShards; ++i )
+		{
+			_socketShards.push_back(
+			    std::make_unique< SocketShard >( i, datagramMaxSize, socketShardHandler, _socketShardsDataSignal ) );
+		}
+
+		for ( uint32 i = 0; i < _numberOfSocketShards; ++i )
+		{
+			if ( !_socketShards[ i ]->Start( address, _ioMode ) )
+			{
+				LOG_ERROR( "Error while starting the socket shards" );
+				StopSocketShards();
+				return false;
+			}
+		}
+
+		LOG_INFO( "Started %u socket shards", _numberOfSocketShards );
+		return true;
+	}
+
+	void Peer::StopSocketShards()
+	{
+		for ( uint32 i = 0; i < _socketShards.size(); ++i )
+		{
+			_socketShards[ i ]->Stop();
+		}
+
+		// The workers are gone, so nobody else accesses the unknown peer messages
+		MessageFactory& messageFactory = MessageFactory::GetInstance();
+		for ( uint32 i = 0; i < _socketShardsUnknownPeerMessages.size(); ++i )
+		{
+			std::vector< UnknownPeerMessage >& unknownPeerMessages = _socketShardsUnknownPeerMessages[ i ];
+			for ( uint32 j = 0; j < unknownPeerMessages.size(); ++j )
+			{
+				messageFactory.ReleaseMessage( std::move( unknownPeerMessages[ j ].message ) );
+			}
+		}
+
+		_socketShards.clear();
+		_socketShardsOutgoingDatagrams.clear();
+		_socketShardsUnknownPeerMessages.clear();
+		_socketShardsRemotePeers.clear();
+		_socketShardsDataSignal.Consume();
+		_currentSocketShardIndex = 0;
+	}
+
+	void Peer::LockSocketShards()
+	{
+		// Always in the same order, so the main thread never deadlocks with itself
+		for ( uint32 i = 0; i < _socketShards.size(); ++i )
+		{
+			_socketShards[ i ]->LockRemotePeers();
+		}
+
+		_areSocketShardsLocked = true;
+	}
+
+	void Peer::UnlockSocketShards()
+	{
+		_areSocketShardsLocked = false;
+		for ( uint32 i = 0; i < _socketShards.size(); ++i )
+		{
+			_socketShards[ i ]->UnlockRemotePeers();
+		}
+	}
+
+	void Peer::ProcessSocketShardDatagrams( SocketShard& socketShard, const DatagramBatch& batch )
+	{
+		const uint32 numberOfDatagrams = batch.GetNumberOfDatagrams();
+		for ( uint32 i = 0; i < numberOfDatagrams; ++i )
+		{
+			ProcessDatagram( batch.GetDatagramData( i ), batch.GetDatagramSize( i ), batch.GetDatagramAddress( i ),
+			                 socketShard.GetIndex() );
+		}
+	}
+
+	void Peer::SendSocketShardData( SocketShard& socketShard )
+	{
+		const std::vector< RemotePeer* >& socketShardRemotePeers = _socketShardsRemotePeers[ socketShard.GetIndex() ];
+		for ( uint32 i = 0; i < socketShardRemotePeers.size(); ++i )
+		{
+			SendDataToRemotePeer( *socketShardRemotePeers[ i ] );
+		}
+	}
+
 	void Peer::StopInternal()
 	{
 		if ( _connectionState == PeerConnectionState::PCS_Disconnected )
@@ -508,9 +1033,17 @@ namespace NetLib
 			return;
 		}
 
+		LockSocketShards();
 		StopConcrete();
 		DisconnectAllRemotePeers( _stopRequestShouldNotifyRemotePeers, _stopRequestReason );
-		_socket.Close();
+		UnlockSocketShards();
+		FlushSendBatch();
+		StopSocketShards();
+		if ( _transport != nullptr )
+		{
+			_transport->Close();
+			_transport.reset();
+		}
 
 		_isStopRequested = false;
 
@@ -3,13 +3,21 @@
 
 #include <vector>
 #include <list>
+#include <memory>
 
 #include "Delegate.h"
 
 #include "core/address.h"
 #include "core/socket.h"
+#include "core/transport.h"
+#include "core/datagram_batch.h"
+#include "core/datagram_queue.h"
+#include "core/socket_shard.h"
+#include "core/i_socket_shard_handler.h"
 #include "core/remote_peers_handler.h"
 
+#include "communication/packet_builder.h"
+
 #include "transmission_channels/transmission_channel.h"
 
 class Buffer;
@@ -17,6 +25,7 @@ class Buffer;
 namespace NetLib
 {
 	class Message;
+	class InlineMessage;
 	class NetworkPacket;
 	class RemotePeer;
 	class Buffer;
@@ -38,6 +47,15 @@ namespace NetLib
 			ConnectionFailedReasonType reason;
 	};
 
+	/// <summary>
+	/// Message from an address without a remote peer, received by a socket shard and waiting for the main thread
+	/// </summary>
+	struct UnknownPeerMessage
+	{
+			std::unique_ptr< Message > message;
+			Address address;
+	};
+
 	enum class PeerType : uint8
 	{
 		NONE = 0,
@@ -54,16 +72,39 @@ namespace NetLib
 
 	// TODO Set ordered and reliable flags in all the connection messages such as challenge response, connection
 	// approved...
-	class Peer
+	class Peer : private ISocketShardHandler
 	{
 		public:
-			bool Start();
+			/// <summary>
+			/// Starts the peer
+			/// </summary>
+			/// <param name="ioMode">Socket I/O mode. If the selected mode is not supported by the platform it falls
+			/// back to the default one</param>
+			bool Start( SocketIOMode ioMode = SocketIOMode::DEFAULT );
+			/// <summary>
+			/// Starts the peer using a custom transport, for example a LoopbackTransport. Socket shards are not
+			/// supported by this overload.
+			/// </summary>
+			bool Start( std::unique_ptr< Transport > transport );
 			bool PreTick();
 			bool Tick( float32 elapsedTime );
 			bool Stop();
+			/// <summary>
+			/// Blocks until there is incoming data to process or the timeout expires. Use it for sleeping between ticks
+			/// instead of busy-polling the socket.
+			/// </summary>
+			/// <param name="maxWaitSeconds">Maximum time to wait, usually the time left until the next tick</param>
+			/// <returns>True if there is incoming data ready to be processed by PreTick, False otherwise</returns>
+			bool WaitForIncomingData( float32 maxWaitSeconds ) const;
 
 			PeerConnectionState GetConnectionState() const { return _connectionState; }
 			PeerType GetPeerType() const { return _type; }
+			/// <summary>
+			/// Size of the biggest datagram known to reach the remote peer. Path MTU discovery keeps looking for it
+			/// while connected.
+			/// </summary>
+			/// <returns>The size in bytes, or 0 if there isn't a remote peer with that id</returns>
+			uint32 GetRemotePeerDatagramMaxSize( uint32 remotePeerId ) const;
 
 			// Delegates related
 			template < typename Functor >
@@ -82,7 +123,14 @@ namespace NetLib
 			virtual ~Peer();
 
 		protected:
-			Peer( PeerType type, uint32 maxConnections, uint32 receiveBufferSize, uint32 sendBufferSize );
+			/// <summary>
+			/// Creates the peer
+			/// </summary>
+			/// <param name="numberOfSocketShards">Number of sockets bound to the same port through SO_REUSEPORT, each
+			/// one with its own thread for the I/O and the processing of the remote peers it receives. With a single
+			/// shard everything happens within the calling thread</param>
+			Peer( PeerType type, uint32 maxConnections, uint32 receiveBufferSize, uint32 sendBufferSize,
+			      uint32 numberOfSocketShards = 1 );
 			Peer( const Peer& ) = delete;
 
 			Peer& operator=( const Peer& ) = delete;
@@ -93,10 +141,29 @@ namespace NetLib
 			virtual void TickConcrete( float32 elapsedTime ) = 0;
 			virtual bool StopConcrete() = 0;
 
-			void SendPacketToAddress( const NetworkPacket& packet, const Address& address ) const;
+			/// <summary>
+			/// Serializes the packet into the send batch. The actual send happens once the batch is full or when the
+			/// batch gets flushed at the end of the tick.
+			/// </summary>
+			void SendPacketToAddress( const NetworkPacket& packet, const Address& address );
+			/// <summary>
+			/// Same as above but, when sharded, the packet leaves through the given socket shard
+			/// </summary>
+			void SendPacketToAddress( const NetworkPacket& packet, const Address& address, uint32 socketShardIndex );
+			/// <summary>
+			/// Serializes a fixed-size message alone within a datagram, the same way SendPacketToAddress does with a
+			/// packet holding only that message, but without lending it from the message factory.
+			/// </summary>
+			void SendMessageToAddress( const InlineMessage& message, const Address& address );
+			/// <summary>
+			/// Same as above but, when sharded, the message leaves through the given socket shard
+			/// </summary>
+			void SendMessageToAddress( const InlineMessage& message, const Address& address, uint32 socketShardIndex );
 			bool AddRemotePeer( const Address& addressInfo, uint16 id, uint64 clientSalt, uint64 serverSalt );
 			void ConnectRemotePeer( RemotePeer& remotePeer );
-			bool BindSocket( const Address& address ) const;
+			bool BindSocket( const Address& address );
+
+			bool IsSharded() const { return _numberOfSocketShards > 1; }
 
 			void StartDisconnectingRemotePeer( uint32 id, bool shouldNotify, ConnectionFailedReasonType reason );
 
@@ -110,8 +177,22 @@ namespace NetLib
 
 		private:
 			void ProcessReceivedData();
-			void ProcessDatagram( Buffer& buffer, const Address& address );
+			/// <summary>
+			/// Messages from unknown peers, like connection requests, reach the game from the main thread, so the
+			/// socket shards leave them here
+			/// </summary>
+			void ProcessSocketShardsUnknownPeerMessages();
+			/// <param name="socketShardIndex">Shard that received the datagram. Its remote peer must belong to
+			/// it</param>
+			void ProcessDatagram( uint8* data, uint32 size, const Address& address, uint32 socketShardIndex );
+			void ProcessPacket( NetworkPacket& packet, RemotePeer* remotePeer, const Address& address,
+			                    uint32 socketShardIndex );
 			void ProcessNewRemotePeerMessages();
+			/// <summary>
+			/// Path MTU discovery messages travel outside of the transmission channels, so they are processed as soon
+			/// as they arrive
+			/// </summary>
+			void ProcessPathMTUMessage( const Message& message, RemotePeer& remotePeer );
 
 			void SetConnectionState( PeerConnectionState state );
 
@@ -122,6 +203,11 @@ namespace NetLib
 			                           ConnectionFailedReasonType reason );
 
 			void CreateDisconnectionPacket( const RemotePeer& remotePeer, ConnectionFailedReasonType reason );
+			/// <summary>
+			/// Sends the probe the remote peer's path MTU discovery is waiting for. It goes alone within a datagram of
+			/// the probed size.
+			/// </summary>
+			void SendPathMTUProbe( RemotePeer& remotePeer );
 
 			void SendData();
 			/// <summary>
@@ -129,13 +215,46 @@ namespace NetLib
 			/// </summary>
 			void SendDataToRemotePeers();
 			void SendDataToRemotePeer( RemotePeer& remotePeer );
-			void SendPacketToRemotePeer( RemotePeer& remotePeer, TransmissionChannelType type );
-
-			void SendDataToAddress( const Buffer& buffer, const Address& address ) const;
+			/// <summary>
+			/// Sends a datagram with one section per transmission channel that has messages or ACKs to send
+			/// </summary>
+			/// <returns>True if there are messages left that didn't fit within the datagram</returns>
+			bool SendDatagramToRemotePeer( RemotePeer& remotePeer );
+			void WriteChannelSection( RemotePeer& remotePeer, TransmissionChannelType type,
+			                          PacketBuilder& packetBuilder );
+			/// <summary>
+			/// Returns the memory where the next outgoing datagram must be written. It has room for up to the send
+			/// buffer size. Call CommitOutgoingDatagram once it has been written. When sharded, a shard worker writes
+			/// straight into its send batch, while the main thread queues the datagram for it.
+			/// </summary>
+			uint8* BeginOutgoingDatagram( const Address& address, uint32 socketShardIndex );
+			/// <summary>
+			/// Maximum size of the datagrams sent to remote peers. Each remote peer's path MTU discovery looks for the
+			/// biggest datagram that reaches it up to this size.
+			/// </summary>
+			uint32 GetOutgoingDatagramMaxSize() const;
+			void CommitOutgoingDatagram( uint32 size, const Address& address, uint32 socketShardIndex );
+			/// <summary>
+			/// Sends all the pending datagrams stored within the send batch
+			/// </summary>
+			void FlushSendBatch();
 
 			bool DoesRemotePeerIdExistInPendingDisconnections( uint32 id ) const;
 			void FinishRemotePeersDisconnection();
 
+			bool StartSocketShards( const Address& address );
+			void StopSocketShards();
+			/// <summary>
+			/// Keeps the socket shard workers away from the remote peers, so the main thread can access all of them
+			/// </summary>
+			void LockSocketShards();
+			void UnlockSocketShards();
+
+			// ISocketShardHandler. Called from the socket shard workers
+			void ProcessSocketShardDatagrams( SocketShard& socketShard, const DatagramBatch& batch ) override;
+			void SendSocketShardData( SocketShard& socketShard ) override;
+
+			bool StartInternal( std::unique_ptr< Transport > transport );
 			void StopInternal();
 
 			// Delegates related
@@ -145,12 +264,27 @@ namespace NetLib
 			PeerType _type;
 			PeerConnectionState _connectionState;
 			Address _address;
-			Socket _socket;
-
-			const uint32 _receiveBufferSize;
-			uint8* _receiveBuffer;
-			const uint32 _sendBufferSize;
-			uint8* _sendBuffer;
+			// Null when sharded, as the shards own the sockets
+			std::unique_ptr< Transport > _transport;
+
+			DatagramBatch _receiveBatch;
+			DatagramBatch _sendBatch;
+			PacketBuilder _packetBuilder;
+
+			// Socket shards related. Only used when there is more than one shard
+			uint32 _numberOfSocketShards;
+			SocketIOMode _ioMode;
+			std::vector< std::unique_ptr< SocketShard > > _socketShards;
+			// Datagrams sent from the main thread. Each shard's worker sends them
+			std::vector< DatagramQueue > _socketShardsOutgoingDatagrams;
+			// Guarded by the remote peers lock of each shard
+			std::vector< std::vector< UnknownPeerMessage > > _socketShardsUnknownPeerMessages;
+			// Remote peers owned by each shard, so its worker only walks its own ones. Guarded like the ones above
+			std::vector< std::vector< RemotePeer* > > _socketShardsRemotePeers;
+			SocketShardsDataSignal _socketShardsDataSignal;
+			// Shard that received the unknown peer message being processed
+			uint32 _currentSocketShardIndex;
+			bool _areSocketShardsLocked;
 
 			// Stop request
 			bool _isStopRequested;
@@ -1,5 +1,6 @@
 #include "server.h"
 
+#include <algorithm>
 #include <cassert>
 #include <memory>
 
@@ -11,6 +12,7 @@
 #include "inputs/i_input_state_factory.h"
 
 #include "communication/message.h"
+#include "communication/inline_message.h"
 #include "communication/message_factory.h"
 #include "communication/network_packet.h"
 
@@ -20,10 +22,12 @@
 
 namespace NetLib
 {
-	Server::Server( int32 maxConnections )
-	    : Peer( PeerType::SERVER, maxConnections, 1024, 1024 )
+	Server::Server( int32 maxConnections, uint32 numberOfSocketShards )
+	    : Peer( PeerType::SERVER, maxConnections, MAX_DATAGRAM_SIZE_BYTES, MAX_DATAGRAM_SIZE_BYTES,
+	            numberOfSocketShards )
 	    , _remotePeerInputsHandler()
 	    , _replicationManager()
+	    , _replicationBudgetBytesPerTick( DEFAULT_REPLICATION_BUDGET_BYTES_PER_TICK )
 	{
 	}
 
@@ -51,6 +55,26 @@ namespace NetLib
 		_replicationManager.RemoveNetworkEntity( entityId );
 	}
 
+	void Server::SetNetworkEntityPosition( uint32 entityId, float32 posX, float32 posY )
+	{
+		_replicationManager.SetNetworkEntityPosition( entityId, posX, posY );
+	}
+
+	void Server::EnableInterestManagement( float32 viewRadius )
+	{
+		_replicationManager.EnableInterestManagement( viewRadius );
+	}
+
+	void Server::SetReplicationBudget( uint32 bytesPerTick )
+	{
+		_replicationBudgetBytesPerTick = bytesPerTick;
+	}
+
+	void Server::EnableParallelReplication( uint32 numberOfWorkers )
+	{
+		_replicationManager.EnableParallelReplication( numberOfWorkers );
+	}
+
 	void Server::RegisterInputStateFactory( IInputStateFactory* factory )
 	{
 		// TODO Create a method for releasing all the inputs consumed during the current tick
@@ -75,13 +99,13 @@ namespace NetLib
 		ExecuteOnLocalPeerConnect();
 
 		SubscribeToOnRemotePeerDisconnect(
-		    std::bind( &Server::RemoveReplicationEntitiesControlledByPeer, this, std::placeholders::_1 ) );
+		    std::bind( &Server::RemoveRemotePeerFromReplication, this, std::placeholders::_1 ) );
 		return true;
 	}
 
 	void Server::TickConcrete( float32 elapsedTime )
 	{
-		TickReplication();
+		TickReplication( elapsedTime );
 	}
 
 	uint64 Server::GenerateServerSalt() const
@@ -132,6 +156,12 @@ namespace NetLib
 					ProcessInputs( inputsMessage, remotePeer );
 					break;
 				}
+			case MessageType::SnapshotAck:
+				{
+					const SnapshotAckMessage& snapshotAckMessage = static_cast< const SnapshotAckMessage& >( message );
+					ProcessSnapshotAck( snapshotAckMessage, remotePeer );
+					break;
+				}
 			default:
 				LOG_WARNING( "Invalid Message type, ignoring it..." );
 				break;
@@ -201,83 +231,43 @@ namespace NetLib
 
 	void Server::CreateDisconnectionMessage( RemotePeer& remotePeer )
 	{
-		MessageFactory& messageFactory = MessageFactory::GetInstance();
-
-		std::unique_ptr< Message > message = messageFactory.LendMessage( MessageType::Disconnection );
-		if ( message == nullptr )
-		{
-			LOG_ERROR(
-			    "Can't create new Disconnection Message because the MessageFactory has returned a null message" );
-			return;
-		}
-
-		std::unique_ptr< DisconnectionMessage > disconnectionMessage(
-		    static_cast< DisconnectionMessage* >( message.release() ) );
-
-		disconnectionMessage->prefix = remotePeer.GetDataPrefix();
-		remotePeer.AddMessage( std::move( disconnectionMessage ) );
+		InlineMessage disconnectionMessage( MessageType::Disconnection );
+		disconnectionMessage.disconnection.prefix = remotePeer.GetDataPrefix();
+		remotePeer.AddMessage( disconnectionMessage );
 
 		LOG_INFO( "Disconnection message created." );
 	}
 
 	void Server::CreateTimeResponseMessage( RemotePeer& remotePeer, const TimeRequestMessage& timeRequest )
 	{
-		MessageFactory& messageFactory = MessageFactory::GetInstance();
-		std::unique_ptr< Message > message( messageFactory.LendMessage( MessageType::TimeResponse ) );
-
-		std::unique_ptr< TimeResponseMessage > timeResponseMessage(
-		    static_cast< TimeResponseMessage* >( message.release() ) );
-		timeResponseMessage->SetOrdered( true );
-		timeResponseMessage->remoteTime = timeRequest.remoteTime;
+		InlineMessage timeResponseMessage( MessageType::TimeResponse );
+		timeResponseMessage.SetOrdered( true );
+		timeResponseMessage.timeResponse.remoteTime = timeRequest.remoteTime;
 
 		TimeClock& timeClock = TimeClock::GetInstance();
-		timeResponseMessage->serverTime = timeClock.GetLocalTimeMilliseconds();
+		timeResponseMessage.timeResponse.serverTime = timeClock.GetLocalTimeMilliseconds();
 
 		// Find remote client
-		remotePeer.AddMessage( std::move( timeResponseMessage ) );
+		remotePeer.AddMessage( timeResponseMessage );
 	}
 
 	void Server::CreateConnectionChallengeMessage( RemotePeer& remotePeer )
 	{
-		MessageFactory& messageFactory = MessageFactory::GetInstance();
-
-		std::unique_ptr< Message > message = messageFactory.LendMessage( MessageType::ConnectionChallenge );
-		if ( message == nullptr )
-		{
-			LOG_ERROR( "Can't create new Connection Challenge Message because the MessageFactory has returned a null "
-			           "message" );
-			return;
-		}
-
-		std::unique_ptr< ConnectionChallengeMessage > connectionChallengePacket(
-		    static_cast< ConnectionChallengeMessage* >( message.release() ) );
-		connectionChallengePacket->clientSalt = remotePeer.GetClientSalt();
-		connectionChallengePacket->serverSalt = remotePeer.GetServerSalt();
-		remotePeer.AddMessage( std::move( connectionChallengePacket ) );
+		InlineMessage connectionChallengeMessage( MessageType::ConnectionChallenge );
+		connectionChallengeMessage.connectionChallenge.clientSalt = remotePeer.GetClientSalt();
+		connectionChallengeMessage.connectionChallenge.serverSalt = remotePeer.GetServerSalt();
+		remotePeer.AddMessage( connectionChallengeMessage );
 
 		LOG_INFO( "Connection challenge message created." );
 	}
 
-	void Server::SendConnectionDeniedPacket( const Address& address, ConnectionFailedReasonType reason ) const
+	void Server::SendConnectionDeniedPacket( const Address& address, ConnectionFailedReasonType reason )
 	{
-		MessageFactory& messageFactory = MessageFactory::GetInstance();
-
-		std::unique_ptr< Message > message = messageFactory.LendMessage( MessageType::ConnectionDenied );
-		std::unique_ptr< ConnectionDeniedMessage > connectionDeniedMessage(
-		    static_cast< ConnectionDeniedMessage* >( message.release() ) );
-		connectionDeniedMessage->reason = reason;
-
-		NetworkPacket packet = NetworkPacket();
-		packet.AddMessage( std::move( connectionDeniedMessage ) );
+		InlineMessage connectionDeniedMessage( MessageType::ConnectionDenied );
+		connectionDeniedMessage.connectionDenied.reason = reason;
 
 		LOG_INFO( "Sending connection denied..." );
-		SendPacketToAddress( packet, address );
-
-		while ( packet.GetNumberOfMessages() > 0 )
-		{
-			std::unique_ptr< Message > messageToReturn = packet.GetMessages();
-			messageFactory.ReleaseMessage( std::move( messageToReturn ) );
-		}
+		SendMessageToAddress( connectionDeniedMessage, address );
 	}
 
 	void Server::ProcessConnectionChallengeResponse( const ConnectionChallengeResponseMessage& message,
@@ -330,6 +320,11 @@ namespace NetLib
 		_remotePeerInputsHandler.AddInputState( inputState, remotePeer.GetClientIndex() );
 	}
 
+	void Server::ProcessSnapshotAck( const SnapshotAckMessage& message, RemotePeer& remotePeer )
+	{
+		_replicationManager.Server_ProcessSnapshotAck( remotePeer.GetClientIndex(), message.snapshotSequenceNumber );
+	}
+
 	void Server::ProcessDisconnection( const DisconnectionMessage& message, RemotePeer& remotePeer )
 	{
 		uint64 dataPrefix = message.prefix;
@@ -348,51 +343,60 @@ namespace NetLib
 
 	void Server::CreateConnectionApprovedMessage( RemotePeer& remotePeer )
 	{
-		MessageFactory& messageFactory = MessageFactory::GetInstance();
-		std::unique_ptr< Message > message = messageFactory.LendMessage( MessageType::ConnectionAccepted );
-		if ( message == nullptr )
-		{
-			LOG_ERROR(
-			    "Can't create new Connection Accepted Message because the MessageFactory has returned a null message" );
-			return;
-		}
-
-		std::unique_ptr< ConnectionAcceptedMessage > connectionAcceptedPacket(
-		    static_cast< ConnectionAcceptedMessage* >( message.release() ) );
-		connectionAcceptedPacket->prefix = remotePeer.GetDataPrefix();
-		connectionAcceptedPacket->clientIndexAssigned = remotePeer.GetClientIndex();
-		remotePeer.AddMessage( std::move( connectionAcceptedPacket ) );
+		InlineMessage connectionAcceptedMessage( MessageType::ConnectionAccepted );
+		connectionAcceptedMessage.connectionAccepted.prefix = remotePeer.GetDataPrefix();
+		connectionAcceptedMessage.connectionAccepted.clientIndexAssigned = remotePeer.GetClientIndex();
+		remotePeer.AddMessage( connectionAcceptedMessage );
 	}
 
-	void Server::SendPacketToRemotePeer( const RemotePeer& remotePeer, const NetworkPacket& packet ) const
+	void Server::SendPacketToRemotePeer( const RemotePeer& remotePeer, const NetworkPacket& packet )
 	{
-		SendPacketToAddress( packet, remotePeer.GetAddress() );
+		SendPacketToAddress( packet, remotePeer.GetAddress(), remotePeer.GetSocketShardIndex() );
 	}
 
-	void Server::TickReplication()
+	void Server::TickReplication( float32 elapsedTime )
 	{
+		std::vector< RemotePeer* > remotePeers;
+		std::vector< uint32 > remotePeerIds;
+		std::vector< uint32 > budgetsBytes;
+
 		auto validRemotePeersIt = _remotePeersHandler.GetValidRemotePeersIterator();
 		auto pastTheEndIt = _remotePeersHandler.GetValidRemotePeersPastTheEndIterator();
-
 		for ( ; validRemotePeersIt != pastTheEndIt; ++validRemotePeersIt )
 		{
-			std::vector< std::unique_ptr< ReplicationMessage > > replication_messages;
-			_replicationManager.Server_ReplicateWorldState( ( *validRemotePeersIt )->GetClientIndex(),
-			                                                replication_messages );
+			// Don't generate more replication than the client is able to take, otherwise it would just pile up
+			const float32 sendRate = ( *validRemotePeersIt )->GetSendRateBytesPerSecond();
+			uint32 budgetBytes = std::max( static_cast< uint32 >( sendRate * elapsedTime ), 1u );
+			if ( _replicationBudgetBytesPerTick != ReplicationManager::UNLIMITED_REPLICATION_BUDGET )
+			{
+				budgetBytes = std::min( budgetBytes, _replicationBudgetBytesPerTick );
+			}
+
+			remotePeers.push_back( *validRemotePeersIt );
+			remotePeerIds.push_back( ( *validRemotePeersIt )->GetClientIndex() );
+			budgetsBytes.push_back( budgetBytes );
+		}
 
-			auto it = replication_messages.begin();
-			for ( ; it != replication_messages.end(); ++it )
+		std::vector< std::vector< std::unique_ptr< ReplicationMessage > > > replication_messages;
+		_replicationManager.Server_ReplicateWorldStates( remotePeerIds, budgetsBytes, replication_messages );
+
+		// Remote peers aren't thread-safe, so the messages are handed to them from here, always in the same order
+		for ( uint32 i = 0; i < remotePeers.size(); ++i )
+		{
+			auto it = replication_messages[ i ].begin();
+			for ( ; it != replication_messages[ i ].end(); ++it )
 			{
-				( *validRemotePeersIt )->AddMessage( std::move( *it ) );
+				remotePeers[ i ]->AddMessage( std::move( *it ) );
 			}
 		}
 
 		_replicationManager.ClearReplicationMessages();
 	}
 
-	void Server::RemoveReplicationEntitiesControlledByPeer( uint32 id )
+	void Server::RemoveRemotePeerFromReplication( uint32 id )
 	{
 		_replicationManager.RemoveNetworkEntitiesControllerByPeer( id );
+		_replicationManager.RemoveRemotePeer( id );
 	}
 
 	bool Server::StopConcrete()
@@ -15,19 +15,44 @@ namespace NetLib
 	class TimeRequestMessage;
 	class InputStateMessage;
 	class DisconnectionMessage;
+	class SnapshotAckMessage;
 	class IInputState;
 	class IInputStateFactory;
 
+	// Leaves room within a single datagram for the rest of the messages sent to a client each tick
+	constexpr uint32 DEFAULT_REPLICATION_BUDGET_BYTES_PER_TICK = 1024;
+
 	class Server : public Peer
 	{
 		public:
-			Server( int32 maxConnections );
+			/// <param name="numberOfSocketShards">Number of sockets listening on the server port, each one with its own
+			/// thread that receives, processes and sends the data of its clients. Requires SO_REUSEPORT support,
+			/// otherwise it falls back to a single socket</param>
+			Server( int32 maxConnections, uint32 numberOfSocketShards = 1 );
 			Server( const Server& ) = delete;
 
 			Server& operator=( const Server& ) = delete;
 
 			uint32 CreateNetworkEntity( uint32 entityType, uint32 controlledByPeerId, float32 posX, float32 posY );
 			void DestroyNetworkEntity( uint32 entityId );
+			void SetNetworkEntityPosition( uint32 entityId, float32 posX, float32 posY );
+			/// <summary>
+			/// Only replicates to each client the network entities within the view radius of the ones it controls.
+			/// Network entity positions must be kept up to date through SetNetworkEntityPosition. Call it before
+			/// creating any network entity.
+			/// </summary>
+			void EnableInterestManagement( float32 viewRadius );
+			/// <summary>
+			/// Maximum bytes of replication sent to each client per tick. The most relevant entity updates are sent
+			/// first and the rest wait for later ticks. Zero means no limit.
+			/// </summary>
+			void SetReplicationBudget( uint32 bytesPerTick );
+			/// <summary>
+			/// Builds the replication of the clients across numberOfWorkers threads, the calling one included. The
+			/// network entity serialization callbacks get called from those threads, so they must only read the game
+			/// state. One keeps everything within the calling thread.
+			/// </summary>
+			void EnableParallelReplication( uint32 numberOfWorkers );
 			// TODO Create a method for destroying all network entities controlled by a remote peer
 			void RegisterInputStateFactory( IInputStateFactory* factory );
 			const IInputState* GetInputFromRemotePeer( uint32 remotePeerId );
@@ -56,6 +81,7 @@ namespace NetLib
 			void ProcessTimeRequest( const TimeRequestMessage& message, RemotePeer& remotePeer );
 			void ProcessInputs( const InputStateMessage& message, RemotePeer& remotePeer );
 			void ProcessDisconnection( const DisconnectionMessage& message, RemotePeer& remotePeer );
+			void ProcessSnapshotAck( const SnapshotAckMessage& message, RemotePeer& remotePeer );
 
 			/// <summary>
 			/// This method checks if a new client is able to connect to server
@@ -72,12 +98,12 @@ namespace NetLib
 			void CreateConnectionApprovedMessage( RemotePeer& remotePeer );
 			void CreateDisconnectionMessage( RemotePeer& remotePeer );
 			void CreateTimeResponseMessage( RemotePeer& remotePeer, const TimeRequestMessage& timeRequest );
-			void SendConnectionDeniedPacket( const Address& address, ConnectionFailedReasonType reason ) const;
-			void SendPacketToRemotePeer( const RemotePeer& remotePeer, const NetworkPacket& packet ) const;
+			void SendConnectionDeniedPacket( const Address& address, ConnectionFailedReasonType reason );
+			void SendPacketToRemotePeer( const RemotePeer& remotePeer, const NetworkPacket& packet );
 
-			void TickReplication();
+			void TickReplication( float32 elapsedTime );
 
-			void RemoveReplicationEntitiesControlledByPeer( uint32 id );
+			void RemoveRemotePeerFromReplication( uint32 id );
 
 			uint32 _nextAssignedRemotePeerID = 1;
 
@@ -85,6 +111,7 @@ namespace NetLib
 			IInputStateFactory* _inputsFactory;
 
 			ReplicationManager _replicationManager;
+			uint32 _replicationBudgetBytesPerTick;
 	};
 
 	template < typename Functor >
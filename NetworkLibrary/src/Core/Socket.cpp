@@ -1,18 +1,57 @@
 #include "socket.h"
 
+#include <algorithm>
+#include <cstring>
+
 #include "core/address.h"
+#include "core/datagram_batch.h"
+#include "core/io_uring_engine.h"
+#include "core/segmentation_offload_engine.h"
 
 #include "logger.h"
 
 namespace NetLib
 {
+	static bool IsWouldBlockError( int32 error )
+	{
+#ifdef _WIN32
+		return error == WSAEWOULDBLOCK;
+#else
+		return error == EAGAIN || error == EWOULDBLOCK;
+#endif
+	}
+
+	static bool IsConnectionResetError( int32 error )
+	{
+#ifdef _WIN32
+		return error == WSAECONNRESET;
+#else
+		// On Linux, ICMP port unreachable errors are reported as ECONNREFUSED
+		return error == ECONNRESET || error == ECONNREFUSED;
+#endif
+	}
+
+	static bool IsMessageSizeError( int32 error )
+	{
+#ifdef _WIN32
+		return error == WSAEMSGSIZE;
+#else
+		return error == EMSGSIZE;
+#endif
+	}
+
 	Socket::Socket()
-	    : _listenSocket( INVALID_SOCKET )
+	    : _listenSocket( INVALID_SOCKET_HANDLE )
+#ifdef __linux__
+	    , _ioUringEngine( nullptr )
+	    , _segmentationOffloadEngine( nullptr )
+#endif
 	{
 	}
 
 	SocketResult Socket::InitializeSocketsLibrary()
 	{
+#ifdef _WIN32
 		WSADATA wsaData;
 		int32 iResult =
 		    WSAStartup( MAKEWORD( 2, 2 ), &wsaData ); // Init WS. You need to pass it the version (1.0, 1.1, 2.2...) and
@@ -22,18 +61,24 @@ namespace NetLib
 			LOG_ERROR( "WSAStartup failed: %d", iResult );
 			return SocketResult::SOKT_ERR;
 		}
+#endif
 
+		// POSIX sockets do not require any library initialization
 		return SocketResult::SOKT_SUCCESS;
 	}
 
 	int32 Socket::GetLastError() const
 	{
+#ifdef _WIN32
 		return WSAGetLastError();
+#else
+		return errno;
+#endif
 	}
 
 	bool Socket::IsValid() const
 	{
-		return !( _listenSocket == INVALID_SOCKET );
+		return !( _listenSocket == INVALID_SOCKET_HANDLE );
 	}
 
 	SocketResult Socket::SetBlockingMode( bool status )
@@ -43,8 +88,18 @@ namespace NetLib
 			return SocketResult::SOKT_ERR;
 		}
 
+#ifdef _WIN32
 		unsigned long listenSocketBlockingMode = status ? 0 : 1;
 		const int32 iResult = ioctlsocket( _listenSocket, FIONBIO, &listenSocketBlockingMode );
+#else
+		unsigned long listenSocketBlockingMode = status ? 0 : 1;
+		int32 iResult = fcntl( _listenSocket, F_GETFL, 0 );
+		if ( iResult != SOCKET_ERROR )
+		{
+			const int32 flags = status ? ( iResult & ~O_NONBLOCK ) : ( iResult | O_NONBLOCK );
+			iResult = fcntl( _listenSocket, F_SETFL, flags );
+		}
+#endif
 		if ( iResult == SOCKET_ERROR )
 		{
 			LOG_ERROR( "Socket error. Error while setting blocking mode, to %lu. Error code %d",
@@ -64,9 +119,74 @@ namespace NetLib
 			return SocketResult::SOKT_ERR;
 		}
 
+		// Not being able to do it only makes path MTU discovery less accurate, so keep going
+		DisableFragmentation();
 		return SocketResult::SOKT_SUCCESS;
 	}
 
+	SocketResult Socket::DisableFragmentation() const
+	{
+		if ( !IsValid() )
+		{
+			return SocketResult::SOKT_ERR;
+		}
+
+#if defined( _WIN32 )
+		const DWORD isEnabled = TRUE;
+		const int32 iResult = setsockopt( _listenSocket, IPPROTO_IP, IP_DONTFRAGMENT,
+		                                  reinterpret_cast< const char* >( &isEnabled ), sizeof( isEnabled ) );
+#elif defined( IP_PMTUDISC_PROBE )
+		// Unlike IP_PMTUDISC_DO, this one doesn't limit the datagram size to the path MTU cached by the kernel, which
+		// would prevent probes from finding out that a path has grown
+		const int32 mode = IP_PMTUDISC_PROBE;
+		const int32 iResult = setsockopt( _listenSocket, IPPROTO_IP, IP_MTU_DISCOVER, &mode, sizeof( mode ) );
+#elif defined( IP_DONTFRAG )
+		const int32 isEnabled = 1;
+		const int32 iResult = setsockopt( _listenSocket, IPPROTO_IP, IP_DONTFRAG, &isEnabled, sizeof( isEnabled ) );
+#else
+		const int32 iResult = SOCKET_ERROR;
+#endif
+		if ( iResult == SOCKET_ERROR )
+		{
+			LOG_WARNING( "Socket warning. Can't set the Don't Fragment bit. Error code %d", GetLastError() );
+			return SocketResult::SOKT_ERR;
+		}
+
+		return SocketResult::SOKT_SUCCESS;
+	}
+
+	SocketResult Socket::EnableReusePort() const
+	{
+		if ( !IsValid() )
+		{
+			return SocketResult::SOKT_ERR;
+		}
+
+#ifdef SO_REUSEPORT
+		const int32 isEnabled = 1;
+		const int32 iResult = setsockopt( _listenSocket, SOL_SOCKET, SO_REUSEPORT, &isEnabled, sizeof( isEnabled ) );
+		if ( iResult == SOCKET_ERROR )
+		{
+			LOG_ERROR( "Socket error. Error while enabling SO_REUSEPORT. Error code %d", GetLastError() );
+			return SocketResult::SOKT_ERR;
+		}
+
+		return SocketResult::SOKT_SUCCESS;
+#else
+		LOG_ERROR( "Socket error. SO_REUSEPORT is not supported on this platform" );
+		return SocketResult::SOKT_ERR;
+#endif
+	}
+
+	bool Socket::IsReusePortSupported()
+	{
+#ifdef SO_REUSEPORT
+		return true;
+#else
+		return false;
+#endif
+	}
+
 	SocketResult Socket::Bind( const Address& address ) const
 	{
 		if ( !IsValid() )
@@ -75,8 +195,7 @@ namespace NetLib
 		}
 
 		// If address port is 0 this function will pick up a random port number
-		const int32 iResult =
-		    bind( _listenSocket, ( sockaddr* ) &address.GetSockAddr(), sizeof( address.GetSockAddr() ) );
+		const int32 iResult = bind( _listenSocket, address.GetSockAddr(), address.GetSockAddrSize() );
 		if ( iResult == SOCKET_ERROR )
 		{
 			LOG_ERROR( "Socket error. Error while binding the listen socket. Error code %d", GetLastError() );
@@ -93,27 +212,48 @@ namespace NetLib
 			return SocketResult::SOKT_ERR;
 		}
 
+#ifdef __linux__
+		// Pending io_uring operations reference the socket, so they must be finished before closing it
+		if ( _ioUringEngine != nullptr )
+		{
+			_ioUringEngine->Close();
+			_ioUringEngine.reset();
+		}
+
+		if ( _segmentationOffloadEngine != nullptr )
+		{
+			_segmentationOffloadEngine->Close();
+			_segmentationOffloadEngine.reset();
+		}
+#endif
+
+#ifdef _WIN32
 		int32 iResult = closesocket( _listenSocket );
+#else
+		int32 iResult = close( _listenSocket );
+#endif
 		if ( iResult == SOCKET_ERROR )
 		{
 			LOG_ERROR( "Socket error. Error while closing the socket. Error code %d", GetLastError() );
 			return SocketResult::SOKT_ERR;
 		}
 
+#ifdef _WIN32
 		iResult = WSACleanup();
 		if ( iResult == SOCKET_ERROR )
 		{
 			LOG_ERROR( "Socket error. Error while closing the sockets library. Error code %d", GetLastError() );
 			return SocketResult::SOKT_ERR;
 		}
+#endif
 
-		_listenSocket = INVALID_SOCKET;
+		_listenSocket = INVALID_SOCKET_HANDLE;
 
 		LOG_INFO( "Socket succesfully closed" );
 		return SocketResult::SOKT_SUCCESS;
 	}
 
-	SocketResult Socket::Start()
+	SocketResult Socket::Start( SocketIOMode ioMode, uint32 datagramMaxSize )
 	{
 		SocketResult result = SocketResult::SOKT_SUCCESS;
 
@@ -130,12 +270,45 @@ namespace NetLib
 			return result;
 		}
 
+		if ( ioMode == SocketIOMode::IO_URING )
+		{
+#ifdef __linux__
+			// io_uring returns EAGAIN instead of waiting for data on non-blocking sockets, so keep this one blocking.
+			// It is never read outside of the io_uring engine
+			_ioUringEngine.reset( new IoUringEngine() );
+			if ( _ioUringEngine->Start( _listenSocket, datagramMaxSize ) )
+			{
+				LOG_INFO( "Socket info. Using io_uring I/O mode" );
+				return SocketResult::SOKT_SUCCESS;
+			}
+
+			_ioUringEngine.reset();
+#endif
+			LOG_WARNING( "Socket warning. io_uring I/O mode is not supported. Falling back to the default I/O mode" );
+		}
+
 		result = SetBlockingMode( false );
 		if ( result != SocketResult::SOKT_SUCCESS )
 		{
 			return result;
 		}
 
+		if ( ioMode == SocketIOMode::SEGMENTATION_OFFLOAD )
+		{
+#ifdef __linux__
+			_segmentationOffloadEngine.reset( new SegmentationOffloadEngine() );
+			if ( _segmentationOffloadEngine->Start( _listenSocket, datagramMaxSize ) )
+			{
+				LOG_INFO( "Socket info. Using segmentation offload I/O mode" );
+				return SocketResult::SOKT_SUCCESS;
+			}
+
+			_segmentationOffloadEngine.reset();
+#endif
+			LOG_WARNING( "Socket warning. Segmentation offload I/O mode is not supported. Falling back to the default "
+			             "I/O mode" );
+		}
+
 		return SocketResult::SOKT_SUCCESS;
 	}
 
@@ -148,13 +321,20 @@ namespace NetLib
 		}
 
 		struct sockaddr_in incomingAddress;
+#ifdef _WIN32
 		int32 incomingAddressSize = sizeof( incomingAddress );
-		ZeroMemory( &incomingAddress, incomingAddressSize );
+		const int32 receiveFlags = 0;
+#else
+		socklen_t incomingAddressSize = sizeof( incomingAddress );
+		// Report the real size of the datagram in case it doesn't fit inside the buffer
+		const int32 receiveFlags = MSG_TRUNC;
+#endif
+		std::memset( &incomingAddress, 0, incomingAddressSize );
 
 		// If recvfrom doesn't find any data, incomingAddress will be invalid. This means that
 		// incomingAddress.sin_family will be AF_UNSPEC, IP will be 0.0.0.0 and port will be 0
-		const int32 bytesIn = recvfrom( _listenSocket, ( char* ) incomingDataBuffer, incomingDataBufferSize, 0,
-		                                ( sockaddr* ) &incomingAddress, &incomingAddressSize );
+		const int32 bytesIn = recvfrom( _listenSocket, ( char* ) incomingDataBuffer, incomingDataBufferSize,
+		                                receiveFlags, ( sockaddr* ) &incomingAddress, &incomingAddressSize );
 
 		remoteAddress.SetFromSockAddr( incomingAddress );
 
@@ -162,16 +342,16 @@ namespace NetLib
 		{
 			const int32 error = GetLastError();
 
-			if ( error == WSAEMSGSIZE )
+			if ( IsMessageSizeError( error ) )
 			{
 				LOG_ERROR( "Socket error. The message received does not fit inside the buffer." );
 				return SocketResult::SOKT_ERR;
 			}
-			else if ( error == WSAEWOULDBLOCK )
+			else if ( IsWouldBlockError( error ) )
 			{
 				return SocketResult::SOKT_WOULDBLOCK;
 			}
-			else if ( error == WSAECONNRESET )
+			else if ( IsConnectionResetError( error ) )
 			{
 				LOG_WARNING( "Socket warning. The remote socket has been closed unexpectly." );
 				return SocketResult::SOKT_CONNRESET;
@@ -183,11 +363,20 @@ namespace NetLib
 			}
 		}
 
+		if ( static_cast< uint32 >( bytesIn ) > incomingDataBufferSize )
+		{
+			LOG_ERROR( "Socket error. The message received does not fit inside the buffer." );
+			return SocketResult::SOKT_ERR;
+		}
+
 		numberOfBytesRead = bytesIn;
 
+#ifdef LOG_ENABLED
+		// Only build the address string when it is going to be logged, as this runs once per datagram
 		std::string ip_and_port;
 		remoteAddress.GetFull( ip_and_port );
 		LOG_INFO( "Socket info. Data received from %s", ip_and_port.c_str() );
+#endif
 
 		return SocketResult::SOKT_SUCCESS;
 	}
@@ -199,30 +388,269 @@ namespace NetLib
 			return SocketResult::SOKT_ERR;
 		}
 
-		if ( dataBufferSize > MTU_SIZE_BYTES )
+		if ( dataBufferSize > MAX_DATAGRAM_SIZE_BYTES )
 		{
 			LOG_WARNING( "Socket warning. Trying to send a packet bigger than the MTU size theshold. This could result "
 			             "in Packet Fragmentation and as a consequence worse network conditions. Packet size: %u, MTU "
 			             "size threshold: %u",
-			             dataBufferSize, MTU_SIZE_BYTES );
+			             dataBufferSize, MAX_DATAGRAM_SIZE_BYTES );
 		}
 
-		const int32 bytesSent =
-		    sendto( _listenSocket, ( char* ) dataBuffer, dataBufferSize, 0, ( sockaddr* ) &remoteAddress.GetSockAddr(),
-		            sizeof( remoteAddress.GetSockAddr() ) );
+		const int32 bytesSent = sendto( _listenSocket, ( char* ) dataBuffer, dataBufferSize, 0,
+		                                remoteAddress.GetSockAddr(), remoteAddress.GetSockAddrSize() );
 		if ( bytesSent == SOCKET_ERROR )
 		{
 			LOG_ERROR( "Socket error. Error while sending data. Error code %d", GetLastError() );
 			return SocketResult::SOKT_ERR;
 		}
 
+#ifdef LOG_ENABLED
 		std::string ip_and_port;
 		remoteAddress.GetFull( ip_and_port );
 		LOG_INFO( "Socket info. Data sent to %s", ip_and_port.c_str() );
+#endif
 
 		return SocketResult::SOKT_SUCCESS;
 	}
 
+	SocketResult Socket::ReceiveFromBatch( DatagramBatch& batch, Address& remoteAddress ) const
+	{
+		if ( !IsValid() || batch.IsFull() )
+		{
+			return SocketResult::SOKT_ERR;
+		}
+
+#ifdef __linux__
+		if ( _ioUringEngine != nullptr )
+		{
+			return _ioUringEngine->ReceiveBatch( batch, remoteAddress );
+		}
+
+		if ( _segmentationOffloadEngine != nullptr )
+		{
+			return _segmentationOffloadEngine->ReceiveBatch( batch, remoteAddress );
+		}
+
+		const uint32 numberOfFreeSlots =
+		    std::min( batch.GetCapacity() - batch.GetNumberOfDatagrams(), MAX_DATAGRAM_BATCH_SIZE );
+		const uint32 datagramMaxSize = batch.GetDatagramMaxSize();
+		uint8* firstFreeDatagramData = batch.GetNextFreeDatagramData();
+
+		struct mmsghdr messages[ MAX_DATAGRAM_BATCH_SIZE ];
+		struct iovec buffers[ MAX_DATAGRAM_BATCH_SIZE ];
+		struct sockaddr_in incomingAddresses[ MAX_DATAGRAM_BATCH_SIZE ];
+		std::memset( messages, 0, sizeof( messages[ 0 ] ) * numberOfFreeSlots );
+		std::memset( incomingAddresses, 0, sizeof( incomingAddresses[ 0 ] ) * numberOfFreeSlots );
+
+		// Batch slots are contiguous so each message points directly to its own slot. No extra copies needed
+		for ( uint32 i = 0; i < numberOfFreeSlots; ++i )
+		{
+			buffers[ i ].iov_base = firstFreeDatagramData + ( i * datagramMaxSize );
+			buffers[ i ].iov_len = datagramMaxSize;
+			messages[ i ].msg_hdr.msg_name = &incomingAddresses[ i ];
+			messages[ i ].msg_hdr.msg_namelen = sizeof( incomingAddresses[ i ] );
+			messages[ i ].msg_hdr.msg_iov = &buffers[ i ];
+			messages[ i ].msg_hdr.msg_iovlen = 1;
+		}
+
+		const int32 numberOfMessagesRead =
+		    recvmmsg( _listenSocket, messages, numberOfFreeSlots, MSG_DONTWAIT, nullptr );
+		if ( numberOfMessagesRead == SOCKET_ERROR )
+		{
+			const int32 error = GetLastError();
+			if ( IsWouldBlockError( error ) )
+			{
+				return SocketResult::SOKT_WOULDBLOCK;
+			}
+			else if ( IsConnectionResetError( error ) )
+			{
+				// Linux does not report which remote address caused the error
+				LOG_WARNING( "Socket warning. The remote socket has been closed unexpectly." );
+				remoteAddress = Address::GetInvalid();
+				return SocketResult::SOKT_CONNRESET;
+			}
+			else
+			{
+				LOG_ERROR( "Socket error. Error while receiving a batch of messages. Error code: %d", error );
+				return SocketResult::SOKT_ERR;
+			}
+		}
+
+		Address incomingAddress = Address::GetInvalid();
+		for ( int32 i = 0; i < numberOfMessagesRead; ++i )
+		{
+			if ( ( messages[ i ].msg_hdr.msg_flags & MSG_TRUNC ) != 0 )
+			{
+				LOG_ERROR( "Socket error. The message received does not fit inside the buffer. Ignoring it..." );
+				continue;
+			}
+
+			// If a previous datagram was discarded, move this one to the next free slot to keep the batch packed
+			uint8* nextFreeDatagramData = batch.GetNextFreeDatagramData();
+			if ( nextFreeDatagramData != buffers[ i ].iov_base )
+			{
+				std::memmove( nextFreeDatagramData, buffers[ i ].iov_base, messages[ i ].msg_len );
+			}
+
+			incomingAddress.SetFromSockAddr( incomingAddresses[ i ] );
+			batch.CommitDatagram( messages[ i ].msg_len, incomingAddress );
+		}
+
+		return SocketResult::SOKT_SUCCESS;
+#else
+		// Fallback for platforms without batched receive support. Read the datagrams one by one
+		SocketResult result = SocketResult::SOKT_SUCCESS;
+		Address incomingAddress = Address::GetInvalid();
+		uint32 numberOfBytesRead = 0;
+
+		while ( !batch.IsFull() )
+		{
+			result = ReceiveFrom( batch.GetNextFreeDatagramData(), batch.GetDatagramMaxSize(), incomingAddress,
+			                      numberOfBytesRead );
+			if ( result != SocketResult::SOKT_SUCCESS )
+			{
+				break;
+			}
+
+			batch.CommitDatagram( numberOfBytesRead, incomingAddress );
+		}
+
+		if ( result == SocketResult::SOKT_WOULDBLOCK && !batch.IsEmpty() )
+		{
+			result = SocketResult::SOKT_SUCCESS;
+		}
+		else if ( result == SocketResult::SOKT_CONNRESET )
+		{
+			remoteAddress = incomingAddress;
+		}
+
+		return result;
+#endif
+	}
+
+	SocketResult Socket::SendToBatch( const DatagramBatch& batch ) const
+	{
+		if ( !IsValid() )
+		{
+			return SocketResult::SOKT_ERR;
+		}
+
+		const uint32 numberOfDatagrams = batch.GetNumberOfDatagrams();
+		for ( uint32 i = 0; i < numberOfDatagrams; ++i )
+		{
+			if ( batch.GetDatagramSize( i ) > MAX_DATAGRAM_SIZE_BYTES )
+			{
+				LOG_WARNING( "Socket warning. Trying to send a packet bigger than the MTU size theshold. This could "
+				             "result in Packet Fragmentation and as a consequence worse network conditions. Packet "
+				             "size: %u, MTU size threshold: %u",
+				             batch.GetDatagramSize( i ), MAX_DATAGRAM_SIZE_BYTES );
+			}
+		}
+
+#ifdef __linux__
+		if ( _ioUringEngine != nullptr )
+		{
+			return _ioUringEngine->SendBatch( batch );
+		}
+
+		if ( _segmentationOffloadEngine != nullptr )
+		{
+			return _segmentationOffloadEngine->SendBatch( batch );
+		}
+
+		struct mmsghdr messages[ MAX_DATAGRAM_BATCH_SIZE ];
+		struct iovec buffers[ MAX_DATAGRAM_BATCH_SIZE ];
+
+		SocketResult result = SocketResult::SOKT_SUCCESS;
+		uint32 numberOfDatagramsSent = 0;
+		while ( numberOfDatagramsSent < numberOfDatagrams )
+		{
+			const uint32 numberOfDatagramsToSend =
+			    std::min( numberOfDatagrams - numberOfDatagramsSent, MAX_DATAGRAM_BATCH_SIZE );
+			std::memset( messages, 0, sizeof( messages[ 0 ] ) * numberOfDatagramsToSend );
+
+			for ( uint32 i = 0; i < numberOfDatagramsToSend; ++i )
+			{
+				const uint32 datagramIndex = numberOfDatagramsSent + i;
+				const Address& address = batch.GetDatagramAddress( datagramIndex );
+
+				buffers[ i ].iov_base = batch.GetDatagramData( datagramIndex );
+				buffers[ i ].iov_len = batch.GetDatagramSize( datagramIndex );
+				messages[ i ].msg_hdr.msg_name = const_cast< sockaddr* >( address.GetSockAddr() );
+				messages[ i ].msg_hdr.msg_namelen = address.GetSockAddrSize();
+				messages[ i ].msg_hdr.msg_iov = &buffers[ i ];
+				messages[ i ].msg_hdr.msg_iovlen = 1;
+			}
+
+			const int32 numberOfMessagesSent = sendmmsg( _listenSocket, messages, numberOfDatagramsToSend, 0 );
+			if ( numberOfMessagesSent != SOCKET_ERROR )
+			{
+				numberOfDatagramsSent += numberOfMessagesSent;
+				continue;
+			}
+
+			// The error belongs to the first datagram not sent
+			const int32 error = GetLastError();
+			if ( IsWouldBlockError( error ) )
+			{
+				// The send buffer is full, so the rest of the datagrams wouldn't make it either
+				LOG_WARNING( "Socket warning. The send buffer is full. %u datagrams have not been sent",
+				             numberOfDatagrams - numberOfDatagramsSent );
+				return SocketResult::SOKT_WOULDBLOCK;
+			}
+
+			if ( IsMessageSizeError( error ) )
+			{
+				// With the Don't Fragment bit set, a datagram bigger than the local link MTU, such as a path MTU probe,
+				// gets rejected
+				LOG_INFO( "Socket info. Discarding a datagram of %u bytes since it is bigger than the link MTU",
+				          batch.GetDatagramSize( numberOfDatagramsSent ) );
+			}
+			else
+			{
+				// Errors such as an unreachable destination only affect that datagram, so the rest of the remote
+				// peers still get theirs
+				LOG_ERROR( "Socket error. Error while sending data. Discarding the datagram. Error code %d", error );
+				result = SocketResult::SOKT_ERR;
+			}
+
+			++numberOfDatagramsSent;
+		}
+
+		return result;
+#else
+		// Fallback for platforms without batched send support. Send the datagrams one by one
+		SocketResult result = SocketResult::SOKT_SUCCESS;
+		for ( uint32 i = 0; i < numberOfDatagrams; ++i )
+		{
+			if ( SendTo( batch.GetDatagramData( i ), batch.GetDatagramSize( i ), batch.GetDatagramAddress( i ) ) !=
+			     SocketResult::SOKT_SUCCESS )
+			{
+				result = SocketResult::SOKT_ERR;
+			}
+		}
+
+		return result;
+#endif
+	}
+
+	SocketIOMode Socket::GetIOMode() const
+	{
+#ifdef __linux__
+		if ( _ioUringEngine != nullptr )
+		{
+			return SocketIOMode::IO_URING;
+		}
+
+		if ( _segmentationOffloadEngine != nullptr )
+		{
+			return SocketIOMode::SEGMENTATION_OFFLOAD;
+		}
+#endif
+
+		return SocketIOMode::DEFAULT;
+	}
+
 	Socket::~Socket()
 	{
 		Close();
@@ -1,14 +1,22 @@
 #pragma once
 #include "numeric_types.h"
 
-#include <winsock2.h>
-#include <ws2tcpip.h>
+#include <memory>
+
+#include "core/socket_platform.h"
 
 namespace NetLib
 {
 	class Address;
+	class DatagramBatch;
+	class IoUringEngine;
+	class SegmentationOffloadEngine;
 
 	constexpr uint32 MTU_SIZE_BYTES = 1500;
+	// Every datagram travels along with an IPv4 and an UDP header, and both of them count towards the MTU
+	constexpr uint32 IP_AND_UDP_HEADERS_SIZE_BYTES = 20 + 8;
+	// Biggest datagram that fits within the MTU without getting fragmented by the IP layer
+	constexpr uint32 MAX_DATAGRAM_SIZE_BYTES = MTU_SIZE_BYTES - IP_AND_UDP_HEADERS_SIZE_BYTES;
 
 	enum SocketResult : uint8
 	{
@@ -18,20 +26,62 @@ namespace NetLib
 		SOKT_CONNRESET = 3
 	};
 
+	enum class SocketIOMode : uint8
+	{
+		// Non-blocking socket calls (recvmmsg/sendmmsg on Linux)
+		DEFAULT = 0,
+		// io_uring on Linux. If the kernel doesn't support it, it falls back to DEFAULT
+		IO_URING = 1,
+		// DEFAULT plus UDP segmentation offload (GSO/GRO) on Linux. If the kernel doesn't support it, it falls back to
+		// DEFAULT
+		SEGMENTATION_OFFLOAD = 2
+	};
+
 	class Socket
 	{
 		public:
 			Socket();
-			Socket( const Socket& other ) = default;
+			Socket( const Socket& other ) = delete;
 			Socket( Socket&& other ) = default;
 
-			SocketResult Start();
+			/// <summary>
+			/// Creates the socket and sets it up for the selected I/O mode
+			/// </summary>
+			/// <param name="ioMode">Mechanism used for the batched operations</param>
+			/// <param name="datagramMaxSize">Maximum size of an incoming datagram. Only used by the io_uring and
+			/// segmentation offload modes in order to create their receive buffers</param>
+			SocketResult Start( SocketIOMode ioMode = SocketIOMode::DEFAULT, uint32 datagramMaxSize = MTU_SIZE_BYTES );
+			/// <summary>
+			/// Allows several sockets to bind the same address and port. The kernel then spreads the incoming flows
+			/// between them. It must be called before Bind.
+			/// </summary>
+			SocketResult EnableReusePort() const;
 			SocketResult Bind( const Address& address ) const;
 			SocketResult ReceiveFrom( uint8* incomingDataBuffer, uint32 incomingDataBufferSize, Address& remoteAddress,
 			                          uint32& numberOfBytesRead ) const;
 			SocketResult SendTo( const uint8* dataBuffer, uint32 dataBufferSize, const Address& remoteAddress ) const;
+
+			/// <summary>
+			/// Reads as many pending datagrams as free slots are left in the batch. On Linux this is done with a single
+			/// recvmmsg call. The datagrams read are added to the batch even if the operation ends with an error.
+			/// </summary>
+			/// <param name="batch">Batch where the incoming datagrams will be stored</param>
+			/// <param name="remoteAddress">In case of SOKT_CONNRESET, the address of the remote socket that got
+			/// closed</param>
+			/// <returns>SOKT_SUCCESS if at least one datagram has been read. If the batch hasn't been filled, there is
+			/// no more data to read at the moment. In io_uring and segmentation offload modes the datagrams are views
+			/// of the socket's receive buffers and they are only valid until the next call</returns>
+			SocketResult ReceiveFromBatch( DatagramBatch& batch, Address& remoteAddress ) const;
+			/// <summary>
+			/// Sends all the datagrams within the batch. On Linux this is done with as few sendmmsg calls as possible.
+			/// </summary>
+			SocketResult SendToBatch( const DatagramBatch& batch ) const;
 			SocketResult Close();
 
+			SocketIOMode GetIOMode() const;
+
+			static bool IsReusePortSupported();
+
 			~Socket();
 
 		private:
@@ -40,7 +90,18 @@ namespace NetLib
 			bool IsValid() const;
 			SocketResult SetBlockingMode( bool status );
 			SocketResult Create();
+			/// <summary>
+			/// Sets the Don't Fragment bit on outgoing datagrams, so the ones bigger than the path MTU get dropped
+			/// instead of fragmented. This is what makes path MTU discovery probes meaningful.
+			/// </summary>
+			SocketResult DisableFragmentation() const;
+
+			SocketHandle _listenSocket;
+#ifdef __linux__
+			std::unique_ptr< IoUringEngine > _ioUringEngine;
+			std::unique_ptr< SegmentationOffloadEngine > _segmentationOffloadEngine;
+#endif
 
-			SOCKET _listenSocket;
+			friend class SocketWaiter;
 	};
 } // namespace NetLib
@@ -0,0 +1,107 @@
+#include "address_index_map.h"
+
+namespace NetLib
+{
+	static constexpr uint32 MIN_NUMBER_OF_BUCKETS = 8;
+
+	static uint32 GetNumberOfBuckets( uint32 maxNumberOfElements )
+	{
+		// Keep the load factor at or below 0.5 so probe sequences stay short
+		uint32 numberOfBuckets = MIN_NUMBER_OF_BUCKETS;
+		while ( numberOfBuckets < maxNumberOfElements * 2 )
+		{
+			numberOfBuckets *= 2;
+		}
+
+		return numberOfBuckets;
+	}
+
+	AddressIndexMap::AddressIndexMap( uint32 maxNumberOfElements )
+	    : _maxNumberOfElements( maxNumberOfElements )
+	    , _numberOfElements( 0 )
+	    , _bucketMask( GetNumberOfBuckets( maxNumberOfElements ) - 1 )
+	    , _entries( GetNumberOfBuckets( maxNumberOfElements ), Entry{ Address::GetInvalid(), 0, false } )
+	{
+	}
+
+	bool AddressIndexMap::Insert( const Address& address, uint32 index )
+	{
+		if ( _numberOfElements == _maxNumberOfElements )
+		{
+			return false;
+		}
+
+		const uint32 bucket = FindBucket( address );
+		Entry& entry = _entries[ bucket ];
+		if ( entry.isOccupied )
+		{
+			return false;
+		}
+
+		entry.address = address;
+		entry.index = index;
+		entry.isOccupied = true;
+		++_numberOfElements;
+		return true;
+	}
+
+	int32 AddressIndexMap::Find( const Address& address ) const
+	{
+		const Entry& entry = _entries[ FindBucket( address ) ];
+		return entry.isOccupied ? static_cast< int32 >( entry.index ) : -1;
+	}
+
+	bool AddressIndexMap::Remove( const Address& address )
+	{
+		uint32 emptyBucket = FindBucket( address );
+		if ( !_entries[ emptyBucket ].isOccupied )
+		{
+			return false;
+		}
+
+		_entries[ emptyBucket ].isOccupied = false;
+		--_numberOfElements;
+
+		// Shift back the following entries of the cluster that can be moved closer to their ideal bucket, so the probe
+		// sequences of the remaining elements don't get broken by the new empty bucket
+		uint32 bucket = GetBucket( emptyBucket + 1 );
+		while ( _entries[ bucket ].isOccupied )
+		{
+			const uint32 idealBucket = GetBucket( _entries[ bucket ].address.GetHash() );
+			const uint32 distanceFromIdealBucket = GetBucket( bucket - idealBucket );
+			const uint32 distanceFromEmptyBucket = GetBucket( bucket - emptyBucket );
+			if ( distanceFromIdealBucket >= distanceFromEmptyBucket )
+			{
+				_entries[ emptyBucket ] = _entries[ bucket ];
+				_entries[ bucket ].isOccupied = false;
+				emptyBucket = bucket;
+			}
+
+			bucket = GetBucket( bucket + 1 );
+		}
+
+		return true;
+	}
+
+	void AddressIndexMap::Clear()
+	{
+		for ( uint32 i = 0; i < _entries.size(); ++i )
+		{
+			_entries[ i ].isOccupied = false;
+		}
+
+		_numberOfElements = 0;
+	}
+
+	uint32 AddressIndexMap::FindBucket( const Address& address ) const
+	{
+		// There is always at least one empty bucket so the loop is guaranteed to end
+		uint32 bucket = GetBucket( address.GetHash() );
+		while ( _entries[ bucket ].isOccupied && _entries[ bucket ].address != address )
+		{
+			bucket = GetBucket( bucket + 1 );
+		}
+
+		return bucket;
+	}
+} // namespace NetLib
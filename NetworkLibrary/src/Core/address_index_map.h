@@ -0,0 +1,54 @@
+#pragma once
+#include "numeric_types.h"
+
+#include <vector>
+
+#include "core/address.h"
+
+namespace NetLib
+{
+	/// <summary>
+	/// Fixed capacity open-addressing hash map from addresses to indices. It uses linear probing over the address
+	/// precomputed hash and backward shift deletion, so lookups never allocate and don't degrade over time because of
+	/// tombstones.
+	/// </summary>
+	class AddressIndexMap
+	{
+		public:
+			AddressIndexMap( uint32 maxNumberOfElements );
+
+			/// <summary>
+			/// Adds a new element.
+			/// </summary>
+			/// <returns>False if the address already exists or the map is full, True otherwise</returns>
+			bool Insert( const Address& address, uint32 index );
+			/// <summary>
+			/// Gets the index associated to the address
+			/// </summary>
+			/// <returns>The index if the address exists, -1 otherwise</returns>
+			int32 Find( const Address& address ) const;
+			bool Remove( const Address& address );
+			void Clear();
+
+			uint32 GetNumberOfElements() const { return _numberOfElements; }
+
+		private:
+			struct Entry
+			{
+					Address address;
+					uint32 index;
+					bool isOccupied;
+			};
+
+			uint32 GetBucket( uint32 hash ) const { return hash & _bucketMask; }
+			/// <summary>
+			/// Returns the bucket where the address is stored or the first empty bucket of its probe sequence
+			/// </summary>
+			uint32 FindBucket( const Address& address ) const;
+
+			const uint32 _maxNumberOfElements;
+			uint32 _numberOfElements;
+			uint32 _bucketMask;
+			std::vector< Entry > _entries;
+	};
+} // namespace NetLib
@@ -0,0 +1,73 @@
+#include "aimd_congestion_controller.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace NetLib
+{
+	static constexpr float32 MIN_CONGESTION_WINDOW_BYTES =
+	    MIN_CONGESTION_WINDOW_SEGMENTS * CONGESTION_CONTROL_SEGMENT_SIZE_BYTES;
+	static constexpr float32 MAX_CONGESTION_WINDOW_BYTES =
+	    MAX_CONGESTION_WINDOW_SEGMENTS * CONGESTION_CONTROL_SEGMENT_SIZE_BYTES;
+
+	AIMDCongestionController::AIMDCongestionController()
+	    : ICongestionController()
+	    , _congestionWindowBytes( 0.f )
+	    , _rttMilliseconds( 0 )
+	    , _timeSinceLastDecrease( 0.f )
+	{
+		Reset();
+	}
+
+	void AIMDCongestionController::OnAck( uint32 ackedBytes, uint32 rttMilliseconds )
+	{
+		if ( rttMilliseconds > 0 )
+		{
+			_rttMilliseconds = rttMilliseconds;
+		}
+
+		// Acking a whole congestion window adds one segment to it
+		const float32 increase =
+		    static_cast< float32 >( CONGESTION_CONTROL_SEGMENT_SIZE_BYTES ) * ackedBytes / _congestionWindowBytes;
+		_congestionWindowBytes = std::min( _congestionWindowBytes + increase, MAX_CONGESTION_WINDOW_BYTES );
+	}
+
+	void AIMDCongestionController::OnLoss()
+	{
+		if ( _timeSinceLastDecrease < GetRTTSeconds() )
+		{
+			return;
+		}
+
+		_congestionWindowBytes = std::max( _congestionWindowBytes * 0.5f, MIN_CONGESTION_WINDOW_BYTES );
+		_timeSinceLastDecrease = 0.f;
+	}
+
+	void AIMDCongestionController::Update( float32 elapsedTime )
+	{
+		_timeSinceLastDecrease += elapsedTime;
+	}
+
+	void AIMDCongestionController::Reset()
+	{
+		_congestionWindowBytes = INITIAL_CONGESTION_WINDOW_SEGMENTS * CONGESTION_CONTROL_SEGMENT_SIZE_BYTES;
+		_rttMilliseconds = 0;
+		// The first loss always counts
+		_timeSinceLastDecrease = std::numeric_limits< float32 >::max();
+	}
+
+	float32 AIMDCongestionController::GetSendRateBytesPerSecond() const
+	{
+		return _congestionWindowBytes / GetRTTSeconds();
+	}
+
+	float32 AIMDCongestionController::GetRTTSeconds() const
+	{
+		if ( _rttMilliseconds == 0 )
+		{
+			return CONGESTION_CONTROL_INITIAL_RTT_SECONDS;
+		}
+
+		return std::max( _rttMilliseconds / 1000.f, CONGESTION_CONTROL_MIN_RTT_SECONDS );
+	}
+} // namespace NetLib
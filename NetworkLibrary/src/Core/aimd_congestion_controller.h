@@ -0,0 +1,44 @@
+#pragma once
+#include "numeric_types.h"
+
+#include "core/i_congestion_controller.h"
+
+namespace NetLib
+{
+	// Size the congestion window grows and shrinks by. It matches the datagram size that every path carries
+	constexpr uint32 CONGESTION_CONTROL_SEGMENT_SIZE_BYTES = 1200;
+	constexpr uint32 INITIAL_CONGESTION_WINDOW_SEGMENTS = 10;
+	constexpr uint32 MIN_CONGESTION_WINDOW_SEGMENTS = 2;
+	constexpr uint32 MAX_CONGESTION_WINDOW_SEGMENTS = 1024;
+	// RTT assumed until the first ack arrives
+	constexpr float32 CONGESTION_CONTROL_INITIAL_RTT_SECONDS = 0.1f;
+	// Floor for the RTT so a remote peer on the same machine doesn't get an unbounded send rate
+	constexpr float32 CONGESTION_CONTROL_MIN_RTT_SECONDS = 0.01f;
+
+	/// <summary>
+	/// Additive increase, multiplicative decrease. The congestion window grows by one segment per RTT while messages
+	/// get acked, and halves when a loss is detected. Losses within the same RTT are taken as a single congestion
+	/// event, since they usually come from the same burst. The send rate is a congestion window per RTT.
+	/// </summary>
+	class AIMDCongestionController : public ICongestionController
+	{
+		public:
+			AIMDCongestionController();
+
+			void OnAck( uint32 ackedBytes, uint32 rttMilliseconds ) override;
+			void OnLoss() override;
+			void Update( float32 elapsedTime ) override;
+			void Reset() override;
+
+			float32 GetSendRateBytesPerSecond() const override;
+			float32 GetCongestionWindowBytes() const { return _congestionWindowBytes; }
+
+		private:
+			float32 GetRTTSeconds() const;
+
+			float32 _congestionWindowBytes;
+			uint32 _rttMilliseconds;
+			// Time since the congestion window was last halved
+			float32 _timeSinceLastDecrease;
+	};
+} // namespace NetLib
@@ -0,0 +1,130 @@
+#include "bit_reader.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include "logger.h"
+
+#include "core/bit_writer.h"
+#include "core/buffer.h"
+
+namespace NetLib
+{
+	BitReader::BitReader( Buffer& buffer )
+	    : _buffer( buffer )
+	    , _data( buffer.GetData() + buffer.GetAccessIndex() )
+	    , _size( static_cast< uint32 >( buffer.GetSize() ) - buffer.GetAccessIndex() )
+	    , _numberOfBytesLoaded( 0 )
+	    , _scratch( 0 )
+	    , _numberOfScratchBits( 0 )
+	    , _numberOfBitsRead( 0 )
+	    , _hasFailed( false )
+	{
+	}
+
+	uint32 BitReader::ReadBits( uint32 numberOfBits )
+	{
+		assert( numberOfBits <= 32 );
+		if ( numberOfBits == 0 || _hasFailed )
+		{
+			return 0;
+		}
+
+		if ( !LoadScratch( numberOfBits ) )
+		{
+			LOG_WARNING( "Trying to read %u bits past the end of the buffer", numberOfBits );
+			_hasFailed = true;
+			return 0;
+		}
+
+		const uint64 mask = ( static_cast< uint64 >( 1 ) << numberOfBits ) - 1;
+		const uint32 value = static_cast< uint32 >( _scratch & mask );
+		_scratch >>= numberOfBits;
+		_numberOfScratchBits -= numberOfBits;
+		_numberOfBitsRead += numberOfBits;
+		return value;
+	}
+
+	bool BitReader::ReadBool()
+	{
+		return ReadBits( 1 ) != 0;
+	}
+
+	int32 BitReader::ReadInteger( int32 min, int32 max )
+	{
+		assert( min <= max );
+
+		const uint32 offset = ReadBits( BitWriter::GetNumberOfBitsRequired( min, max ) );
+		const int64 value = static_cast< int64 >( min ) + offset;
+		if ( value > max )
+		{
+			_hasFailed = true;
+			return 0;
+		}
+
+		return static_cast< int32 >( value );
+	}
+
+	float32 BitReader::ReadFloat()
+	{
+		const uint32 bits = ReadBits( 32 );
+		float32 value = 0.f;
+		std::memcpy( &value, &bits, sizeof( uint32 ) );
+		return value;
+	}
+
+	float32 BitReader::ReadQuantizedFloat( float32 min, float32 max, float32 resolution )
+	{
+		const uint32 quantizedValue = ReadBits( BitWriter::GetNumberOfBitsRequired( min, max, resolution ) );
+		if ( _hasFailed )
+		{
+			return 0.f;
+		}
+
+		// The last step can go beyond max if the range is not a multiple of the resolution
+		return std::min( min + ( static_cast< float32 >( quantizedValue ) * resolution ), max );
+	}
+
+	void BitReader::Finish()
+	{
+		// Bytes loaded into the scratch word but not read are given back to the buffer
+		const uint32 numberOfBytesRead = ( _numberOfBitsRead + 7 ) / 8;
+		_buffer.ReadDataView( numberOfBytesRead );
+
+		_scratch = 0;
+		_numberOfScratchBits = 0;
+	}
+
+	bool BitReader::LoadScratch( uint32 numberOfBits )
+	{
+		if ( _numberOfScratchBits >= numberOfBits )
+		{
+			return true;
+		}
+
+		// A whole word fits as there are less than 32 bits left within the scratch word. Words are stored in
+		// little-endian order, and compilers turn this into a single load on little-endian hosts
+		if ( _size - _numberOfBytesLoaded >= sizeof( uint32 ) )
+		{
+			const uint8* bytes = _data + _numberOfBytesLoaded;
+			const uint32 word = static_cast< uint32 >( bytes[ 0 ] ) | ( static_cast< uint32 >( bytes[ 1 ] ) << 8 ) |
+			                    ( static_cast< uint32 >( bytes[ 2 ] ) << 16 ) |
+			                    ( static_cast< uint32 >( bytes[ 3 ] ) << 24 );
+			_scratch |= static_cast< uint64 >( word ) << _numberOfScratchBits;
+			_numberOfScratchBits += 32;
+			_numberOfBytesLoaded += sizeof( uint32 );
+			return true;
+		}
+
+		// Close to the end of the buffer, load byte by byte
+		while ( _numberOfScratchBits < numberOfBits && _numberOfBytesLoaded < _size )
+		{
+			_scratch |= static_cast< uint64 >( _data[ _numberOfBytesLoaded ] ) << _numberOfScratchBits;
+			_numberOfScratchBits += 8;
+			++_numberOfBytesLoaded;
+		}
+
+		return _numberOfScratchBits >= numberOfBits;
+	}
+} // namespace NetLib
@@ -0,0 +1,60 @@
+#pragma once
+#include "numeric_types.h"
+
+namespace NetLib
+{
+	class Buffer;
+
+	/// <summary>
+	/// Reads the values written by a BitWriter from a Buffer, starting at its access index. The same sequence of calls
+	/// with the same ranges must be used. Bits are loaded into a scratch word up to 32 bits at a time.
+	/// The buffer must not be read through while the reader is in use, and Finish must be called once done.
+	/// </summary>
+	class BitReader
+	{
+		public:
+			BitReader( Buffer& buffer );
+			BitReader( const BitReader& ) = delete;
+
+			BitReader& operator=( const BitReader& ) = delete;
+
+			/// <summary>
+			/// Reads the next numberOfBits bits. Up to 32 bits at a time.
+			/// </summary>
+			uint32 ReadBits( uint32 numberOfBits );
+			bool ReadBool();
+			int32 ReadInteger( int32 min, int32 max );
+			float32 ReadFloat();
+			float32 ReadQuantizedFloat( float32 min, float32 max, float32 resolution );
+			/// <summary>
+			/// Moves the buffer access index right after the last byte read, skipping the padding bits of the last
+			/// byte
+			/// </summary>
+			void Finish();
+
+			/// <summary>
+			/// Returns True if the data read so far is not valid. This happens when reading past the end of the buffer
+			/// or when a value is out of the range it was written with. Values read after that are zero.
+			/// </summary>
+			bool HasFailed() const { return _hasFailed; }
+			uint32 GetNumberOfBitsRead() const { return _numberOfBitsRead; }
+
+		private:
+			/// <summary>
+			/// Loads bytes into the scratch word until it has at least numberOfBits bits
+			/// </summary>
+			bool LoadScratch( uint32 numberOfBits );
+
+			Buffer& _buffer;
+			// Memory from the buffer access index up to its end
+			const uint8* _data;
+			uint32 _size;
+			// Bytes already loaded into the scratch word
+			uint32 _numberOfBytesLoaded;
+
+			uint64 _scratch;
+			uint32 _numberOfScratchBits;
+			uint32 _numberOfBitsRead;
+			bool _hasFailed;
+	};
+} // namespace NetLib
@@ -0,0 +1,111 @@
+#include "bit_writer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+#include "core/buffer.h"
+
+#include "utils/bitwise_utils.h"
+
+namespace NetLib
+{
+	BitWriter::BitWriter( Buffer& buffer )
+	    : _buffer( buffer )
+	    , _scratch( 0 )
+	    , _numberOfScratchBits( 0 )
+	    , _numberOfBitsWritten( 0 )
+	{
+	}
+
+	void BitWriter::WriteBits( uint32 value, uint32 numberOfBits )
+	{
+		assert( numberOfBits <= 32 );
+		if ( numberOfBits == 0 )
+		{
+			return;
+		}
+
+		const uint64 mask = ( static_cast< uint64 >( 1 ) << numberOfBits ) - 1;
+		_scratch |= ( static_cast< uint64 >( value ) & mask ) << _numberOfScratchBits;
+		_numberOfScratchBits += numberOfBits;
+		_numberOfBitsWritten += numberOfBits;
+
+		if ( _numberOfScratchBits >= 32 )
+		{
+			_buffer.WriteInteger( static_cast< uint32 >( _scratch ) );
+			_scratch >>= 32;
+			_numberOfScratchBits -= 32;
+		}
+	}
+
+	void BitWriter::WriteBool( bool value )
+	{
+		WriteBits( value ? 1 : 0, 1 );
+	}
+
+	void BitWriter::WriteInteger( int32 value, int32 min, int32 max )
+	{
+		assert( min <= max );
+		assert( value >= min && value <= max );
+
+		const uint32 offset = static_cast< uint32 >( static_cast< int64 >( value ) - min );
+		WriteBits( offset, GetNumberOfBitsRequired( min, max ) );
+	}
+
+	void BitWriter::WriteFloat( float32 value )
+	{
+		uint32 bits = 0;
+		std::memcpy( &bits, &value, sizeof( uint32 ) );
+		WriteBits( bits, 32 );
+	}
+
+	void BitWriter::WriteQuantizedFloat( float32 value, float32 min, float32 max, float32 resolution )
+	{
+		assert( min < max );
+		assert( resolution > 0.f );
+
+		const uint32 numberOfBits = GetNumberOfBitsRequired( min, max, resolution );
+		const uint32 maxQuantizedValue = static_cast< uint32 >( std::ceil( ( max - min ) / resolution ) );
+
+		// Written this way so NaN ends up as min
+		const float32 clampedValue = ( value > min ) ? std::min( value, max ) : min;
+		const uint32 quantizedValue =
+		    std::min( static_cast< uint32 >( std::lround( ( clampedValue - min ) / resolution ) ), maxQuantizedValue );
+		WriteBits( quantizedValue, numberOfBits );
+	}
+
+	void BitWriter::Flush()
+	{
+		while ( _numberOfScratchBits > 0 )
+		{
+			_buffer.WriteByte( static_cast< uint8 >( _scratch ) );
+			_scratch >>= 8;
+			_numberOfScratchBits = ( _numberOfScratchBits > 8 ) ? _numberOfScratchBits - 8 : 0;
+		}
+
+		_scratch = 0;
+	}
+
+	uint32 BitWriter::GetNumberOfBitsRequired( int32 min, int32 max )
+	{
+		assert( min <= max );
+		const uint32 range = static_cast< uint32 >( static_cast< int64 >( max ) - min );
+		return BitwiseUtils::GetNumberOfBitsRequired( range );
+	}
+
+	uint32 BitWriter::GetNumberOfBitsRequired( float32 min, float32 max, float32 resolution )
+	{
+		assert( min < max );
+		assert( resolution > 0.f );
+		const uint32 maxQuantizedValue = static_cast< uint32 >( std::ceil( ( max - min ) / resolution ) );
+		return BitwiseUtils::GetNumberOfBitsRequired( maxQuantizedValue );
+	}
+
+	BitWriter::~BitWriter()
+	{
+		// Bits left within the scratch word would be lost
+		assert( _numberOfScratchBits == 0 );
+	}
+} // namespace NetLib
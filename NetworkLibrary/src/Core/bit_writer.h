@@ -0,0 +1,67 @@
+#pragma once
+#include "numeric_types.h"
+
+namespace NetLib
+{
+	class Buffer;
+
+	/// <summary>
+	/// Writes values using only the bits they need into a Buffer, starting at its access index. Bits are accumulated
+	/// within a scratch word and stored one 32-bit word at a time. Anything that serializes into a Buffer (messages,
+	/// input states, replication callbacks...) can wrap it with a BitWriter, and read it back with a BitReader.
+	/// The buffer must not be written through while the writer is in use, and Flush must be called once done.
+	/// </summary>
+	class BitWriter
+	{
+		public:
+			BitWriter( Buffer& buffer );
+			BitWriter( const BitWriter& ) = delete;
+
+			BitWriter& operator=( const BitWriter& ) = delete;
+
+			/// <summary>
+			/// Writes the lowest numberOfBits bits of value. Up to 32 bits at a time.
+			/// </summary>
+			void WriteBits( uint32 value, uint32 numberOfBits );
+			void WriteBool( bool value );
+			/// <summary>
+			/// Writes an integer within [min, max] using only the bits that range needs
+			/// </summary>
+			void WriteInteger( int32 value, int32 min, int32 max );
+			/// <summary>
+			/// Writes the whole 32 bits of the float
+			/// </summary>
+			void WriteFloat( float32 value );
+			/// <summary>
+			/// Writes a float within [min, max] rounded to the nearest multiple of resolution. Values out of the range
+			/// are clamped.
+			/// </summary>
+			void WriteQuantizedFloat( float32 value, float32 min, float32 max, float32 resolution );
+			/// <summary>
+			/// Writes the bits left within the scratch word, padding the last byte with zeros, and moves the buffer
+			/// access index right after it
+			/// </summary>
+			void Flush();
+
+			uint32 GetNumberOfBitsWritten() const { return _numberOfBitsWritten; }
+			uint32 GetNumberOfBytesWritten() const { return ( _numberOfBitsWritten + 7 ) / 8; }
+
+			/// <summary>
+			/// Number of bits used by WriteInteger for the given range
+			/// </summary>
+			static uint32 GetNumberOfBitsRequired( int32 min, int32 max );
+			/// <summary>
+			/// Number of bits used by WriteQuantizedFloat for the given range and resolution
+			/// </summary>
+			static uint32 GetNumberOfBitsRequired( float32 min, float32 max, float32 resolution );
+
+			~BitWriter();
+
+		private:
+			Buffer& _buffer;
+			// Bits not stored yet. It has room for a whole word on top of the bits left from the previous write
+			uint64 _scratch;
+			uint32 _numberOfScratchBits;
+			uint32 _numberOfBitsWritten;
+	};
+} // namespace NetLib
@@ -0,0 +1,84 @@
+#include "datagram_batch.h"
+
+#include <cassert>
+
+namespace NetLib
+{
+	DatagramBatch::DatagramBatch( uint32 capacity, uint32 datagramMaxSize )
+	    : _capacity( capacity )
+	    , _datagramMaxSize( datagramMaxSize )
+	    , _numberOfDatagrams( 0 )
+	    , _data( nullptr )
+	    , _datagramData()
+	    , _datagramSizes()
+	    , _datagramAddresses()
+	{
+		assert( _capacity > 0 );
+
+		_data = new uint8[ _capacity * _datagramMaxSize ];
+		_datagramData.resize( _capacity, nullptr );
+		_datagramSizes.resize( _capacity, 0 );
+		_datagramAddresses.reserve( _capacity );
+		for ( uint32 i = 0; i < _capacity; ++i )
+		{
+			_datagramAddresses.push_back( Address::GetInvalid() );
+		}
+	}
+
+	uint8* DatagramBatch::GetDatagramData( uint32 index ) const
+	{
+		assert( index < _numberOfDatagrams );
+		return _datagramData[ index ];
+	}
+
+	uint32 DatagramBatch::GetDatagramSize( uint32 index ) const
+	{
+		assert( index < _numberOfDatagrams );
+		return _datagramSizes[ index ];
+	}
+
+	const Address& DatagramBatch::GetDatagramAddress( uint32 index ) const
+	{
+		assert( index < _numberOfDatagrams );
+		return _datagramAddresses[ index ];
+	}
+
+	uint8* DatagramBatch::GetNextFreeDatagramData() const
+	{
+		assert( !IsFull() );
+		return _data + ( _numberOfDatagrams * _datagramMaxSize );
+	}
+
+	void DatagramBatch::CommitDatagram( uint32 size, const Address& address )
+	{
+		assert( !IsFull() );
+		assert( size <= _datagramMaxSize );
+
+		_datagramData[ _numberOfDatagrams ] = _data + ( _numberOfDatagrams * _datagramMaxSize );
+		_datagramSizes[ _numberOfDatagrams ] = size;
+		_datagramAddresses[ _numberOfDatagrams ] = address;
+		++_numberOfDatagrams;
+	}
+
+	void DatagramBatch::CommitDatagramView( uint8* data, uint32 size, const Address& address )
+	{
+		assert( !IsFull() );
+		assert( data != nullptr );
+
+		_datagramData[ _numberOfDatagrams ] = data;
+		_datagramSizes[ _numberOfDatagrams ] = size;
+		_datagramAddresses[ _numberOfDatagrams ] = address;
+		++_numberOfDatagrams;
+	}
+
+	void DatagramBatch::Clear()
+	{
+		_numberOfDatagrams = 0;
+	}
+
+	DatagramBatch::~DatagramBatch()
+	{
+		delete[] _data;
+		_data = nullptr;
+	}
+} // namespace NetLib
@@ -0,0 +1,62 @@
+#pragma once
+#include "numeric_types.h"
+
+#include <vector>
+
+#include "core/address.h"
+
+namespace NetLib
+{
+	// Maximum number of datagrams that can be read or written within a single batched socket operation
+	constexpr uint32 MAX_DATAGRAM_BATCH_SIZE = 64;
+
+	/// <summary>
+	/// Fixed capacity collection of datagrams that share a single contiguous memory block. It is used for reading and
+	/// writing several datagrams with a single socket call (recvmmsg/sendmmsg on Linux). A datagram can also be a view
+	/// of memory owned by someone else (for example an io_uring receive buffer) in order to avoid copying it.
+	/// </summary>
+	class DatagramBatch
+	{
+		public:
+			DatagramBatch( uint32 capacity, uint32 datagramMaxSize );
+			DatagramBatch( const DatagramBatch& ) = delete;
+
+			DatagramBatch& operator=( const DatagramBatch& ) = delete;
+
+			uint32 GetCapacity() const { return _capacity; }
+			uint32 GetDatagramMaxSize() const { return _datagramMaxSize; }
+			uint32 GetNumberOfDatagrams() const { return _numberOfDatagrams; }
+			bool IsEmpty() const { return _numberOfDatagrams == 0; }
+			bool IsFull() const { return _numberOfDatagrams == _capacity; }
+
+			uint8* GetDatagramData( uint32 index ) const;
+			uint32 GetDatagramSize( uint32 index ) const;
+			const Address& GetDatagramAddress( uint32 index ) const;
+
+			/// <summary>
+			/// Returns the memory of the next free datagram slot. Write up to GetDatagramMaxSize() bytes into it and
+			/// call CommitDatagram in order to add it to the batch.
+			/// </summary>
+			uint8* GetNextFreeDatagramData() const;
+			void CommitDatagram( uint32 size, const Address& address );
+			/// <summary>
+			/// Adds a datagram whose data lives outside the batch. The memory must remain valid until the batch gets
+			/// cleared.
+			/// </summary>
+			void CommitDatagramView( uint8* data, uint32 size, const Address& address );
+
+			void Clear();
+
+			~DatagramBatch();
+
+		private:
+			const uint32 _capacity;
+			const uint32 _datagramMaxSize;
+			uint32 _numberOfDatagrams;
+
+			uint8* _data;
+			std::vector< uint8* > _datagramData;
+			std::vector< uint32 > _datagramSizes;
+			std::vector< Address > _datagramAddresses;
+	};
+} // namespace NetLib
@@ -0,0 +1,74 @@
+#include "datagram_queue.h"
+
+#include <cassert>
+#include <cstring>
+
+namespace NetLib
+{
+	DatagramQueue::DatagramQueue()
+	    : _data()
+	    , _entries()
+	{
+	}
+
+	const uint8* DatagramQueue::GetDatagramData( uint32 index ) const
+	{
+		assert( index < _entries.size() );
+		return _data.data() + _entries[ index ].offset;
+	}
+
+	uint8* DatagramQueue::GetDatagramData( uint32 index )
+	{
+		assert( index < _entries.size() );
+		return _data.data() + _entries[ index ].offset;
+	}
+
+	uint32 DatagramQueue::GetDatagramSize( uint32 index ) const
+	{
+		assert( index < _entries.size() );
+		return _entries[ index ].size;
+	}
+
+	const Address& DatagramQueue::GetDatagramAddress( uint32 index ) const
+	{
+		assert( index < _entries.size() );
+		return _entries[ index ].address;
+	}
+
+	uint8* DatagramQueue::PushDatagram( uint32 size, const Address& address )
+	{
+		const uint32 offset = static_cast< uint32 >( _data.size() );
+		_data.resize( offset + size );
+		_entries.emplace_back( offset, size, address );
+
+		return _data.data() + offset;
+	}
+
+	void DatagramQueue::PushDatagram( const uint8* data, uint32 size, const Address& address )
+	{
+		uint8* datagramData = PushDatagram( size, address );
+		std::memcpy( datagramData, data, size );
+	}
+
+	void DatagramQueue::ShrinkLastDatagram( uint32 size )
+	{
+		assert( !_entries.empty() );
+		Entry& lastEntry = _entries.back();
+		assert( size <= lastEntry.size );
+
+		lastEntry.size = size;
+		_data.resize( lastEntry.offset + size );
+	}
+
+	void DatagramQueue::Clear()
+	{
+		_data.clear();
+		_entries.clear();
+	}
+
+	void DatagramQueue::Swap( DatagramQueue& other )
+	{
+		_data.swap( other._data );
+		_entries.swap( other._entries );
+	}
+} // namespace NetLib
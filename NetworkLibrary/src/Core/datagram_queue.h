@@ -0,0 +1,68 @@
+#pragma once
+#include "numeric_types.h"
+
+#include <vector>
+
+#include "core/address.h"
+
+namespace NetLib
+{
+	/// <summary>
+	/// Growable collection of datagrams stored back to back within a single memory block. It is used for handing over
+	/// datagrams between threads, so it grows as needed instead of having a fixed capacity like DatagramBatch.
+	/// </summary>
+	class DatagramQueue
+	{
+		public:
+			DatagramQueue();
+			DatagramQueue( const DatagramQueue& ) = delete;
+			DatagramQueue( DatagramQueue&& other ) = default;
+
+			DatagramQueue& operator=( const DatagramQueue& ) = delete;
+			DatagramQueue& operator=( DatagramQueue&& other ) = default;
+
+			uint32 GetNumberOfDatagrams() const { return static_cast< uint32 >( _entries.size() ); }
+			bool IsEmpty() const { return _entries.empty(); }
+
+			const uint8* GetDatagramData( uint32 index ) const;
+			uint8* GetDatagramData( uint32 index );
+			uint32 GetDatagramSize( uint32 index ) const;
+			const Address& GetDatagramAddress( uint32 index ) const;
+
+			/// <summary>
+			/// Adds a new datagram and returns the memory where its data must be written. The pointer is only valid
+			/// until the next call to any of the Push methods.
+			/// </summary>
+			uint8* PushDatagram( uint32 size, const Address& address );
+			void PushDatagram( const uint8* data, uint32 size, const Address& address );
+			/// <summary>
+			/// Reduces the size of the last datagram pushed. Useful when it was pushed with its maximum size before
+			/// knowing how many bytes were going to be written.
+			/// </summary>
+			void ShrinkLastDatagram( uint32 size );
+
+			/// <summary>
+			/// Removes all the datagrams but keeps the memory for later reuse
+			/// </summary>
+			void Clear();
+			void Swap( DatagramQueue& other );
+
+		private:
+			struct Entry
+			{
+					Entry( uint32 offset, uint32 size, const Address& address )
+					    : offset( offset )
+					    , size( size )
+					    , address( address )
+					{
+					}
+
+					uint32 offset;
+					uint32 size;
+					Address address;
+			};
+
+			std::vector< uint8 > _data;
+			std::vector< Entry > _entries;
+	};
+} // namespace NetLib
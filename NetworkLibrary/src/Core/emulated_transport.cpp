@@ -0,0 +1,176 @@
+#include "emulated_transport.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+#include "logger.h"
+
+#include "core/datagram_batch.h"
+#include "core/socket.h"
+#include "core/time_clock.h"
+
+namespace NetLib
+{
+	EmulatedTransport::EmulatedTransport( std::unique_ptr< Transport > transport,
+	                                      const NetworkConditions& outgoingConditions,
+	                                      const NetworkConditions& incomingConditions, uint32 seed )
+	    : Transport()
+	    , _transport( std::move( transport ) )
+	    , _outgoingEmulator( outgoingConditions, seed )
+	    , _incomingEmulator( incomingConditions, seed + 1 )
+	    , _outgoingBatch( nullptr )
+	    , _incomingBatch( nullptr )
+	{
+		assert( _transport != nullptr );
+	}
+
+	bool EmulatedTransport::Start( uint32 datagramMaxSize )
+	{
+		if ( !_transport->Start( datagramMaxSize ) )
+		{
+			return false;
+		}
+
+		// Outgoing datagrams can be bigger than incoming ones, as long as they fit within the MTU
+		_outgoingBatch = std::make_unique< DatagramBatch >( MAX_DATAGRAM_BATCH_SIZE,
+		                                                    std::max( datagramMaxSize, MTU_SIZE_BYTES ) );
+		_incomingBatch = std::make_unique< DatagramBatch >( MAX_DATAGRAM_BATCH_SIZE, datagramMaxSize );
+		return true;
+	}
+
+	bool EmulatedTransport::Bind( const Address& address )
+	{
+		return _transport->Bind( address );
+	}
+
+	SocketResult EmulatedTransport::ReceiveFromBatch( DatagramBatch& batch, Address& remoteAddress )
+	{
+		if ( _incomingBatch == nullptr )
+		{
+			return SocketResult::SOKT_ERR;
+		}
+
+		const float64 currentTime = TimeClock::GetInstance().GetLocalTimeSeconds();
+
+		// Peers receive every tick, so this is where outgoing datagrams held back by the conditions get sent
+		FlushDueOutgoingDatagrams( currentTime );
+
+		// Read everything the wrapped transport has and let the conditions decide when it gets delivered
+		SocketResult result = SocketResult::SOKT_SUCCESS;
+		do
+		{
+			_incomingBatch->Clear();
+			result = _transport->ReceiveFromBatch( *_incomingBatch, remoteAddress );
+
+			const uint32 numberOfDatagrams = _incomingBatch->GetNumberOfDatagrams();
+			for ( uint32 i = 0; i < numberOfDatagrams; ++i )
+			{
+				_incomingEmulator.Submit( _incomingBatch->GetDatagramData( i ), _incomingBatch->GetDatagramSize( i ),
+				                          _incomingBatch->GetDatagramAddress( i ), currentTime );
+			}
+		} while ( result == SocketResult::SOKT_SUCCESS && _incomingBatch->IsFull() );
+
+		if ( result == SocketResult::SOKT_ERR || result == SocketResult::SOKT_CONNRESET )
+		{
+			return result;
+		}
+
+		while ( _incomingEmulator.PopDueDatagram( batch, currentTime ) )
+		{
+		}
+
+		return batch.IsEmpty() ? SocketResult::SOKT_WOULDBLOCK : SocketResult::SOKT_SUCCESS;
+	}
+
+	SocketResult EmulatedTransport::SendToBatch( const DatagramBatch& batch )
+	{
+		if ( _outgoingBatch == nullptr )
+		{
+			return SocketResult::SOKT_ERR;
+		}
+
+		const float64 currentTime = TimeClock::GetInstance().GetLocalTimeSeconds();
+
+		const uint32 numberOfDatagrams = batch.GetNumberOfDatagrams();
+		for ( uint32 i = 0; i < numberOfDatagrams; ++i )
+		{
+			_outgoingEmulator.Submit( batch.GetDatagramData( i ), batch.GetDatagramSize( i ),
+			                          batch.GetDatagramAddress( i ), currentTime );
+		}
+
+		return FlushDueOutgoingDatagrams( currentTime );
+	}
+
+	bool EmulatedTransport::WaitForIncomingData( float32 timeoutSeconds ) const
+	{
+		const float64 currentTime = TimeClock::GetInstance().GetLocalTimeSeconds();
+
+		// Wake up in time for the next held back datagram, in either direction
+		float64 nextDeliveryTime = std::numeric_limits< float64 >::max();
+		if ( _incomingEmulator.ArePendingDatagrams() )
+		{
+			nextDeliveryTime = _incomingEmulator.GetNextDeliveryTime();
+		}
+
+		if ( _outgoingEmulator.ArePendingDatagrams() )
+		{
+			nextDeliveryTime = std::min( nextDeliveryTime, _outgoingEmulator.GetNextDeliveryTime() );
+		}
+
+		if ( nextDeliveryTime <= currentTime )
+		{
+			return true;
+		}
+
+		const float64 waitTime = std::min( static_cast< float64 >( timeoutSeconds ), nextDeliveryTime - currentTime );
+		if ( _transport->WaitForIncomingData( static_cast< float32 >( waitTime ) ) )
+		{
+			return true;
+		}
+
+		return nextDeliveryTime <= TimeClock::GetInstance().GetLocalTimeSeconds();
+	}
+
+	void EmulatedTransport::Close()
+	{
+		// Datagrams already on their way, such as disconnection ones, still reach their destination
+		if ( _outgoingBatch != nullptr )
+		{
+			FlushDueOutgoingDatagrams( std::numeric_limits< float64 >::max() );
+		}
+
+		_outgoingEmulator.Clear();
+		_incomingEmulator.Clear();
+		_transport->Close();
+	}
+
+	SocketResult EmulatedTransport::FlushDueOutgoingDatagrams( float64 currentTime )
+	{
+		while ( true )
+		{
+			_outgoingBatch->Clear();
+			while ( _outgoingEmulator.PopDueDatagram( *_outgoingBatch, currentTime ) )
+			{
+			}
+
+			if ( _outgoingBatch->IsEmpty() )
+			{
+				return SocketResult::SOKT_SUCCESS;
+			}
+
+			const SocketResult result = _transport->SendToBatch( *_outgoingBatch );
+			if ( result != SocketResult::SOKT_SUCCESS )
+			{
+				LOG_WARNING( "Error while sending emulated datagrams through the wrapped transport" );
+				_outgoingBatch->Clear();
+				return result;
+			}
+		}
+	}
+
+	EmulatedTransport::~EmulatedTransport()
+	{
+		Close();
+	}
+} // namespace NetLib
@@ -0,0 +1,48 @@
+#pragma once
+#include "numeric_types.h"
+
+#include <memory>
+
+#include "core/network_condition_emulator.h"
+#include "core/transport.h"
+
+namespace NetLib
+{
+	/// <summary>
+	/// Transport that wraps another one and applies network conditions (latency, jitter, loss, duplication,
+	/// reordering, bandwidth caps and path MTU) to the datagrams going through it. Outgoing and incoming datagrams have
+	/// their own conditions. Every random decision comes from the seed, so a run can be reproduced by reusing it.
+	/// </summary>
+	class EmulatedTransport : public Transport
+	{
+		public:
+			EmulatedTransport( std::unique_ptr< Transport > transport, const NetworkConditions& outgoingConditions,
+			                   const NetworkConditions& incomingConditions, uint32 seed );
+
+			bool Start( uint32 datagramMaxSize ) override;
+			bool Bind( const Address& address ) override;
+			SocketResult ReceiveFromBatch( DatagramBatch& batch, Address& remoteAddress ) override;
+			SocketResult SendToBatch( const DatagramBatch& batch ) override;
+			bool WaitForIncomingData( float32 timeoutSeconds ) const override;
+			void Close() override;
+
+			const NetworkConditionStats& GetOutgoingStats() const { return _outgoingEmulator.GetStats(); }
+			const NetworkConditionStats& GetIncomingStats() const { return _incomingEmulator.GetStats(); }
+
+			~EmulatedTransport() override;
+
+		private:
+			/// <summary>
+			/// Sends through the wrapped transport the outgoing datagrams whose delivery time has come
+			/// </summary>
+			SocketResult FlushDueOutgoingDatagrams( float64 currentTime );
+
+			std::unique_ptr< Transport > _transport;
+			NetworkConditionEmulator _outgoingEmulator;
+			NetworkConditionEmulator _incomingEmulator;
+
+			// Scratch batches used to move datagrams between the wrapped transport and the emulators
+			std::unique_ptr< DatagramBatch > _outgoingBatch;
+			std::unique_ptr< DatagramBatch > _incomingBatch;
+	};
+} // namespace NetLib
@@ -0,0 +1,24 @@
+#pragma once
+#include "numeric_types.h"
+
+namespace NetLib
+{
+	/// <summary>
+	/// Decides how fast data can be sent to a remote peer. It is fed with the signals observed by the reliable
+	/// transmission channel: acked messages, which carry RTT samples, and messages whose retransmission timeout
+	/// expired, which are taken as losses. Implementations can react to losses, like AIMD, or to RTT growth.
+	/// </summary>
+	class ICongestionController
+	{
+		public:
+			ICongestionController() {}
+			virtual ~ICongestionController() {}
+
+			virtual void OnAck( uint32 ackedBytes, uint32 rttMilliseconds ) = 0;
+			virtual void OnLoss() = 0;
+			virtual void Update( float32 elapsedTime ) = 0;
+			virtual void Reset() = 0;
+
+			virtual float32 GetSendRateBytesPerSecond() const = 0;
+	};
+} // namespace NetLib
@@ -0,0 +1,29 @@
+#pragma once
+#include "numeric_types.h"
+
+namespace NetLib
+{
+	class SocketShard;
+	class DatagramBatch;
+
+	/// <summary>
+	/// Per remote peer work run by the socket shard workers. Each shard owns the remote peers whose first datagram
+	/// arrived through it, so these calls must only touch those ones. They are called while the worker holds the remote
+	/// peers lock of its shard.
+	/// </summary>
+	class ISocketShardHandler
+	{
+		public:
+			ISocketShardHandler() {}
+			virtual ~ISocketShardHandler() {}
+
+			/// <summary>
+			/// Processes the datagrams received by the shard. The batch memory gets reused once this returns.
+			/// </summary>
+			virtual void ProcessSocketShardDatagrams( SocketShard& socketShard, const DatagramBatch& batch ) = 0;
+			/// <summary>
+			/// Serializes the pending data of the shard's remote peers through its outgoing datagrams
+			/// </summary>
+			virtual void SendSocketShardData( SocketShard& socketShard ) = 0;
+	};
+} // namespace NetLib
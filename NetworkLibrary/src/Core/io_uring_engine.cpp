@@ -0,0 +1,618 @@
+#include "io_uring_engine.h"
+
+#ifdef __linux__
+	#include <cassert>
+	#include <cstring>
+	#include <algorithm>
+
+	#include <linux/io_uring.h>
+	#include <sys/mman.h>
+	#include <sys/syscall.h>
+
+	#include "core/address.h"
+
+	#include "logger.h"
+
+namespace NetLib
+{
+	// Completions are matched to their operation through the user data. Its upper half tells the type of operation and
+	// the lower one the receive operation index or the send slot index
+	static constexpr uint64 OPERATION_TYPE_USER_DATA_MASK = 0xFFFFFFFFull << 32;
+	static constexpr uint64 RECEIVE_OPERATION_USER_DATA = 0;
+	static constexpr uint64 SEND_OPERATION_USER_DATA = 1ull << 32;
+	static constexpr uint64 CANCEL_OPERATION_USER_DATA = 2ull << 32;
+	static constexpr uint64 PROVIDE_BUFFERS_OPERATION_USER_DATA = 3ull << 32;
+
+	static constexpr uint16 RECEIVE_BUFFER_GROUP = 0;
+
+	IoUringEngine::IoUringEngine()
+	    : _socket( INVALID_SOCKET_HANDLE )
+	    , _ringHandle( -1 )
+	    , _datagramMaxSize( 0 )
+	    , _submissionRingMemory( nullptr )
+	    , _submissionRingMemorySize( 0 )
+	    , _submissionHead( nullptr )
+	    , _submissionTail( nullptr )
+	    , _submissionLocalTail( 0 )
+	    , _submissionRingMask( 0 )
+	    , _submissionArray( nullptr )
+	    , _submissionEntries( nullptr )
+	    , _submissionEntriesMemorySize( 0 )
+	    , _submissionEntriesCount( 0 )
+	    , _completionRingMemory( nullptr )
+	    , _completionRingMemorySize( 0 )
+	    , _completionHead( nullptr )
+	    , _completionTail( nullptr )
+	    , _completionRingMask( 0 )
+	    , _completionEntries( nullptr )
+	    , _receiveBuffers( nullptr )
+	    , _receiveOperations()
+	    , _completedReceives()
+	    , _receiveOperationsPendingToPost()
+	    , _receiveBuffersPendingToProvide()
+	    , _numberOfReceivesInFlight( 0 )
+	    , _hasProvideBuffersFailed( false )
+	    , _sendBuffers( nullptr )
+	    , _sendSlots()
+	    , _freeSendSlots()
+	    , _numberOfSendsInFlight( 0 )
+	    , _numberOfFailedSends( 0 )
+	{
+	}
+
+	bool IoUringEngine::Start( SocketHandle socket, uint32 datagramMaxSize )
+	{
+		if ( IsValid() )
+		{
+			LOG_WARNING( "io_uring warning. Trying to start an io_uring engine that has already been started" );
+			return true;
+		}
+
+		struct io_uring_params params;
+		std::memset( &params, 0, sizeof( params ) );
+
+		// Enough entries for queuing every receive operation and receive buffer, and a full send batch, at once
+		const uint32 numberOfEntries =
+		    IO_URING_NUMBER_OF_RECEIVE_OPERATIONS + IO_URING_NUMBER_OF_RECEIVE_BUFFERS + MAX_DATAGRAM_BATCH_SIZE;
+		_ringHandle = static_cast< int32 >( syscall( __NR_io_uring_setup, numberOfEntries, &params ) );
+		if ( _ringHandle == -1 )
+		{
+			LOG_WARNING( "io_uring warning. io_uring is not available. Error code %d", errno );
+			return false;
+		}
+
+		if ( !MapRings( params ) )
+		{
+			UnmapRings();
+			close( _ringHandle );
+			_ringHandle = -1;
+			return false;
+		}
+
+		_socket = socket;
+		_datagramMaxSize = datagramMaxSize;
+
+		// All the receive buffers live in a single block, which is handed to the kernel as a single buffer group
+		_receiveBuffers = new uint8[ IO_URING_NUMBER_OF_RECEIVE_BUFFERS * _datagramMaxSize ];
+		if ( !ProvideInitialReceiveBuffers() )
+		{
+			LOG_WARNING( "io_uring warning. The kernel doesn't support provided buffers" );
+			Close();
+			return false;
+		}
+
+		// The receive operations are posted lazily, on the first receive call
+		_receiveOperations.resize( IO_URING_NUMBER_OF_RECEIVE_OPERATIONS );
+		_receiveOperationsPendingToPost.reserve( IO_URING_NUMBER_OF_RECEIVE_OPERATIONS );
+		_receiveBuffersPendingToProvide.reserve( IO_URING_NUMBER_OF_RECEIVE_BUFFERS );
+		for ( uint32 i = 0; i < IO_URING_NUMBER_OF_RECEIVE_OPERATIONS; ++i )
+		{
+			_receiveOperations[ i ].isInFlight = false;
+			_receiveOperationsPendingToPost.push_back( i );
+		}
+
+		_sendBuffers = new uint8[ IO_URING_NUMBER_OF_SEND_SLOTS * _datagramMaxSize ];
+		_sendSlots.resize( IO_URING_NUMBER_OF_SEND_SLOTS );
+		_freeSendSlots.reserve( IO_URING_NUMBER_OF_SEND_SLOTS );
+		for ( uint32 i = 0; i < IO_URING_NUMBER_OF_SEND_SLOTS; ++i )
+		{
+			_sendSlots[ i ].data = _sendBuffers + ( i * _datagramMaxSize );
+			_freeSendSlots.push_back( i );
+		}
+
+		LOG_INFO( "io_uring engine started. Submission entries: %u, Completion entries: %u", params.sq_entries,
+		          params.cq_entries );
+		return true;
+	}
+
+	SocketResult IoUringEngine::ReceiveBatch( DatagramBatch& batch, Address& remoteAddress )
+	{
+		if ( !IsValid() )
+		{
+			return SocketResult::SOKT_ERR;
+		}
+
+		// The datagrams returned in the previous call have already been processed, so their buffers can be reused.
+		// Operations are posted after them, so they don't find the buffer group empty
+		for ( uint32 i = 0; i < _receiveBuffersPendingToProvide.size(); ++i )
+		{
+			PrepareProvideBuffers( _receiveBuffersPendingToProvide[ i ], 1 );
+		}
+		_receiveBuffersPendingToProvide.clear();
+
+		for ( uint32 i = 0; i < _receiveOperationsPendingToPost.size(); ++i )
+		{
+			PrepareReceive( _receiveOperationsPendingToPost[ i ] );
+		}
+		_receiveOperationsPendingToPost.clear();
+
+		if ( Submit( 0 ) == SOCKET_ERROR )
+		{
+			LOG_ERROR( "io_uring error. Error while submitting receive operations. Error code %d", errno );
+			return SocketResult::SOKT_ERR;
+		}
+
+		ProcessCompletions();
+		if ( _hasProvideBuffersFailed )
+		{
+			LOG_ERROR( "io_uring error. Error while giving receive buffers back to the kernel" );
+			_hasProvideBuffersFailed = false;
+		}
+
+		if ( _completedReceives.empty() )
+		{
+			return SocketResult::SOKT_WOULDBLOCK;
+		}
+
+		SocketResult result = SocketResult::SOKT_SUCCESS;
+		Address incomingAddress = Address::GetInvalid();
+		while ( !batch.IsFull() && !_completedReceives.empty() )
+		{
+			const CompletedReceive completedReceive = _completedReceives.front();
+			_completedReceives.pop_front();
+			if ( completedReceive.hasBuffer )
+			{
+				_receiveBuffersPendingToProvide.push_back( completedReceive.bufferId );
+			}
+
+			if ( completedReceive.result < 0 )
+			{
+				const int32 error = -completedReceive.result;
+				if ( error == ECONNREFUSED || error == ECONNRESET )
+				{
+					// Linux does not report which remote address caused the error
+					LOG_WARNING( "Socket warning. The remote socket has been closed unexpectly." );
+					remoteAddress = Address::GetInvalid();
+					result = SocketResult::SOKT_CONNRESET;
+				}
+				else if ( error != ECANCELED && error != ENOBUFS )
+				{
+					// Running out of buffers is not an error. The operation gets posted again once they are given back
+					LOG_ERROR( "io_uring error. Error while receiving a message. Error code: %d", error );
+				}
+
+				continue;
+			}
+
+			// The receive operations use MSG_TRUNC so the result is the real size of the datagram
+			if ( static_cast< uint32 >( completedReceive.result ) > _datagramMaxSize )
+			{
+				LOG_ERROR( "Socket error. The message received does not fit inside the buffer. Ignoring it..." );
+				continue;
+			}
+
+			assert( completedReceive.hasBuffer );
+			incomingAddress.SetFromSockAddr( completedReceive.address );
+			batch.CommitDatagramView( _receiveBuffers + ( completedReceive.bufferId * _datagramMaxSize ),
+			                          static_cast< uint32 >( completedReceive.result ), incomingAddress );
+		}
+
+		if ( result == SocketResult::SOKT_SUCCESS && batch.IsEmpty() )
+		{
+			result = SocketResult::SOKT_WOULDBLOCK;
+		}
+
+		return result;
+	}
+
+	SocketResult IoUringEngine::SendBatch( const DatagramBatch& batch )
+	{
+		if ( !IsValid() )
+		{
+			return SocketResult::SOKT_ERR;
+		}
+
+		// Frees the slots of the sends completed since the previous call
+		ProcessCompletions();
+
+		const uint32 numberOfDatagrams = batch.GetNumberOfDatagrams();
+		for ( uint32 i = 0; i < numberOfDatagrams; ++i )
+		{
+			const uint32 datagramSize = batch.GetDatagramSize( i );
+			if ( datagramSize > _datagramMaxSize )
+			{
+				LOG_ERROR( "io_uring error. Datagram bigger than the send buffer size. Discarding it..." );
+				continue;
+			}
+
+			// Every slot is still in flight, so submit what is prepared so far and wait for some of them
+			while ( _freeSendSlots.empty() )
+			{
+				if ( Submit( 1 ) == SOCKET_ERROR )
+				{
+					LOG_ERROR( "io_uring error. Error while submitting send operations. Error code %d", errno );
+					return SocketResult::SOKT_ERR;
+				}
+
+				ProcessCompletions();
+			}
+
+			const uint32 slotIndex = _freeSendSlots.back();
+			_freeSendSlots.pop_back();
+			PrepareSend( slotIndex, batch.GetDatagramData( i ), datagramSize, batch.GetDatagramAddress( i ) );
+		}
+
+		// The sends are independent, so one that fails doesn't cancel the rest
+		if ( Submit( 0 ) == SOCKET_ERROR )
+		{
+			LOG_ERROR( "io_uring error. Error while submitting send operations. Error code %d", errno );
+			return SocketResult::SOKT_ERR;
+		}
+
+		if ( _numberOfFailedSends > 0 )
+		{
+			LOG_ERROR( "io_uring error. Error while sending data. %u datagrams have been discarded",
+			           _numberOfFailedSends );
+			_numberOfFailedSends = 0;
+			return SocketResult::SOKT_ERR;
+		}
+
+		return SocketResult::SOKT_SUCCESS;
+	}
+
+	void IoUringEngine::Close()
+	{
+		if ( !IsValid() )
+		{
+			return;
+		}
+
+		// The kernel might still access the receive and send buffers, so make sure every operation is finished before
+		// releasing them
+		CancelInFlightReceives();
+		WaitForInFlightSends();
+
+		UnmapRings();
+		close( _ringHandle );
+		_ringHandle = -1;
+
+		delete[] _receiveBuffers;
+		_receiveBuffers = nullptr;
+		_receiveOperations.clear();
+		_completedReceives.clear();
+		_receiveOperationsPendingToPost.clear();
+		_receiveBuffersPendingToProvide.clear();
+		_numberOfReceivesInFlight = 0;
+		_hasProvideBuffersFailed = false;
+
+		delete[] _sendBuffers;
+		_sendBuffers = nullptr;
+		_sendSlots.clear();
+		_freeSendSlots.clear();
+		_numberOfSendsInFlight = 0;
+		_numberOfFailedSends = 0;
+		_socket = INVALID_SOCKET_HANDLE;
+	}
+
+	IoUringEngine::~IoUringEngine()
+	{
+		Close();
+	}
+
+	bool IoUringEngine::MapRings( const io_uring_params& params )
+	{
+		_submissionRingMemorySize = params.sq_off.array + ( params.sq_entries * sizeof( uint32 ) );
+		_completionRingMemorySize = params.cq_off.cqes + ( params.cq_entries * sizeof( io_uring_cqe ) );
+
+		// Newer kernels allow mapping both rings with a single call
+		const bool isSingleMap = ( params.features & IORING_FEAT_SINGLE_MMAP ) != 0;
+		if ( isSingleMap )
+		{
+			_submissionRingMemorySize = std::max( _submissionRingMemorySize, _completionRingMemorySize );
+			_completionRingMemorySize = _submissionRingMemorySize;
+		}
+
+		_submissionRingMemory = mmap( nullptr, _submissionRingMemorySize, PROT_READ | PROT_WRITE,
+		                              MAP_SHARED | MAP_POPULATE, _ringHandle, IORING_OFF_SQ_RING );
+		if ( _submissionRingMemory == MAP_FAILED )
+		{
+			LOG_ERROR( "io_uring error. Error while mapping the submission ring. Error code %d", errno );
+			_submissionRingMemory = nullptr;
+			return false;
+		}
+
+		if ( isSingleMap )
+		{
+			_completionRingMemory = _submissionRingMemory;
+		}
+		else
+		{
+			_completionRingMemory = mmap( nullptr, _completionRingMemorySize, PROT_READ | PROT_WRITE,
+			                              MAP_SHARED | MAP_POPULATE, _ringHandle, IORING_OFF_CQ_RING );
+			if ( _completionRingMemory == MAP_FAILED )
+			{
+				LOG_ERROR( "io_uring error. Error while mapping the completion ring. Error code %d", errno );
+				_completionRingMemory = nullptr;
+				return false;
+			}
+		}
+
+		_submissionEntriesCount = params.sq_entries;
+		_submissionEntriesMemorySize = params.sq_entries * sizeof( io_uring_sqe );
+		void* submissionEntriesMemory = mmap( nullptr, _submissionEntriesMemorySize, PROT_READ | PROT_WRITE,
+		                                      MAP_SHARED | MAP_POPULATE, _ringHandle, IORING_OFF_SQES );
+		if ( submissionEntriesMemory == MAP_FAILED )
+		{
+			LOG_ERROR( "io_uring error. Error while mapping the submission entries. Error code %d", errno );
+			return false;
+		}
+
+		uint8* submissionRing = static_cast< uint8* >( _submissionRingMemory );
+		_submissionHead = reinterpret_cast< uint32* >( submissionRing + params.sq_off.head );
+		_submissionTail = reinterpret_cast< uint32* >( submissionRing + params.sq_off.tail );
+		_submissionRingMask = *reinterpret_cast< uint32* >( submissionRing + params.sq_off.ring_mask );
+		_submissionArray = reinterpret_cast< uint32* >( submissionRing + params.sq_off.array );
+		_submissionEntries = static_cast< io_uring_sqe* >( submissionEntriesMemory );
+		_submissionLocalTail = *_submissionTail;
+
+		uint8* completionRing = static_cast< uint8* >( _completionRingMemory );
+		_completionHead = reinterpret_cast< uint32* >( completionRing + params.cq_off.head );
+		_completionTail = reinterpret_cast< uint32* >( completionRing + params.cq_off.tail );
+		_completionRingMask = *reinterpret_cast< uint32* >( completionRing + params.cq_off.ring_mask );
+		_completionEntries = reinterpret_cast< io_uring_cqe* >( completionRing + params.cq_off.cqes );
+
+		return true;
+	}
+
+	void IoUringEngine::UnmapRings()
+	{
+		if ( _submissionEntries != nullptr )
+		{
+			munmap( _submissionEntries, _submissionEntriesMemorySize );
+			_submissionEntries = nullptr;
+		}
+
+		if ( _completionRingMemory != nullptr && _completionRingMemory != _submissionRingMemory )
+		{
+			munmap( _completionRingMemory, _completionRingMemorySize );
+		}
+		_completionRingMemory = nullptr;
+
+		if ( _submissionRingMemory != nullptr )
+		{
+			munmap( _submissionRingMemory, _submissionRingMemorySize );
+			_submissionRingMemory = nullptr;
+		}
+	}
+
+	io_uring_sqe* IoUringEngine::GetSubmissionEntry()
+	{
+		const uint32 head = __atomic_load_n( _submissionHead, __ATOMIC_ACQUIRE );
+		if ( _submissionLocalTail - head >= _submissionEntriesCount )
+		{
+			return nullptr;
+		}
+
+		const uint32 index = _submissionLocalTail & _submissionRingMask;
+		io_uring_sqe* entry = &_submissionEntries[ index ];
+		std::memset( entry, 0, sizeof( io_uring_sqe ) );
+		_submissionArray[ index ] = index;
+		++_submissionLocalTail;
+
+		return entry;
+	}
+
+	void IoUringEngine::PrepareProvideBuffers( uint32 firstBufferId, uint32 numberOfBuffers )
+	{
+		io_uring_sqe* entry = GetSubmissionEntry();
+		assert( entry != nullptr );
+		entry->opcode = IORING_OP_PROVIDE_BUFFERS;
+		entry->fd = static_cast< int32 >( numberOfBuffers );
+		entry->addr = reinterpret_cast< uint64 >( _receiveBuffers + ( firstBufferId * _datagramMaxSize ) );
+		entry->len = _datagramMaxSize;
+		entry->off = firstBufferId;
+		entry->buf_group = RECEIVE_BUFFER_GROUP;
+		entry->user_data = PROVIDE_BUFFERS_OPERATION_USER_DATA;
+	}
+
+	bool IoUringEngine::ProvideInitialReceiveBuffers()
+	{
+		PrepareProvideBuffers( 0, IO_URING_NUMBER_OF_RECEIVE_BUFFERS );
+		if ( Submit( 1 ) == SOCKET_ERROR )
+		{
+			return false;
+		}
+
+		ProcessCompletions();
+		return !_hasProvideBuffersFailed;
+	}
+
+	void IoUringEngine::PrepareReceive( uint32 operationIndex )
+	{
+		// The kernel picks the buffer, so the operation only tells how much of it can be written
+		ReceiveOperation& operation = _receiveOperations[ operationIndex ];
+		operation.buffer.iov_base = nullptr;
+		operation.buffer.iov_len = _datagramMaxSize;
+
+		std::memset( &operation.header, 0, sizeof( operation.header ) );
+		std::memset( &operation.address, 0, sizeof( operation.address ) );
+		operation.header.msg_name = &operation.address;
+		operation.header.msg_namelen = sizeof( operation.address );
+		operation.header.msg_iov = &operation.buffer;
+		operation.header.msg_iovlen = 1;
+
+		io_uring_sqe* entry = GetSubmissionEntry();
+		assert( entry != nullptr );
+		entry->opcode = IORING_OP_RECVMSG;
+		entry->fd = _socket;
+		entry->flags = IOSQE_BUFFER_SELECT;
+		entry->addr = reinterpret_cast< uint64 >( &operation.header );
+		entry->len = 1;
+		entry->msg_flags = MSG_TRUNC;
+		entry->buf_group = RECEIVE_BUFFER_GROUP;
+		entry->user_data = RECEIVE_OPERATION_USER_DATA | operationIndex;
+
+		operation.isInFlight = true;
+		++_numberOfReceivesInFlight;
+	}
+
+	void IoUringEngine::PrepareSend( uint32 slotIndex, const uint8* data, uint32 size, const Address& address )
+	{
+		SendSlot& slot = _sendSlots[ slotIndex ];
+		std::memcpy( slot.data, data, size );
+		slot.address = address;
+		slot.buffer.iov_base = slot.data;
+		slot.buffer.iov_len = size;
+
+		std::memset( &slot.header, 0, sizeof( slot.header ) );
+		slot.header.msg_name = const_cast< sockaddr* >( slot.address.GetSockAddr() );
+		slot.header.msg_namelen = slot.address.GetSockAddrSize();
+		slot.header.msg_iov = &slot.buffer;
+		slot.header.msg_iovlen = 1;
+
+		io_uring_sqe* entry = GetSubmissionEntry();
+		assert( entry != nullptr );
+		entry->opcode = IORING_OP_SENDMSG;
+		entry->fd = _socket;
+		entry->addr = reinterpret_cast< uint64 >( &slot.header );
+		entry->len = 1;
+		entry->user_data = SEND_OPERATION_USER_DATA | slotIndex;
+
+		++_numberOfSendsInFlight;
+	}
+
+	int32 IoUringEngine::Submit( uint32 minCompletions )
+	{
+		// Publish the prepared entries to the kernel
+		const uint32 numberOfEntriesToSubmit = _submissionLocalTail - *_submissionTail;
+		__atomic_store_n( _submissionTail, _submissionLocalTail, __ATOMIC_RELEASE );
+
+		if ( numberOfEntriesToSubmit == 0 && minCompletions == 0 )
+		{
+			return 0;
+		}
+
+		const uint32 flags = ( minCompletions > 0 ) ? IORING_ENTER_GETEVENTS : 0;
+		int32 result = 0;
+		do
+		{
+			result = static_cast< int32 >( syscall( __NR_io_uring_enter, _ringHandle, numberOfEntriesToSubmit,
+			                                        minCompletions, flags, nullptr, 0 ) );
+		} while ( result == SOCKET_ERROR && errno == EINTR );
+
+		return result;
+	}
+
+	void IoUringEngine::ProcessCompletions()
+	{
+		uint32 head = *_completionHead;
+		const uint32 tail = __atomic_load_n( _completionTail, __ATOMIC_ACQUIRE );
+
+		while ( head != tail )
+		{
+			ProcessCompletion( _completionEntries[ head & _completionRingMask ] );
+			++head;
+		}
+
+		__atomic_store_n( _completionHead, head, __ATOMIC_RELEASE );
+	}
+
+	void IoUringEngine::ProcessCompletion( const io_uring_cqe& completion )
+	{
+		const uint64 operationType = completion.user_data & OPERATION_TYPE_USER_DATA_MASK;
+		const uint32 index = static_cast< uint32 >( completion.user_data );
+		if ( operationType == SEND_OPERATION_USER_DATA )
+		{
+			assert( index < _sendSlots.size() );
+			--_numberOfSendsInFlight;
+			_freeSendSlots.push_back( index );
+			if ( completion.res < 0 )
+			{
+				++_numberOfFailedSends;
+			}
+		}
+		else if ( operationType == CANCEL_OPERATION_USER_DATA )
+		{
+			// Nothing to do. The cancelled operation gets its own completion
+		}
+		else if ( operationType == PROVIDE_BUFFERS_OPERATION_USER_DATA )
+		{
+			if ( completion.res < 0 )
+			{
+				_hasProvideBuffersFailed = true;
+			}
+		}
+		else
+		{
+			assert( index < _receiveOperations.size() );
+
+			// The operation can be posted again right away, as its result is kept apart
+			ReceiveOperation& operation = _receiveOperations[ index ];
+			operation.isInFlight = false;
+			--_numberOfReceivesInFlight;
+			_receiveOperationsPendingToPost.push_back( index );
+
+			CompletedReceive completedReceive;
+			completedReceive.result = completion.res;
+			completedReceive.hasBuffer = ( completion.flags & IORING_CQE_F_BUFFER ) != 0;
+			completedReceive.bufferId =
+			    completedReceive.hasBuffer ? ( completion.flags >> IORING_CQE_BUFFER_SHIFT ) : 0;
+			completedReceive.address = operation.address;
+			_completedReceives.push_back( completedReceive );
+		}
+	}
+
+	void IoUringEngine::CancelInFlightReceives()
+	{
+		for ( uint32 i = 0; i < _receiveOperations.size(); ++i )
+		{
+			if ( !_receiveOperations[ i ].isInFlight )
+			{
+				continue;
+			}
+
+			io_uring_sqe* entry = GetSubmissionEntry();
+			if ( entry == nullptr )
+			{
+				Submit( 0 );
+				entry = GetSubmissionEntry();
+				assert( entry != nullptr );
+			}
+
+			entry->opcode = IORING_OP_ASYNC_CANCEL;
+			entry->fd = -1;
+			entry->addr = RECEIVE_OPERATION_USER_DATA | i;
+			entry->user_data = CANCEL_OPERATION_USER_DATA;
+		}
+
+		int32 submitResult = Submit( 0 );
+		ProcessCompletions();
+		while ( _numberOfReceivesInFlight > 0 && submitResult != SOCKET_ERROR )
+		{
+			submitResult = Submit( 1 );
+			ProcessCompletions();
+		}
+	}
+
+	void IoUringEngine::WaitForInFlightSends()
+	{
+		int32 submitResult = Submit( 0 );
+		ProcessCompletions();
+		while ( _numberOfSendsInFlight > 0 && submitResult != SOCKET_ERROR )
+		{
+			submitResult = Submit( 1 );
+			ProcessCompletions();
+		}
+	}
+} // namespace NetLib
+#endif
@@ -0,0 +1,156 @@
+#pragma once
+#include "numeric_types.h"
+
+#ifdef __linux__
+	#include <vector>
+	#include <deque>
+
+	#include <sys/uio.h>
+
+	#include "core/address.h"
+	#include "core/socket_platform.h"
+	#include "core/socket.h"
+	#include "core/datagram_batch.h"
+
+struct io_uring_params;
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace NetLib
+{
+	// Number of recvmsg operations kept in flight
+	constexpr uint32 IO_URING_NUMBER_OF_RECEIVE_OPERATIONS = MAX_DATAGRAM_BATCH_SIZE;
+	// Number of receive buffers provided to the kernel. They are only taken by the operations that get a datagram, so
+	// there are more of them than operations in order to keep receiving while the Peer parses the previous ones
+	constexpr uint32 IO_URING_NUMBER_OF_RECEIVE_BUFFERS = MAX_DATAGRAM_BATCH_SIZE * 2;
+	// Number of datagrams that can be waiting for their sendmsg operation to complete
+	constexpr uint32 IO_URING_NUMBER_OF_SEND_SLOTS = MAX_DATAGRAM_BATCH_SIZE * 2;
+
+	/// <summary>
+	/// io_uring based socket I/O. The receive buffers are registered with the kernel as a provided buffer group, and
+	/// the recvmsg operations kept in flight let the kernel pick one of them for each incoming datagram. Datagrams are
+	/// written directly where the Peer is going to parse them. Outgoing datagrams are submitted as independent sendmsg
+	/// operations with a single system call, and their completions are collected on later calls instead of waiting.
+	/// The io_uring interface is accessed through raw system calls so there are no extra dependencies.
+	/// </summary>
+	class IoUringEngine
+	{
+		public:
+			IoUringEngine();
+			IoUringEngine( const IoUringEngine& ) = delete;
+
+			IoUringEngine& operator=( const IoUringEngine& ) = delete;
+
+			/// <summary>
+			/// Creates the ring and registers the receive buffers. It fails if the kernel doesn't support io_uring or
+			/// provided buffers, or if io_uring has been disabled, in which case the caller should fall back to plain
+			/// socket calls.
+			/// </summary>
+			/// <param name="socket">Socket to operate on. It must be in blocking mode</param>
+			bool Start( SocketHandle socket, uint32 datagramMaxSize );
+			/// <summary>
+			/// Gives the receive buffers used in the previous call back to the kernel, then adds as many received
+			/// datagrams as fit into the batch. The datagrams are views of the engine's receive buffers so they remain
+			/// valid only until the next call.
+			/// </summary>
+			SocketResult ReceiveBatch( DatagramBatch& batch, Address& remoteAddress );
+			/// <summary>
+			/// Queues all the datagrams within the batch for sending with a single system call and returns without
+			/// waiting for them. They are copied into send slots, so the batch can be reused right away. It only waits
+			/// if every send slot is still in flight. Sends that failed are reported by a later call.
+			/// </summary>
+			SocketResult SendBatch( const DatagramBatch& batch );
+			void Close();
+
+			int32 GetRingHandle() const { return _ringHandle; }
+			bool IsValid() const { return _ringHandle != -1; }
+
+			~IoUringEngine();
+
+		private:
+			struct ReceiveOperation
+			{
+					struct msghdr header;
+					struct iovec buffer;
+					struct sockaddr_in address;
+					bool isInFlight;
+			};
+
+			struct CompletedReceive
+			{
+					int32 result;
+					// Only valid if the kernel picked a buffer for it
+					uint32 bufferId;
+					bool hasBuffer;
+					struct sockaddr_in address;
+			};
+
+			struct SendSlot
+			{
+					uint8* data;
+					struct msghdr header;
+					struct iovec buffer;
+					Address address;
+			};
+
+			bool MapRings( const io_uring_params& params );
+			void UnmapRings();
+			io_uring_sqe* GetSubmissionEntry();
+			/// <summary>
+			/// Gives receive buffers back to the kernel, starting at the given buffer id
+			/// </summary>
+			void PrepareProvideBuffers( uint32 firstBufferId, uint32 numberOfBuffers );
+			bool ProvideInitialReceiveBuffers();
+			void PrepareReceive( uint32 operationIndex );
+			void PrepareSend( uint32 slotIndex, const uint8* data, uint32 size, const Address& address );
+			/// <summary>
+			/// Submits all the prepared submission entries and optionally waits for completions
+			/// </summary>
+			int32 Submit( uint32 minCompletions );
+			void ProcessCompletions();
+			void ProcessCompletion( const io_uring_cqe& completion );
+			void CancelInFlightReceives();
+			void WaitForInFlightSends();
+
+			SocketHandle _socket;
+			int32 _ringHandle;
+			uint32 _datagramMaxSize;
+
+			// Shared submission queue ring
+			void* _submissionRingMemory;
+			uint64 _submissionRingMemorySize;
+			uint32* _submissionHead;
+			uint32* _submissionTail;
+			uint32 _submissionLocalTail;
+			uint32 _submissionRingMask;
+			uint32* _submissionArray;
+			io_uring_sqe* _submissionEntries;
+			uint64 _submissionEntriesMemorySize;
+			uint32 _submissionEntriesCount;
+
+			// Shared completion queue ring
+			void* _completionRingMemory;
+			uint64 _completionRingMemorySize;
+			uint32* _completionHead;
+			uint32* _completionTail;
+			uint32 _completionRingMask;
+			io_uring_cqe* _completionEntries;
+
+			// Receive related
+			uint8* _receiveBuffers;
+			std::vector< ReceiveOperation > _receiveOperations;
+			std::deque< CompletedReceive > _completedReceives;
+			std::vector< uint32 > _receiveOperationsPendingToPost;
+			std::vector< uint32 > _receiveBuffersPendingToProvide;
+			uint32 _numberOfReceivesInFlight;
+			bool _hasProvideBuffersFailed;
+
+			// Send related
+			uint8* _sendBuffers;
+			std::vector< SendSlot > _sendSlots;
+			std::vector< uint32 > _freeSendSlots;
+			uint32 _numberOfSendsInFlight;
+			uint32 _numberOfFailedSends;
+	};
+} // namespace NetLib
+#endif
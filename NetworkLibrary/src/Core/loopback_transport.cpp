@@ -0,0 +1,365 @@
+#include "loopback_transport.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstring>
+#include <vector>
+
+#include "logger.h"
+
+#include "core/datagram_batch.h"
+#include "core/socket_shard.h"
+
+namespace NetLib
+{
+	// Ports handed out when binding to port zero. Same range as the IANA ephemeral ports
+	static constexpr uint32 FIRST_EPHEMERAL_PORT = 49152;
+	static constexpr uint32 LAST_EPHEMERAL_PORT = 65535;
+
+	static uint32 RoundUpToPowerOfTwo( uint32 value )
+	{
+		uint32 result = 1;
+		while ( result < value )
+		{
+			result <<= 1;
+		}
+
+		return result;
+	}
+
+	/// <summary>
+	/// Bounded multi-producer multi-consumer lock-free queue of datagrams (Dmitry Vyukov's algorithm). Every slot has
+	/// a sequence number that tells whether it is ready to be written or read for a given position, so producers and
+	/// consumers only need a compare and swap on their own position.
+	/// </summary>
+	class LoopbackDatagramQueue
+	{
+		public:
+			LoopbackDatagramQueue( uint32 capacity )
+			    : _slots( new Slot[ RoundUpToPowerOfTwo( capacity ) ] )
+			    , _mask( RoundUpToPowerOfTwo( capacity ) - 1 )
+			    , _enqueuePosition( 0 )
+			    , _dequeuePosition( 0 )
+			{
+				for ( uint32 i = 0; i <= _mask; ++i )
+				{
+					_slots[ i ].sequence.store( i, std::memory_order_relaxed );
+				}
+			}
+
+			bool TryPush( const uint8* data, uint32 size, const Address& address )
+			{
+				uint32 position = _enqueuePosition.load( std::memory_order_relaxed );
+				Slot* slot = nullptr;
+				while ( true )
+				{
+					slot = &_slots[ position & _mask ];
+					const uint32 sequence = slot->sequence.load( std::memory_order_acquire );
+					const int32 difference = static_cast< int32 >( sequence - position );
+					if ( difference == 0 )
+					{
+						if ( _enqueuePosition.compare_exchange_weak( position, position + 1,
+						                                             std::memory_order_relaxed ) )
+						{
+							break;
+						}
+					}
+					else if ( difference < 0 )
+					{
+						// The queue is full
+						return false;
+					}
+					else
+					{
+						position = _enqueuePosition.load( std::memory_order_relaxed );
+					}
+				}
+
+				// Resizing keeps the capacity, so slots stop allocating once they have seen the biggest datagram
+				slot->data.resize( size );
+				std::memcpy( slot->data.data(), data, size );
+				slot->address = address;
+				slot->sequence.store( position + 1, std::memory_order_release );
+				return true;
+			}
+
+			bool TryPop( DatagramBatch& batch )
+			{
+				uint32 position = _dequeuePosition.load( std::memory_order_relaxed );
+				Slot* slot = nullptr;
+				while ( true )
+				{
+					slot = &_slots[ position & _mask ];
+					const uint32 sequence = slot->sequence.load( std::memory_order_acquire );
+					const int32 difference = static_cast< int32 >( sequence - ( position + 1 ) );
+					if ( difference == 0 )
+					{
+						if ( _dequeuePosition.compare_exchange_weak( position, position + 1,
+						                                             std::memory_order_relaxed ) )
+						{
+							break;
+						}
+					}
+					else if ( difference < 0 )
+					{
+						// The queue is empty
+						return false;
+					}
+					else
+					{
+						position = _dequeuePosition.load( std::memory_order_relaxed );
+					}
+				}
+
+				const uint32 size = static_cast< uint32 >( slot->data.size() );
+				std::memcpy( batch.GetNextFreeDatagramData(), slot->data.data(), size );
+				batch.CommitDatagram( size, slot->address );
+				slot->sequence.store( position + _mask + 1, std::memory_order_release );
+				return true;
+			}
+
+			bool IsEmpty() const
+			{
+				const uint32 position = _dequeuePosition.load( std::memory_order_relaxed );
+				const uint32 sequence = _slots[ position & _mask ].sequence.load( std::memory_order_acquire );
+				return sequence != position + 1;
+			}
+
+		private:
+			struct Slot
+			{
+					Slot()
+					    : sequence( 0 )
+					    , data()
+					    , address( Address::GetInvalid() )
+					{
+					}
+
+					std::atomic< uint32 > sequence;
+					std::vector< uint8 > data;
+					Address address;
+			};
+
+			std::unique_ptr< Slot[] > _slots;
+			const uint32 _mask;
+			// Keep producers and consumers positions in different cache lines
+			alignas( 64 ) std::atomic< uint32 > _enqueuePosition;
+			alignas( 64 ) std::atomic< uint32 > _dequeuePosition;
+	};
+
+	class LoopbackEndpoint
+	{
+		public:
+			LoopbackEndpoint( uint32 queueCapacity, uint32 datagramMaxSize )
+			    : queue( queueCapacity )
+			    , dataSignal()
+			    , datagramMaxSize( datagramMaxSize )
+			{
+			}
+
+			LoopbackDatagramQueue queue;
+			SocketShardsDataSignal dataSignal;
+			const uint32 datagramMaxSize;
+	};
+
+	LoopbackNetwork::LoopbackNetwork( uint32 queueCapacity )
+	    : _queueCapacity( RoundUpToPowerOfTwo( ( queueCapacity > 0 ) ? queueCapacity : 1 ) )
+	    , _nextEphemeralPort( FIRST_EPHEMERAL_PORT )
+	    , _mutex()
+	    , _endpoints()
+	{
+	}
+
+	LoopbackNetwork::~LoopbackNetwork()
+	{
+		assert( _endpoints.empty() );
+	}
+
+	bool LoopbackNetwork::Bind( const std::shared_ptr< LoopbackEndpoint >& endpoint, const Address& address,
+	                            Address& boundAddress )
+	{
+		std::lock_guard< std::mutex > lock( _mutex );
+
+		uint32 port = address.GetPort();
+		if ( port == 0 )
+		{
+			// Look for a free ephemeral port, starting right after the last one handed out
+			const uint32 numberOfEphemeralPorts = LAST_EPHEMERAL_PORT - FIRST_EPHEMERAL_PORT + 1;
+			for ( uint32 i = 0; i < numberOfEphemeralPorts && port == 0; ++i )
+			{
+				const uint32 candidate = _nextEphemeralPort;
+				_nextEphemeralPort =
+				    ( _nextEphemeralPort == LAST_EPHEMERAL_PORT ) ? FIRST_EPHEMERAL_PORT : _nextEphemeralPort + 1;
+				if ( _endpoints.find( candidate ) == _endpoints.end() )
+				{
+					port = candidate;
+				}
+			}
+
+			if ( port == 0 )
+			{
+				LOG_ERROR( "There are no free ports left in the loopback network" );
+				return false;
+			}
+		}
+		else if ( _endpoints.find( port ) != _endpoints.end() )
+		{
+			LOG_ERROR( "The port %u is already in use in the loopback network", port );
+			return false;
+		}
+
+		_endpoints[ port ] = endpoint;
+
+		// Everything within a loopback network is local, so an address bound to any interface is reachable at the
+		// loopback one. This way, replies come from the same address the remote peer sent its datagrams to
+		boundAddress = Address( IPV4_LOOPBACK, port );
+		return true;
+	}
+
+	void LoopbackNetwork::Unbind( const LoopbackEndpoint& endpoint, const Address& boundAddress )
+	{
+		std::lock_guard< std::mutex > lock( _mutex );
+
+		auto it = _endpoints.find( boundAddress.GetPort() );
+		if ( it != _endpoints.end() && it->second.get() == &endpoint )
+		{
+			_endpoints.erase( it );
+		}
+	}
+
+	uint32 LoopbackNetwork::Send( const DatagramBatch& batch, const Address& sourceAddress )
+	{
+		uint32 numberOfDroppedDatagrams = 0;
+
+		// Batches usually go to a single destination, so it is only looked up again when the port changes
+		std::shared_ptr< LoopbackEndpoint > destination;
+		uint32 destinationPort = 0;
+
+		const uint32 numberOfDatagrams = batch.GetNumberOfDatagrams();
+		for ( uint32 i = 0; i < numberOfDatagrams; ++i )
+		{
+			const uint32 port = batch.GetDatagramAddress( i ).GetPort();
+			if ( i == 0 || port != destinationPort )
+			{
+				destinationPort = port;
+
+				// The reference keeps the destination alive even if it gets unbound before the datagram is delivered
+				std::lock_guard< std::mutex > lock( _mutex );
+				auto it = _endpoints.find( port );
+				destination = ( it != _endpoints.end() ) ? it->second : nullptr;
+			}
+
+			if ( destination == nullptr )
+			{
+				++numberOfDroppedDatagrams;
+				continue;
+			}
+
+			const uint32 size = batch.GetDatagramSize( i );
+			if ( size > destination->datagramMaxSize ||
+			     !destination->queue.TryPush( batch.GetDatagramData( i ), size, sourceAddress ) )
+			{
+				++numberOfDroppedDatagrams;
+				continue;
+			}
+
+			destination->dataSignal.Notify();
+		}
+
+		return numberOfDroppedDatagrams;
+	}
+
+	LoopbackTransport::LoopbackTransport( LoopbackNetwork& network )
+	    : Transport()
+	    , _network( network )
+	    , _endpoint( nullptr )
+	    , _boundAddress( Address::GetInvalid() )
+	    , _isBound( false )
+	{
+	}
+
+	bool LoopbackTransport::Start( uint32 datagramMaxSize )
+	{
+		_endpoint = std::make_shared< LoopbackEndpoint >( _network.GetQueueCapacity(), datagramMaxSize );
+		return true;
+	}
+
+	bool LoopbackTransport::Bind( const Address& address )
+	{
+		assert( _endpoint != nullptr );
+
+		if ( _isBound )
+		{
+			LOG_ERROR( "The loopback transport is already bound" );
+			return false;
+		}
+
+		_isBound = _network.Bind( _endpoint, address, _boundAddress );
+		return _isBound;
+	}
+
+	SocketResult LoopbackTransport::ReceiveFromBatch( DatagramBatch& batch, Address& /*remoteAddress*/ )
+	{
+		if ( _endpoint == nullptr )
+		{
+			return SocketResult::SOKT_ERR;
+		}
+
+		// Consume before reading so data delivered meanwhile is not lost for the next wait
+		_endpoint->dataSignal.Consume();
+
+		while ( !batch.IsFull() && _endpoint->queue.TryPop( batch ) )
+		{
+		}
+
+		return batch.IsEmpty() ? SocketResult::SOKT_WOULDBLOCK : SocketResult::SOKT_SUCCESS;
+	}
+
+	SocketResult LoopbackTransport::SendToBatch( const DatagramBatch& batch )
+	{
+		if ( !_isBound )
+		{
+			LOG_ERROR( "Trying to send through a loopback transport that is not bound" );
+			return SocketResult::SOKT_ERR;
+		}
+
+		const uint32 numberOfDroppedDatagrams = _network.Send( batch, _boundAddress );
+		if ( numberOfDroppedDatagrams > 0 )
+		{
+			LOG_WARNING( "%u loopback datagrams have been dropped", numberOfDroppedDatagrams );
+		}
+
+		return SocketResult::SOKT_SUCCESS;
+	}
+
+	bool LoopbackTransport::WaitForIncomingData( float32 timeoutSeconds ) const
+	{
+		if ( _endpoint == nullptr )
+		{
+			return false;
+		}
+
+		if ( !_endpoint->queue.IsEmpty() )
+		{
+			return true;
+		}
+
+		return _endpoint->dataSignal.WaitFor( timeoutSeconds );
+	}
+
+	void LoopbackTransport::Close()
+	{
+		if ( _isBound )
+		{
+			_network.Unbind( *_endpoint, _boundAddress );
+			_isBound = false;
+		}
+
+		_endpoint.reset();
+	}
+
+	LoopbackTransport::~LoopbackTransport()
+	{
+		Close();
+	}
+} // namespace NetLib
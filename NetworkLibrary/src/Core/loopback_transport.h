@@ -0,0 +1,89 @@
+#pragma once
+#include "numeric_types.h"
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "core/address.h"
+#include "core/transport.h"
+
+namespace NetLib
+{
+	class LoopbackEndpoint;
+
+	// Default number of datagrams that can be waiting to be received by a loopback transport
+	constexpr uint32 DEFAULT_LOOPBACK_QUEUE_CAPACITY = 256;
+
+	/// <summary>
+	/// In-process network shared by several loopback transports. Every transport bound to it gets an address at
+	/// 127.0.0.1 and datagrams are delivered by copying them into the destination's lock-free queue, with no sockets
+	/// or kernel calls involved. Each network is isolated, so several of them can reuse the same ports at the same
+	/// time. It must outlive all the transports using it.
+	/// </summary>
+	class LoopbackNetwork
+	{
+		public:
+			/// <param name="queueCapacity">Maximum number of datagrams waiting to be received per transport. It gets
+			/// rounded up to a power of two. Datagrams sent to a full queue are dropped, as UDP would do</param>
+			LoopbackNetwork( uint32 queueCapacity = DEFAULT_LOOPBACK_QUEUE_CAPACITY );
+			LoopbackNetwork( const LoopbackNetwork& ) = delete;
+
+			LoopbackNetwork& operator=( const LoopbackNetwork& ) = delete;
+
+			uint32 GetQueueCapacity() const { return _queueCapacity; }
+
+			~LoopbackNetwork();
+
+		private:
+			/// <summary>
+			/// Binds the endpoint to the address port. Port zero picks any free port.
+			/// </summary>
+			/// <param name="boundAddress">The address actually bound</param>
+			bool Bind( const std::shared_ptr< LoopbackEndpoint >& endpoint, const Address& address,
+			           Address& boundAddress );
+			void Unbind( const LoopbackEndpoint& endpoint, const Address& boundAddress );
+			/// <summary>
+			/// Delivers every datagram in the batch to the endpoint bound to its destination port
+			/// </summary>
+			/// <returns>The number of datagrams dropped because their destination doesn't exist or is full</returns>
+			uint32 Send( const DatagramBatch& batch, const Address& sourceAddress );
+
+			const uint32 _queueCapacity;
+			uint32 _nextEphemeralPort;
+
+			// Only guards the endpoints map. Senders take a reference to the destination under it and deliver the
+			// datagram after releasing it, so an endpoint unbound meanwhile stays alive until they are done
+			std::mutex _mutex;
+			std::unordered_map< uint32, std::shared_ptr< LoopbackEndpoint > > _endpoints;
+
+			friend class LoopbackTransport;
+	};
+
+	/// <summary>
+	/// Transport that moves datagrams between peers in the same process through a LoopbackNetwork. Useful for tests,
+	/// benchmarks and bots that need lots of peers without any socket.
+	/// </summary>
+	class LoopbackTransport : public Transport
+	{
+		public:
+			LoopbackTransport( LoopbackNetwork& network );
+
+			bool Start( uint32 datagramMaxSize ) override;
+			bool Bind( const Address& address ) override;
+			SocketResult ReceiveFromBatch( DatagramBatch& batch, Address& remoteAddress ) override;
+			SocketResult SendToBatch( const DatagramBatch& batch ) override;
+			bool WaitForIncomingData( float32 timeoutSeconds ) const override;
+			void Close() override;
+
+			const Address& GetBoundAddress() const { return _boundAddress; }
+
+			~LoopbackTransport() override;
+
+		private:
+			LoopbackNetwork& _network;
+			std::shared_ptr< LoopbackEndpoint > _endpoint;
+			Address _boundAddress;
+			bool _isBound;
+	};
+} // namespace NetLib
@@ -0,0 +1,200 @@
+#include "network_condition_emulator.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include "logger.h"
+
+#include "core/datagram_batch.h"
+
+namespace NetLib
+{
+	NetworkConditionEmulator::NetworkConditionEmulator( const NetworkConditions& conditions, uint32 seed )
+	    : _conditions( conditions )
+	    , _randomGenerator( seed )
+	    , _isInBadState( false )
+	    , _linkBusyUntilTime( 0.0 )
+	    , _nextOrder( 0 )
+	    , _pendingDatagrams()
+	    , _freeDataBuffers()
+	    , _stats()
+	{
+	}
+
+	void NetworkConditionEmulator::Submit( const uint8* data, uint32 size, const Address& address,
+	                                       float64 currentTime )
+	{
+		++_stats.numberOfSubmittedDatagrams;
+
+		if ( _conditions.maxDatagramSize > 0 && size > _conditions.maxDatagramSize )
+		{
+			++_stats.numberOfDatagramsDroppedBySize;
+			return;
+		}
+
+		if ( IsLost() )
+		{
+			++_stats.numberOfLostDatagrams;
+			return;
+		}
+
+		// A capped link transmits the datagrams one after another, so they wait for the previous ones to get through
+		float64 departureTime = currentTime;
+		if ( _conditions.bandwidthBytesPerSecond > 0 )
+		{
+			const float64 transmissionStartTime = std::max( currentTime, _linkBusyUntilTime );
+			if ( transmissionStartTime - currentTime > _conditions.maxQueueDelaySeconds )
+			{
+				++_stats.numberOfDatagramsDroppedByBandwidth;
+				return;
+			}
+
+			_linkBusyUntilTime =
+			    transmissionStartTime + static_cast< float64 >( size ) / _conditions.bandwidthBytesPerSecond;
+			departureTime = _linkBusyUntilTime;
+		}
+
+		float64 delay = _conditions.latencySeconds;
+		if ( _conditions.jitterSeconds > 0.f )
+		{
+			delay += _conditions.jitterSeconds * ( 2.f * GetRandomNumber() - 1.f );
+		}
+
+		if ( _conditions.reorderProbability > 0.f && GetRandomNumber() < _conditions.reorderProbability )
+		{
+			delay += _conditions.reorderDelaySeconds;
+			++_stats.numberOfReorderedDatagrams;
+		}
+
+		Schedule( data, size, address, departureTime + std::max( delay, 0.0 ) );
+
+		if ( _conditions.duplicationProbability > 0.f && GetRandomNumber() < _conditions.duplicationProbability )
+		{
+			// The copy travels on its own, so it gets its own jitter
+			float64 duplicateDelay = _conditions.latencySeconds;
+			if ( _conditions.jitterSeconds > 0.f )
+			{
+				duplicateDelay += _conditions.jitterSeconds * ( 2.f * GetRandomNumber() - 1.f );
+			}
+
+			Schedule( data, size, address, departureTime + std::max( duplicateDelay, 0.0 ) );
+			++_stats.numberOfDuplicatedDatagrams;
+		}
+	}
+
+	bool NetworkConditionEmulator::PopDueDatagram( DatagramBatch& batch, float64 currentTime )
+	{
+		while ( !_pendingDatagrams.empty() && !batch.IsFull() )
+		{
+			if ( _pendingDatagrams.front().deliveryTime > currentTime )
+			{
+				return false;
+			}
+
+			std::pop_heap( _pendingDatagrams.begin(), _pendingDatagrams.end(), IsDeliveredLater );
+
+			PendingDatagram& pendingDatagram = _pendingDatagrams.back();
+			const uint32 size = static_cast< uint32 >( pendingDatagram.data.size() );
+			const bool fits = ( size <= batch.GetDatagramMaxSize() );
+			if ( fits )
+			{
+				std::memcpy( batch.GetNextFreeDatagramData(), pendingDatagram.data.data(), size );
+				batch.CommitDatagram( size, pendingDatagram.address );
+				++_stats.numberOfDeliveredDatagrams;
+			}
+			else
+			{
+				LOG_WARNING( "Dropping an emulated datagram of %u bytes since it doesn't fit in the batch. Max: %u",
+				             size, batch.GetDatagramMaxSize() );
+			}
+
+			_freeDataBuffers.push_back( std::move( pendingDatagram.data ) );
+			_pendingDatagrams.pop_back();
+
+			if ( fits )
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	float64 NetworkConditionEmulator::GetNextDeliveryTime() const
+	{
+		assert( !_pendingDatagrams.empty() );
+		return _pendingDatagrams.front().deliveryTime;
+	}
+
+	void NetworkConditionEmulator::Clear()
+	{
+		for ( PendingDatagram& pendingDatagram : _pendingDatagrams )
+		{
+			_freeDataBuffers.push_back( std::move( pendingDatagram.data ) );
+		}
+
+		_pendingDatagrams.clear();
+		_linkBusyUntilTime = 0.0;
+	}
+
+	bool NetworkConditionEmulator::IsDeliveredLater( const PendingDatagram& first, const PendingDatagram& second )
+	{
+		if ( first.deliveryTime != second.deliveryTime )
+		{
+			return first.deliveryTime > second.deliveryTime;
+		}
+
+		return first.order > second.order;
+	}
+
+	float32 NetworkConditionEmulator::GetRandomNumber()
+	{
+		// 24 bits is the float32 mantissa precision. Using more of them could round the result up to 1
+		return static_cast< float32 >( _randomGenerator() >> 8 ) / 16777216.f;
+	}
+
+	bool NetworkConditionEmulator::IsLost()
+	{
+		switch ( _conditions.lossModel )
+		{
+			case NetworkLossModel::UNIFORM:
+				return _conditions.lossProbability > 0.f && GetRandomNumber() < _conditions.lossProbability;
+			case NetworkLossModel::GILBERT_ELLIOTT:
+			{
+				const float32 transitionProbability =
+				    _isInBadState ? _conditions.badToGoodProbability : _conditions.goodToBadProbability;
+				if ( GetRandomNumber() < transitionProbability )
+				{
+					_isInBadState = !_isInBadState;
+				}
+
+				const float32 lossProbability =
+				    _isInBadState ? _conditions.badStateLossProbability : _conditions.goodStateLossProbability;
+				return GetRandomNumber() < lossProbability;
+			}
+			case NetworkLossModel::NONE:
+			default:
+				return false;
+		}
+	}
+
+	void NetworkConditionEmulator::Schedule( const uint8* data, uint32 size, const Address& address,
+	                                         float64 deliveryTime )
+	{
+		PendingDatagram pendingDatagram;
+		if ( !_freeDataBuffers.empty() )
+		{
+			pendingDatagram.data = std::move( _freeDataBuffers.back() );
+			_freeDataBuffers.pop_back();
+		}
+
+		pendingDatagram.data.assign( data, data + size );
+		pendingDatagram.address = address;
+		pendingDatagram.deliveryTime = deliveryTime;
+		pendingDatagram.order = _nextOrder++;
+
+		_pendingDatagrams.push_back( std::move( pendingDatagram ) );
+		std::push_heap( _pendingDatagrams.begin(), _pendingDatagrams.end(), IsDeliveredLater );
+	}
+} // namespace NetLib
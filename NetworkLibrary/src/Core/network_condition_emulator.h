@@ -0,0 +1,178 @@
+#pragma once
+#include "numeric_types.h"
+
+#include <random>
+#include <vector>
+
+#include "core/address.h"
+
+namespace NetLib
+{
+	class DatagramBatch;
+
+	enum class NetworkLossModel : uint8
+	{
+		// No datagram gets lost
+		NONE = 0,
+		// Every datagram has the same probability of getting lost
+		UNIFORM = 1,
+		// Two state Markov chain (Good and Bad) with a different loss probability per state. It models loss bursts
+		GILBERT_ELLIOTT = 2
+	};
+
+	/// <summary>
+	/// Conditions applied to the datagrams travelling in one direction. Probabilities are within [0, 1].
+	/// </summary>
+	struct NetworkConditions
+	{
+		NetworkConditions()
+		    : latencySeconds( 0.f )
+		    , jitterSeconds( 0.f )
+		    , lossModel( NetworkLossModel::NONE )
+		    , lossProbability( 0.f )
+		    , goodToBadProbability( 0.f )
+		    , badToGoodProbability( 1.f )
+		    , goodStateLossProbability( 0.f )
+		    , badStateLossProbability( 1.f )
+		    , duplicationProbability( 0.f )
+		    , reorderProbability( 0.f )
+		    , reorderDelaySeconds( 0.f )
+		    , bandwidthBytesPerSecond( 0 )
+		    , maxQueueDelaySeconds( 1.f )
+		    , maxDatagramSize( 0 )
+		{
+		}
+
+		// Base one way delay
+		float32 latencySeconds;
+		// Random delay within [-jitterSeconds, jitterSeconds] added to the latency
+		float32 jitterSeconds;
+
+		NetworkLossModel lossModel;
+		// Only used by the UNIFORM loss model
+		float32 lossProbability;
+		// Only used by the GILBERT_ELLIOTT loss model. The state transition is evaluated before every datagram
+		float32 goodToBadProbability;
+		float32 badToGoodProbability;
+		float32 goodStateLossProbability;
+		float32 badStateLossProbability;
+
+		// Probability of delivering a datagram twice
+		float32 duplicationProbability;
+		// Probability of holding a datagram back reorderDelaySeconds, so the ones sent after it overtake it
+		float32 reorderProbability;
+		float32 reorderDelaySeconds;
+
+		// Link capacity. Zero means unlimited
+		uint32 bandwidthBytesPerSecond;
+		// When the link is capped, datagrams that would wait longer than this to get through it are dropped
+		float32 maxQueueDelaySeconds;
+
+		// Datagrams bigger than this are dropped, as a path with a small MTU does with the ones that can't be
+		// fragmented. Zero means unlimited
+		uint32 maxDatagramSize;
+	};
+
+	struct NetworkConditionStats
+	{
+		NetworkConditionStats()
+		    : numberOfSubmittedDatagrams( 0 )
+		    , numberOfDeliveredDatagrams( 0 )
+		    , numberOfLostDatagrams( 0 )
+		    , numberOfDuplicatedDatagrams( 0 )
+		    , numberOfReorderedDatagrams( 0 )
+		    , numberOfDatagramsDroppedByBandwidth( 0 )
+		    , numberOfDatagramsDroppedBySize( 0 )
+		{
+		}
+
+		uint64 numberOfSubmittedDatagrams;
+		uint64 numberOfDeliveredDatagrams;
+		uint64 numberOfLostDatagrams;
+		uint64 numberOfDuplicatedDatagrams;
+		uint64 numberOfReorderedDatagrams;
+		uint64 numberOfDatagramsDroppedByBandwidth;
+		uint64 numberOfDatagramsDroppedBySize;
+	};
+
+	/// <summary>
+	/// Applies network conditions to the datagrams travelling in one direction. Every random decision comes from a
+	/// seeded generator and the current time is always passed in, so the same seed and inputs always give the same
+	/// output.
+	/// </summary>
+	class NetworkConditionEmulator
+	{
+		public:
+			NetworkConditionEmulator( const NetworkConditions& conditions, uint32 seed );
+			NetworkConditionEmulator( const NetworkConditionEmulator& ) = delete;
+
+			NetworkConditionEmulator& operator=( const NetworkConditionEmulator& ) = delete;
+
+			/// <summary>
+			/// Applies the conditions to the datagram. It can be dropped, or scheduled for delivery once or twice.
+			/// </summary>
+			void Submit( const uint8* data, uint32 size, const Address& address, float64 currentTime );
+			/// <summary>
+			/// Adds to the batch the next datagram whose delivery time has come, if any
+			/// </summary>
+			/// <returns>True if a datagram has been added, False otherwise</returns>
+			bool PopDueDatagram( DatagramBatch& batch, float64 currentTime );
+
+			bool ArePendingDatagrams() const { return !_pendingDatagrams.empty(); }
+			/// <summary>
+			/// Delivery time of the next pending datagram. Only valid if there are pending datagrams.
+			/// </summary>
+			float64 GetNextDeliveryTime() const;
+			const NetworkConditions& GetConditions() const { return _conditions; }
+			const NetworkConditionStats& GetStats() const { return _stats; }
+
+			/// <summary>
+			/// Drops all the pending datagrams
+			/// </summary>
+			void Clear();
+
+		private:
+			struct PendingDatagram
+			{
+					PendingDatagram()
+					    : deliveryTime( 0.0 )
+					    , order( 0 )
+					    , data()
+					    , address( Address::GetInvalid() )
+					{
+					}
+
+					float64 deliveryTime;
+					// Keeps datagrams with the same delivery time in submission order
+					uint64 order;
+					std::vector< uint8 > data;
+					Address address;
+			};
+
+			/// <summary>
+			/// Heap comparator. It puts the datagram with the earliest delivery time on top of the heap
+			/// </summary>
+			static bool IsDeliveredLater( const PendingDatagram& first, const PendingDatagram& second );
+			/// <summary>
+			/// Returns a random number within [0, 1). It doesn't rely on the standard distributions since their output
+			/// differs between standard library implementations.
+			/// </summary>
+			float32 GetRandomNumber();
+			bool IsLost();
+			void Schedule( const uint8* data, uint32 size, const Address& address, float64 deliveryTime );
+
+			NetworkConditions _conditions;
+			std::mt19937 _randomGenerator;
+			bool _isInBadState;
+			// Time when the capped link finishes transmitting the datagrams already submitted
+			float64 _linkBusyUntilTime;
+			uint64 _nextOrder;
+
+			// Min-heap sorted by delivery time
+			std::vector< PendingDatagram > _pendingDatagrams;
+			// Data vectors of delivered datagrams, kept for reuse
+			std::vector< std::vector< uint8 > > _freeDataBuffers;
+
+			NetworkConditionStats _stats;
+	};
+} // namespace NetLib
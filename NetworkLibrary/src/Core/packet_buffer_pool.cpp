@@ -0,0 +1,125 @@
+#include "packet_buffer_pool.h"
+
+#include <cassert>
+#include <cstring>
+
+#include "logger.h"
+
+#include "core/socket.h"
+
+namespace NetLib
+{
+	PacketBuffer::PacketBuffer()
+	    : _data()
+	    , _size( 0 )
+	    , _referenceCount( 0 )
+	{
+		_data.reserve( MTU_SIZE_BYTES );
+	}
+
+	void PacketBuffer::AddReference()
+	{
+		assert( _referenceCount > 0 );
+		++_referenceCount;
+	}
+
+	void PacketBuffer::RemoveReference()
+	{
+		assert( _referenceCount > 0 );
+		--_referenceCount;
+
+		if ( _referenceCount == 0 )
+		{
+			PacketBufferPool::GetInstance().ReleasePacketBuffer( this );
+		}
+	}
+
+	void PacketBuffer::Assign( const uint8* data, uint32 size )
+	{
+		// Resizing keeps the capacity, so buffers stop allocating once they have seen the biggest datagram
+		_data.resize( size );
+		std::memcpy( _data.data(), data, size );
+		_size = size;
+		_referenceCount = 1;
+	}
+
+	PacketBufferPool* PacketBufferPool::_instance = nullptr;
+
+	void PacketBufferPool::CreateInstance( uint32 size )
+	{
+		if ( _instance != nullptr )
+		{
+			return;
+		}
+
+		_instance = new PacketBufferPool( size );
+	}
+
+	PacketBufferPool& PacketBufferPool::GetInstance()
+	{
+		return *_instance;
+	}
+
+	void PacketBufferPool::DeleteInstance()
+	{
+		if ( _instance != nullptr )
+		{
+			delete _instance;
+			_instance = nullptr;
+		}
+	}
+
+	PacketBufferPool::PacketBufferPool( uint32 size )
+	    : _mutex()
+	    , _packetBuffers()
+	    , _availablePacketBuffers()
+	{
+		_packetBuffers.reserve( size );
+		_availablePacketBuffers.reserve( size );
+		for ( uint32 i = 0; i < size; ++i )
+		{
+			_packetBuffers.emplace_back( new PacketBuffer() );
+			_availablePacketBuffers.push_back( _packetBuffers.back().get() );
+		}
+	}
+
+	PacketBuffer* PacketBufferPool::LendPacketBuffer( const uint8* data, uint32 size )
+	{
+		PacketBuffer* packetBuffer = nullptr;
+		{
+			std::lock_guard< std::mutex > lock( _mutex );
+			if ( !_availablePacketBuffers.empty() )
+			{
+				packetBuffer = _availablePacketBuffers.back();
+				_availablePacketBuffers.pop_back();
+			}
+			else
+			{
+				LOG_WARNING( "The packet buffer pool is empty. Creating a new packet buffer... Current size: %u",
+				             static_cast< uint32 >( _packetBuffers.size() ) );
+
+				_packetBuffers.emplace_back( new PacketBuffer() );
+				packetBuffer = _packetBuffers.back().get();
+			}
+		}
+
+		// The buffer belongs to the caller from now on, so it can be filled without holding the lock
+		packetBuffer->Assign( data, size );
+		return packetBuffer;
+	}
+
+	void PacketBufferPool::ReleasePacketBuffer( PacketBuffer* packetBuffer )
+	{
+		assert( packetBuffer != nullptr );
+		assert( packetBuffer->GetReferenceCount() == 0 );
+
+		std::lock_guard< std::mutex > lock( _mutex );
+		_availablePacketBuffers.push_back( packetBuffer );
+	}
+
+	uint32 PacketBufferPool::GetNumberOfAvailablePacketBuffers() const
+	{
+		std::lock_guard< std::mutex > lock( _mutex );
+		return static_cast< uint32 >( _availablePacketBuffers.size() );
+	}
+} // namespace NetLib
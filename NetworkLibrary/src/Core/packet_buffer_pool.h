@@ -0,0 +1,82 @@
+#pragma once
+#include "numeric_types.h"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace NetLib
+{
+	class PacketBufferPool;
+
+	/// <summary>
+	/// Reference counted copy of an incoming datagram. Messages read from it keep views of their payloads into this
+	/// memory instead of copying them, so the buffer goes back to the pool once the last of those messages gets
+	/// released.
+	/// </summary>
+	class PacketBuffer
+	{
+		public:
+			PacketBuffer( const PacketBuffer& ) = delete;
+			PacketBuffer& operator=( const PacketBuffer& ) = delete;
+
+			uint8* GetData() { return _data.data(); }
+			uint32 GetSize() const { return _size; }
+			uint32 GetReferenceCount() const { return _referenceCount; }
+
+			void AddReference();
+			/// <summary>
+			/// Removes one reference. When there are no references left, the buffer is returned to its pool and it must
+			/// not be accessed anymore.
+			/// </summary>
+			void RemoveReference();
+
+		private:
+			PacketBuffer();
+
+			void Assign( const uint8* data, uint32 size );
+
+			std::vector< uint8 > _data;
+			uint32 _size;
+			uint32 _referenceCount;
+
+			friend class PacketBufferPool;
+	};
+
+	class PacketBufferPool
+	{
+		public:
+			static void CreateInstance( uint32 size );
+			/// <summary>
+			/// Get unique instance. Before calling to this method, be sure to call CreateInstance(uint32 size) or you
+			/// will get an error.
+			/// </summary>
+			static PacketBufferPool& GetInstance();
+			static void DeleteInstance();
+
+			/// <summary>
+			/// Copies the datagram into a pooled buffer. The returned buffer starts with one reference that belongs to
+			/// the caller.
+			/// </summary>
+			PacketBuffer* LendPacketBuffer( const uint8* data, uint32 size );
+
+			uint32 GetNumberOfAvailablePacketBuffers() const;
+
+		private:
+			PacketBufferPool( uint32 size );
+			PacketBufferPool( const PacketBufferPool& ) = delete;
+			PacketBufferPool& operator=( const PacketBufferPool& ) = delete;
+
+			void ReleasePacketBuffer( PacketBuffer* packetBuffer );
+
+			static PacketBufferPool* _instance;
+
+			// Socket shard workers lend and release buffers concurrently
+			mutable std::mutex _mutex;
+			// Owns every buffer ever created, so a lent buffer never gets freed while there are views into it
+			std::vector< std::unique_ptr< PacketBuffer > > _packetBuffers;
+			std::vector< PacketBuffer* > _availablePacketBuffers;
+
+			friend class PacketBuffer;
+	};
+} // namespace NetLib
@@ -0,0 +1,137 @@
+#include "path_mtu_discovery.h"
+
+#include <algorithm>
+
+#include "logger.h"
+
+#include "core/socket.h"
+
+namespace NetLib
+{
+	PathMTUDiscovery::PathMTUDiscovery()
+	    : _state( PathMTUDiscoveryState::SEARCH_COMPLETE )
+	    , _maxDatagramSize( MAX_DATAGRAM_SIZE_BYTES )
+	    , _datagramMaxSize( MIN_PATH_DATAGRAM_SIZE_BYTES )
+	    , _searchLowerBound( MIN_PATH_DATAGRAM_SIZE_BYTES )
+	    , _searchUpperBound( MIN_PATH_DATAGRAM_SIZE_BYTES )
+	    , _probeId( 0 )
+	    , _probeSize( 0 )
+	    , _numberOfProbeAttempts( 0 )
+	    , _timeLeft( 0.f )
+	{
+		Reset( MAX_DATAGRAM_SIZE_BYTES );
+	}
+
+	void PathMTUDiscovery::Reset( uint32 maxDatagramSize )
+	{
+		_maxDatagramSize = maxDatagramSize;
+		_datagramMaxSize = std::min( MIN_PATH_DATAGRAM_SIZE_BYTES, maxDatagramSize );
+		StartSearch();
+	}
+
+	void PathMTUDiscovery::Update( float32 elapsedTime )
+	{
+		if ( _state == PathMTUDiscoveryState::PROBE_PENDING )
+		{
+			return;
+		}
+
+		_timeLeft -= elapsedTime;
+		if ( _timeLeft > 0.f )
+		{
+			return;
+		}
+
+		if ( _state == PathMTUDiscoveryState::SEARCH_COMPLETE )
+		{
+			StartSearch();
+		}
+		else if ( _numberOfProbeAttempts < MAX_PATH_MTU_PROBE_ATTEMPTS )
+		{
+			// Try again with the same size. The probe might have been lost for a reason other than its size
+			_state = PathMTUDiscoveryState::PROBE_PENDING;
+		}
+		else
+		{
+			OnProbeFailed();
+		}
+	}
+
+	void PathMTUDiscovery::OnProbeSent()
+	{
+		++_numberOfProbeAttempts;
+		_timeLeft = PATH_MTU_PROBE_TIMEOUT_SECONDS;
+		_state = PathMTUDiscoveryState::WAITING_FOR_PROBE_RESPONSE;
+	}
+
+	void PathMTUDiscovery::OnProbeResponse( uint16 probeId )
+	{
+		// Retries keep the probe id, so a late response to a previous attempt also counts
+		if ( _state == PathMTUDiscoveryState::SEARCH_COMPLETE || probeId != _probeId || _numberOfProbeAttempts == 0 )
+		{
+			return;
+		}
+
+		OnProbeSucceeded();
+	}
+
+	void PathMTUDiscovery::StartSearch()
+	{
+		_searchLowerBound = _datagramMaxSize;
+		_searchUpperBound = _maxDatagramSize;
+
+		// Make sure the current size still gets through before looking for a bigger one
+		if ( _datagramMaxSize > MIN_PATH_DATAGRAM_SIZE_BYTES )
+		{
+			_searchLowerBound = std::min( MIN_PATH_DATAGRAM_SIZE_BYTES, _maxDatagramSize );
+			SetNextProbe( _datagramMaxSize );
+			return;
+		}
+
+		SetNextProbe( _searchLowerBound + ( ( _searchUpperBound - _searchLowerBound + 1 ) / 2 ) );
+	}
+
+	void PathMTUDiscovery::OnProbeSucceeded()
+	{
+		_searchLowerBound = _probeSize;
+		if ( _probeSize > _datagramMaxSize )
+		{
+			LOG_INFO( "Path MTU discovery. Datagram max size raised from %u to %u bytes", _datagramMaxSize,
+			          _probeSize );
+			_datagramMaxSize = _probeSize;
+		}
+
+		SetNextProbe( _searchLowerBound + ( ( _searchUpperBound - _searchLowerBound + 1 ) / 2 ) );
+	}
+
+	void PathMTUDiscovery::OnProbeFailed()
+	{
+		_searchUpperBound = _probeSize - 1;
+		if ( _datagramMaxSize > _searchUpperBound )
+		{
+			// The path has shrunk. Fall back to the size known to work while looking for the new one
+			LOG_INFO( "Path MTU discovery. Datagram max size lowered from %u to %u bytes", _datagramMaxSize,
+			          _searchLowerBound );
+			_datagramMaxSize = _searchLowerBound;
+		}
+
+		SetNextProbe( _searchLowerBound + ( ( _searchUpperBound - _searchLowerBound + 1 ) / 2 ) );
+	}
+
+	void PathMTUDiscovery::SetNextProbe( uint32 probeSize )
+	{
+		_numberOfProbeAttempts = 0;
+
+		const bool isValidatingCurrentSize = ( probeSize == _datagramMaxSize && probeSize > _searchLowerBound );
+		if ( !isValidatingCurrentSize && _searchUpperBound < _searchLowerBound + PATH_MTU_SEARCH_PRECISION_BYTES )
+		{
+			_state = PathMTUDiscoveryState::SEARCH_COMPLETE;
+			_timeLeft = PATH_MTU_REPROBE_INTERVAL_SECONDS;
+			return;
+		}
+
+		++_probeId;
+		_probeSize = probeSize;
+		_state = PathMTUDiscoveryState::PROBE_PENDING;
+	}
+} // namespace NetLib
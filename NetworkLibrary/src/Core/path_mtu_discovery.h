@@ -0,0 +1,93 @@
+#pragma once
+#include "numeric_types.h"
+
+namespace NetLib
+{
+	// Datagram size that every path is expected to carry. It leaves room for the IPv6 and UDP headers, and for some
+	// tunnel overhead, within the IPv6 minimum MTU of 1280 bytes. Discovery starts from here
+	constexpr uint32 MIN_PATH_DATAGRAM_SIZE_BYTES = 1200;
+	// The search ends once the biggest datagram size is known within this margin
+	constexpr uint32 PATH_MTU_SEARCH_PRECISION_BYTES = 8;
+	// Unanswered probes of the same size before considering that size too big for the path. More than one, so a
+	// random loss doesn't get mistaken for a size limit
+	constexpr uint32 MAX_PATH_MTU_PROBE_ATTEMPTS = 2;
+	constexpr float32 PATH_MTU_PROBE_TIMEOUT_SECONDS = 0.5f;
+	// Time between searches. Routes change over time, so the path MTU can grow or shrink
+	constexpr float32 PATH_MTU_REPROBE_INTERVAL_SECONDS = 30.f;
+
+	enum class PathMTUDiscoveryState : uint8
+	{
+		// A probe needs to be sent
+		PROBE_PENDING = 0,
+		// Waiting for the answer to the last probe sent
+		WAITING_FOR_PROBE_RESPONSE = 1,
+		// The biggest datagram size is known. Waiting for the next search
+		SEARCH_COMPLETE = 2
+	};
+
+	/// <summary>
+	/// Finds out the biggest datagram that reaches a remote peer without getting fragmented by the IP layer. It sends
+	/// padded probe datagrams with the Don't Fragment bit set, and considers the sizes whose probes don't get answered
+	/// too big for the path. A binary search between a size that every path is expected to carry and the local datagram
+	/// size limit finds the result within a few probes. Searches are repeated periodically, and each one starts by
+	/// probing the current size, so a path that has shrunk gets detected too.
+	/// Anything that drops big datagrams, such as a smaller receive buffer on the remote peer, lowers the result.
+	/// </summary>
+	class PathMTUDiscovery
+	{
+		public:
+			PathMTUDiscovery();
+
+			/// <summary>
+			/// Starts a new search from scratch
+			/// </summary>
+			/// <param name="maxDatagramSize">Biggest datagram the local peer is able to send</param>
+			void Reset( uint32 maxDatagramSize );
+			void Update( float32 elapsedTime );
+
+			/// <summary>
+			/// Returns True if a probe of GetProbeSize bytes must be sent. Call OnProbeSent once sent.
+			/// </summary>
+			bool IsProbePending() const { return _state == PathMTUDiscoveryState::PROBE_PENDING; }
+			uint16 GetProbeId() const { return _probeId; }
+			/// <summary>
+			/// Size of the whole probe datagram, headers included
+			/// </summary>
+			uint32 GetProbeSize() const { return _probeSize; }
+			void OnProbeSent();
+			/// <summary>
+			/// Processes the answer to a probe. Answers to probes of sizes that have already been resolved are ignored.
+			/// </summary>
+			void OnProbeResponse( uint16 probeId );
+
+			PathMTUDiscoveryState GetState() const { return _state; }
+			/// <summary>
+			/// Biggest datagram size known to reach the remote peer
+			/// </summary>
+			uint32 GetDatagramMaxSize() const { return _datagramMaxSize; }
+
+		private:
+			void StartSearch();
+			void OnProbeSucceeded();
+			void OnProbeFailed();
+			/// <summary>
+			/// Picks the next size to probe or ends the search if the biggest datagram size is already known
+			/// </summary>
+			void SetNextProbe( uint32 probeSize );
+
+			PathMTUDiscoveryState _state;
+			uint32 _maxDatagramSize;
+			uint32 _datagramMaxSize;
+
+			// The biggest datagram size is within [_searchLowerBound, _searchUpperBound]. The lower bound is known to
+			// reach the remote peer
+			uint32 _searchLowerBound;
+			uint32 _searchUpperBound;
+
+			uint16 _probeId;
+			uint32 _probeSize;
+			uint32 _numberOfProbeAttempts;
+			// Time left until the probe times out or, once the search is complete, until the next search
+			float32 _timeLeft;
+	};
+} // namespace NetLib
@@ -1,9 +1,16 @@
 #include "remote_peer.h"
 
 #include <cassert>
+#include <cstring>
 #include <memory>
 
+#include "core/aimd_congestion_controller.h"
+#include "core/buffer.h"
+
+#include "communication/fragment_reassembler.h"
 #include "communication/message.h"
+#include "communication/message_factory.h"
+#include "communication/packet_builder.h"
 
 #include "transmission_channels/unreliable_ordered_transmission_channel.h"
 #include "transmission_channels/unreliable_unordered_transmission_channel.h"
@@ -56,12 +63,18 @@ namespace NetLib
 
 	RemotePeer::RemotePeer()
 	    : _address( Address::GetInvalid() )
-	    , _clientSalt( 0 )
-	    , _serverSalt( 0 )
+	    , _currentState( RemotePeerState::Disconnected )
 	    , _maxInactivityTime( 0 )
 	    , _inactivityTimeLeft( 0 )
+	    , _clientSalt( 0 )
+	    , _serverSalt( 0 )
 	    , _nextPacketSequenceNumber( 0 )
-	    , _currentState( RemotePeerState::Disconnected )
+	    , _socketShardIndex( 0 )
+	    , _pathMTUDiscovery()
+	    , _nextFragmentedMessageId( 0 )
+	    , _fragmentationBuffer()
+	    , _congestionController( new AIMDCongestionController() )
+	    , _sendPacer()
 	    , _transmissionChannels()
 	{
 		InitTransmissionChannels();
@@ -70,8 +83,14 @@ namespace NetLib
 	RemotePeer::RemotePeer( const Address& address, uint16 id, float32 maxInactivityTime, uint64 clientSalt,
 	                        uint64 serverSalt )
 	    : _address( Address::GetInvalid() )
-	    , _nextPacketSequenceNumber( 0 )
 	    , _currentState( RemotePeerState::Disconnected )
+	    , _nextPacketSequenceNumber( 0 )
+	    , _socketShardIndex( 0 )
+	    , _pathMTUDiscovery()
+	    , _nextFragmentedMessageId( 0 )
+	    , _fragmentationBuffer()
+	    , _congestionController( new AIMDCongestionController() )
+	    , _sendPacer()
 	{
 		InitTransmissionChannels();
 		Connect( address, id, maxInactivityTime, clientSalt, serverSalt );
@@ -125,11 +144,42 @@ namespace NetLib
 			_inactivityTimeLeft = 0.f;
 		}
 
+		// Probing makes no sense until both ends know about each other
+		if ( _currentState == RemotePeerState::Connected )
+		{
+			_pathMTUDiscovery.Update( elapsedTime );
+		}
+
 		// Update transmission channels
+		bool isThereLoss = false;
 		for ( uint32 i = 0; i < GetNumberOfTransmissionChannels(); ++i )
 		{
 			_transmissionChannels[ i ]->Update( elapsedTime );
+
+			uint32 ackedBytes = 0;
+			uint32 numberOfTimedOutMessages = 0;
+			_transmissionChannels[ i ]->TakeCongestionSignals( ackedBytes, numberOfTimedOutMessages );
+			if ( ackedBytes > 0 )
+			{
+				_congestionController->OnAck( ackedBytes, _transmissionChannels[ i ]->GetRTTMilliseconds() );
+			}
+
+			isThereLoss = isThereLoss || numberOfTimedOutMessages > 0;
+		}
+
+		if ( isThereLoss )
+		{
+			_congestionController->OnLoss();
 		}
+
+		_congestionController->Update( elapsedTime );
+		_sendPacer.Update( elapsedTime, _congestionController->GetSendRateBytesPerSecond(), GetDatagramMaxSize() );
+	}
+
+	void RemotePeer::SetCongestionController( std::unique_ptr< ICongestionController > congestionController )
+	{
+		assert( congestionController != nullptr );
+		_congestionController = std::move( congestionController );
 	}
 
 	bool RemotePeer::AddMessage( std::unique_ptr< Message > message )
@@ -139,6 +189,11 @@ namespace NetLib
 		TransmissionChannel* transmissionChannel = GetTransmissionChannelFromType( channelType );
 		if ( transmissionChannel != nullptr )
 		{
+			if ( message->Size() > GetMaxMessageSize() )
+			{
+				return AddFragmentedMessage( std::move( message ), *transmissionChannel );
+			}
+
 			transmissionChannel->AddMessageToSend( std::move( message ) );
 			return true;
 		}
@@ -149,6 +204,22 @@ namespace NetLib
 		}
 	}
 
+	bool RemotePeer::AddMessage( const InlineMessage& message )
+	{
+		TransmissionChannelType channelType = GetTransmissionChannelTypeFromHeader( message.GetHeader() );
+
+		TransmissionChannel* transmissionChannel = GetTransmissionChannelFromType( channelType );
+		if ( transmissionChannel == nullptr )
+		{
+			return false;
+		}
+
+		// Fixed-size messages are way smaller than any datagram, so they never get fragmented
+		assert( message.Size() <= GetMaxMessageSize() );
+		transmissionChannel->AddMessageToSend( message );
+		return true;
+	}
+
 	TransmissionChannelType RemotePeer::GetTransmissionChannelTypeFromHeader( const MessageHeader& messageHeader ) const
 	{
 		TransmissionChannelType result;
@@ -169,6 +240,66 @@ namespace NetLib
 		return result;
 	}
 
+	bool RemotePeer::AddFragmentedMessage( std::unique_ptr< Message > message,
+	                                       TransmissionChannel& transmissionChannel )
+	{
+		MessageFactory& messageFactory = MessageFactory::GetInstance();
+
+		const uint32 maxFragmentDataSize = GetMaxMessageSize() - FragmentMessage::GetHeaderSize();
+		const uint32 numberOfFragments = ( message->Size() + maxFragmentDataSize - 1 ) / maxFragmentDataSize;
+		if ( numberOfFragments > MAX_NUMBER_OF_FRAGMENTS )
+		{
+			LOG_ERROR( "Can't send a message of type %hhu and %u bytes. It would need %u fragments and the maximum is "
+			           "%u. Ignoring it...",
+			           message->GetHeader().type, message->Size(), numberOfFragments, MAX_NUMBER_OF_FRAGMENTS );
+			messageFactory.ReleaseMessage( std::move( message ) );
+			return false;
+		}
+
+		// Resizing keeps the capacity, so this stops allocating once it has seen the biggest message
+		_fragmentationBuffer.resize( message->Size() );
+		Buffer buffer( _fragmentationBuffer.data(), static_cast< int32 >( _fragmentationBuffer.size() ) );
+		message->Write( buffer );
+
+		const uint32 messageSize = buffer.GetAccessIndex();
+		const uint32 stride = FragmentReassembler::GetFragmentStride( messageSize, numberOfFragments );
+		const MessageHeader& header = message->GetHeader();
+
+		// Fragments go through the same transmission channel as the message. Reliable fragments get acked and resent
+		// one by one, while unreliable ones are dropped as a whole by the receiver if any of them gets lost
+		for ( uint32 i = 0; i < numberOfFragments; ++i )
+		{
+			const uint32 offset = i * stride;
+			const uint32 remainingSize = messageSize - offset;
+			const uint16 fragmentDataSize =
+			    static_cast< uint16 >( ( remainingSize < stride ) ? remainingSize : stride );
+
+			std::unique_ptr< Message > fragmentMessage = messageFactory.LendMessage( MessageType::Fragment );
+			fragmentMessage->SetReliability( header.isReliable );
+			fragmentMessage->SetOrdered( header.isOrdered );
+
+			FragmentMessage& fragment = static_cast< FragmentMessage& >( *fragmentMessage );
+			fragment.fragmentedMessageId = _nextFragmentedMessageId;
+			fragment.fragmentIndex = static_cast< uint8 >( i );
+			fragment.numberOfFragments = static_cast< uint8 >( numberOfFragments );
+			fragment.messageSize = messageSize;
+			fragment.dataSize = fragmentDataSize;
+			fragment.data = new uint8[ fragmentDataSize ];
+			std::memcpy( fragment.data, _fragmentationBuffer.data() + offset, fragmentDataSize );
+
+			transmissionChannel.AddMessageToSend( std::move( fragmentMessage ) );
+		}
+
+		++_nextFragmentedMessageId;
+		messageFactory.ReleaseMessage( std::move( message ) );
+		return true;
+	}
+
+	uint32 RemotePeer::GetMaxMessageSize() const
+	{
+		return PacketBuilder::GetMaxMessageSize( GetDatagramMaxSize() );
+	}
+
 	bool RemotePeer::ArePendingMessages( TransmissionChannelType channelType ) const
 	{
 		bool arePendingMessages = false;
@@ -182,9 +313,9 @@ namespace NetLib
 		return arePendingMessages;
 	}
 
-	std::unique_ptr< Message > RemotePeer::GetPendingMessage( TransmissionChannelType channelType )
+	QueuedMessage RemotePeer::GetPendingMessage( TransmissionChannelType channelType )
 	{
-		std::unique_ptr< Message > message = nullptr;
+		QueuedMessage message;
 
 		TransmissionChannel* transmissionChannel = GetTransmissionChannelFromType( channelType );
 		if ( transmissionChannel != nullptr )
@@ -192,7 +323,7 @@ namespace NetLib
 			message = transmissionChannel->GetMessageToSend();
 		}
 
-		return std::move( message );
+		return message;
 	}
 
 	uint32 RemotePeer::GetSizeOfNextUnsentMessage( TransmissionChannelType channelType ) const
@@ -216,7 +347,7 @@ namespace NetLib
 		}
 	}
 
-	void RemotePeer::AddSentMessage( std::unique_ptr< Message > message, TransmissionChannelType channelType )
+	void RemotePeer::AddSentMessage( QueuedMessage message, TransmissionChannelType channelType )
 	{
 		TransmissionChannel* transmissionChannel = GetTransmissionChannelFromType( channelType );
 		if ( transmissionChannel != nullptr )
@@ -347,24 +478,30 @@ namespace NetLib
 		return _transmissionChannels.size();
 	}
 
+	TransmissionChannelType RemotePeer::GetTransmissionChannelType( uint32 index ) const
+	{
+		assert( index < GetNumberOfTransmissionChannels() );
+		return _transmissionChannels[ index ]->GetType();
+	}
+
 	uint32 RemotePeer::GetRTTMilliseconds() const
 	{
 		uint32 rtt = 0;
-		uint32 numberOfTransmissionChannels = 0;
+		uint32 numberOfTransmissionChannelsWithRTT = 0;
 
-		for ( uint32 i = 0; i < numberOfTransmissionChannels; ++i )
+		for ( uint32 i = 0; i < GetNumberOfTransmissionChannels(); ++i )
 		{
 			uint32 transmissionChannelRTT = _transmissionChannels[ i ]->GetRTTMilliseconds();
 			if ( transmissionChannelRTT > 0 )
 			{
 				rtt += transmissionChannelRTT;
-				++numberOfTransmissionChannels;
+				++numberOfTransmissionChannelsWithRTT;
 			}
 		}
 
-		if ( numberOfTransmissionChannels > 0 )
+		if ( numberOfTransmissionChannelsWithRTT > 0 )
 		{
-			rtt /= numberOfTransmissionChannels;
+			rtt /= numberOfTransmissionChannelsWithRTT;
 		}
 
 		return rtt;
@@ -378,6 +515,14 @@ namespace NetLib
 			_transmissionChannels[ i ]->Reset();
 		}
 
+		// Moved from remote peers don't have a congestion controller anymore
+		if ( _congestionController != nullptr )
+		{
+			_congestionController->Reset();
+		}
+
+		_sendPacer.Reset();
+
 		// Reset address
 		_address = Address::GetInvalid();
 
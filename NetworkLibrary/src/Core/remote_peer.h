@@ -6,12 +6,16 @@
 #include "logger.h"
 
 #include "core/address.h"
+#include "core/i_congestion_controller.h"
+#include "core/path_mtu_discovery.h"
+#include "core/send_pacer.h"
 
 #include "transmission_channels/transmission_channel.h"
 
 namespace NetLib
 {
 	class Message;
+	class InlineMessage;
 	struct MessageHeader;
 
 	enum RemotePeerState : uint8
@@ -34,6 +38,18 @@ namespace NetLib
 			uint64 _serverSalt;
 
 			uint16 _nextPacketSequenceNumber;
+			// Socket shard used for sending data to this remote peer
+			uint32 _socketShardIndex;
+			// Finds out the biggest datagram that reaches this remote peer. Messages that don't fit within it are split
+			// into fragments
+			PathMTUDiscovery _pathMTUDiscovery;
+			uint16 _nextFragmentedMessageId;
+			// Memory where messages are serialized before splitting them into fragments
+			std::vector< uint8 > _fragmentationBuffer;
+			// Derives the send rate from the congestion signals of the transmission channels, and the pacer keeps the
+			// datagrams sent under it
+			std::unique_ptr< ICongestionController > _congestionController;
+			SendPacer _sendPacer;
 
 			std::vector< TransmissionChannel* > _transmissionChannels;
 
@@ -41,6 +57,7 @@ namespace NetLib
 			TransmissionChannel* GetTransmissionChannelFromType( TransmissionChannelType channelType );
 			const TransmissionChannel* GetTransmissionChannelFromType( TransmissionChannelType channelType ) const;
 			TransmissionChannelType GetTransmissionChannelTypeFromHeader( const MessageHeader& messageHeader ) const;
+			bool AddFragmentedMessage( std::unique_ptr< Message > message, TransmissionChannel& transmissionChannel );
 
 		public:
 			RemotePeer();
@@ -83,13 +100,48 @@ namespace NetLib
 
 			void SetServerSalt( uint64 newValue ) { _serverSalt = newValue; }
 
+			uint32 GetSocketShardIndex() const { return _socketShardIndex; }
+			void SetSocketShardIndex( uint32 index ) { _socketShardIndex = index; }
+			/// <summary>
+			/// Sets the size of the biggest datagram the local peer can send and restarts the path MTU discovery, which
+			/// looks for the biggest one that reaches this remote peer up to that size.
+			/// </summary>
+			void SetMaxDatagramSize( uint32 size ) { _pathMTUDiscovery.Reset( size ); }
+			/// <summary>
+			/// Size of the biggest datagram known to reach this remote peer without getting fragmented by the IP layer
+			/// </summary>
+			uint32 GetDatagramMaxSize() const { return _pathMTUDiscovery.GetDatagramMaxSize(); }
+			/// <summary>
+			/// Size of the biggest message that fits within GetDatagramMaxSize. Bigger messages added through
+			/// AddMessage are transparently split into fragments and reassembled by the receiver.
+			/// </summary>
+			uint32 GetMaxMessageSize() const;
+			PathMTUDiscovery& GetPathMTUDiscovery() { return _pathMTUDiscovery; }
+
+			/// <summary>
+			/// Replaces the congestion controller, which is AIMD by default.
+			/// </summary>
+			void SetCongestionController( std::unique_ptr< ICongestionController > congestionController );
+			const ICongestionController& GetCongestionController() const { return *_congestionController; }
+			float32 GetSendRateBytesPerSecond() const { return _congestionController->GetSendRateBytesPerSecond(); }
+			/// <summary>
+			/// Returns False once the datagrams sent this tick have spent the bytes allowed by the send rate. Pending
+			/// messages wait for the next ticks.
+			/// </summary>
+			bool CanSendDatagram() const { return _sendPacer.CanSendDatagram(); }
+			void OnDatagramSent( uint32 size ) { _sendPacer.OnDatagramSent( size ); }
+
 			bool IsAddressEqual( const Address& other ) const { return other == _address; }
 			bool IsInactive() const { return _inactivityTimeLeft == 0.f; }
 			bool AddMessage( std::unique_ptr< Message > message );
+			/// <summary>
+			/// Queues a fixed-size message by value, with no message from the message factory involved
+			/// </summary>
+			bool AddMessage( const InlineMessage& message );
 			bool ArePendingMessages( TransmissionChannelType channelType ) const;
-			std::unique_ptr< Message > GetPendingMessage( TransmissionChannelType channelType );
+			QueuedMessage GetPendingMessage( TransmissionChannelType channelType );
 			uint32 GetSizeOfNextUnsentMessage( TransmissionChannelType channelType ) const;
-			void AddSentMessage( std::unique_ptr< Message > message, TransmissionChannelType channelType );
+			void AddSentMessage( QueuedMessage message, TransmissionChannelType channelType );
 			void FreeSentMessages();
 			void FreeProcessedMessages();
 			void SeUnsentACKsToFalse( TransmissionChannelType channelType );
@@ -105,6 +157,7 @@ namespace NetLib
 
 			std::vector< TransmissionChannelType > GetAvailableTransmissionChannelTypes() const;
 			uint32 GetNumberOfTransmissionChannels() const;
+			TransmissionChannelType GetTransmissionChannelType( uint32 index ) const;
 
 			/// <summary>
 			/// Disconnect and reset the remote client
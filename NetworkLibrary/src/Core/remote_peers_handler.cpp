@@ -9,6 +9,10 @@ namespace NetLib
 {
 	RemotePeersHandler::RemotePeersHandler( uint32 maxConnections )
 	    : _maxConnections( maxConnections )
+	    , _remotePeerSlots()
+	    , _remotePeers()
+	    , _validRemotePeers()
+	    , _remotePeerSlotsByAddress( maxConnections )
 	{
 		_remotePeerSlots.reserve( _maxConnections );
 		_remotePeers.reserve( _maxConnections );
@@ -49,6 +53,12 @@ namespace NetLib
 			return false;
 		}
 
+		if ( !_remotePeerSlotsByAddress.Insert( addressInfo, slotIndex ) )
+		{
+			// There is already a remote peer with the same address
+			return false;
+		}
+
 		_remotePeerSlots[ slotIndex ] = true;
 		_remotePeers[ slotIndex ].Connect( addressInfo, id, REMOTE_PEER_INACTIVITY_TIME, clientSalt, serverSalt );
 
@@ -89,22 +99,13 @@ namespace NetLib
 
 	RemotePeer* RemotePeersHandler::GetRemotePeerFromAddress( const Address& address )
 	{
-		RemotePeer* result = nullptr;
-		for ( uint32 i = 0; i < _maxConnections; ++i )
+		const int32 slotIndex = _remotePeerSlotsByAddress.Find( address );
+		if ( slotIndex == -1 )
 		{
-			if ( !_remotePeerSlots[ i ] )
-			{
-				continue;
-			}
-
-			if ( _remotePeers[ i ].GetAddress() == address )
-			{
-				result = &_remotePeers[ i ];
-				break;
-			}
+			return nullptr;
 		}
 
-		return result;
+		return &_remotePeers[ slotIndex ];
 	}
 
 	RemotePeer* RemotePeersHandler::GetRemotePeerFromId( uint32 id )
@@ -127,9 +128,9 @@ namespace NetLib
 		return result;
 	}
 
-	bool RemotePeersHandler::IsRemotePeerAlreadyConnected( const Address& address ) const
+	const RemotePeer* RemotePeersHandler::GetRemotePeerFromId( uint32 id ) const
 	{
-		bool found = false;
+		const RemotePeer* result = nullptr;
 		for ( uint32 i = 0; i < _maxConnections; ++i )
 		{
 			if ( !_remotePeerSlots[ i ] )
@@ -137,14 +138,19 @@ namespace NetLib
 				continue;
 			}
 
-			if ( _remotePeers[ i ].GetAddress() == address )
+			if ( _remotePeers[ i ].GetClientIndex() == id )
 			{
-				found = true;
+				result = &_remotePeers[ i ];
 				break;
 			}
 		}
 
-		return found;
+		return result;
+	}
+
+	bool RemotePeersHandler::IsRemotePeerAlreadyConnected( const Address& address ) const
+	{
+		return _remotePeerSlotsByAddress.Find( address ) != -1;
 	}
 
 	bool RemotePeersHandler::DoesRemotePeerIdExist( uint32 id ) const
@@ -185,6 +191,9 @@ namespace NetLib
 		int32 id = GetIndexFromId( remotePeerId );
 		if ( id != -1 )
 		{
+			const bool removedSuccesfully = _remotePeerSlotsByAddress.Remove( _remotePeers[ id ].GetAddress() );
+			assert( removedSuccesfully );
+
 			_remotePeerSlots[ id ] = false;
 			_remotePeers[ id ].Disconnect();
 
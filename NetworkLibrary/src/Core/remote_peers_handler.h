@@ -6,6 +6,7 @@
 #include "numeric_types.h"
 
 #include "core/remote_peer.h"
+#include "core/address_index_map.h"
 
 namespace NetLib
 {
@@ -34,6 +35,7 @@ namespace NetLib
 			int32 FindFreeRemotePeerSlot() const;
 			RemotePeer* GetRemotePeerFromAddress( const Address& address );
 			RemotePeer* GetRemotePeerFromId( uint32 id );
+			const RemotePeer* GetRemotePeerFromId( uint32 id ) const;
 			bool IsRemotePeerAlreadyConnected( const Address& address ) const;
 			bool DoesRemotePeerIdExist( uint32 id ) const;
 			RemotePeersHandlerResult IsRemotePeerAbleToConnect( const Address& address ) const;
@@ -53,5 +55,7 @@ namespace NetLib
 			std::vector< bool > _remotePeerSlots;
 			std::vector< RemotePeer > _remotePeers;
 			std::unordered_set< RemotePeer* > _validRemotePeers;
+			// Slot index of every valid remote peer by address. Looked up once per received datagram
+			AddressIndexMap _remotePeerSlotsByAddress;
 	};
 } // namespace NetLib
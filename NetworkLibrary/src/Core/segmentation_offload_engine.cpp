@@ -0,0 +1,390 @@
+#include "segmentation_offload_engine.h"
+
+#ifdef __linux__
+	#include <cstring>
+	#include <algorithm>
+
+	#include <netinet/udp.h>
+
+	#include "core/address.h"
+
+	#include "logger.h"
+
+	// Older C library headers might not define them even if the kernel supports them
+	#ifndef SOL_UDP
+		#define SOL_UDP 17
+	#endif
+	#ifndef UDP_SEGMENT
+		#define UDP_SEGMENT 103
+	#endif
+	#ifndef UDP_GRO
+		#define UDP_GRO 104
+	#endif
+
+namespace NetLib
+{
+	static constexpr uint32 RECEIVE_CONTROL_BUFFER_SIZE = CMSG_SPACE( sizeof( int32 ) );
+	static constexpr uint32 SEND_CONTROL_BUFFER_SIZE = CMSG_SPACE( sizeof( uint16 ) );
+
+	SegmentationOffloadEngine::SegmentationOffloadEngine()
+	    : _socket( INVALID_SOCKET_HANDLE )
+	    , _datagramMaxSize( 0 )
+	    , _isSendOffloadEnabled( false )
+	    , _receiveBuffers()
+	    , _receiveControlBuffers()
+	    , _receivedMessages()
+	    , _numberOfReceivedMessages( 0 )
+	    , _nextMessageIndex( 0 )
+	    , _nextMessageOffset( 0 )
+	    , _sendControlBuffers()
+	{
+	}
+
+	bool SegmentationOffloadEngine::Start( SocketHandle socket, uint32 datagramMaxSize )
+	{
+		if ( IsValid() )
+		{
+			LOG_WARNING( "Segmentation offload warning. Trying to start an engine that has already been started" );
+			return true;
+		}
+
+		int32 isEnabled = 1;
+		if ( setsockopt( socket, SOL_UDP, UDP_GRO, &isEnabled, sizeof( isEnabled ) ) == SOCKET_ERROR )
+		{
+			LOG_WARNING( "Segmentation offload warning. UDP_GRO is not supported. Error code %d", errno );
+			return false;
+		}
+
+		// Probe UDP_SEGMENT support. A zero value means that only sends carrying their own segment size get segmented
+		const int32 defaultSegmentSize = 0;
+		if ( setsockopt( socket, SOL_UDP, UDP_SEGMENT, &defaultSegmentSize, sizeof( defaultSegmentSize ) ) ==
+		     SOCKET_ERROR )
+		{
+			LOG_WARNING( "Segmentation offload warning. UDP_SEGMENT is not supported. Error code %d", errno );
+			isEnabled = 0;
+			setsockopt( socket, SOL_UDP, UDP_GRO, &isEnabled, sizeof( isEnabled ) );
+			return false;
+		}
+
+		_socket = socket;
+		_datagramMaxSize = datagramMaxSize;
+		_isSendOffloadEnabled = true;
+
+		_receiveBuffers.resize( GRO_NUMBER_OF_RECEIVE_BUFFERS * SEGMENTATION_OFFLOAD_MAX_SIZE );
+		_receiveControlBuffers.resize( GRO_NUMBER_OF_RECEIVE_BUFFERS * RECEIVE_CONTROL_BUFFER_SIZE );
+		_receivedMessages.resize( GRO_NUMBER_OF_RECEIVE_BUFFERS );
+		_numberOfReceivedMessages = 0;
+		_nextMessageIndex = 0;
+		_nextMessageOffset = 0;
+
+		_sendControlBuffers.resize( MAX_DATAGRAM_BATCH_SIZE * SEND_CONTROL_BUFFER_SIZE );
+
+		return true;
+	}
+
+	SocketResult SegmentationOffloadEngine::ReceiveBatch( DatagramBatch& batch, Address& remoteAddress )
+	{
+		if ( !IsValid() || batch.IsFull() )
+		{
+			return SocketResult::SOKT_ERR;
+		}
+
+		// Don't read again until the previous read has been fully handed out, as it would overwrite its buffers
+		if ( _nextMessageIndex < _numberOfReceivedMessages )
+		{
+			CommitPendingSegments( batch );
+			return SocketResult::SOKT_SUCCESS;
+		}
+
+		const uint32 numberOfFreeSlots = batch.GetCapacity() - batch.GetNumberOfDatagrams();
+		const uint32 numberOfMessagesToRead = std::min( numberOfFreeSlots, GRO_NUMBER_OF_RECEIVE_BUFFERS );
+
+		struct mmsghdr messages[ GRO_NUMBER_OF_RECEIVE_BUFFERS ];
+		struct iovec buffers[ GRO_NUMBER_OF_RECEIVE_BUFFERS ];
+		std::memset( messages, 0, sizeof( messages[ 0 ] ) * numberOfMessagesToRead );
+
+		for ( uint32 i = 0; i < numberOfMessagesToRead; ++i )
+		{
+			ReceivedMessage& receivedMessage = _receivedMessages[ i ];
+			std::memset( &receivedMessage.address, 0, sizeof( receivedMessage.address ) );
+
+			buffers[ i ].iov_base = _receiveBuffers.data() + ( i * SEGMENTATION_OFFLOAD_MAX_SIZE );
+			buffers[ i ].iov_len = SEGMENTATION_OFFLOAD_MAX_SIZE;
+			messages[ i ].msg_hdr.msg_name = &receivedMessage.address;
+			messages[ i ].msg_hdr.msg_namelen = sizeof( receivedMessage.address );
+			messages[ i ].msg_hdr.msg_iov = &buffers[ i ];
+			messages[ i ].msg_hdr.msg_iovlen = 1;
+			messages[ i ].msg_hdr.msg_control = _receiveControlBuffers.data() + ( i * RECEIVE_CONTROL_BUFFER_SIZE );
+			messages[ i ].msg_hdr.msg_controllen = RECEIVE_CONTROL_BUFFER_SIZE;
+		}
+
+		const int32 numberOfMessagesRead = recvmmsg( _socket, messages, numberOfMessagesToRead, MSG_DONTWAIT, nullptr );
+		if ( numberOfMessagesRead == SOCKET_ERROR )
+		{
+			const int32 error = errno;
+			if ( error == EAGAIN || error == EWOULDBLOCK )
+			{
+				return SocketResult::SOKT_WOULDBLOCK;
+			}
+			else if ( error == ECONNRESET || error == ECONNREFUSED )
+			{
+				// Linux does not report which remote address caused the error
+				LOG_WARNING( "Socket warning. The remote socket has been closed unexpectly." );
+				remoteAddress = Address::GetInvalid();
+				return SocketResult::SOKT_CONNRESET;
+			}
+			else
+			{
+				LOG_ERROR( "Socket error. Error while receiving a batch of messages. Error code: %d", error );
+				return SocketResult::SOKT_ERR;
+			}
+		}
+
+		for ( int32 i = 0; i < numberOfMessagesRead; ++i )
+		{
+			ReceivedMessage& receivedMessage = _receivedMessages[ i ];
+			receivedMessage.data = static_cast< uint8* >( buffers[ i ].iov_base );
+			receivedMessage.size = messages[ i ].msg_len;
+			receivedMessage.segmentSize = messages[ i ].msg_len;
+
+			if ( ( messages[ i ].msg_hdr.msg_flags & MSG_TRUNC ) != 0 )
+			{
+				LOG_ERROR( "Socket error. The message received does not fit inside the buffer. Ignoring it..." );
+				receivedMessage.size = 0;
+				continue;
+			}
+
+			// Without this control message the read holds a single datagram
+			for ( struct cmsghdr* controlMessage = CMSG_FIRSTHDR( &messages[ i ].msg_hdr ); controlMessage != nullptr;
+			      controlMessage = CMSG_NXTHDR( &messages[ i ].msg_hdr, controlMessage ) )
+			{
+				if ( controlMessage->cmsg_level == SOL_UDP && controlMessage->cmsg_type == UDP_GRO )
+				{
+					int32 segmentSize = 0;
+					std::memcpy( &segmentSize, CMSG_DATA( controlMessage ), sizeof( segmentSize ) );
+					if ( segmentSize > 0 )
+					{
+						receivedMessage.segmentSize = static_cast< uint32 >( segmentSize );
+					}
+				}
+			}
+		}
+
+		_numberOfReceivedMessages = numberOfMessagesRead;
+		_nextMessageIndex = 0;
+		_nextMessageOffset = 0;
+
+		CommitPendingSegments( batch );
+
+		return SocketResult::SOKT_SUCCESS;
+	}
+
+	SocketResult SegmentationOffloadEngine::SendBatch( const DatagramBatch& batch )
+	{
+		if ( !IsValid() )
+		{
+			return SocketResult::SOKT_ERR;
+		}
+
+		struct mmsghdr messages[ MAX_DATAGRAM_BATCH_SIZE ];
+		struct iovec buffers[ MAX_DATAGRAM_BATCH_SIZE ];
+		uint32 messagesNumberOfSegments[ MAX_DATAGRAM_BATCH_SIZE ];
+
+		const uint32 numberOfDatagrams = batch.GetNumberOfDatagrams();
+		SocketResult sendResult = SocketResult::SOKT_SUCCESS;
+		uint32 numberOfDatagramsSent = 0;
+		while ( numberOfDatagramsSent < numberOfDatagrams )
+		{
+			// Each datagram takes one buffer so a single sendmmsg call never holds more than MAX_DATAGRAM_BATCH_SIZE
+			const uint32 lastDatagramIndex =
+			    std::min( numberOfDatagrams, numberOfDatagramsSent + MAX_DATAGRAM_BATCH_SIZE );
+			uint32 numberOfMessages = 0;
+			uint32 datagramIndex = numberOfDatagramsSent;
+
+			while ( datagramIndex < lastDatagramIndex )
+			{
+				uint32 numberOfSegments = 1;
+				if ( _isSendOffloadEnabled )
+				{
+					numberOfSegments = GetNumberOfCoalescableDatagrams( batch, datagramIndex, lastDatagramIndex );
+				}
+				const Address& address = batch.GetDatagramAddress( datagramIndex );
+				struct iovec* messageBuffers = &buffers[ datagramIndex - numberOfDatagramsSent ];
+
+				// The kernel concatenates the buffers and splits them again at the segment size boundaries
+				for ( uint32 i = 0; i < numberOfSegments; ++i )
+				{
+					messageBuffers[ i ].iov_base = batch.GetDatagramData( datagramIndex + i );
+					messageBuffers[ i ].iov_len = batch.GetDatagramSize( datagramIndex + i );
+				}
+
+				struct msghdr& header = messages[ numberOfMessages ].msg_hdr;
+				std::memset( &messages[ numberOfMessages ], 0, sizeof( messages[ numberOfMessages ] ) );
+				header.msg_name = const_cast< sockaddr* >( address.GetSockAddr() );
+				header.msg_namelen = address.GetSockAddrSize();
+				header.msg_iov = messageBuffers;
+				header.msg_iovlen = numberOfSegments;
+
+				if ( numberOfSegments > 1 )
+				{
+					header.msg_control = _sendControlBuffers.data() + ( numberOfMessages * SEND_CONTROL_BUFFER_SIZE );
+					header.msg_controllen = SEND_CONTROL_BUFFER_SIZE;
+
+					struct cmsghdr* controlMessage = CMSG_FIRSTHDR( &header );
+					controlMessage->cmsg_level = SOL_UDP;
+					controlMessage->cmsg_type = UDP_SEGMENT;
+					controlMessage->cmsg_len = CMSG_LEN( sizeof( uint16 ) );
+					const uint16 segmentSize = static_cast< uint16 >( batch.GetDatagramSize( datagramIndex ) );
+					std::memcpy( CMSG_DATA( controlMessage ), &segmentSize, sizeof( segmentSize ) );
+				}
+
+				messagesNumberOfSegments[ numberOfMessages ] = numberOfSegments;
+				++numberOfMessages;
+				datagramIndex += numberOfSegments;
+			}
+
+			const int32 result = sendmmsg( _socket, messages, numberOfMessages, 0 );
+			if ( result == SOCKET_ERROR )
+			{
+				const int32 error = errno;
+
+				// Some devices can't segment UDP, for example when their checksum offload is disabled. Retry the
+				// same datagrams without coalescing them
+				if ( _isSendOffloadEnabled && ( error == EIO || error == EINVAL ) )
+				{
+					LOG_WARNING( "Segmentation offload warning. The kernel refused a segmented send. Error code %d. "
+					             "Falling back to plain sends",
+					             error );
+					_isSendOffloadEnabled = false;
+					continue;
+				}
+
+				if ( error == EAGAIN || error == EWOULDBLOCK )
+				{
+					// The send buffer is full, so the rest of the datagrams wouldn't make it either
+					LOG_WARNING( "Socket warning. The send buffer is full. %u datagrams have not been sent",
+					             numberOfDatagrams - numberOfDatagramsSent );
+					return SocketResult::SOKT_WOULDBLOCK;
+				}
+
+				// The error belongs to the first message, whose segments all go to the same destination. Drop only
+				// those so the rest of the remote peers still get their datagrams
+				if ( error == EMSGSIZE )
+				{
+					LOG_INFO( "Socket info. Discarding %u datagrams since they are bigger than the link MTU",
+					          messagesNumberOfSegments[ 0 ] );
+				}
+				else
+				{
+					LOG_ERROR( "Socket error. Error while sending data. Discarding %u datagrams. Error code %d",
+					           messagesNumberOfSegments[ 0 ], error );
+					sendResult = SocketResult::SOKT_ERR;
+				}
+
+				numberOfDatagramsSent += messagesNumberOfSegments[ 0 ];
+				continue;
+			}
+
+			for ( int32 i = 0; i < result; ++i )
+			{
+				numberOfDatagramsSent += messagesNumberOfSegments[ i ];
+			}
+		}
+
+		return sendResult;
+	}
+
+	void SegmentationOffloadEngine::Close()
+	{
+		if ( !IsValid() )
+		{
+			return;
+		}
+
+		// The socket is owned by the Socket class, just forget about it
+		_socket = INVALID_SOCKET_HANDLE;
+		_isSendOffloadEnabled = false;
+
+		_receiveBuffers.clear();
+		_receiveControlBuffers.clear();
+		_receivedMessages.clear();
+		_numberOfReceivedMessages = 0;
+		_nextMessageIndex = 0;
+		_nextMessageOffset = 0;
+		_sendControlBuffers.clear();
+	}
+
+	SegmentationOffloadEngine::~SegmentationOffloadEngine()
+	{
+		Close();
+	}
+
+	void SegmentationOffloadEngine::CommitPendingSegments( DatagramBatch& batch )
+	{
+		Address address = Address::GetInvalid();
+		while ( _nextMessageIndex < _numberOfReceivedMessages && !batch.IsFull() )
+		{
+			const ReceivedMessage& receivedMessage = _receivedMessages[ _nextMessageIndex ];
+			if ( _nextMessageOffset < receivedMessage.size )
+			{
+				// The last segment might be smaller than the rest
+				const uint32 segmentSize =
+				    std::min( receivedMessage.segmentSize, receivedMessage.size - _nextMessageOffset );
+				if ( segmentSize > _datagramMaxSize )
+				{
+					LOG_ERROR( "Socket error. The message received does not fit inside the buffer. Ignoring it..." );
+				}
+				else
+				{
+					address.SetFromSockAddr( receivedMessage.address );
+					batch.CommitDatagramView( receivedMessage.data + _nextMessageOffset, segmentSize, address );
+				}
+
+				_nextMessageOffset += segmentSize;
+			}
+
+			if ( _nextMessageOffset >= receivedMessage.size )
+			{
+				++_nextMessageIndex;
+				_nextMessageOffset = 0;
+			}
+		}
+	}
+
+	uint32 SegmentationOffloadEngine::GetNumberOfCoalescableDatagrams( const DatagramBatch& batch, uint32 firstIndex,
+	                                                                   uint32 lastIndex ) const
+	{
+		const Address& address = batch.GetDatagramAddress( firstIndex );
+		const uint32 segmentSize = batch.GetDatagramSize( firstIndex );
+		if ( segmentSize == 0 )
+		{
+			return 1;
+		}
+
+		uint32 numberOfDatagrams = 1;
+		uint32 totalSize = segmentSize;
+		while ( firstIndex + numberOfDatagrams < lastIndex && numberOfDatagrams < GSO_MAX_NUMBER_OF_SEGMENTS )
+		{
+			const uint32 index = firstIndex + numberOfDatagrams;
+			const uint32 size = batch.GetDatagramSize( index );
+
+			// Every segment but the last one must have exactly the same size
+			if ( size == 0 || size > segmentSize || totalSize + size > SEGMENTATION_OFFLOAD_MAX_SIZE ||
+			     batch.GetDatagramAddress( index ) != address )
+			{
+				break;
+			}
+
+			totalSize += size;
+			++numberOfDatagrams;
+
+			if ( size < segmentSize )
+			{
+				break;
+			}
+		}
+
+		return numberOfDatagrams;
+	}
+} // namespace NetLib
+#endif
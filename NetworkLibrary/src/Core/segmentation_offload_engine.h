@@ -0,0 +1,93 @@
+#pragma once
+#include "numeric_types.h"
+
+#ifdef __linux__
+	#include <vector>
+
+	#include <sys/uio.h>
+
+	#include "core/socket_platform.h"
+	#include "core/socket.h"
+	#include "core/datagram_batch.h"
+
+namespace NetLib
+{
+	// Maximum number of segments the kernel accepts within a single UDP_SEGMENT send
+	constexpr uint32 GSO_MAX_NUMBER_OF_SEGMENTS = 64;
+	// Maximum payload of a single coalesced datagram, whether it is sent through GSO or received through GRO
+	constexpr uint32 SEGMENTATION_OFFLOAD_MAX_SIZE = 65507;
+	// Number of coalesced datagrams that can be read with a single system call
+	constexpr uint32 GRO_NUMBER_OF_RECEIVE_BUFFERS = 8;
+
+	/// <summary>
+	/// UDP segmentation offload based socket I/O. On send, consecutive datagrams with the same destination and size
+	/// are handed to the kernel as a single super-buffer using UDP_SEGMENT (GSO), so the stack is traversed once per
+	/// group instead of once per datagram. On receive, UDP_GRO lets the kernel coalesce datagrams of the same flow
+	/// into a single read, which is split back into the original datagrams here.
+	/// </summary>
+	class SegmentationOffloadEngine
+	{
+		public:
+			SegmentationOffloadEngine();
+			SegmentationOffloadEngine( const SegmentationOffloadEngine& ) = delete;
+
+			SegmentationOffloadEngine& operator=( const SegmentationOffloadEngine& ) = delete;
+
+			/// <summary>
+			/// Enables UDP_GRO on the socket and creates the receive buffers. It fails if the kernel doesn't support
+			/// segmentation offload, in which case the caller should fall back to plain socket calls.
+			/// </summary>
+			/// <param name="socket">Socket to operate on. It must be in non-blocking mode</param>
+			bool Start( SocketHandle socket, uint32 datagramMaxSize );
+			/// <summary>
+			/// Adds as many received datagrams as fit into the batch. The datagrams are views of the engine's receive
+			/// buffers so they remain valid only until the next call. If a coalesced read didn't fit into the batch,
+			/// the next call hands out its remaining datagrams before reading from the socket again.
+			/// </summary>
+			SocketResult ReceiveBatch( DatagramBatch& batch, Address& remoteAddress );
+			/// <summary>
+			/// Sends all the datagrams within the batch, coalescing them wherever possible.
+			/// </summary>
+			SocketResult SendBatch( const DatagramBatch& batch );
+			void Close();
+
+			bool IsValid() const { return _socket != INVALID_SOCKET_HANDLE; }
+
+			~SegmentationOffloadEngine();
+
+		private:
+			struct ReceivedMessage
+			{
+					uint8* data;
+					uint32 size;
+					uint32 segmentSize;
+					struct sockaddr_in address;
+			};
+
+			/// <summary>
+			/// Splits the pending received messages into the batch until it gets full or there is nothing left
+			/// </summary>
+			void CommitPendingSegments( DatagramBatch& batch );
+			/// <summary>
+			/// Returns the number of datagrams, starting at the given index, that can be sent as a single super-buffer
+			/// </summary>
+			uint32 GetNumberOfCoalescableDatagrams( const DatagramBatch& batch, uint32 firstIndex,
+			                                        uint32 lastIndex ) const;
+
+			SocketHandle _socket;
+			uint32 _datagramMaxSize;
+			bool _isSendOffloadEnabled;
+
+			// Receive related
+			std::vector< uint8 > _receiveBuffers;
+			std::vector< uint8 > _receiveControlBuffers;
+			std::vector< ReceivedMessage > _receivedMessages;
+			uint32 _numberOfReceivedMessages;
+			uint32 _nextMessageIndex;
+			uint32 _nextMessageOffset;
+
+			// Send related
+			std::vector< uint8 > _sendControlBuffers;
+	};
+} // namespace NetLib
+#endif
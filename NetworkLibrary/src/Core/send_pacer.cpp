@@ -0,0 +1,26 @@
+#include "send_pacer.h"
+
+#include <algorithm>
+
+#include "core/path_mtu_discovery.h"
+
+namespace NetLib
+{
+	SendPacer::SendPacer()
+	    : _availableBytes( 0.f )
+	{
+		Reset();
+	}
+
+	void SendPacer::Update( float32 elapsedTime, float32 sendRateBytesPerSecond, uint32 datagramMaxSize )
+	{
+		const float32 allowedBytes = sendRateBytesPerSecond * elapsedTime;
+		_availableBytes = std::min( _availableBytes + allowedBytes, allowedBytes + datagramMaxSize );
+	}
+
+	void SendPacer::Reset()
+	{
+		// Enough for the first datagram to go right away
+		_availableBytes = static_cast< float32 >( MIN_PATH_DATAGRAM_SIZE_BYTES );
+	}
+} // namespace NetLib
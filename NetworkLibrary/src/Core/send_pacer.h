@@ -0,0 +1,27 @@
+#pragma once
+#include "numeric_types.h"
+
+namespace NetLib
+{
+	/// <summary>
+	/// Token bucket that keeps the datagrams sent to a remote peer under its send rate. Every tick adds the bytes that
+	/// the rate allows within the elapsed time. A datagram can be sent while there are bytes available, even if it
+	/// takes more than them, and the debt is paid by the next ticks. Unused bytes only carry over up to a datagram, so
+	/// a peer that has been idle can't send a burst afterwards.
+	/// </summary>
+	class SendPacer
+	{
+		public:
+			SendPacer();
+
+			void Update( float32 elapsedTime, float32 sendRateBytesPerSecond, uint32 datagramMaxSize );
+			void Reset();
+
+			bool CanSendDatagram() const { return _availableBytes > 0.f; }
+			void OnDatagramSent( uint32 size ) { _availableBytes -= size; }
+			float32 GetAvailableBytes() const { return _availableBytes; }
+
+		private:
+			float32 _availableBytes;
+	};
+} // namespace NetLib
@@ -0,0 +1,31 @@
+#pragma once
+#include "numeric_types.h"
+
+// Platform specific socket headers. Any file that needs to deal with native socket types (sockaddr_in, socket handles,
+// error codes...) must include this one instead of the platform headers directly.
+#ifdef _WIN32
+	#include <winsock2.h>
+	#include <ws2tcpip.h>
+#else
+	#include <sys/types.h>
+	#include <sys/socket.h>
+	#include <netinet/in.h>
+	#include <arpa/inet.h>
+	#include <unistd.h>
+	#include <fcntl.h>
+	#include <errno.h>
+
+	// Keep the same return code naming as Winsock so the socket code can be shared between platforms
+	#define SOCKET_ERROR ( -1 )
+#endif
+
+namespace NetLib
+{
+#ifdef _WIN32
+	typedef SOCKET SocketHandle;
+	constexpr SocketHandle INVALID_SOCKET_HANDLE = INVALID_SOCKET;
+#else
+	typedef int32 SocketHandle;
+	constexpr SocketHandle INVALID_SOCKET_HANDLE = -1;
+#endif
+} // namespace NetLib
@@ -0,0 +1,298 @@
+#include "socket_shard.h"
+
+#include <cassert>
+#include <chrono>
+#include <cstring>
+
+#include "core/address.h"
+
+#include "logger.h"
+
+namespace NetLib
+{
+#ifdef __linux__
+	// The worker is woken up as soon as there is data to send, so this is only a safety net
+	static constexpr float32 WORKER_WAIT_TIMEOUT_SECONDS = 0.1f;
+#else
+	// Waits can't be interrupted on this platform, so keep them short in order to not delay the outgoing data
+	static constexpr float32 WORKER_WAIT_TIMEOUT_SECONDS = 0.001f;
+#endif
+
+	// Shard whose worker is running within the calling thread, if any
+	static thread_local const SocketShard* currentWorkerSocketShard = nullptr;
+
+	SocketShardsDataSignal::SocketShardsDataSignal()
+	    : _mutex()
+	    , _condition()
+	    , _isDataAvailable( false )
+	{
+	}
+
+	void SocketShardsDataSignal::Notify()
+	{
+		{
+			std::lock_guard< std::mutex > lock( _mutex );
+			_isDataAvailable = true;
+		}
+
+		_condition.notify_one();
+	}
+
+	void SocketShardsDataSignal::Consume()
+	{
+		std::lock_guard< std::mutex > lock( _mutex );
+		_isDataAvailable = false;
+	}
+
+	bool SocketShardsDataSignal::WaitFor( float32 timeoutSeconds ) const
+	{
+		std::unique_lock< std::mutex > lock( _mutex );
+		if ( timeoutSeconds <= 0.f )
+		{
+			return _isDataAvailable;
+		}
+
+		const std::chrono::duration< float32 > timeout( timeoutSeconds );
+		return _condition.wait_for( lock, timeout, [ this ]() { return _isDataAvailable; } );
+	}
+
+	SocketShard::SocketShard( uint32 index, uint32 datagramMaxSize, ISocketShardHandler& handler,
+	                          SocketShardsDataSignal& dataSignal )
+	    : _index( index )
+	    , _handler( handler )
+	    , _dataSignal( dataSignal )
+	    , _socket()
+	    , _socketWaiter()
+	    , _receiveBatch( MAX_DATAGRAM_BATCH_SIZE, datagramMaxSize )
+	    , _sendBatch( MAX_DATAGRAM_BATCH_SIZE, datagramMaxSize )
+	    , _workerDatagramsToSend()
+	    , _packetBuilder()
+	    , _workerThread()
+	    , _isRunning( false )
+	    , _isSendDataRequested( false )
+	    , _remotePeersMutex()
+	    , _mutex()
+	    , _datagramsToSend()
+	{
+	}
+
+	bool SocketShard::Start( const Address& address, SocketIOMode ioMode )
+	{
+		if ( _isRunning )
+		{
+			LOG_WARNING( "Socket shard %u has already been started", _index );
+			return true;
+		}
+
+		if ( _socket.Start( ioMode, _receiveBatch.GetDatagramMaxSize() ) != SocketResult::SOKT_SUCCESS )
+		{
+			LOG_ERROR( "Error while starting socket shard %u", _index );
+			return false;
+		}
+
+		if ( _socket.EnableReusePort() != SocketResult::SOKT_SUCCESS ||
+		     _socket.Bind( address ) != SocketResult::SOKT_SUCCESS || !_socketWaiter.Start( _socket ) )
+		{
+			LOG_ERROR( "Error while starting socket shard %u", _index );
+			_socketWaiter.Close();
+			_socket.Close();
+			return false;
+		}
+
+		_isRunning = true;
+		_workerThread = std::thread( &SocketShard::WorkerLoop, this );
+
+		LOG_INFO( "Socket shard %u started", _index );
+		return true;
+	}
+
+	void SocketShard::Stop()
+	{
+		if ( !_isRunning )
+		{
+			return;
+		}
+
+		_isRunning = false;
+		_socketWaiter.WakeUp();
+		_workerThread.join();
+
+		_socketWaiter.Close();
+		_socket.Close();
+
+		_isSendDataRequested = false;
+
+		std::lock_guard< std::mutex > lock( _mutex );
+		_datagramsToSend.Clear();
+	}
+
+	void SocketShard::LockRemotePeers()
+	{
+		_remotePeersMutex.lock();
+	}
+
+	void SocketShard::UnlockRemotePeers()
+	{
+		_remotePeersMutex.unlock();
+	}
+
+	void SocketShard::SendDatagrams( DatagramQueue& queue )
+	{
+		if ( queue.IsEmpty() )
+		{
+			return;
+		}
+
+		{
+			std::lock_guard< std::mutex > lock( _mutex );
+			if ( _datagramsToSend.IsEmpty() )
+			{
+				_datagramsToSend.Swap( queue );
+			}
+			else
+			{
+				// The worker hasn't sent the previous datagrams yet
+				const uint32 numberOfDatagrams = queue.GetNumberOfDatagrams();
+				for ( uint32 i = 0; i < numberOfDatagrams; ++i )
+				{
+					_datagramsToSend.PushDatagram( queue.GetDatagramData( i ), queue.GetDatagramSize( i ),
+					                               queue.GetDatagramAddress( i ) );
+				}
+			}
+		}
+
+		queue.Clear();
+		_socketWaiter.WakeUp();
+	}
+
+	void SocketShard::RequestSendData()
+	{
+		_isSendDataRequested = true;
+		_socketWaiter.WakeUp();
+	}
+
+	bool SocketShard::IsWorkerThread() const
+	{
+		return currentWorkerSocketShard == this;
+	}
+
+	uint8* SocketShard::BeginOutgoingDatagram()
+	{
+		assert( IsWorkerThread() );
+		if ( _sendBatch.IsFull() )
+		{
+			FlushSendBatch();
+		}
+
+		return _sendBatch.GetNextFreeDatagramData();
+	}
+
+	void SocketShard::CommitOutgoingDatagram( uint32 size, const Address& address )
+	{
+		assert( IsWorkerThread() );
+		_sendBatch.CommitDatagram( size, address );
+	}
+
+	SocketShard::~SocketShard()
+	{
+		Stop();
+	}
+
+	void SocketShard::WorkerLoop()
+	{
+		currentWorkerSocketShard = this;
+
+		while ( _isRunning )
+		{
+			_socketWaiter.Wait( WORKER_WAIT_TIMEOUT_SECONDS );
+
+			ReceivePendingDatagrams();
+			SendPendingDatagrams();
+		}
+
+		// Make sure that the last datagrams, such as disconnection ones, leave before closing the socket
+		SendPendingDatagrams();
+		currentWorkerSocketShard = nullptr;
+	}
+
+	void SocketShard::ReceivePendingDatagrams()
+	{
+		Address remoteAddress = Address::GetInvalid();
+		bool arePendingDatagramsToRead = true;
+
+		do
+		{
+			_receiveBatch.Clear();
+			const SocketResult result = _socket.ReceiveFromBatch( _receiveBatch, remoteAddress );
+
+			// The datagrams are processed right where they were read. Their messages wait within the remote peers until
+			// the main thread picks them up
+			if ( !_receiveBatch.IsEmpty() )
+			{
+				{
+					std::lock_guard< std::mutex > lock( _remotePeersMutex );
+					_handler.ProcessSocketShardDatagrams( *this, _receiveBatch );
+				}
+
+				_dataSignal.Notify();
+			}
+
+			// Remote peers closed unexpectedly are detected through their inactivity timeout, so keep reading after a
+			// SOKT_CONNRESET
+			if ( result == SocketResult::SOKT_SUCCESS )
+			{
+				arePendingDatagramsToRead = _receiveBatch.IsFull();
+			}
+			else if ( result == SocketResult::SOKT_ERR || result == SocketResult::SOKT_WOULDBLOCK )
+			{
+				arePendingDatagramsToRead = false;
+			}
+		} while ( arePendingDatagramsToRead );
+	}
+
+	void SocketShard::SendPendingDatagrams()
+	{
+		{
+			std::lock_guard< std::mutex > lock( _mutex );
+			_workerDatagramsToSend.Swap( _datagramsToSend );
+		}
+
+		// Datagrams queued by the main thread go first, as they were created before the remote peers data
+		const uint32 numberOfDatagrams = _workerDatagramsToSend.GetNumberOfDatagrams();
+		for ( uint32 i = 0; i < numberOfDatagrams; ++i )
+		{
+			const uint32 datagramSize = _workerDatagramsToSend.GetDatagramSize( i );
+			if ( datagramSize > _sendBatch.GetDatagramMaxSize() )
+			{
+				LOG_ERROR( "Socket shard %u error. Datagram bigger than the send buffer size. Discarding it...",
+				           _index );
+				continue;
+			}
+
+			std::memcpy( BeginOutgoingDatagram(), _workerDatagramsToSend.GetDatagramData( i ), datagramSize );
+			CommitOutgoingDatagram( datagramSize, _workerDatagramsToSend.GetDatagramAddress( i ) );
+		}
+
+		_workerDatagramsToSend.Clear();
+
+		if ( _isSendDataRequested.exchange( false ) )
+		{
+			std::lock_guard< std::mutex > lock( _remotePeersMutex );
+			_handler.SendSocketShardData( *this );
+		}
+
+		// Also flushes the datagrams written while processing the received ones
+		FlushSendBatch();
+	}
+
+	void SocketShard::FlushSendBatch()
+	{
+		if ( _sendBatch.IsEmpty() )
+		{
+			return;
+		}
+
+		_socket.SendToBatch( _sendBatch );
+		_sendBatch.Clear();
+	}
+} // namespace NetLib
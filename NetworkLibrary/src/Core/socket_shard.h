@@ -0,0 +1,135 @@
+#pragma once
+#include "numeric_types.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "core/socket.h"
+#include "core/socket_waiter.h"
+#include "core/datagram_batch.h"
+#include "core/datagram_queue.h"
+#include "core/i_socket_shard_handler.h"
+
+#include "communication/packet_builder.h"
+
+namespace NetLib
+{
+	class Address;
+
+	/// <summary>
+	/// Lets the socket shards tell the main thread that there is received data waiting to be processed
+	/// </summary>
+	class SocketShardsDataSignal
+	{
+		public:
+			SocketShardsDataSignal();
+			SocketShardsDataSignal( const SocketShardsDataSignal& ) = delete;
+
+			SocketShardsDataSignal& operator=( const SocketShardsDataSignal& ) = delete;
+
+			void Notify();
+			/// <summary>
+			/// Marks all the notified data as consumed. Call it right before processing the data from the shards.
+			/// </summary>
+			void Consume();
+			/// <summary>
+			/// Blocks until any shard notifies new data or the timeout expires
+			/// </summary>
+			/// <returns>True if there is data pending to be consumed, False otherwise</returns>
+			bool WaitFor( float32 timeoutSeconds ) const;
+
+		private:
+			mutable std::mutex _mutex;
+			mutable std::condition_variable _condition;
+			bool _isDataAvailable;
+	};
+
+	/// <summary>
+	/// One of the sockets of a sharded peer. All the shards bind the same address and port using SO_REUSEPORT so the
+	/// kernel spreads the incoming flows between them. Each shard runs its own worker thread, which owns a subset of
+	/// the remote peers. It processes their received datagrams and serializes their outgoing data through the handler,
+	/// right where the socket reads and writes them. The main thread only accesses those remote peers while holding the
+	/// shard's remote peers lock.
+	/// </summary>
+	class SocketShard
+	{
+		public:
+			SocketShard( uint32 index, uint32 datagramMaxSize, ISocketShardHandler& handler,
+			             SocketShardsDataSignal& dataSignal );
+			SocketShard( const SocketShard& ) = delete;
+
+			SocketShard& operator=( const SocketShard& ) = delete;
+
+			bool Start( const Address& address, SocketIOMode ioMode );
+			/// <summary>
+			/// Stops the worker thread after sending all the datagrams queued so far and closes the socket
+			/// </summary>
+			void Stop();
+
+			uint32 GetIndex() const { return _index; }
+
+			/// <summary>
+			/// Blocks the worker from accessing the remote peers of this shard until UnlockRemotePeers is called
+			/// </summary>
+			void LockRemotePeers();
+			void UnlockRemotePeers();
+
+			/// <summary>
+			/// Hands the datagrams over to the worker thread in order to send them. The queue will be left empty.
+			/// Only call it from the main thread.
+			/// </summary>
+			void SendDatagrams( DatagramQueue& queue );
+			/// <summary>
+			/// Asks the worker thread to send the pending data of the shard's remote peers. Only call it from the main
+			/// thread.
+			/// </summary>
+			void RequestSendData();
+
+			/// <summary>
+			/// Whether the calling thread is the worker thread of this shard
+			/// </summary>
+			bool IsWorkerThread() const;
+
+			// Only call these from the worker thread
+			PacketBuilder& GetPacketBuilder() { return _packetBuilder; }
+			/// <summary>
+			/// Returns the memory where the next outgoing datagram must be written, straight within the send batch.
+			/// Call CommitOutgoingDatagram once it has been written.
+			/// </summary>
+			uint8* BeginOutgoingDatagram();
+			void CommitOutgoingDatagram( uint32 size, const Address& address );
+
+			~SocketShard();
+
+		private:
+			void WorkerLoop();
+			void ReceivePendingDatagrams();
+			void SendPendingDatagrams();
+			void FlushSendBatch();
+
+			const uint32 _index;
+			ISocketShardHandler& _handler;
+			SocketShardsDataSignal& _dataSignal;
+
+			// Only used by the worker thread once started
+			Socket _socket;
+			SocketWaiter _socketWaiter;
+			DatagramBatch _receiveBatch;
+			DatagramBatch _sendBatch;
+			DatagramQueue _workerDatagramsToSend;
+			PacketBuilder _packetBuilder;
+
+			std::thread _workerThread;
+			std::atomic< bool > _isRunning;
+			std::atomic< bool > _isSendDataRequested;
+
+			// Held by the worker while it accesses its remote peers, and by the main thread to keep it from doing so
+			std::mutex _remotePeersMutex;
+
+			// Shared between the main thread and the worker thread
+			std::mutex _mutex;
+			DatagramQueue _datagramsToSend;
+	};
+} // namespace NetLib
@@ -0,0 +1,63 @@
+#include "socket_transport.h"
+
+#include "logger.h"
+
+namespace NetLib
+{
+	SocketTransport::SocketTransport( SocketIOMode ioMode )
+	    : Transport()
+	    , _ioMode( ioMode )
+	    , _socket()
+	    , _socketWaiter()
+	{
+	}
+
+	bool SocketTransport::Start( uint32 datagramMaxSize )
+	{
+		if ( _socket.Start( _ioMode, datagramMaxSize ) != SocketResult::SOKT_SUCCESS )
+		{
+			LOG_ERROR( "Error while starting the socket transport" );
+			return false;
+		}
+
+		if ( !_socketWaiter.Start( _socket ) )
+		{
+			LOG_ERROR( "Error while starting the socket transport waiter" );
+			_socket.Close();
+			return false;
+		}
+
+		return true;
+	}
+
+	bool SocketTransport::Bind( const Address& address )
+	{
+		return _socket.Bind( address ) == SocketResult::SOKT_SUCCESS;
+	}
+
+	SocketResult SocketTransport::ReceiveFromBatch( DatagramBatch& batch, Address& remoteAddress )
+	{
+		return _socket.ReceiveFromBatch( batch, remoteAddress );
+	}
+
+	SocketResult SocketTransport::SendToBatch( const DatagramBatch& batch )
+	{
+		return _socket.SendToBatch( batch );
+	}
+
+	bool SocketTransport::WaitForIncomingData( float32 timeoutSeconds ) const
+	{
+		return _socketWaiter.Wait( timeoutSeconds ) == SocketWaitResult::SWR_DATA_AVAILABLE;
+	}
+
+	void SocketTransport::Close()
+	{
+		_socketWaiter.Close();
+		_socket.Close();
+	}
+
+	SocketTransport::~SocketTransport()
+	{
+		Close();
+	}
+} // namespace NetLib
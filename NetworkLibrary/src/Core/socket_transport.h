@@ -0,0 +1,34 @@
+#pragma once
+#include "numeric_types.h"
+
+#include "core/socket.h"
+#include "core/socket_waiter.h"
+#include "core/transport.h"
+
+namespace NetLib
+{
+	/// <summary>
+	/// Transport over a UDP socket. Waiting for incoming data relies on a SocketWaiter.
+	/// </summary>
+	class SocketTransport : public Transport
+	{
+		public:
+			/// <param name="ioMode">Socket I/O mode. If the selected mode is not supported by the platform it falls
+			/// back to the default one</param>
+			SocketTransport( SocketIOMode ioMode = SocketIOMode::DEFAULT );
+
+			bool Start( uint32 datagramMaxSize ) override;
+			bool Bind( const Address& address ) override;
+			SocketResult ReceiveFromBatch( DatagramBatch& batch, Address& remoteAddress ) override;
+			SocketResult SendToBatch( const DatagramBatch& batch ) override;
+			bool WaitForIncomingData( float32 timeoutSeconds ) const override;
+			void Close() override;
+
+			~SocketTransport() override;
+
+		private:
+			SocketIOMode _ioMode;
+			Socket _socket;
+			SocketWaiter _socketWaiter;
+	};
+} // namespace NetLib
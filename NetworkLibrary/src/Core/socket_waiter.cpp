@@ -0,0 +1,278 @@
+#include "socket_waiter.h"
+
+#include <cmath>
+
+#ifdef __linux__
+	#include <sys/epoll.h>
+	#include <sys/timerfd.h>
+	#include <sys/eventfd.h>
+#endif
+
+#include "core/socket.h"
+#include "core/io_uring_engine.h"
+
+#include "logger.h"
+
+namespace NetLib
+{
+	static int32 GetLastWaitError()
+	{
+#ifdef _WIN32
+		return WSAGetLastError();
+#else
+		return errno;
+#endif
+	}
+
+	SocketWaiter::SocketWaiter()
+	    : _socketHandle( INVALID_SOCKET_HANDLE )
+#ifdef __linux__
+	    , _epollHandle( -1 )
+	    , _timerHandle( -1 )
+	    , _wakeUpHandle( -1 )
+#endif
+	{
+	}
+
+	bool SocketWaiter::Start( const Socket& socket )
+	{
+		if ( IsValid() )
+		{
+			LOG_WARNING( "Socket waiter warning. Trying to start a socket waiter that has already been started" );
+			return true;
+		}
+
+		_socketHandle = socket._listenSocket;
+		if ( _socketHandle == INVALID_SOCKET_HANDLE )
+		{
+			LOG_ERROR( "Socket waiter error. Trying to wait on an invalid socket" );
+			return false;
+		}
+
+#ifdef __linux__
+		_epollHandle = epoll_create1( EPOLL_CLOEXEC );
+		if ( _epollHandle == SOCKET_ERROR )
+		{
+			LOG_ERROR( "Socket waiter error. Error while creating the epoll instance. Error code %d",
+			           GetLastWaitError() );
+			Close();
+			return false;
+		}
+
+		_timerHandle = timerfd_create( CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC );
+		if ( _timerHandle == SOCKET_ERROR )
+		{
+			LOG_ERROR( "Socket waiter error. Error while creating the timer. Error code %d", GetLastWaitError() );
+			Close();
+			return false;
+		}
+
+		_wakeUpHandle = eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC );
+		if ( _wakeUpHandle == SOCKET_ERROR )
+		{
+			LOG_ERROR( "Socket waiter error. Error while creating the wake up event. Error code %d",
+			           GetLastWaitError() );
+			Close();
+			return false;
+		}
+
+		struct epoll_event event;
+		event.events = EPOLLIN;
+		event.data.fd = _socketHandle;
+		if ( epoll_ctl( _epollHandle, EPOLL_CTL_ADD, _socketHandle, &event ) == SOCKET_ERROR )
+		{
+			LOG_ERROR( "Socket waiter error. Error while registering the socket. Error code %d", GetLastWaitError() );
+			Close();
+			return false;
+		}
+
+		// In io_uring mode the incoming datagrams are consumed by the ring, so it also has to wake up on completions
+		if ( socket._ioUringEngine != nullptr )
+		{
+			const int32 ringHandle = socket._ioUringEngine->GetRingHandle();
+			event.events = EPOLLIN;
+			event.data.fd = ringHandle;
+			if ( epoll_ctl( _epollHandle, EPOLL_CTL_ADD, ringHandle, &event ) == SOCKET_ERROR )
+			{
+				LOG_ERROR( "Socket waiter error. Error while registering the io_uring instance. Error code %d",
+				           GetLastWaitError() );
+				Close();
+				return false;
+			}
+		}
+
+		event.events = EPOLLIN;
+		event.data.fd = _timerHandle;
+		if ( epoll_ctl( _epollHandle, EPOLL_CTL_ADD, _timerHandle, &event ) == SOCKET_ERROR )
+		{
+			LOG_ERROR( "Socket waiter error. Error while registering the timer. Error code %d", GetLastWaitError() );
+			Close();
+			return false;
+		}
+
+		event.events = EPOLLIN;
+		event.data.fd = _wakeUpHandle;
+		if ( epoll_ctl( _epollHandle, EPOLL_CTL_ADD, _wakeUpHandle, &event ) == SOCKET_ERROR )
+		{
+			LOG_ERROR( "Socket waiter error. Error while registering the wake up event. Error code %d",
+			           GetLastWaitError() );
+			Close();
+			return false;
+		}
+#endif
+
+		return true;
+	}
+
+	SocketWaitResult SocketWaiter::Wait( float32 timeoutSeconds ) const
+	{
+		if ( !IsValid() )
+		{
+			return SocketWaitResult::SWR_ERR;
+		}
+
+#ifdef __linux__
+		int32 epollTimeout = 0;
+		if ( timeoutSeconds > 0.f )
+		{
+			// Arm the timer instead of using the epoll_wait timeout, which only has millisecond precision. Setting a new
+			// value also resets any expiration that has not been read yet
+			const float64 wholeSeconds = std::floor( static_cast< float64 >( timeoutSeconds ) );
+			struct itimerspec timerValue = {};
+			timerValue.it_value.tv_sec = static_cast< time_t >( wholeSeconds );
+			timerValue.it_value.tv_nsec = static_cast< long >( ( timeoutSeconds - wholeSeconds ) * 1e9 );
+			if ( timerValue.it_value.tv_sec == 0 && timerValue.it_value.tv_nsec == 0 )
+			{
+				// A zero value would disarm the timer
+				timerValue.it_value.tv_nsec = 1;
+			}
+
+			if ( timerfd_settime( _timerHandle, 0, &timerValue, nullptr ) == SOCKET_ERROR )
+			{
+				LOG_ERROR( "Socket waiter error. Error while arming the timer. Error code %d", GetLastWaitError() );
+				return SocketWaitResult::SWR_ERR;
+			}
+
+			epollTimeout = -1;
+		}
+
+		struct epoll_event events[ 4 ];
+		int32 numberOfEvents = 0;
+		do
+		{
+			numberOfEvents = epoll_wait( _epollHandle, events, 4, epollTimeout );
+		} while ( numberOfEvents == SOCKET_ERROR && GetLastWaitError() == EINTR );
+
+		if ( numberOfEvents == SOCKET_ERROR )
+		{
+			LOG_ERROR( "Socket waiter error. Error while waiting for events. Error code %d", GetLastWaitError() );
+			return SocketWaitResult::SWR_ERR;
+		}
+
+		bool isDataAvailable = false;
+		bool isWakeUpRequested = false;
+		for ( int32 i = 0; i < numberOfEvents; ++i )
+		{
+			if ( events[ i ].data.fd == _timerHandle )
+			{
+				// Consume the expiration so the timer doesn't keep waking up epoll
+				uint64 numberOfExpirations = 0;
+				read( _timerHandle, &numberOfExpirations, sizeof( numberOfExpirations ) );
+			}
+			else if ( events[ i ].data.fd == _wakeUpHandle )
+			{
+				uint64 numberOfWakeUps = 0;
+				read( _wakeUpHandle, &numberOfWakeUps, sizeof( numberOfWakeUps ) );
+				isWakeUpRequested = true;
+			}
+			else
+			{
+				// Either the socket or the io_uring instance
+				isDataAvailable = true;
+			}
+		}
+
+		if ( isDataAvailable )
+		{
+			return SocketWaitResult::SWR_DATA_AVAILABLE;
+		}
+
+		return isWakeUpRequested ? SocketWaitResult::SWR_WAKE_UP : SocketWaitResult::SWR_TIMEOUT;
+#else
+		fd_set readSet;
+		FD_ZERO( &readSet );
+		FD_SET( _socketHandle, &readSet );
+
+		struct timeval timeout = {};
+		if ( timeoutSeconds > 0.f )
+		{
+			const float64 wholeSeconds = std::floor( static_cast< float64 >( timeoutSeconds ) );
+			timeout.tv_sec = static_cast< long >( wholeSeconds );
+			timeout.tv_usec = static_cast< long >( ( timeoutSeconds - wholeSeconds ) * 1e6 );
+		}
+
+		// The first parameter is ignored by Winsock
+		const int32 result =
+		    select( static_cast< int32 >( _socketHandle ) + 1, &readSet, nullptr, nullptr, &timeout );
+		if ( result == SOCKET_ERROR )
+		{
+			LOG_ERROR( "Socket waiter error. Error while waiting for data. Error code %d", GetLastWaitError() );
+			return SocketWaitResult::SWR_ERR;
+		}
+
+		return ( result > 0 ) ? SocketWaitResult::SWR_DATA_AVAILABLE : SocketWaitResult::SWR_TIMEOUT;
+#endif
+	}
+
+	void SocketWaiter::WakeUp() const
+	{
+#ifdef __linux__
+		if ( _wakeUpHandle != -1 )
+		{
+			const uint64 value = 1;
+			write( _wakeUpHandle, &value, sizeof( value ) );
+		}
+#endif
+	}
+
+	void SocketWaiter::Close()
+	{
+#ifdef __linux__
+		if ( _wakeUpHandle != -1 )
+		{
+			close( _wakeUpHandle );
+			_wakeUpHandle = -1;
+		}
+
+		if ( _timerHandle != -1 )
+		{
+			close( _timerHandle );
+			_timerHandle = -1;
+		}
+
+		if ( _epollHandle != -1 )
+		{
+			close( _epollHandle );
+			_epollHandle = -1;
+		}
+#endif
+
+		// The socket is owned by the Socket class, just forget about it
+		_socketHandle = INVALID_SOCKET_HANDLE;
+	}
+
+	SocketWaiter::~SocketWaiter()
+	{
+		Close();
+	}
+
+	bool SocketWaiter::IsValid() const
+	{
+#ifdef __linux__
+		return _socketHandle != INVALID_SOCKET_HANDLE && _epollHandle != -1 && _timerHandle != -1 &&
+		       _wakeUpHandle != -1;
+#else
+		return _socketHandle != INVALID_SOCKET_HANDLE;
+#endif
+	}
+} // namespace NetLib
@@ -0,0 +1,57 @@
+#pragma once
+#include "numeric_types.h"
+
+#include "core/socket_platform.h"
+
+namespace NetLib
+{
+	class Socket;
+
+	enum SocketWaitResult : uint8
+	{
+		SWR_ERR = 0,
+		SWR_DATA_AVAILABLE = 1,
+		SWR_TIMEOUT = 2,
+		SWR_WAKE_UP = 3
+	};
+
+	/// <summary>
+	/// Blocks the calling thread until a socket has incoming data or a timeout expires. On Linux it relies on an epoll
+	/// instance watching both the socket and a timerfd, so the timeout has sub-millisecond precision. When the socket
+	/// uses io_uring, the ring is also watched. Other platforms fall back to select.
+	/// </summary>
+	class SocketWaiter
+	{
+		public:
+			SocketWaiter();
+			SocketWaiter( const SocketWaiter& ) = delete;
+
+			SocketWaiter& operator=( const SocketWaiter& ) = delete;
+
+			bool Start( const Socket& socket );
+			/// <summary>
+			/// Waits until the socket has data to read or the timeout expires, whatever happens first.
+			/// </summary>
+			/// <param name="timeoutSeconds">Maximum time to wait. If it is zero or negative this will only check if
+			/// there is data available without blocking</param>
+			SocketWaitResult Wait( float32 timeoutSeconds ) const;
+			/// <summary>
+			/// Makes a blocked Wait call, possibly from another thread, return SWR_WAKE_UP. This is only supported on
+			/// Linux. On other platforms Wait calls will keep blocking until data arrives or the timeout expires.
+			/// </summary>
+			void WakeUp() const;
+			void Close();
+
+			~SocketWaiter();
+
+		private:
+			bool IsValid() const;
+
+			SocketHandle _socketHandle;
+#ifdef __linux__
+			int32 _epollHandle;
+			int32 _timerHandle;
+			int32 _wakeUpHandle;
+#endif
+	};
+} // namespace NetLib
@@ -0,0 +1,46 @@
+#pragma once
+#include "numeric_types.h"
+
+#include "core/socket.h"
+
+namespace NetLib
+{
+	class Address;
+	class DatagramBatch;
+
+	/// <summary>
+	/// Moves datagrams between a peer and its remote peers. The default implementation is SocketTransport, which uses
+	/// a UDP socket. Other implementations, such as LoopbackTransport, can be passed to Peer::Start.
+	/// </summary>
+	class Transport
+	{
+		public:
+			Transport() = default;
+			Transport( const Transport& ) = delete;
+
+			Transport& operator=( const Transport& ) = delete;
+
+			/// <summary>
+			/// Prepares the transport for use. It is called by the peer before Bind.
+			/// </summary>
+			/// <param name="datagramMaxSize">Maximum size of an incoming datagram</param>
+			virtual bool Start( uint32 datagramMaxSize ) = 0;
+			virtual bool Bind( const Address& address ) = 0;
+			/// <summary>
+			/// Same contract as Socket::ReceiveFromBatch
+			/// </summary>
+			virtual SocketResult ReceiveFromBatch( DatagramBatch& batch, Address& remoteAddress ) = 0;
+			/// <summary>
+			/// Same contract as Socket::SendToBatch
+			/// </summary>
+			virtual SocketResult SendToBatch( const DatagramBatch& batch ) = 0;
+			/// <summary>
+			/// Blocks until there is incoming data or the timeout expires
+			/// </summary>
+			/// <returns>True if there is incoming data ready to be read, False otherwise</returns>
+			virtual bool WaitForIncomingData( float32 timeoutSeconds ) const = 0;
+			virtual void Close() = 0;
+
+			virtual ~Transport() {}
+	};
+} // namespace NetLib
@@ -0,0 +1,181 @@
+#include "fragment_reassembler.h"
+
+#include <cassert>
+#include <cstring>
+
+#include "logger.h"
+
+#include "core/buffer.h"
+#include "core/socket.h"
+
+#include "communication/message.h"
+#include "communication/message_factory.h"
+#include "communication/message_utils.h"
+
+namespace NetLib
+{
+	FragmentReassembler::FragmentReassembler()
+	    : _entries( MAX_NUMBER_OF_FRAGMENTED_MESSAGES_IN_PROGRESS )
+	    , _nextFragmentOrder( 0 )
+	    , _recentlyCompletedMessageIds()
+	    , _numberOfRecentlyCompletedMessages( 0 )
+	    , _nextRecentlyCompletedMessageIndex( 0 )
+	{
+	}
+
+	std::unique_ptr< Message > FragmentReassembler::AddFragment( const FragmentMessage& fragment )
+	{
+		if ( !IsFragmentValid( fragment ) )
+		{
+			LOG_WARNING( "Ignoring invalid fragment %hhu of fragmented message %hu", fragment.fragmentIndex,
+			             fragment.fragmentedMessageId );
+			return nullptr;
+		}
+
+		if ( IsFragmentedMessageRecentlyCompleted( fragment.fragmentedMessageId ) )
+		{
+			// Duplicated fragment of an already reassembled message
+			return nullptr;
+		}
+
+		FragmentedMessageEntry& entry = GetEntry( fragment );
+		if ( entry.receivedFragments[ fragment.fragmentIndex ] )
+		{
+			// Duplicated fragment
+			return nullptr;
+		}
+
+		const uint32 offset = fragment.fragmentIndex * GetFragmentStride( entry.messageSize, entry.numberOfFragments );
+		std::memcpy( entry.data.data() + offset, fragment.data, fragment.dataSize );
+		entry.receivedFragments[ fragment.fragmentIndex ] = true;
+		++entry.numberOfReceivedFragments;
+
+		if ( entry.numberOfReceivedFragments < entry.numberOfFragments )
+		{
+			return nullptr;
+		}
+
+		entry.isInUse = false;
+		_recentlyCompletedMessageIds[ _nextRecentlyCompletedMessageIndex ] = entry.fragmentedMessageId;
+		_nextRecentlyCompletedMessageIndex =
+		    ( _nextRecentlyCompletedMessageIndex + 1 ) % MAX_NUMBER_OF_FRAGMENTED_MESSAGES_IN_PROGRESS;
+		if ( _numberOfRecentlyCompletedMessages < MAX_NUMBER_OF_FRAGMENTED_MESSAGES_IN_PROGRESS )
+		{
+			++_numberOfRecentlyCompletedMessages;
+		}
+
+		// Messages read from a buffer without a packet buffer copy their payloads, so the entry can be reused now
+		Buffer buffer( entry.data.data(), static_cast< int32 >( entry.messageSize ) );
+		std::unique_ptr< Message > message = MessageUtils::ReadMessage( buffer );
+		if ( message != nullptr && message->GetHeader().type == MessageType::Fragment )
+		{
+			LOG_WARNING( "Ignoring fragmented message %hu since it contains another fragment",
+			             fragment.fragmentedMessageId );
+			MessageFactory::GetInstance().ReleaseMessage( std::move( message ) );
+			return nullptr;
+		}
+
+		return message;
+	}
+
+	void FragmentReassembler::Clear()
+	{
+		for ( uint32 i = 0; i < _entries.size(); ++i )
+		{
+			_entries[ i ].isInUse = false;
+		}
+
+		_numberOfRecentlyCompletedMessages = 0;
+		_nextRecentlyCompletedMessageIndex = 0;
+	}
+
+	uint32 FragmentReassembler::GetFragmentStride( uint32 messageSize, uint32 numberOfFragments )
+	{
+		assert( numberOfFragments > 0 );
+		return ( messageSize + numberOfFragments - 1 ) / numberOfFragments;
+	}
+
+	bool FragmentReassembler::IsFragmentValid( const FragmentMessage& fragment ) const
+	{
+		if ( fragment.numberOfFragments == 0 || fragment.fragmentIndex >= fragment.numberOfFragments ||
+		     fragment.messageSize == 0 || fragment.data == nullptr )
+		{
+			return false;
+		}
+
+		// Every fragment but the last one takes a whole stride, the last one takes what is left. Since fragments fit
+		// within a datagram, this also bounds the memory a remote peer can make us reserve
+		const uint32 stride = GetFragmentStride( fragment.messageSize, fragment.numberOfFragments );
+		const uint32 offset = fragment.fragmentIndex * stride;
+		if ( stride > MTU_SIZE_BYTES || offset >= fragment.messageSize )
+		{
+			return false;
+		}
+
+		const uint32 remainingSize = fragment.messageSize - offset;
+		const uint32 expectedSize = ( remainingSize < stride ) ? remainingSize : stride;
+		return fragment.dataSize == expectedSize;
+	}
+
+	bool FragmentReassembler::IsFragmentedMessageRecentlyCompleted( uint16 fragmentedMessageId ) const
+	{
+		for ( uint32 i = 0; i < _numberOfRecentlyCompletedMessages; ++i )
+		{
+			if ( _recentlyCompletedMessageIds[ i ] == fragmentedMessageId )
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	FragmentReassembler::FragmentedMessageEntry& FragmentReassembler::GetEntry( const FragmentMessage& fragment )
+	{
+		FragmentedMessageEntry* freeEntry = nullptr;
+		FragmentedMessageEntry* oldestEntry = nullptr;
+		for ( uint32 i = 0; i < _entries.size(); ++i )
+		{
+			FragmentedMessageEntry& entry = _entries[ i ];
+			if ( !entry.isInUse )
+			{
+				if ( freeEntry == nullptr )
+				{
+					freeEntry = &entry;
+				}
+
+				continue;
+			}
+
+			if ( entry.fragmentedMessageId == fragment.fragmentedMessageId &&
+			     entry.numberOfFragments == fragment.numberOfFragments && entry.messageSize == fragment.messageSize )
+			{
+				return entry;
+			}
+
+			if ( oldestEntry == nullptr || entry.firstFragmentOrder < oldestEntry->firstFragmentOrder )
+			{
+				oldestEntry = &entry;
+			}
+		}
+
+		FragmentedMessageEntry* entry = freeEntry;
+		if ( entry == nullptr )
+		{
+			LOG_INFO( "Dropping incomplete fragmented message %hu in order to make room for a new one",
+			          oldestEntry->fragmentedMessageId );
+			entry = oldestEntry;
+		}
+
+		entry->isInUse = true;
+		entry->fragmentedMessageId = fragment.fragmentedMessageId;
+		entry->numberOfFragments = fragment.numberOfFragments;
+		entry->numberOfReceivedFragments = 0;
+		entry->messageSize = fragment.messageSize;
+		entry->firstFragmentOrder = _nextFragmentOrder++;
+		entry->receivedFragments.assign( fragment.numberOfFragments, false );
+		// Resizing keeps the capacity, so entries stop allocating once they have seen the biggest message
+		entry->data.resize( fragment.messageSize );
+		return *entry;
+	}
+} // namespace NetLib
@@ -0,0 +1,78 @@
+#pragma once
+#include "numeric_types.h"
+
+#include <memory>
+#include <vector>
+
+namespace NetLib
+{
+	class Message;
+	class FragmentMessage;
+
+	// The number of fragments is stored in a single byte
+	constexpr uint32 MAX_NUMBER_OF_FRAGMENTS = 255;
+	// Maximum number of fragmented messages being reassembled at the same time per transmission channel
+	constexpr uint32 MAX_NUMBER_OF_FRAGMENTED_MESSAGES_IN_PROGRESS = 4;
+
+	/// <summary>
+	/// Puts fragmented messages back together. Fragments can arrive in any order and duplicated fragments are ignored.
+	/// If a fragment of a new message arrives while all the slots are busy, the oldest incomplete message gets dropped
+	/// as a whole, which is what happens to unreliable messages that lost some of their fragments. Slot buffers keep
+	/// their memory between messages, so once warmed up reassembling doesn't allocate.
+	/// </summary>
+	class FragmentReassembler
+	{
+		public:
+			FragmentReassembler();
+
+			/// <summary>
+			/// Stores the fragment data. The fragment is not needed after this call.
+			/// </summary>
+			/// <returns>The reassembled message if this was its last missing fragment, nullptr otherwise</returns>
+			std::unique_ptr< Message > AddFragment( const FragmentMessage& fragment );
+			void Clear();
+
+			/// <summary>
+			/// Distance in bytes between the start of two consecutive fragments. Every fragment but the last one
+			/// has this size.
+			/// </summary>
+			static uint32 GetFragmentStride( uint32 messageSize, uint32 numberOfFragments );
+
+		private:
+			struct FragmentedMessageEntry
+			{
+					FragmentedMessageEntry()
+					    : isInUse( false )
+					    , fragmentedMessageId( 0 )
+					    , numberOfFragments( 0 )
+					    , numberOfReceivedFragments( 0 )
+					    , messageSize( 0 )
+					    , firstFragmentOrder( 0 )
+					    , receivedFragments()
+					    , data()
+					{
+					}
+
+					bool isInUse;
+					uint16 fragmentedMessageId;
+					uint32 numberOfFragments;
+					uint32 numberOfReceivedFragments;
+					uint32 messageSize;
+					// Used for dropping the oldest message when all the entries are in use
+					uint64 firstFragmentOrder;
+					std::vector< bool > receivedFragments;
+					std::vector< uint8 > data;
+			};
+
+			bool IsFragmentValid( const FragmentMessage& fragment ) const;
+			FragmentedMessageEntry& GetEntry( const FragmentMessage& fragment );
+			bool IsFragmentedMessageRecentlyCompleted( uint16 fragmentedMessageId ) const;
+
+			std::vector< FragmentedMessageEntry > _entries;
+			uint64 _nextFragmentOrder;
+			// Late duplicated fragments of these messages are ignored instead of starting a new entry
+			uint16 _recentlyCompletedMessageIds[ MAX_NUMBER_OF_FRAGMENTED_MESSAGES_IN_PROGRESS ];
+			uint32 _numberOfRecentlyCompletedMessages;
+			uint32 _nextRecentlyCompletedMessageIndex;
+	};
+} // namespace NetLib
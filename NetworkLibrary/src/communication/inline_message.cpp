@@ -0,0 +1,134 @@
+#include "inline_message.h"
+
+#include <cassert>
+
+#include "core/buffer.h"
+
+namespace NetLib
+{
+	InlineMessage::InlineMessage( MessageType type )
+	    : connectionChallenge() // The biggest fields, so zeroing them zeroes every other one
+	    , _header( type, 0, false, false )
+	{
+		assert( IsInlineType( type ) );
+	}
+
+	InlineMessage::InlineMessage()
+	    : InlineMessage( MessageType::ConnectionRequest )
+	{
+	}
+
+	bool InlineMessage::IsInlineType( MessageType type )
+	{
+		switch ( type )
+		{
+			case MessageType::ConnectionRequest:
+			case MessageType::ConnectionAccepted:
+			case MessageType::ConnectionDenied:
+			case MessageType::ConnectionChallenge:
+			case MessageType::ConnectionChallengeResponse:
+			case MessageType::Disconnection:
+			case MessageType::TimeRequest:
+			case MessageType::TimeResponse:
+			case MessageType::PathMTUProbe:
+			case MessageType::PathMTUProbeResponse:
+			case MessageType::SnapshotAck:
+				return true;
+			default:
+				return false;
+		}
+	}
+
+	void InlineMessage::Write( Buffer& buffer ) const
+	{
+		_header.Write( buffer );
+
+		switch ( _header.type )
+		{
+			case MessageType::ConnectionRequest:
+				buffer.WriteLong( connectionRequest.clientSalt );
+				break;
+			case MessageType::ConnectionAccepted:
+				buffer.WriteLong( connectionAccepted.prefix );
+				buffer.WriteShort( connectionAccepted.clientIndexAssigned );
+				break;
+			case MessageType::ConnectionDenied:
+				buffer.WriteByte( connectionDenied.reason );
+				break;
+			case MessageType::ConnectionChallenge:
+				buffer.WriteLong( connectionChallenge.clientSalt );
+				buffer.WriteLong( connectionChallenge.serverSalt );
+				break;
+			case MessageType::ConnectionChallengeResponse:
+				buffer.WriteLong( connectionChallengeResponse.prefix );
+				break;
+			case MessageType::Disconnection:
+				buffer.WriteLong( disconnection.prefix );
+				buffer.WriteByte( disconnection.reason );
+				break;
+			case MessageType::TimeRequest:
+				buffer.WriteInteger( timeRequest.remoteTime );
+				break;
+			case MessageType::TimeResponse:
+				buffer.WriteInteger( timeResponse.remoteTime );
+				buffer.WriteInteger( timeResponse.serverTime );
+				break;
+			case MessageType::PathMTUProbe:
+				buffer.WriteShort( pathMTUProbe.probeId );
+				buffer.WriteShort( pathMTUProbe.paddingSize );
+				buffer.WriteZeros( pathMTUProbe.paddingSize );
+				break;
+			case MessageType::PathMTUProbeResponse:
+				buffer.WriteShort( pathMTUProbeResponse.probeId );
+				break;
+			case MessageType::SnapshotAck:
+				buffer.WriteShort( snapshotAck.snapshotSequenceNumber );
+				break;
+			default:
+				assert( false );
+				break;
+		}
+	}
+
+	uint32 InlineMessage::Size() const
+	{
+		uint32 fieldsSize = 0;
+		switch ( _header.type )
+		{
+			case MessageType::ConnectionRequest:
+			case MessageType::ConnectionChallengeResponse:
+				fieldsSize = sizeof( uint64 );
+				break;
+			case MessageType::ConnectionAccepted:
+				fieldsSize = sizeof( uint64 ) + sizeof( uint16 );
+				break;
+			case MessageType::ConnectionDenied:
+				fieldsSize = sizeof( uint8 );
+				break;
+			case MessageType::ConnectionChallenge:
+				fieldsSize = sizeof( uint64 ) * 2;
+				break;
+			case MessageType::Disconnection:
+				fieldsSize = sizeof( uint64 ) + sizeof( uint8 );
+				break;
+			case MessageType::TimeRequest:
+				fieldsSize = sizeof( uint32 );
+				break;
+			case MessageType::TimeResponse:
+				fieldsSize = sizeof( uint32 ) * 2;
+				break;
+			case MessageType::PathMTUProbe:
+				fieldsSize = sizeof( uint16 ) + sizeof( uint16 ) + pathMTUProbe.paddingSize;
+				break;
+			case MessageType::PathMTUProbeResponse:
+			case MessageType::SnapshotAck:
+				fieldsSize = sizeof( uint16 );
+				break;
+			default:
+				assert( false );
+				break;
+		}
+
+		return _header.Size() + fieldsSize;
+	}
+} // namespace NetLib
@@ -0,0 +1,121 @@
+#pragma once
+#include "numeric_types.h"
+
+#include "communication/message_header.h"
+
+namespace NetLib
+{
+	class Buffer;
+
+	/// <summary>
+	/// Value type for the messages whose fields have a fixed size (Connection, time, snapshot ack and path MTU ones).
+	/// Transmission channels store it inline within their rings instead of lending a pooled heap message, and it is
+	/// serialized by a switch on its type instead of virtual calls. It keeps the wire format of its Message class, so
+	/// receivers read it as usual.
+	/// </summary>
+	class InlineMessage
+	{
+		public:
+			struct ConnectionRequestFields
+			{
+					uint64 clientSalt;
+			};
+
+			struct ConnectionAcceptedFields
+			{
+					uint64 prefix;
+					uint16 clientIndexAssigned;
+			};
+
+			struct ConnectionDeniedFields
+			{
+					uint8 reason;
+			};
+
+			struct ConnectionChallengeFields
+			{
+					uint64 clientSalt;
+					uint64 serverSalt;
+			};
+
+			struct ConnectionChallengeResponseFields
+			{
+					uint64 prefix;
+			};
+
+			struct DisconnectionFields
+			{
+					uint64 prefix;
+					uint8 reason;
+			};
+
+			struct TimeRequestFields
+			{
+					uint32 remoteTime;
+			};
+
+			struct TimeResponseFields
+			{
+					uint32 remoteTime;
+					uint32 serverTime;
+			};
+
+			struct PathMTUProbeFields
+			{
+					uint16 probeId;
+					// Only its size is stored, the padding is written as zeros
+					uint16 paddingSize;
+			};
+
+			struct PathMTUProbeResponseFields
+			{
+					uint16 probeId;
+			};
+
+			struct SnapshotAckFields
+			{
+					uint16 snapshotSequenceNumber;
+			};
+
+			/// <summary>
+			/// Unreliable and unordered, as a lent message would be, and with all its fields set to zero.
+			/// </summary>
+			InlineMessage( MessageType type );
+			/// <summary>
+			/// Only meant for containers that need default constructible elements. Set a type before using it.
+			/// </summary>
+			InlineMessage();
+
+			static bool IsInlineType( MessageType type );
+
+			MessageHeader GetHeader() const { return _header; }
+			void SetHeaderPacketSequenceNumber( uint16 packetSequenceNumber )
+			{
+				_header.messageSequenceNumber = packetSequenceNumber;
+			}
+			void SetReliability( bool isReliable ) { _header.isReliable = isReliable; }
+			void SetOrdered( bool isOrdered ) { _header.isOrdered = isOrdered; }
+
+			void Write( Buffer& buffer ) const;
+			uint32 Size() const;
+
+			// Fields of the message. Only the ones matching its type are valid
+			union
+			{
+					ConnectionRequestFields connectionRequest;
+					ConnectionAcceptedFields connectionAccepted;
+					ConnectionDeniedFields connectionDenied;
+					ConnectionChallengeFields connectionChallenge;
+					ConnectionChallengeResponseFields connectionChallengeResponse;
+					DisconnectionFields disconnection;
+					TimeRequestFields timeRequest;
+					TimeResponseFields timeResponse;
+					PathMTUProbeFields pathMTUProbe;
+					PathMTUProbeResponseFields pathMTUProbeResponse;
+					SnapshotAckFields snapshotAck;
+			};
+
+		private:
+			MessageHeader _header;
+	};
+} // namespace NetLib
@@ -1,28 +1,117 @@
 #include "message.h"
 
+#include <cassert>
+#include <cstring>
+
 #include "logger.h"
 
 #include "core/buffer.h"
+#include "core/packet_buffer_pool.h"
+
+#include "replication/replication_action_type.h"
+
+#include "utils/bitwise_utils.h"
 
 namespace NetLib
 {
+	// Replication messages start with a byte holding the action and which of the optional fields follow
+	static constexpr uint8 REPLICATION_ACTION_MASK = 0x03;
+	static constexpr uint8 HAS_CONTROLLED_BY_PEER_ID_BIT_INDEX = 2;
+	static constexpr uint8 HAS_REPLICATED_CLASS_ID_BIT_INDEX = 3;
+	static constexpr uint8 HAS_DATA_BIT_INDEX = 4;
+	static constexpr uint8 IS_DELTA_COMPRESSED_BIT_INDEX = 5;
+
+	static bool TryReadVarShort( Buffer& buffer, uint16& value )
+	{
+		uint32 varInteger = 0;
+		if ( !buffer.TryReadVarInteger( varInteger ) || varInteger > 0xFFFF )
+		{
+			return false;
+		}
+
+		value = static_cast< uint16 >( varInteger );
+		return true;
+	}
+
+	bool Message::ReadPayload( Buffer& buffer, uint16& size, uint8*& payload )
+	{
+		if ( size == 0 )
+		{
+			return true;
+		}
+
+		uint8* view = nullptr;
+		if ( !buffer.TryReadDataView( size, view ) )
+		{
+			size = 0;
+			return false;
+		}
+
+		// The datagram might only get copied into a packet buffer now, so the view is taken from there
+		PacketBuffer* packetBuffer = buffer.AcquirePacketBuffer();
+		if ( packetBuffer != nullptr )
+		{
+			_payloadPacketBuffer = packetBuffer;
+			_payloadPacketBuffer->AddReference();
+			payload = buffer.GetData() + ( buffer.GetAccessIndex() - size );
+			return true;
+		}
+
+		payload = new uint8[ size ];
+		std::memcpy( payload, view, size );
+		return true;
+	}
+
+	void Message::SetSharedPayload( const std::shared_ptr< const std::vector< uint8 > >& sharedPayload, uint16& size,
+	                                uint8*& payload )
+	{
+		ReleasePayload( payload );
+		size = 0;
+		if ( sharedPayload == nullptr || sharedPayload->empty() )
+		{
+			return;
+		}
+
+		assert( sharedPayload->size() <= UINT16_MAX );
+		_sharedPayload = sharedPayload;
+		size = static_cast< uint16 >( sharedPayload->size() );
+		// Never written through, as every message sharing it would see the change
+		payload = const_cast< uint8* >( sharedPayload->data() );
+	}
+
+	void Message::ReleasePayload( uint8*& payload )
+	{
+		if ( _payloadPacketBuffer != nullptr )
+		{
+			_payloadPacketBuffer->RemoveReference();
+			_payloadPacketBuffer = nullptr;
+		}
+		else if ( _sharedPayload != nullptr )
+		{
+			_sharedPayload.reset();
+		}
+		else if ( payload != nullptr )
+		{
+			delete[] payload;
+		}
+
+		payload = nullptr;
+	}
+
 	void ConnectionRequestMessage::Write( Buffer& buffer ) const
 	{
 		_header.Write( buffer );
 		buffer.WriteLong( clientSalt );
 	}
 
-	void ConnectionRequestMessage::Read( Buffer& buffer )
+	bool ConnectionRequestMessage::Read( Buffer& buffer )
 	{
-		_header.type = MessageType::ConnectionRequest;
-		_header.ReadWithoutHeader( buffer );
-
-		clientSalt = buffer.ReadLong();
+		return _header.Read( buffer ) && buffer.TryReadLong( clientSalt );
 	}
 
 	uint32 ConnectionRequestMessage::Size() const
 	{
-		return MessageHeader::Size() + sizeof( uint64 );
+		return _header.Size() + sizeof( uint64 );
 	}
 
 	void ConnectionChallengeMessage::Write( Buffer& buffer ) const
@@ -32,18 +121,15 @@ namespace NetLib
 		buffer.WriteLong( serverSalt );
 	}
 
-	void ConnectionChallengeMessage::Read( Buffer& buffer )
+	bool ConnectionChallengeMessage::Read( Buffer& buffer )
 	{
-		_header.type = MessageType::ConnectionChallenge;
-		_header.ReadWithoutHeader( buffer );
-
-		clientSalt = buffer.ReadLong();
-		serverSalt = buffer.ReadLong();
+		return _header.Read( buffer ) && buffer.TryReadLong( clientSalt ) &&
+		       buffer.TryReadLong( serverSalt );
 	}
 
 	uint32 ConnectionChallengeMessage::Size() const
 	{
-		return MessageHeader::Size() + ( sizeof( uint64 ) * 2 );
+		return _header.Size() + ( sizeof( uint64 ) * 2 );
 	}
 
 	void ConnectionChallengeResponseMessage::Write( Buffer& buffer ) const
@@ -52,17 +138,14 @@ namespace NetLib
 		buffer.WriteLong( prefix );
 	}
 
-	void ConnectionChallengeResponseMessage::Read( Buffer& buffer )
+	bool ConnectionChallengeResponseMessage::Read( Buffer& buffer )
 	{
-		_header.type = MessageType::ConnectionChallengeResponse;
-		_header.ReadWithoutHeader( buffer );
-
-		prefix = buffer.ReadLong();
+		return _header.Read( buffer ) && buffer.TryReadLong( prefix );
 	}
 
 	uint32 ConnectionChallengeResponseMessage::Size() const
 	{
-		return MessageHeader::Size() + sizeof( uint64 );
+		return _header.Size() + sizeof( uint64 );
 	}
 
 	void ConnectionAcceptedMessage::Write( Buffer& buffer ) const
@@ -72,18 +155,15 @@ namespace NetLib
 		buffer.WriteShort( clientIndexAssigned );
 	}
 
-	void ConnectionAcceptedMessage::Read( Buffer& buffer )
+	bool ConnectionAcceptedMessage::Read( Buffer& buffer )
 	{
-		_header.type = MessageType::ConnectionAccepted;
-		_header.ReadWithoutHeader( buffer );
-
-		prefix = buffer.ReadLong();
-		clientIndexAssigned = buffer.ReadShort();
+		return _header.Read( buffer ) && buffer.TryReadLong( prefix ) &&
+		       buffer.TryReadShort( clientIndexAssigned );
 	}
 
 	uint32 ConnectionAcceptedMessage::Size() const
 	{
-		return MessageHeader::Size() + sizeof( uint64 ) + sizeof( uint16 );
+		return _header.Size() + sizeof( uint64 ) + sizeof( uint16 );
 	}
 
 	void ConnectionDeniedMessage::Write( Buffer& buffer ) const
@@ -92,16 +172,14 @@ namespace NetLib
 		buffer.WriteByte( reason );
 	}
 
-	void ConnectionDeniedMessage::Read( Buffer& buffer )
+	bool ConnectionDeniedMessage::Read( Buffer& buffer )
 	{
-		_header.type = MessageType::ConnectionDenied;
-		_header.ReadWithoutHeader( buffer );
-		reason = buffer.ReadByte();
+		return _header.Read( buffer ) && buffer.TryReadByte( reason );
 	}
 
 	uint32 ConnectionDeniedMessage::Size() const
 	{
-		return MessageHeader::Size() + sizeof( uint8 );
+		return _header.Size() + sizeof( uint8 );
 	}
 
 	void DisconnectionMessage::Write( Buffer& buffer ) const
@@ -111,18 +189,14 @@ namespace NetLib
 		buffer.WriteByte( reason );
 	}
 
-	void DisconnectionMessage::Read( Buffer& buffer )
+	bool DisconnectionMessage::Read( Buffer& buffer )
 	{
-		_header.type = MessageType::Disconnection;
-		_header.ReadWithoutHeader( buffer );
-
-		prefix = buffer.ReadLong();
-		reason = buffer.ReadByte();
+		return _header.Read( buffer ) && buffer.TryReadLong( prefix ) && buffer.TryReadByte( reason );
 	}
 
 	uint32 DisconnectionMessage::Size() const
 	{
-		return MessageHeader::Size() + sizeof( uint64 ) + sizeof( uint8 );
+		return _header.Size() + sizeof( uint64 ) + sizeof( uint8 );
 	}
 
 	void TimeRequestMessage::Write( Buffer& buffer ) const
@@ -131,17 +205,14 @@ namespace NetLib
 		buffer.WriteInteger( remoteTime );
 	}
 
-	void TimeRequestMessage::Read( Buffer& buffer )
+	bool TimeRequestMessage::Read( Buffer& buffer )
 	{
-		_header.type = MessageType::TimeRequest;
-		_header.ReadWithoutHeader( buffer );
-
-		remoteTime = buffer.ReadInteger();
+		return _header.Read( buffer ) && buffer.TryReadInteger( remoteTime );
 	}
 
 	uint32 TimeRequestMessage::Size() const
 	{
-		return MessageHeader::Size() + sizeof( uint32 );
+		return _header.Size() + sizeof( uint32 );
 	}
 
 	void TimeResponseMessage::Write( Buffer& buffer ) const
@@ -151,122 +222,309 @@ namespace NetLib
 		buffer.WriteInteger( serverTime );
 	}
 
-	void TimeResponseMessage::Read( Buffer& buffer )
+	bool TimeResponseMessage::Read( Buffer& buffer )
 	{
-		_header.type = MessageType::TimeResponse;
-		_header.ReadWithoutHeader( buffer );
-
-		remoteTime = buffer.ReadInteger();
-		serverTime = buffer.ReadInteger();
+		return _header.Read( buffer ) && buffer.TryReadInteger( remoteTime ) &&
+		       buffer.TryReadInteger( serverTime );
 	}
 
 	uint32 TimeResponseMessage::Size() const
 	{
-		return MessageHeader::Size() + ( 2 * sizeof( uint32 ) );
+		return _header.Size() + ( 2 * sizeof( uint32 ) );
 	}
 
 	void ReplicationMessage::Write( Buffer& buffer ) const
 	{
 		_header.Write( buffer );
-		buffer.WriteByte( replicationAction );
-		buffer.WriteInteger( networkEntityId );
-		buffer.WriteInteger( controlledByPeerId );
-		buffer.WriteInteger( replicatedClassId );
-		buffer.WriteShort( dataSize );
-		// TODO Create method called WriteData(data, size) in order to avoid this for loop
-		for ( uint16 i = 0; i < dataSize; ++i )
+
+		const uint8 actionAndFields = GetActionAndFields();
+		buffer.WriteByte( actionAndFields );
+		buffer.WriteVarInteger( networkEntityId );
+		if ( replicationAction == static_cast< uint8 >( ReplicationActionType::UPDATE ) )
+		{
+			buffer.WriteShort( snapshotSequenceNumber );
+			buffer.WriteByte( snapshotBaselineDistance );
+			buffer.WriteVarInteger( numberOfUpdatesInSnapshot );
+		}
+
+		if ( BitwiseUtils::GetBitAtIndex( actionAndFields, HAS_CONTROLLED_BY_PEER_ID_BIT_INDEX ) )
+		{
+			buffer.WriteVarInteger( controlledByPeerId );
+		}
+
+		if ( BitwiseUtils::GetBitAtIndex( actionAndFields, HAS_REPLICATED_CLASS_ID_BIT_INDEX ) )
+		{
+			buffer.WriteVarInteger( replicatedClassId );
+		}
+
+		if ( BitwiseUtils::GetBitAtIndex( actionAndFields, HAS_DATA_BIT_INDEX ) )
 		{
-			buffer.WriteByte( data[ i ] );
+			buffer.WriteVarInteger( dataSize );
+			buffer.WriteBytes( data, dataSize );
 		}
 	}
 
-	void ReplicationMessage::Read( Buffer& buffer )
+	bool ReplicationMessage::Read( Buffer& buffer )
 	{
-		_header.type = MessageType::Replication;
-		_header.ReadWithoutHeader( buffer );
+		// Elided fields are zero
+		controlledByPeerId = 0;
+		replicatedClassId = 0;
+		snapshotSequenceNumber = 0;
+		snapshotBaselineDistance = 0;
+		numberOfUpdatesInSnapshot = 0;
+		dataSize = 0;
 
-		replicationAction = buffer.ReadByte();
-		networkEntityId = buffer.ReadInteger();
-		controlledByPeerId = buffer.ReadInteger();
-		replicatedClassId = buffer.ReadInteger();
-		dataSize = buffer.ReadShort();
-		if ( dataSize > 0 )
+		uint8 actionAndFields = 0;
+		if ( !_header.Read( buffer ) || !buffer.TryReadByte( actionAndFields ) ||
+		     !buffer.TryReadVarInteger( networkEntityId ) )
 		{
-			data = new uint8[ dataSize ];
+			return false;
 		}
 
-		// TODO Create method called ReadData(uint8& data, size) in order to avoid this for loop
-		for ( uint16 i = 0; i < dataSize; ++i )
+		replicationAction = actionAndFields & REPLICATION_ACTION_MASK;
+		isDeltaCompressed = BitwiseUtils::GetBitAtIndex( actionAndFields, IS_DELTA_COMPRESSED_BIT_INDEX );
+		if ( replicationAction == static_cast< uint8 >( ReplicationActionType::UPDATE ) &&
+		     ( !buffer.TryReadShort( snapshotSequenceNumber ) || !buffer.TryReadByte( snapshotBaselineDistance ) ||
+		       !buffer.TryReadVarInteger( numberOfUpdatesInSnapshot ) ) )
 		{
-			data[ i ] = buffer.ReadByte();
+			return false;
 		}
+
+		if ( BitwiseUtils::GetBitAtIndex( actionAndFields, HAS_CONTROLLED_BY_PEER_ID_BIT_INDEX ) &&
+		     !buffer.TryReadVarInteger( controlledByPeerId ) )
+		{
+			return false;
+		}
+
+		if ( BitwiseUtils::GetBitAtIndex( actionAndFields, HAS_REPLICATED_CLASS_ID_BIT_INDEX ) &&
+		     !buffer.TryReadVarInteger( replicatedClassId ) )
+		{
+			return false;
+		}
+
+		if ( BitwiseUtils::GetBitAtIndex( actionAndFields, HAS_DATA_BIT_INDEX ) &&
+		     !TryReadVarShort( buffer, dataSize ) )
+		{
+			return false;
+		}
+
+		return ReadPayload( buffer, dataSize, data );
 	}
 
 	uint32 ReplicationMessage::Size() const
 	{
-		return MessageHeader::Size() + sizeof( uint8 ) + ( 3 * sizeof( uint32 ) ) + sizeof( uint16 ) +
-		       ( dataSize * sizeof( uint8 ) );
+		const uint8 actionAndFields = GetActionAndFields();
+		uint32 size = _header.Size() + sizeof( uint8 ) + Buffer::GetVarIntegerSize( networkEntityId );
+		if ( replicationAction == static_cast< uint8 >( ReplicationActionType::UPDATE ) )
+		{
+			size += sizeof( uint16 ) + sizeof( uint8 ) + Buffer::GetVarIntegerSize( numberOfUpdatesInSnapshot );
+		}
+
+		if ( BitwiseUtils::GetBitAtIndex( actionAndFields, HAS_CONTROLLED_BY_PEER_ID_BIT_INDEX ) )
+		{
+			size += Buffer::GetVarIntegerSize( controlledByPeerId );
+		}
+
+		if ( BitwiseUtils::GetBitAtIndex( actionAndFields, HAS_REPLICATED_CLASS_ID_BIT_INDEX ) )
+		{
+			size += Buffer::GetVarIntegerSize( replicatedClassId );
+		}
+
+		if ( BitwiseUtils::GetBitAtIndex( actionAndFields, HAS_DATA_BIT_INDEX ) )
+		{
+			size += Buffer::GetVarIntegerSize( dataSize ) + ( dataSize * sizeof( uint8 ) );
+		}
+
+		return size;
 	}
 
-	void ReplicationMessage::Reset()
+	uint8 ReplicationMessage::GetActionAndFields() const
 	{
-		if ( data != nullptr )
+		assert( ( replicationAction & REPLICATION_ACTION_MASK ) == replicationAction );
+
+		// Updates don't need the class, and destroys only need the entity ID. Zero fields are elided too
+		const ReplicationActionType action = static_cast< ReplicationActionType >( replicationAction );
+		const bool isCreate = ( action == ReplicationActionType::CREATE );
+		const bool isDestroy = ( action == ReplicationActionType::DESTROY );
+		const bool isUpdate = ( action == ReplicationActionType::UPDATE );
+
+		uint8 actionAndFields = replicationAction;
+		if ( !isDestroy && controlledByPeerId != 0 )
+		{
+			BitwiseUtils::SetBitAtIndex( actionAndFields, HAS_CONTROLLED_BY_PEER_ID_BIT_INDEX );
+		}
+
+		if ( isCreate && replicatedClassId != 0 )
+		{
+			BitwiseUtils::SetBitAtIndex( actionAndFields, HAS_REPLICATED_CLASS_ID_BIT_INDEX );
+		}
+
+		if ( !isDestroy && dataSize != 0 )
+		{
+			BitwiseUtils::SetBitAtIndex( actionAndFields, HAS_DATA_BIT_INDEX );
+		}
+
+		if ( isUpdate && isDeltaCompressed )
 		{
-			delete[] data;
-			data = nullptr;
+			BitwiseUtils::SetBitAtIndex( actionAndFields, IS_DELTA_COMPRESSED_BIT_INDEX );
 		}
+
+		return actionAndFields;
+	}
+
+	void ReplicationMessage::Reset()
+	{
+		ReleasePayload( data );
+		dataSize = 0;
+		snapshotSequenceNumber = 0;
+		snapshotBaselineDistance = 0;
+		numberOfUpdatesInSnapshot = 0;
+		isDeltaCompressed = false;
 	}
 
 	ReplicationMessage::~ReplicationMessage()
 	{
-		if ( data != nullptr )
-		{
-			delete[] data;
-			data = nullptr;
-		}
+		ReleasePayload( data );
 	}
 
 	void InputStateMessage::Write( Buffer& buffer ) const
 	{
 		_header.Write( buffer );
 
-		buffer.WriteShort( dataSize );
-		// TODO Create method called WriteData(data, size) in order to avoid this for loop
-		for ( uint32 i = 0; i < dataSize; ++i )
+		buffer.WriteVarInteger( dataSize );
+		buffer.WriteBytes( data, dataSize );
+	}
+
+	bool InputStateMessage::Read( Buffer& buffer )
+	{
+		if ( !_header.Read( buffer ) || !TryReadVarShort( buffer, dataSize ) )
 		{
-			buffer.WriteByte( data[ i ] );
+			dataSize = 0;
+			return false;
 		}
+
+		return ReadPayload( buffer, dataSize, data );
 	}
 
-	void InputStateMessage::Read( Buffer& buffer )
+	uint32 InputStateMessage::Size() const
 	{
-		_header.type = MessageType::Inputs;
-		_header.ReadWithoutHeader( buffer );
+		return _header.Size() + Buffer::GetVarIntegerSize( dataSize ) + ( dataSize * sizeof( uint8 ) );
+	}
 
-		dataSize = buffer.ReadShort();
-		if ( dataSize > 0 )
-		{
-			data = new uint8[ dataSize ];
-		}
+	void InputStateMessage::Reset()
+	{
+		ReleasePayload( data );
+		dataSize = 0;
+	}
 
-		// TODO Create method called ReadData(uint8& data, size) in order to avoid this for loop
-		for ( uint16 i = 0; i < dataSize; ++i )
+	InputStateMessage::~InputStateMessage()
+	{
+		ReleasePayload( data );
+	}
+
+	void FragmentMessage::Write( Buffer& buffer ) const
+	{
+		_header.Write( buffer );
+
+		buffer.WriteShort( fragmentedMessageId );
+		buffer.WriteByte( fragmentIndex );
+		buffer.WriteByte( numberOfFragments );
+		buffer.WriteVarInteger( messageSize );
+		buffer.WriteVarInteger( dataSize );
+		buffer.WriteBytes( data, dataSize );
+	}
+
+	bool FragmentMessage::Read( Buffer& buffer )
+	{
+		if ( !_header.Read( buffer ) || !buffer.TryReadShort( fragmentedMessageId ) ||
+		     !buffer.TryReadByte( fragmentIndex ) || !buffer.TryReadByte( numberOfFragments ) ||
+		     !buffer.TryReadVarInteger( messageSize ) || !TryReadVarShort( buffer, dataSize ) )
 		{
-			data[ i ] = buffer.ReadByte();
+			dataSize = 0;
+			return false;
 		}
+
+		return ReadPayload( buffer, dataSize, data );
 	}
 
-	uint32 InputStateMessage::Size() const
+	uint32 FragmentMessage::Size() const
 	{
-		return MessageHeader::Size() + sizeof( uint16 ) + ( dataSize * sizeof( uint8 ) );
+		return _header.Size() + sizeof( uint16 ) + ( 2 * sizeof( uint8 ) ) + Buffer::GetVarIntegerSize( messageSize ) +
+		       Buffer::GetVarIntegerSize( dataSize ) + ( dataSize * sizeof( uint8 ) );
 	}
 
-	void InputStateMessage::Reset()
+	uint32 FragmentMessage::GetHeaderSize()
+	{
+		return MessageHeader::MAX_SIZE + sizeof( uint16 ) + ( 2 * sizeof( uint8 ) ) +
+		       ( 2 * MAX_VAR_INTEGER_SIZE_BYTES );
+	}
+
+	void FragmentMessage::Reset()
+	{
+		ReleasePayload( data );
+		dataSize = 0;
+	}
+
+	FragmentMessage::~FragmentMessage()
+	{
+		ReleasePayload( data );
+	}
+
+	void PathMTUProbeMessage::Write( Buffer& buffer ) const
 	{
-		if ( data != nullptr )
+		_header.Write( buffer );
+
+		buffer.WriteShort( probeId );
+		buffer.WriteShort( paddingSize );
+		buffer.WriteZeros( paddingSize );
+	}
+
+	bool PathMTUProbeMessage::Read( Buffer& buffer )
+	{
+		if ( !_header.Read( buffer ) || !buffer.TryReadShort( probeId ) || !buffer.TryReadShort( paddingSize ) )
 		{
-			delete[] data;
-			data = nullptr;
+			return false;
 		}
+
+		// The padding only matters while travelling
+		uint8* padding = nullptr;
+		return buffer.TryReadDataView( paddingSize, padding );
+	}
+
+	uint32 PathMTUProbeMessage::Size() const
+	{
+		return GetHeaderSize() + ( paddingSize * sizeof( uint8 ) );
+	}
+
+	void PathMTUProbeResponseMessage::Write( Buffer& buffer ) const
+	{
+		_header.Write( buffer );
+		buffer.WriteShort( probeId );
+	}
+
+	bool PathMTUProbeResponseMessage::Read( Buffer& buffer )
+	{
+		return _header.Read( buffer ) && buffer.TryReadShort( probeId );
+	}
+
+	uint32 PathMTUProbeResponseMessage::Size() const
+	{
+		return _header.Size() + sizeof( uint16 );
+	}
+
+	void SnapshotAckMessage::Write( Buffer& buffer ) const
+	{
+		_header.Write( buffer );
+		buffer.WriteShort( snapshotSequenceNumber );
+	}
+
+	bool SnapshotAckMessage::Read( Buffer& buffer )
+	{
+		return _header.Read( buffer ) && buffer.TryReadShort( snapshotSequenceNumber );
+	}
+
+	uint32 SnapshotAckMessage::Size() const
+	{
+		return _header.Size() + sizeof( uint16 );
 	}
 } // namespace NetLib
@@ -1,10 +1,15 @@
 #pragma once
 #include "numeric_types.h"
 
+#include <memory>
+#include <vector>
+
 #include "communication/message_header.h"
 
 namespace NetLib
 {
+	class PacketBuffer;
+
 	class Message
 	{
 	public:
@@ -13,9 +18,10 @@ namespace NetLib
 		void SetReliability(bool isReliable) { _header.isReliable = isReliable; };
 		void SetOrdered(bool isOrdered) { _header.isOrdered = isOrdered; }
 
+		//Fields can be bit packed by wrapping the buffer within a BitWriter (and a BitReader in Read)
 		virtual void Write(Buffer& buffer) const = 0;
-		//Read it without the message header type
-		virtual void Read(Buffer& buffer) = 0;
+		//Read it including its header. Returns False if the buffer ends before the message does
+		virtual bool Read(Buffer& buffer) = 0;
 		virtual uint32 Size() const = 0;
 
 		//TODO Temp, until I find a better way to clean Replication's data field
@@ -24,9 +30,36 @@ namespace NetLib
 		virtual ~Message() {};
 
 	protected:
-		Message(MessageType messageType) : _header(messageType, 0, false, false) {};
+		Message(MessageType messageType) : _header(messageType, 0, false, false), _payloadPacketBuffer(nullptr), _sharedPayload(), _nextInPool(nullptr) {};
+
+		/// <summary>
+		/// Reads a payload of the given size. If the buffer belongs to a pooled packet buffer, the payload is a view
+		/// into it and the packet buffer is kept alive until ReleasePayload is called. Otherwise, the payload is copied
+		/// into a new allocation. If the buffer ends before the payload does, it returns False and sets size to zero.
+		/// </summary>
+		bool ReadPayload(Buffer& buffer, uint16& size, uint8*& payload);
+		/// <summary>
+		/// Makes the payload a view into an immutable buffer that other messages can share too. The buffer is kept
+		/// alive until ReleasePayload is called, and the payload must not be modified through the view.
+		/// </summary>
+		void SetSharedPayload(const std::shared_ptr<const std::vector<uint8>>& sharedPayload, uint16& size,
+			uint8*& payload);
+		const std::shared_ptr<const std::vector<uint8>>& GetSharedPayload() const { return _sharedPayload; }
+		/// <summary>
+		/// Frees a payload that was either read with ReadPayload, set with SetSharedPayload or allocated with new[] by
+		/// the message creator.
+		/// </summary>
+		void ReleasePayload(uint8*& payload);
 
 		MessageHeader _header;
+
+	private:
+		PacketBuffer* _payloadPacketBuffer;
+		std::shared_ptr<const std::vector<uint8>> _sharedPayload;
+		//Next free message within its MessageFactory pool. Only used while the message is not lent
+		Message* _nextInPool;
+
+		friend class MessageFactory;
 	};
 
 	class ConnectionRequestMessage : public Message
@@ -35,7 +68,7 @@ namespace NetLib
 		ConnectionRequestMessage() : clientSalt(0), Message(MessageType::ConnectionRequest) {}
 
 		void Write(Buffer& buffer) const override;
-		void Read(Buffer& buffer) override;
+		bool Read(Buffer& buffer) override;
 		uint32 Size() const override;
 
 		~ConnectionRequestMessage() override {};
@@ -49,7 +82,7 @@ namespace NetLib
 		ConnectionChallengeMessage() : clientSalt(0), serverSalt(0), Message(MessageType::ConnectionChallenge) {}
 
 		void Write(Buffer& buffer) const override;
-		void Read(Buffer& buffer) override;
+		bool Read(Buffer& buffer) override;
 		uint32 Size() const override;
 
 		~ConnectionChallengeMessage() override {};
@@ -64,7 +97,7 @@ namespace NetLib
 		ConnectionChallengeResponseMessage() : prefix(0), Message(MessageType::ConnectionChallengeResponse) {}
 
 		void Write(Buffer& buffer) const override;
-		void Read(Buffer& buffer) override;
+		bool Read(Buffer& buffer) override;
 		uint32 Size() const override;
 
 		~ConnectionChallengeResponseMessage() override {};
@@ -78,7 +111,7 @@ namespace NetLib
 		ConnectionAcceptedMessage() : prefix(0), clientIndexAssigned(0), Message(MessageType::ConnectionAccepted) {}
 
 		void Write(Buffer& buffer) const override;
-		void Read(Buffer& buffer) override;
+		bool Read(Buffer& buffer) override;
 		uint32 Size() const override;
 
 		~ConnectionAcceptedMessage() override {};
@@ -93,7 +126,7 @@ namespace NetLib
 		ConnectionDeniedMessage() : Message(MessageType::ConnectionDenied), reason(0) {}
 
 		void Write(Buffer& buffer) const override;
-		void Read(Buffer& buffer) override;
+		bool Read(Buffer& buffer) override;
 		uint32 Size() const override;
 
 		~ConnectionDeniedMessage() override {};
@@ -107,7 +140,7 @@ namespace NetLib
 		DisconnectionMessage() : prefix(0), reason(0), Message(MessageType::Disconnection) {}
 
 		void Write(Buffer& buffer) const override;
-		void Read(Buffer& buffer) override;
+		bool Read(Buffer& buffer) override;
 		uint32 Size() const override;
 
 		~DisconnectionMessage() override {};
@@ -122,7 +155,7 @@ namespace NetLib
 		TimeRequestMessage() : remoteTime(0), Message(MessageType::TimeRequest) {}
 
 		void Write(Buffer& buffer) const override;
-		void Read(Buffer& buffer) override;
+		bool Read(Buffer& buffer) override;
 		uint32 Size() const override;
 
 		~TimeRequestMessage() override {};
@@ -136,7 +169,7 @@ namespace NetLib
 		TimeResponseMessage() : remoteTime(0), serverTime(0), Message(MessageType::TimeResponse) {}
 
 		void Write(Buffer& buffer) const override;
-		void Read(Buffer& buffer) override;
+		bool Read(Buffer& buffer) override;
 		uint32 Size() const override;
 
 		~TimeResponseMessage() override {};
@@ -148,22 +181,48 @@ namespace NetLib
 	class ReplicationMessage : public Message
 	{
 	public:
-		ReplicationMessage() : replicationAction(0), networkEntityId(0), controlledByPeerId(0), replicatedClassId(0), dataSize(0), data(nullptr), Message(MessageType::Replication) {}
+		ReplicationMessage() : replicationAction(0), networkEntityId(0), controlledByPeerId(0), replicatedClassId(0), snapshotSequenceNumber(0), snapshotBaselineDistance(0), numberOfUpdatesInSnapshot(0), isDeltaCompressed(false), dataSize(0), data(nullptr), Message(MessageType::Replication) {}
 
 		void Write(Buffer& buffer) const override;
-		void Read(Buffer& buffer) override;
-		uint32 Size() const override; //TODO Make this also dynamic based on replication action. Now it is set to its worst case
+		bool Read(Buffer& buffer) override;
+		uint32 Size() const override;
 
 		void Reset() override;
 
+		//Shares data with other messages instead of copying it. GetSharedData returns null if data isn't shared
+		void SetSharedData(const std::shared_ptr<const std::vector<uint8>>& sharedData)
+		{
+			SetSharedPayload(sharedData, dataSize, data);
+		}
+		const std::shared_ptr<const std::vector<uint8>>& GetSharedData() const { return GetSharedPayload(); }
+
 		~ReplicationMessage() override;
 
 		uint8 replicationAction;
 		uint32 networkEntityId;
 		uint32 controlledByPeerId;
-		uint32 replicatedClassId; //TODO If replication action is update or destroy, we don't care about this one
-		uint16 dataSize; //TODO If replication action is destroy, we don't care about this one
-		uint8* data; //TODO Free this memory when calling MessageFactory::Release in order to avoid memory leaks
+		//Only sent within creates
+		uint32 replicatedClassId;
+		//Only sent within updates. The snapshot this update belongs to
+		uint16 snapshotSequenceNumber;
+		//Only sent within updates. How many snapshots behind is the baseline the snapshot is encoded against (Zero if
+		//there is no baseline)
+		uint8 snapshotBaselineDistance;
+		//Only sent within updates. The snapshot is complete once this number of updates has been received
+		uint32 numberOfUpdatesInSnapshot;
+		//Only sent within updates. If true, data is the delta between the entity state within the baseline and the
+		//current one
+		bool isDeltaCompressed;
+		//Not sent within destroys
+		uint16 dataSize;
+		// When read from a datagram or shared, it is a view into the datagram's packet buffer or the shared data. Either
+		// way, it gets freed on Reset
+		uint8* data;
+
+	private:
+		//Wire format (version 3): The action and which of the optional fields are sent. Fields that the action doesn't
+		//use or that are zero are elided, and the rest are var integers except for the snapshot ones
+		uint8 GetActionAndFields() const;
 	};
 
 	class InputStateMessage : public Message
@@ -172,12 +231,92 @@ namespace NetLib
 		InputStateMessage() : dataSize(0), data(nullptr), Message(MessageType::Inputs) {}
 
 		void Write(Buffer& buffer) const override;
-		void Read(Buffer& buffer) override;
+		bool Read(Buffer& buffer) override;
+		uint32 Size() const override;
+
+		void Reset() override;
+
+		~InputStateMessage() override;
+
+		uint16 dataSize;
+		uint8* data;
+	};
+
+	//Chunk of a message that doesn't fit within a single datagram. Fragments are sent through the same transmission
+	//channel as the original message, and FragmentReassembler puts them back together when received
+	class FragmentMessage : public Message
+	{
+	public:
+		FragmentMessage() : Message(MessageType::Fragment), fragmentedMessageId(0), fragmentIndex(0), numberOfFragments(0), messageSize(0), dataSize(0), data(nullptr) {}
+
+		void Write(Buffer& buffer) const override;
+		bool Read(Buffer& buffer) override;
 		uint32 Size() const override;
 
 		void Reset() override;
 
+		//Maximum size of a fragment without its data
+		static uint32 GetHeaderSize();
+
+		~FragmentMessage() override;
+
+		uint16 fragmentedMessageId;
+		uint8 fragmentIndex;
+		uint8 numberOfFragments;
+		//Size of the whole serialized message
+		uint32 messageSize;
 		uint16 dataSize;
 		uint8* data;
 	};
+
+	//Padded message used for finding out the biggest datagram that reaches a remote peer. It travels alone within its
+	//datagram, and its padding makes that datagram have the size being probed
+	class PathMTUProbeMessage : public Message
+	{
+	public:
+		PathMTUProbeMessage() : Message(MessageType::PathMTUProbe), probeId(0), paddingSize(0) {}
+
+		void Write(Buffer& buffer) const override;
+		bool Read(Buffer& buffer) override;
+		uint32 Size() const override;
+
+		//Size of a probe without its padding
+		uint32 GetHeaderSize() const { return _header.Size() + sizeof(uint16) + sizeof(uint16); }
+
+		~PathMTUProbeMessage() override {};
+
+		uint16 probeId;
+		uint16 paddingSize;
+	};
+
+	//Answer to a PathMTUProbeMessage. Receiving it means that the probed datagram size reaches the remote peer
+	class PathMTUProbeResponseMessage : public Message
+	{
+	public:
+		PathMTUProbeResponseMessage() : Message(MessageType::PathMTUProbeResponse), probeId(0) {}
+
+		void Write(Buffer& buffer) const override;
+		bool Read(Buffer& buffer) override;
+		uint32 Size() const override;
+
+		~PathMTUProbeResponseMessage() override {};
+
+		uint16 probeId;
+	};
+
+	//Sent by clients to let the server know that they have received all the updates of a snapshot, so it can be
+	//used as the baseline for the next ones
+	class SnapshotAckMessage : public Message
+	{
+	public:
+		SnapshotAckMessage() : Message(MessageType::SnapshotAck), snapshotSequenceNumber(0) {}
+
+		void Write(Buffer& buffer) const override;
+		bool Read(Buffer& buffer) override;
+		uint32 Size() const override;
+
+		~SnapshotAckMessage() override {};
+
+		uint16 snapshotSequenceNumber;
+	};
 }
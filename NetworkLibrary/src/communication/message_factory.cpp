@@ -6,26 +6,32 @@
 
 namespace NetLib
 {
-	MessageFactory* MessageFactory::_instance = nullptr;
+	std::atomic< MessageFactory* > MessageFactory::_instance( nullptr );
+	std::mutex MessageFactory::_instanceMutex;
+	uint64 MessageFactory::_nextInstanceId = 1;
 
 	void MessageFactory::CreateInstance( uint32 size )
 	{
-		if ( _instance != nullptr )
+		std::lock_guard< std::mutex > lock( _instanceMutex );
+		if ( _instance.load( std::memory_order_relaxed ) != nullptr )
 		{
 			return;
 		}
 
-		_instance = new MessageFactory( size );
+		_instance.store( new MessageFactory( size ), std::memory_order_release );
 	}
 
 	MessageFactory& MessageFactory::GetInstance()
 	{
-		return *_instance;
+		return *_instance.load( std::memory_order_acquire );
 	}
 
 	MessageFactory::MessageFactory( uint32 size )
+	    : _isInitialized( false )
+	    , _initialSize( size )
+	    , _id( _nextInstanceId++ )
+	    , _messagePools()
 	{
-		_initialSize = size;
 		InitializePools();
 		_isInitialized = true;
 	}
@@ -34,32 +40,59 @@ namespace NetLib
 	{
 		assert( _isInitialized == true );
 
-		std::unique_ptr< Message > message = nullptr;
-
-		std::queue< std::unique_ptr< Message > >* pool = GetPoolFromType( messageType );
-		if ( pool == nullptr )
+		if ( messageType >= NUMBER_OF_MESSAGE_TYPES )
 		{
+			LOG_ERROR( "Can't lend a message. Invalid message type" );
 			return nullptr;
 		}
 
-		if ( !pool->empty() )
+		MessagePool& pool = _messagePools[ messageType ];
+		FreeList& freeList = GetThreadCache().freeLists[ messageType ];
+		if ( freeList.head == nullptr )
+		{
+			// Take every free message of the shared pool at once
+			freeList.head = pool.sharedHead.exchange( nullptr, std::memory_order_acquire );
+			freeList.size = 0;
+			for ( const Message* it = freeList.head; it != nullptr; it = it->_nextInPool )
+			{
+				++freeList.size;
+			}
+		}
+
+		std::unique_ptr< Message > message = nullptr;
+		if ( freeList.head != nullptr )
 		{
-			message = std::move( pool->front() );
-			pool->pop();
+			Message* freeMessage = freeList.head;
+			freeList.head = freeMessage->_nextInPool;
+			--freeList.size;
+
+			freeMessage->_nextInPool = nullptr;
+			message.reset( freeMessage );
 		}
 		else
 		{
-			LOG_WARNING( "The message pool of type %hhu is empty. Creating a new message... Consider increasing pool "
-			             "size. Current init size: %u",
-			             messageType, _initialSize );
+			if ( pool.numberOfCreatedMessages.fetch_add( 1, std::memory_order_relaxed ) == 0 )
+			{
+				LOG_WARNING( "The message pool of type %hhu is empty. Creating new messages... Consider increasing "
+				             "pool size. Current init size: %u",
+				             messageType, _initialSize );
+			}
 
 			message = CreateMessage( messageType );
 		}
 
+		const uint32 numberOfLentMessages = pool.numberOfLentMessages.fetch_add( 1, std::memory_order_relaxed ) + 1;
+		uint32 maxNumberOfLentMessages = pool.maxNumberOfLentMessages.load( std::memory_order_relaxed );
+		while ( numberOfLentMessages > maxNumberOfLentMessages &&
+		        !pool.maxNumberOfLentMessages.compare_exchange_weak( maxNumberOfLentMessages, numberOfLentMessages,
+		                                                             std::memory_order_relaxed ) )
+		{
+		}
+
 		assert( message != nullptr );
 		assert( message->GetHeader().type == messageType );
 
-		return std::move( message );
+		return message;
 	}
 
 	void MessageFactory::ReleaseMessage( std::unique_ptr< Message > message )
@@ -70,71 +103,111 @@ namespace NetLib
 		message->Reset();
 
 		MessageType messageType = message->GetHeader().type;
-		std::queue< std::unique_ptr< Message > >* pool = GetPoolFromType( messageType );
-		if ( pool != nullptr )
+		if ( messageType >= NUMBER_OF_MESSAGE_TYPES )
 		{
-			pool->push( std::move( message ) );
+			return;
+		}
+
+		MessagePool& pool = _messagePools[ messageType ];
+		pool.numberOfLentMessages.fetch_sub( 1, std::memory_order_relaxed );
+
+		FreeList& freeList = GetThreadCache().freeLists[ messageType ];
+		Message* freeMessage = message.release();
+		freeMessage->_nextInPool = freeList.head;
+		freeList.head = freeMessage;
+		++freeList.size;
+
+		// Threads that release more than they lend would keep the messages that other threads need
+		if ( freeList.size > THREAD_CACHE_MAX_SIZE )
+		{
+			Message* first = freeList.head;
+			Message* last = first;
+			for ( uint32 i = 1; i < THREAD_CACHE_BATCH_SIZE; ++i )
+			{
+				last = last->_nextInPool;
+			}
+
+			freeList.head = last->_nextInPool;
+			freeList.size -= THREAD_CACHE_BATCH_SIZE;
+			PushToSharedPool( pool, first, last );
+		}
+	}
+
+	MessagePoolStats MessageFactory::GetPoolStats( MessageType messageType ) const
+	{
+		assert( messageType < NUMBER_OF_MESSAGE_TYPES );
+
+		const MessagePool& pool = _messagePools[ messageType ];
+		MessagePoolStats stats;
+		stats.initialSize = _initialSize;
+		stats.numberOfLentMessages = pool.numberOfLentMessages.load( std::memory_order_relaxed );
+		stats.maxNumberOfLentMessages = pool.maxNumberOfLentMessages.load( std::memory_order_relaxed );
+		stats.numberOfCreatedMessages = pool.numberOfCreatedMessages.load( std::memory_order_relaxed );
+		return stats;
+	}
+
+	void MessageFactory::LogPoolStats() const
+	{
+		for ( uint32 i = 0; i < NUMBER_OF_MESSAGE_TYPES; ++i )
+		{
+			const MessagePoolStats stats = GetPoolStats( static_cast< MessageType >( i ) );
+			if ( stats.numberOfCreatedMessages > 0 )
+			{
+				LOG_INFO( "The message pool of type %u created %u messages on demand. Up to %u of them were lent at "
+				          "the same time. Current init size: %u",
+				          i, stats.numberOfCreatedMessages, stats.maxNumberOfLentMessages, stats.initialSize );
+			}
 		}
 	}
 
 	void MessageFactory::DeleteInstance()
 	{
-		if ( _instance == nullptr )
+		std::lock_guard< std::mutex > lock( _instanceMutex );
+		MessageFactory* instance = _instance.load( std::memory_order_relaxed );
+		if ( instance == nullptr )
 		{
 			return;
 		}
 
-		delete _instance;
-		_instance = nullptr;
+		instance->LogPoolStats();
+		_instance.store( nullptr, std::memory_order_release );
+		delete instance;
 	}
 
 	MessageFactory::~MessageFactory()
 	{
-		for ( std::unordered_map< MessageType, std::queue< std::unique_ptr< Message > > >::iterator it =
-		          _messagePools.begin();
-		      it != _messagePools.end(); ++it )
+		for ( uint32 i = 0; i < NUMBER_OF_MESSAGE_TYPES; ++i )
 		{
-			ReleasePool( ( *it ).second );
+			ReleasePool( _messagePools[ i ] );
 		}
 
-		_messagePools.clear();
+		// The caches of other threads get emptied the next time they are used, or when their thread ends
+		ThreadCache& threadCache = GetRawThreadCache();
+		if ( threadCache.factoryId == _id )
+		{
+			for ( uint32 i = 0; i < NUMBER_OF_MESSAGE_TYPES; ++i )
+			{
+				DeleteFreeList( threadCache.freeLists[ i ] );
+			}
+
+			threadCache.factoryId = 0;
+		}
 	}
 
 	void MessageFactory::InitializePools()
 	{
-		_messagePools[ MessageType::ConnectionRequest ] = std::queue< std::unique_ptr< Message > >();
-		InitializePool( _messagePools[ MessageType::ConnectionRequest ], MessageType::ConnectionRequest );
-
-		_messagePools[ MessageType::ConnectionChallenge ] = std::queue< std::unique_ptr< Message > >();
-		InitializePool( _messagePools[ MessageType::ConnectionChallenge ], MessageType::ConnectionChallenge );
-
-		_messagePools[ MessageType::ConnectionChallengeResponse ] = std::queue< std::unique_ptr< Message > >();
-		InitializePool( _messagePools[ MessageType::ConnectionChallengeResponse ],
-		                MessageType::ConnectionChallengeResponse );
-
-		_messagePools[ MessageType::ConnectionAccepted ] = std::queue< std::unique_ptr< Message > >();
-		InitializePool( _messagePools[ MessageType::ConnectionAccepted ], MessageType::ConnectionAccepted );
-
-		_messagePools[ MessageType::ConnectionDenied ] = std::queue< std::unique_ptr< Message > >();
-		InitializePool( _messagePools[ MessageType::ConnectionDenied ], MessageType::ConnectionDenied );
-
-		_messagePools[ MessageType::Disconnection ] = std::queue< std::unique_ptr< Message > >();
-		InitializePool( _messagePools[ MessageType::Disconnection ], MessageType::Disconnection );
-
-		_messagePools[ MessageType::TimeRequest ] = std::queue< std::unique_ptr< Message > >();
-		InitializePool( _messagePools[ MessageType::TimeRequest ], MessageType::TimeRequest );
-
-		_messagePools[ MessageType::TimeResponse ] = std::queue< std::unique_ptr< Message > >();
-		InitializePool( _messagePools[ MessageType::TimeResponse ], MessageType::TimeResponse );
-
-		_messagePools[ MessageType::Replication ] = std::queue< std::unique_ptr< Message > >();
-		InitializePool( _messagePools[ MessageType::Replication ], MessageType::Replication );
-
-		_messagePools[ MessageType::Inputs ] = std::queue< std::unique_ptr< Message > >();
-		InitializePool( _messagePools[ MessageType::Inputs ], MessageType::Inputs );
+		for ( uint32 i = 0; i < NUMBER_OF_MESSAGE_TYPES; ++i )
+		{
+			MessagePool& pool = _messagePools[ i ];
+			pool.sharedHead = nullptr;
+			pool.numberOfLentMessages = 0;
+			pool.maxNumberOfLentMessages = 0;
+			pool.numberOfCreatedMessages = 0;
+			InitializePool( pool, static_cast< MessageType >( i ) );
+		}
 	}
 
-	void MessageFactory::InitializePool( std::queue< std::unique_ptr< Message > >& pool, MessageType messageType )
+	void MessageFactory::InitializePool( MessagePool& pool, MessageType messageType )
 	{
 		for ( uint32 i = 0; i < _initialSize; ++i )
 		{
@@ -142,24 +215,12 @@ namespace NetLib
 			assert( message != nullptr );
 			assert( message->GetHeader().type == messageType );
 
-			pool.push( std::move( message ) );
+			Message* freeMessage = message.release();
+			freeMessage->_nextInPool = pool.sharedHead.load( std::memory_order_relaxed );
+			pool.sharedHead.store( freeMessage, std::memory_order_relaxed );
 		}
 	}
 
-	std::queue< std::unique_ptr< Message > >* MessageFactory::GetPoolFromType( MessageType messageType )
-	{
-		std::queue< std::unique_ptr< Message > >* resultPool = nullptr;
-
-		std::unordered_map< MessageType, std::queue< std::unique_ptr< Message > > >::iterator it =
-		    _messagePools.find( messageType );
-		if ( it != _messagePools.end() )
-		{
-			resultPool = &( *it ).second;
-		}
-
-		return resultPool;
-	}
-
 	std::unique_ptr< Message > MessageFactory::CreateMessage( MessageType messageType )
 	{
 		std::unique_ptr< Message > resultMessage = nullptr;
@@ -196,19 +257,114 @@ namespace NetLib
 			case MessageType::Inputs:
 				resultMessage = std::make_unique< InputStateMessage >();
 				break;
+			case MessageType::Fragment:
+				resultMessage = std::make_unique< FragmentMessage >();
+				break;
+			case MessageType::PathMTUProbe:
+				resultMessage = std::make_unique< PathMTUProbeMessage >();
+				break;
+			case MessageType::PathMTUProbeResponse:
+				resultMessage = std::make_unique< PathMTUProbeResponseMessage >();
+				break;
+			case MessageType::SnapshotAck:
+				resultMessage = std::make_unique< SnapshotAckMessage >();
+				break;
 			default:
 				LOG_ERROR( "Can't create a new message. Invalid message type" );
 				break;
 		}
 
-		return std::move( resultMessage );
+		return resultMessage;
+	}
+
+	void MessageFactory::ReleasePool( MessagePool& pool )
+	{
+		FreeList freeList;
+		freeList.head = pool.sharedHead.exchange( nullptr, std::memory_order_acquire );
+		freeList.size = 0;
+		DeleteFreeList( freeList );
+	}
+
+	MessageFactory::ThreadCache& MessageFactory::GetThreadCache()
+	{
+		ThreadCache& threadCache = GetRawThreadCache();
+		if ( threadCache.factoryId != _id )
+		{
+			// They belong to a deleted instance, so nobody else is going to free them
+			for ( uint32 i = 0; i < NUMBER_OF_MESSAGE_TYPES; ++i )
+			{
+				DeleteFreeList( threadCache.freeLists[ i ] );
+			}
+
+			threadCache.factoryId = _id;
+		}
+
+		return threadCache;
+	}
+
+	MessageFactory::ThreadCache& MessageFactory::GetRawThreadCache()
+	{
+		thread_local ThreadCache threadCache;
+		return threadCache;
+	}
+
+	void MessageFactory::PushToSharedPool( MessagePool& pool, Message* first, Message* last )
+	{
+		Message* head = pool.sharedHead.load( std::memory_order_relaxed );
+		do
+		{
+			last->_nextInPool = head;
+		} while ( !pool.sharedHead.compare_exchange_weak( head, first, std::memory_order_release,
+		                                                  std::memory_order_relaxed ) );
+	}
+
+	void MessageFactory::DeleteFreeList( FreeList& freeList )
+	{
+		while ( freeList.head != nullptr )
+		{
+			Message* nextMessage = freeList.head->_nextInPool;
+			delete freeList.head;
+			freeList.head = nextMessage;
+		}
+
+		freeList.size = 0;
+	}
+
+	MessageFactory::ThreadCache::ThreadCache()
+	    : factoryId( 0 )
+	    , freeLists()
+	{
+		for ( uint32 i = 0; i < NUMBER_OF_MESSAGE_TYPES; ++i )
+		{
+			freeLists[ i ].head = nullptr;
+			freeLists[ i ].size = 0;
+		}
 	}
 
-	void MessageFactory::ReleasePool( std::queue< std::unique_ptr< Message > >& pool )
+	MessageFactory::ThreadCache::~ThreadCache()
 	{
-		while ( !pool.empty() )
+		// Thread ends are rare, so taking the lock here keeps the instance from being deleted meanwhile
+		std::lock_guard< std::mutex > lock( MessageFactory::_instanceMutex );
+		MessageFactory* factory = MessageFactory::_instance.load( std::memory_order_acquire );
+		const bool isFactoryAlive = ( factory != nullptr && factory->_id == factoryId );
+		for ( uint32 i = 0; i < NUMBER_OF_MESSAGE_TYPES; ++i )
 		{
-			pool.pop();
+			FreeList& freeList = freeLists[ i ];
+			if ( !isFactoryAlive || freeList.head == nullptr )
+			{
+				DeleteFreeList( freeList );
+				continue;
+			}
+
+			Message* last = freeList.head;
+			while ( last->_nextInPool != nullptr )
+			{
+				last = last->_nextInPool;
+			}
+
+			PushToSharedPool( factory->_messagePools[ i ], freeList.head, last );
+			freeList.head = nullptr;
+			freeList.size = 0;
 		}
 	}
 } // namespace NetLib
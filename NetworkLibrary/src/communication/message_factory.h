@@ -1,15 +1,32 @@
 #pragma once
-#include <queue>
-#include <unordered_map>
+#include <array>
+#include <atomic>
 #include <memory>
+#include <mutex>
 
 #include "communication/message.h"
 
 namespace NetLib
 {
+	//Usage of a message pool, useful for sizing the initial pools
+	struct MessagePoolStats
+	{
+		uint32 initialSize;
+		//Messages currently lent and not released yet
+		uint32 numberOfLentMessages;
+		//High-water mark of the lent messages. The pool never needs more than this
+		uint32 maxNumberOfLentMessages;
+		//Messages created on demand because there wasn't any free one
+		uint32 numberOfCreatedMessages;
+	};
+
 	class MessageFactory
 	{
 	public:
+		//Free messages a thread keeps for itself. Past it, a batch of them goes back to the shared pool
+		static constexpr uint32 THREAD_CACHE_MAX_SIZE = 64;
+		static constexpr uint32 THREAD_CACHE_BATCH_SIZE = 32;
+
 		static void CreateInstance(uint32 size);
 
 		/// <summary>
@@ -18,30 +35,84 @@ namespace NetLib
 		/// <returns></returns>
 		static MessageFactory& GetInstance();
 
+		/// <summary>
+		/// Lending and releasing messages is thread-safe and doesn't take any lock. Each thread keeps its own cache of
+		/// free messages, and only goes to the shared pool when the cache is empty or too big. Messages must not be
+		/// lent or released while the instance is being deleted.
+		/// </summary>
 		std::unique_ptr<Message> LendMessage(MessageType messageType);
 		void ReleaseMessage(std::unique_ptr<Message> message);
 
+		MessagePoolStats GetPoolStats(MessageType messageType) const;
+		/// <summary>
+		/// Logs the pools that had to create messages on demand, with their high-water mark of lent messages.
+		/// </summary>
+		void LogPoolStats() const;
+
+		/// <summary>
+		/// Logs the pool stats before deleting the instance. Threads ending meanwhile wait until it is deleted before
+		/// getting rid of their cached messages.
+		/// </summary>
 		static void DeleteInstance();
 
 	private:
+		//Stack of free messages linked through Message::_nextInPool
+		struct FreeList
+		{
+			Message* head;
+			uint32 size;
+		};
+
+		struct MessagePool
+		{
+			//Shared by every thread. Messages are pushed in batches and always popped all at once, which keeps the
+			//lock-free stack safe from the ABA problem
+			std::atomic<Message*> sharedHead;
+			std::atomic<uint32> numberOfLentMessages;
+			std::atomic<uint32> maxNumberOfLentMessages;
+			std::atomic<uint32> numberOfCreatedMessages;
+		};
+
+		struct ThreadCache
+		{
+			ThreadCache();
+			//Gives the free messages back to their factory when the thread ends
+			~ThreadCache();
+
+			//The factory instance the free messages belong to. Zero if none
+			uint64 factoryId;
+			std::array<FreeList, NUMBER_OF_MESSAGE_TYPES> freeLists;
+		};
+
 		MessageFactory(uint32 size);
 		MessageFactory(const MessageFactory&) = delete;
 
 		MessageFactory& operator=(const MessageFactory&) = delete;
 
 		void InitializePools();
-		void InitializePool(std::queue<std::unique_ptr<Message>>& pool, MessageType messageType);
-		std::queue<std::unique_ptr<Message>>* GetPoolFromType(MessageType messageType);
+		void InitializePool(MessagePool& pool, MessageType messageType);
 		std::unique_ptr<Message> CreateMessage(MessageType messageType);
-		void ReleasePool(std::queue<std::unique_ptr<Message>>& pool);
+		void ReleasePool(MessagePool& pool);
+
+		/// <summary>
+		/// Returns the cache of the calling thread, emptied first if its messages belong to a deleted instance.
+		/// </summary>
+		ThreadCache& GetThreadCache();
+		static ThreadCache& GetRawThreadCache();
+		static void PushToSharedPool(MessagePool& pool, Message* first, Message* last);
+		static void DeleteFreeList(FreeList& freeList);
 
 		~MessageFactory();
 
-		static MessageFactory* _instance;
+		static std::atomic< MessageFactory* > _instance;
+		//Keeps the instance alive while an ending thread gives its cached messages back to it
+		static std::mutex _instanceMutex;
+		static uint64 _nextInstanceId;
 
 		bool _isInitialized;
 		uint32 _initialSize;
+		uint64 _id;
 
-		std::unordered_map<MessageType, std::queue<std::unique_ptr<Message>>> _messagePools;
+		std::array<MessagePool, NUMBER_OF_MESSAGE_TYPES> _messagePools;
 	};
 }
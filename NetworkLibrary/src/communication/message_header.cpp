@@ -1,4 +1,5 @@
 #include "message_header.h"
+#include <cassert>
 
 #include "core/buffer.h"
 
@@ -8,34 +9,39 @@ namespace NetLib
 {
 	void MessageHeader::Write(Buffer& buffer) const
 	{
-		buffer.WriteByte(type);
-		buffer.WriteShort(messageSequenceNumber);
+		assert((type & TYPE_MASK) == type);
 
-		uint8 flags = 0;
+		uint8 typeAndFlags = type;
 		if (isReliable)
 		{
-			BitwiseUtils::SetBitAtIndex(flags, 0);
+			BitwiseUtils::SetBitAtIndex(typeAndFlags, IS_RELIABLE_BIT_INDEX);
 		}
 
 		if (isOrdered)
 		{
-			BitwiseUtils::SetBitAtIndex(flags, 1);
+			BitwiseUtils::SetBitAtIndex(typeAndFlags, IS_ORDERED_BIT_INDEX);
 		}
 
-		buffer.WriteByte(flags);
+		buffer.WriteByte(typeAndFlags);
+		if (HasSequenceNumber())
+		{
+			buffer.WriteShort(messageSequenceNumber);
+		}
 	}
 
-	void MessageHeader::Read(Buffer& buffer)
+	bool MessageHeader::Read(Buffer& buffer)
 	{
-		type = static_cast<MessageType>(buffer.ReadByte());
-		ReadWithoutHeader(buffer);
-	}
+		uint8 typeAndFlags = 0;
+		if (!buffer.TryReadByte(typeAndFlags))
+		{
+			return false;
+		}
 
-	void MessageHeader::ReadWithoutHeader(Buffer& buffer)
-	{
-		messageSequenceNumber = buffer.ReadShort();
-		uint8 flags = buffer.ReadByte();
-		isReliable = BitwiseUtils::GetBitAtIndex(flags, 0);
-		isOrdered = BitwiseUtils::GetBitAtIndex(flags, 1);
+		type = static_cast<MessageType>(typeAndFlags & TYPE_MASK);
+		isReliable = BitwiseUtils::GetBitAtIndex(typeAndFlags, IS_RELIABLE_BIT_INDEX);
+		isOrdered = BitwiseUtils::GetBitAtIndex(typeAndFlags, IS_ORDERED_BIT_INDEX);
+
+		messageSequenceNumber = 0;
+		return !HasSequenceNumber() || buffer.TryReadShort(messageSequenceNumber);
 	}
 }
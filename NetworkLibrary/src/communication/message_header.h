@@ -16,19 +16,34 @@ namespace NetLib
 		TimeRequest = 6,
 		TimeResponse = 7,
 		Replication = 8,
-		Inputs = 9
+		Inputs = 9,
+		Fragment = 10,
+		PathMTUProbe = 11,
+		PathMTUProbeResponse = 12,
+		SnapshotAck = 13
 	};
 
+	//Message types are dense, so they can index arrays. Keep it updated when adding a new type
+	constexpr uint32 NUMBER_OF_MESSAGE_TYPES = SnapshotAck + 1;
+
+	//Wire format (version 2): The type and the flags share the first byte. The sequence number follows it only if the
+	//message goes through an ordered or reliable channel, as the unreliable unordered one doesn't use it
 	struct MessageHeader
 	{
+		static constexpr uint8 TYPE_MASK = 0x1F;
+		static constexpr uint8 IS_RELIABLE_BIT_INDEX = 5;
+		static constexpr uint8 IS_ORDERED_BIT_INDEX = 6;
+		static constexpr uint32 MAX_SIZE = sizeof(uint8) + sizeof(uint16);
+
 		MessageHeader(MessageType messageType, uint16 packetSequenceNumber, bool isReliable, bool isOrdered) : type(messageType), messageSequenceNumber(packetSequenceNumber), isReliable(isReliable), isOrdered(isOrdered) {}
 
 		MessageHeader(const MessageHeader& other) : type(other.type), messageSequenceNumber(other.messageSequenceNumber), isReliable(other.isReliable), isOrdered(other.isOrdered) {}
 
 		void Write(Buffer& buffer) const;
-		void Read(Buffer& buffer);
-		void ReadWithoutHeader(Buffer& buffer);
-		static uint32 Size() { return sizeof(MessageType) + sizeof(uint16) + sizeof(uint8); }
+		//Returns False if the buffer ends before the header does
+		bool Read(Buffer& buffer);
+		bool HasSequenceNumber() const { return isReliable || isOrdered; }
+		uint32 Size() const { return HasSequenceNumber() ? MAX_SIZE : sizeof(uint8); }
 
 		~MessageHeader() {}
 
@@ -12,7 +12,15 @@ namespace NetLib
 	{
 		MessageFactory& messageFactory = MessageFactory::GetInstance();
 
-		MessageType type = static_cast< MessageType >( buffer.ReadByte() );
+		// The message reads its whole header, so only peek at the type
+		uint8 typeAndFlags = 0;
+		if ( !buffer.TryPeekByte( typeAndFlags ) )
+		{
+			LOG_WARNING( "Can't read message type, the buffer ends before it. Ignoring it..." );
+			return nullptr;
+		}
+
+		MessageType type = static_cast< MessageType >( typeAndFlags & MessageHeader::TYPE_MASK );
 		std::unique_ptr< Message > message = nullptr;
 
 		switch ( type )
@@ -47,13 +55,28 @@ namespace NetLib
 			case MessageType::Inputs:
 				message = messageFactory.LendMessage( MessageType::Inputs );
 				break;
+			case MessageType::Fragment:
+				message = messageFactory.LendMessage( MessageType::Fragment );
+				break;
+			case MessageType::PathMTUProbe:
+				message = messageFactory.LendMessage( MessageType::PathMTUProbe );
+				break;
+			case MessageType::PathMTUProbeResponse:
+				message = messageFactory.LendMessage( MessageType::PathMTUProbeResponse );
+				break;
+			case MessageType::SnapshotAck:
+				message = messageFactory.LendMessage( MessageType::SnapshotAck );
+				break;
 			default:
 				LOG_WARNING( "Can't read message of type MessageType = %hhu. Ignoring it...", type );
 		}
 
-		if ( message != nullptr )
+		if ( message != nullptr && !message->Read( buffer ) )
 		{
-			message->Read( buffer );
+			LOG_WARNING( "Can't read message of type MessageType = %hhu, the buffer ends before it. Ignoring it...",
+			             type );
+			messageFactory.ReleaseMessage( std::move( message ) );
+			message = nullptr;
 		}
 
 		return std::move( message );
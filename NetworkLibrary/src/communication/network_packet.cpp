@@ -2,6 +2,9 @@
 #include <cassert>
 
 #include "core/buffer.h"
+#include "core/socket.h"
+
+#include "utils/bitwise_utils.h"
 
 #include "communication/message.h"
 #include "communication/message_utils.h"
@@ -9,21 +12,79 @@
 
 namespace NetLib
 {
+	void NetworkDatagramHeader::Write(Buffer& buffer) const
+	{
+		assert(numberOfSections <= MAX_NUMBER_OF_SECTIONS);
+		buffer.WriteByte((WIRE_FORMAT_VERSION << WIRE_FORMAT_VERSION_SHIFT) | numberOfSections);
+	}
+
+	bool NetworkDatagramHeader::Read(Buffer& buffer)
+	{
+		uint8 versionAndNumberOfSections = 0;
+		if (!buffer.TryReadByte(versionAndNumberOfSections) ||
+			(versionAndNumberOfSections >> WIRE_FORMAT_VERSION_SHIFT) != WIRE_FORMAT_VERSION)
+		{
+			return false;
+		}
+
+		numberOfSections = versionAndNumberOfSections & NUMBER_OF_SECTIONS_MASK;
+		return true;
+	}
+
 	void NetworkPacketHeader::Write(Buffer& buffer) const
 	{
+		assert((channelType & CHANNEL_TYPE_MASK) == channelType);
+
+		uint8 channelTypeAndFlags = channelType;
+		if (!HasACKs())
+		{
+			buffer.WriteByte(channelTypeAndFlags);
+			return;
+		}
+
+		BitwiseUtils::SetBitAtIndex(channelTypeAndFlags, HAS_ACKS_BIT_INDEX);
+		buffer.WriteByte(channelTypeAndFlags);
 		buffer.WriteShort(lastAckedSequenceNumber);
-		buffer.WriteInteger(ackBits);
-		buffer.WriteByte(channelType);
+		buffer.WriteVarInteger(~ackBits);
 	}
 
-	void NetworkPacketHeader::Read(Buffer& buffer)
+	bool NetworkPacketHeader::Read(Buffer& buffer)
 	{
-		lastAckedSequenceNumber = buffer.ReadShort();
-		ackBits = buffer.ReadInteger();
-		channelType = buffer.ReadByte();
+		uint8 channelTypeAndFlags = 0;
+		if (!buffer.TryReadByte(channelTypeAndFlags))
+		{
+			return false;
+		}
+
+		channelType = channelTypeAndFlags & CHANNEL_TYPE_MASK;
+		lastAckedSequenceNumber = 0;
+		ackBits = 0;
+		if (!BitwiseUtils::GetBitAtIndex(channelTypeAndFlags, HAS_ACKS_BIT_INDEX))
+		{
+			return true;
+		}
+
+		uint32 invertedAckBits = 0;
+		if (!buffer.TryReadShort(lastAckedSequenceNumber) || !buffer.TryReadVarInteger(invertedAckBits))
+		{
+			return false;
+		}
+
+		ackBits = ~invertedAckBits;
+		return true;
+	}
+
+	uint32 NetworkPacketHeader::Size() const
+	{
+		if (!HasACKs())
+		{
+			return sizeof(uint8);
+		}
+
+		return sizeof(uint8) + sizeof(uint16) + Buffer::GetVarIntegerSize(~ackBits);
 	}
 
-	NetworkPacket::NetworkPacket() : _header(0, 0, 0), _defaultMTUSizeInBytes(1500)
+	NetworkPacket::NetworkPacket() : _header(0, 0, 0), _defaultMTUSizeInBytes(MAX_DATAGRAM_SIZE_BYTES)
 	{
 	}
 
@@ -51,20 +112,27 @@ namespace NetLib
 		}
 	}
 
-	void NetworkPacket::Read(Buffer& buffer)
+	bool NetworkPacket::Read(Buffer& buffer)
 	{
-		_header.Read(buffer);
-
-		uint8 numberOfMessages = buffer.ReadByte();
+		uint8 numberOfMessages = 0;
+		if (!_header.Read(buffer) || !buffer.TryReadByte(numberOfMessages))
+		{
+			return false;
+		}
 
 		for (uint32 i = 0; i < numberOfMessages; ++i)
 		{
 			std::unique_ptr<Message> message = MessageUtils::ReadMessage(buffer);
-			if (message != nullptr)
+			if (message == nullptr)
 			{
-				AddMessage(std::move(message));
+				//The size of what is left is unknown, so the rest of the packet can't be read
+				return false;
 			}
+
+			AddMessage(std::move(message));
 		}
+
+		return true;
 	}
 
 	bool NetworkPacket::AddMessage(std::unique_ptr<Message> message)
@@ -87,7 +155,7 @@ namespace NetLib
 
 	uint32 NetworkPacket::Size() const
 	{
-		uint32 packetSize = NetworkPacketHeader::Size();
+		uint32 packetSize = _header.Size();
 		packetSize += 1; //We store in 1 byte the number of messages that this packet contains
 
 		std::deque<std::unique_ptr<Message>>::const_iterator iterator = _messages.cbegin();
@@ -102,7 +170,8 @@ namespace NetLib
 
 	bool NetworkPacket::CanMessageFit(uint32 sizeOfMessagesInBytes) const
 	{
-		return (sizeOfMessagesInBytes + Size() < MaxSize());
+		//The packet is sent as the only section of a datagram
+		return (sizeOfMessagesInBytes + Size() + NetworkDatagramHeader::Size() < MaxSize());
 	}
 
 	NetworkPacket::~NetworkPacket()
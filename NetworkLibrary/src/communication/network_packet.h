@@ -4,20 +4,54 @@
 #include <deque>
 #include <memory>
 
+#include "core/buffer.h"
+
 namespace NetLib
 {
-	class Buffer;
 	class Message;
 
+	/// <summary>
+	/// Every datagram starts with this header. It is followed by one section per transmission channel with data to
+	/// send, and each of those sections has the layout of a NetworkPacket. This way, all the channels of a remote peer
+	/// share a single datagram and their ACKs piggyback on any data going out.
+	/// The wire format version is stored along with the number of sections, so datagrams from peers using a different
+	/// format are ignored instead of misread.
+	/// </summary>
+	struct NetworkDatagramHeader
+	{
+		static constexpr uint8 WIRE_FORMAT_VERSION = 3;
+		static constexpr uint8 WIRE_FORMAT_VERSION_SHIFT = 5;
+		static constexpr uint8 NUMBER_OF_SECTIONS_MASK = 0x1F;
+		static constexpr uint32 MAX_NUMBER_OF_SECTIONS = NUMBER_OF_SECTIONS_MASK;
+
+		NetworkDatagramHeader() : numberOfSections(0) {}
+		NetworkDatagramHeader(uint8 number_of_sections) : numberOfSections(number_of_sections) {}
+
+		void Write(Buffer& buffer) const;
+		//Returns False if the buffer is empty or if the datagram uses another wire format version
+		bool Read(Buffer& buffer);
+
+		static uint32 Size() { return sizeof(uint8); };
+
+		uint8 numberOfSections;
+	};
+
+	//Wire format (version 2): The channel type and whether there are ACKs share the first byte. Channels without ACKs
+	//to send elide them. The ACK bits are sent inverted as a var integer, so a window without losses takes one byte
 	struct NetworkPacketHeader
 	{
+		static constexpr uint8 CHANNEL_TYPE_MASK = 0x0F;
+		static constexpr uint8 HAS_ACKS_BIT_INDEX = 4;
+		static constexpr uint32 MAX_SIZE = sizeof(uint8) + sizeof(uint16) + MAX_VAR_INTEGER_SIZE_BYTES;
+
 		NetworkPacketHeader() : lastAckedSequenceNumber(0), ackBits(0), channelType(0) {}
 		NetworkPacketHeader(uint16 ack, uint32 ack_bits, uint8 channel_type) : lastAckedSequenceNumber(ack), ackBits(ack_bits), channelType(channel_type) {}
 
 		void Write(Buffer& buffer) const;
-		void Read(Buffer& buffer);
+		bool Read(Buffer& buffer);
 
-		static uint32 Size() { return sizeof(uint16) + sizeof(uint32) + sizeof(uint8); };
+		bool HasACKs() const { return lastAckedSequenceNumber != 0 || ackBits != 0; }
+		uint32 Size() const;
 
 		void SetACKs(uint32 acks) { ackBits = acks; };
 		void SetHeaderLastAcked(uint16 lastAckedMessage) { lastAckedSequenceNumber = lastAckedMessage; };
@@ -31,7 +65,6 @@ namespace NetLib
 	class NetworkPacket
 	{
 	public:
-		//NetworkPacket() : _defaultMTUSizeInBytes(1500) {};
 		NetworkPacket();
 		NetworkPacket(const NetworkPacket&) = delete;
 		NetworkPacket(NetworkPacket&& other) noexcept = default;
@@ -40,7 +73,9 @@ namespace NetLib
 		NetworkPacket& operator=(NetworkPacket&& other) noexcept;
 
 		void Write(Buffer& buffer) const;
-		void Read(Buffer& buffer);
+		//Returns False if the buffer ends before the packet does or if it contains an unknown message. The messages
+		//read until then are kept
+		bool Read(Buffer& buffer);
 
 		const NetworkPacketHeader& GetHeader() const { return _header; };
 
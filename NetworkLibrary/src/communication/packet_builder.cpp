@@ -0,0 +1,131 @@
+#include "packet_builder.h"
+
+#include <cassert>
+
+#include "core/buffer.h"
+
+#include "communication/message.h"
+#include "communication/inline_message.h"
+#include "communication/network_packet.h"
+
+namespace NetLib
+{
+	// The number of messages per section is stored in a single byte
+	static constexpr uint32 MAX_NUMBER_OF_MESSAGES_PER_SECTION = 255;
+
+	static uint32 GetSectionHeaderMaxSize()
+	{
+		return NetworkPacketHeader::MAX_SIZE + sizeof( uint8 );
+	}
+
+	PacketBuilder::PacketBuilder()
+	    : _data( nullptr )
+	    , _maxSize( 0 )
+	    , _size( 0 )
+	    , _numberOfSections( 0 )
+	    , _numberOfMessages( 0 )
+	    , _isSectionOpen( false )
+	    , _sectionNumberOfMessagesOffset( 0 )
+	    , _numberOfSectionMessages( 0 )
+	{
+	}
+
+	void PacketBuilder::Begin( uint8* data, uint32 maxSize )
+	{
+		assert( data != nullptr );
+		assert( maxSize > NetworkDatagramHeader::Size() + GetSectionHeaderMaxSize() );
+
+		_data = data;
+		_maxSize = maxSize;
+		_size = NetworkDatagramHeader::Size();
+		_numberOfSections = 0;
+		_numberOfMessages = 0;
+		_isSectionOpen = false;
+	}
+
+	bool PacketBuilder::CanSectionFit() const
+	{
+		return _numberOfSections < NetworkDatagramHeader::MAX_NUMBER_OF_SECTIONS &&
+		       ( _size + GetSectionHeaderMaxSize() < _maxSize );
+	}
+
+	void PacketBuilder::BeginSection( const NetworkPacketHeader& header )
+	{
+		assert( _data != nullptr );
+		assert( !_isSectionOpen );
+		assert( CanSectionFit() );
+
+		Buffer buffer( _data + _size, static_cast< int32 >( _maxSize - _size ) );
+		header.Write( buffer );
+
+		// The number of messages goes right after the header, and it is filled in when the section ends
+		_isSectionOpen = true;
+		_sectionNumberOfMessagesOffset = _size + buffer.GetAccessIndex();
+		_numberOfSectionMessages = 0;
+		_size = _sectionNumberOfMessagesOffset + sizeof( uint8 );
+	}
+
+	bool PacketBuilder::CanMessageFit( uint32 messageSize ) const
+	{
+		// Same criteria as NetworkPacket::CanMessageFit
+		return _isSectionOpen && _numberOfSectionMessages < MAX_NUMBER_OF_MESSAGES_PER_SECTION &&
+		       ( _size + messageSize < _maxSize );
+	}
+
+	void PacketBuilder::AddMessage( const Message& message )
+	{
+		assert( CanMessageFit( message.Size() ) );
+
+		Buffer buffer( _data + _size, static_cast< int32 >( _maxSize - _size ) );
+		message.Write( buffer );
+
+		_size += buffer.GetAccessIndex();
+		++_numberOfSectionMessages;
+		++_numberOfMessages;
+	}
+
+	void PacketBuilder::AddMessage( const InlineMessage& message )
+	{
+		assert( CanMessageFit( message.Size() ) );
+
+		Buffer buffer( _data + _size, static_cast< int32 >( _maxSize - _size ) );
+		message.Write( buffer );
+
+		_size += buffer.GetAccessIndex();
+		++_numberOfSectionMessages;
+		++_numberOfMessages;
+	}
+
+	void PacketBuilder::EndSection()
+	{
+		assert( _isSectionOpen );
+
+		_data[ _sectionNumberOfMessagesOffset ] = static_cast< uint8 >( _numberOfSectionMessages );
+
+		_isSectionOpen = false;
+		++_numberOfSections;
+	}
+
+	uint32 PacketBuilder::Finish()
+	{
+		assert( _data != nullptr );
+		assert( !_isSectionOpen );
+
+		Buffer buffer( _data, static_cast< int32 >( NetworkDatagramHeader::Size() ) );
+		const NetworkDatagramHeader datagramHeader( static_cast< uint8 >( _numberOfSections ) );
+		datagramHeader.Write( buffer );
+
+		const uint32 datagramSize = _size;
+		_data = nullptr;
+		_maxSize = 0;
+		_size = 0;
+
+		return datagramSize;
+	}
+
+	uint32 PacketBuilder::GetMaxMessageSize( uint32 datagramMaxSize )
+	{
+		// The message must fit alone within a single section, and CanMessageFit requires some space to be left
+		return datagramMaxSize - NetworkDatagramHeader::Size() - GetSectionHeaderMaxSize() - 1;
+	}
+} // namespace NetLib
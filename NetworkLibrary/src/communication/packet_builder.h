@@ -0,0 +1,77 @@
+#pragma once
+#include "numeric_types.h"
+
+namespace NetLib
+{
+	class Message;
+	class InlineMessage;
+	struct NetworkPacketHeader;
+
+	/// <summary>
+	/// Serializes an outgoing datagram straight into its memory. A datagram holds one section per transmission channel
+	/// (See NetworkDatagramHeader). Messages are written as they are added and the size is tracked as they go, so
+	/// checking if a message fits is O(1) and nothing gets allocated. Section headers are written when the section
+	/// begins, and only their number of messages is filled in when the section ends.
+	/// </summary>
+	class PacketBuilder
+	{
+		public:
+			PacketBuilder();
+			PacketBuilder( const PacketBuilder& ) = delete;
+
+			PacketBuilder& operator=( const PacketBuilder& ) = delete;
+
+			/// <summary>
+			/// Starts a new datagram. The memory must remain valid until Finish is called.
+			/// </summary>
+			/// <param name="data">Memory where the datagram will be serialized</param>
+			/// <param name="maxSize">Maximum size of the datagram in bytes</param>
+			void Begin( uint8* data, uint32 maxSize );
+			bool CanSectionFit() const;
+			/// <summary>
+			/// Writes the section header. Its size depends on its ACKs, so they must be known before adding messages.
+			/// </summary>
+			void BeginSection( const NetworkPacketHeader& header );
+			bool CanMessageFit( uint32 messageSize ) const;
+			/// <summary>
+			/// Serializes the message right after the previous one within the current section. The message is not
+			/// needed after this call.
+			/// </summary>
+			void AddMessage( const Message& message );
+			/// <summary>
+			/// Same as above for a fixed-size message stored by value
+			/// </summary>
+			void AddMessage( const InlineMessage& message );
+			/// <summary>
+			/// Writes the number of messages of the section in front of them
+			/// </summary>
+			void EndSection();
+			/// <summary>
+			/// Writes the datagram header
+			/// </summary>
+			/// <returns>The final datagram size in bytes</returns>
+			uint32 Finish();
+
+			/// <summary>
+			/// Size of the biggest message that fits within a datagram of the given size. Bigger messages must be
+			/// fragmented.
+			/// </summary>
+			static uint32 GetMaxMessageSize( uint32 datagramMaxSize );
+
+			uint32 GetSize() const { return _size; }
+			uint32 GetNumberOfSections() const { return _numberOfSections; }
+			uint32 GetNumberOfMessages() const { return _numberOfMessages; }
+
+		private:
+			uint8* _data;
+			uint32 _maxSize;
+			uint32 _size;
+			uint32 _numberOfSections;
+			uint32 _numberOfMessages;
+
+			// Current section
+			bool _isSectionOpen;
+			uint32 _sectionNumberOfMessagesOffset;
+			uint32 _numberOfSectionMessages;
+	};
+} // namespace NetLib
@@ -8,7 +8,14 @@ namespace NetLib
 	class IInputState
 	{
 		public:
+			/// <summary>
+			/// Returns the number of bytes written by Serialize
+			/// </summary>
 			virtual int32 GetSize() const = 0;
+			/// <summary>
+			/// The buffer can be wrapped within a BitWriter in order to bit pack bools, bounded integers and quantized
+			/// floats. Deserialize must read them back with a BitReader.
+			/// </summary>
 			virtual void Serialize( Buffer& buffer ) const = 0;
 			virtual void Deserialize( Buffer& buffer ) = 0;
 	};
@@ -0,0 +1,83 @@
+#include "delta_compression.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include "core/bit_reader.h"
+#include "core/bit_writer.h"
+#include "core/buffer.h"
+
+namespace NetLib
+{
+	// The last word of a state can be shorter than a whole word
+	static uint32 LoadWord( const uint8* bytes, uint32 numberOfBytes )
+	{
+		uint32 word = 0;
+		for ( uint32 i = 0; i < numberOfBytes; ++i )
+		{
+			word |= static_cast< uint32 >( bytes[ i ] ) << ( i * 8 );
+		}
+
+		return word;
+	}
+
+	static void StoreWord( uint32 word, uint8* bytes, uint32 numberOfBytes )
+	{
+		for ( uint32 i = 0; i < numberOfBytes; ++i )
+		{
+			bytes[ i ] = static_cast< uint8 >( word >> ( i * 8 ) );
+		}
+	}
+
+	bool DeltaCompression::CanCompress( const std::vector< uint8 >& baseline, uint32 stateSize )
+	{
+		return stateSize > 0 && baseline.size() == stateSize;
+	}
+
+	uint32 DeltaCompression::GetMaxCompressedSize( uint32 stateSize )
+	{
+		// One bit per word plus every word changed
+		return ( GetNumberOfWords( stateSize ) + ( stateSize * 8 ) + 7 ) / 8;
+	}
+
+	void DeltaCompression::Compress( const std::vector< uint8 >& baseline, const uint8* state, uint32 stateSize,
+	                                 Buffer& buffer )
+	{
+		assert( CanCompress( baseline, stateSize ) );
+
+		BitWriter writer( buffer );
+		for ( uint32 offset = 0; offset < stateSize; offset += WORD_SIZE )
+		{
+			const uint32 numberOfBytes = std::min( WORD_SIZE, stateSize - offset );
+			const bool hasChanged = std::memcmp( state + offset, baseline.data() + offset, numberOfBytes ) != 0;
+			writer.WriteBool( hasChanged );
+			if ( hasChanged )
+			{
+				writer.WriteBits( LoadWord( state + offset, numberOfBytes ), numberOfBytes * 8 );
+			}
+		}
+
+		writer.Flush();
+	}
+
+	bool DeltaCompression::Decompress( const std::vector< uint8 >& baseline, Buffer& buffer,
+	                                   std::vector< uint8 >& state )
+	{
+		const uint32 stateSize = static_cast< uint32 >( baseline.size() );
+		state.assign( baseline.cbegin(), baseline.cend() );
+
+		BitReader reader( buffer );
+		for ( uint32 offset = 0; offset < stateSize; offset += WORD_SIZE )
+		{
+			const uint32 numberOfBytes = std::min( WORD_SIZE, stateSize - offset );
+			if ( reader.ReadBool() )
+			{
+				StoreWord( reader.ReadBits( numberOfBytes * 8 ), state.data() + offset, numberOfBytes );
+			}
+		}
+
+		reader.Finish();
+		return !reader.HasFailed();
+	}
+} // namespace NetLib
@@ -0,0 +1,39 @@
+#pragma once
+#include "numeric_types.h"
+
+#include <vector>
+
+namespace NetLib
+{
+	class Buffer;
+
+	/// <summary>
+	/// Encodes a serialized entity state relative to a baseline state of the same size. The state is split into 32 bit
+	/// words, and each of them takes a single bit if it hasn't changed since the baseline. Changed words are sent
+	/// after their bit.
+	/// </summary>
+	class DeltaCompression
+	{
+		public:
+			static constexpr uint32 WORD_SIZE = sizeof( uint32 );
+
+			/// <summary>
+			/// States can only be delta compressed against baselines of their same size.
+			/// </summary>
+			static bool CanCompress( const std::vector< uint8 >& baseline, uint32 stateSize );
+
+			static uint32 GetMaxCompressedSize( uint32 stateSize );
+
+			static void Compress( const std::vector< uint8 >& baseline, const uint8* state, uint32 stateSize,
+			                      Buffer& buffer );
+
+			/// <summary>
+			/// Rebuilds the state from its baseline and the delta stored within the buffer. Returns False if the
+			/// buffer ends before the delta does.
+			/// </summary>
+			static bool Decompress( const std::vector< uint8 >& baseline, Buffer& buffer, std::vector< uint8 >& state );
+
+		private:
+			static uint32 GetNumberOfWords( uint32 stateSize ) { return ( stateSize + WORD_SIZE - 1 ) / WORD_SIZE; }
+	};
+} // namespace NetLib
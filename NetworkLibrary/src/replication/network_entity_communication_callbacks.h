@@ -5,6 +5,10 @@
 
 namespace NetLib
 {
+	/// <summary>
+	/// The buffers given to these callbacks can be wrapped within a BitWriter or a BitReader in order to bit pack the
+	/// entity state.
+	/// </summary>
 	struct NetworkEntityCommunicationCallbacks
 	{
 			NetworkEntityCommunicationCallbacks() = default;
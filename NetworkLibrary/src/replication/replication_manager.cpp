@@ -1,18 +1,29 @@
 #include "replication_manager.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 
 #include "logger.h"
 
 #include "communication/message_factory.h"
 
+#include "replication/delta_compression.h"
 #include "replication/replication_action_type.h"
 #include "replication/on_network_entity_create_config.h"
 
 namespace NetLib
 {
 	ReplicationManager::ReplicationManager()
-	    : _nextNetworkEntityId( 1 )
+	    : _spatialGrid( DEFAULT_VIEW_RADIUS )
+	    , _isInterestManagementEnabled( false )
+	    , _viewRadius( DEFAULT_VIEW_RADIUS )
+	    , _workerPool()
+	    , _workerSerializationBuffers( 1, std::vector< uint8 >( SERIALIZATION_BUFFER_SIZE ) )
+	    , _workerDeltaCompressionBuffers( 1 )
+	    , _networkEntityIdToNonOwnerStateMap()
+	    , _areNonOwnerStatesSerialized( false )
+	    , _nextNetworkEntityId( 1 )
 	{
 	}
 
@@ -36,13 +47,20 @@ namespace NetLib
 		const uint32 gameEntity = _onNetworkEntityCreate( network_entity_create_config );
 
 		new_entity_data.inGameId = gameEntity;
+
+		_spatialGrid.AddEntity( network_entity_id, pos_x, pos_y );
+		_remotePeerIdToControlledNetworkEntityIdsMap[ controlled_by_peer_id ].push_back( network_entity_id );
+
+		// Within the same tick, the new entity still needs its non owner state
+		_areNonOwnerStatesSerialized = false;
 		return new_entity_data;
 	}
 
 	std::unique_ptr< ReplicationMessage > ReplicationManager::CreateCreateReplicationMessage( uint32 entityType,
 	                                                                                          uint32 controlledByPeerId,
 	                                                                                          uint32 networkEntityId,
-	                                                                                          const Buffer& dataBuffer )
+	                                                                                          float32 posX,
+	                                                                                          float32 posY )
 	{
 		// Get message from message factory
 		MessageFactory& messageFactory = MessageFactory::GetInstance();
@@ -59,17 +77,21 @@ namespace NetLib
 		replicationMessage->networkEntityId = networkEntityId;
 		replicationMessage->controlledByPeerId = controlledByPeerId;
 		replicationMessage->replicatedClassId = entityType;
-		replicationMessage->data = dataBuffer.GetData();
-		replicationMessage->dataSize = dataBuffer.GetSize();
+
+		std::shared_ptr< std::vector< uint8 > > data = std::make_shared< std::vector< uint8 > >( 8 );
+		Buffer buffer( data->data(), 8 );
+		buffer.WriteFloat( posX );
+		buffer.WriteFloat( posY );
+		replicationMessage->SetSharedData( data );
 
 		return std::move( replicationMessage );
 	}
 
 	// TODO Do we need the entity_type here too in case we need to create the entity from the update?
-	std::unique_ptr< ReplicationMessage > ReplicationManager::CreateUpdateReplicationMessage( uint32 entityType,
-	                                                                                          uint32 networkEntityId,
-	                                                                                          uint32 controlledByPeerId,
-	                                                                                          const Buffer& buffer )
+	std::unique_ptr< ReplicationMessage > ReplicationManager::CreateUpdateReplicationMessage(
+	    uint32 entityType, uint32 networkEntityId, uint32 controlledByPeerId,
+	    const std::shared_ptr< const std::vector< uint8 > >& state, const std::vector< uint8 >* baselineState,
+	    std::vector< uint8 >& deltaCompressionBuffer )
 	{
 		// Get message from message factory
 		MessageFactory& messageFactory = MessageFactory::GetInstance();
@@ -85,10 +107,33 @@ namespace NetLib
 		replicationMessage->replicationAction = static_cast< uint8 >( ReplicationActionType::UPDATE );
 		replicationMessage->networkEntityId = networkEntityId;
 		replicationMessage->controlledByPeerId = controlledByPeerId;
-		// TODO Use some write stream here instead of manual buffer
-		replicationMessage->dataSize = buffer.GetAccessIndex();
-		replicationMessage->data = new uint8[ replicationMessage->dataSize ];
-		buffer.CopyUsedData( replicationMessage->data, replicationMessage->dataSize );
+
+		const uint32 stateSize = static_cast< uint32 >( state->size() );
+		if ( baselineState != nullptr && DeltaCompression::CanCompress( *baselineState, stateSize ) )
+		{
+			const uint32 maxDeltaSize = DeltaCompression::GetMaxCompressedSize( stateSize );
+			if ( deltaCompressionBuffer.size() < maxDeltaSize )
+			{
+				deltaCompressionBuffer.resize( maxDeltaSize );
+			}
+
+			uint8* deltaData = deltaCompressionBuffer.data();
+			Buffer deltaBuffer( deltaData, static_cast< int32 >( maxDeltaSize ) );
+			DeltaCompression::Compress( *baselineState, state->data(), stateSize, deltaBuffer );
+
+			// If most of the state has changed, the delta can be bigger than the state itself
+			if ( deltaBuffer.GetAccessIndex() < stateSize )
+			{
+				replicationMessage->isDeltaCompressed = true;
+				replicationMessage->SetSharedData(
+				    std::make_shared< std::vector< uint8 > >( deltaData, deltaData + deltaBuffer.GetAccessIndex() ) );
+				return replicationMessage;
+			}
+		}
+
+		// The whole state is the same for every remote peer that gets it, so it is shared instead of copied
+		replicationMessage->isDeltaCompressed = false;
+		replicationMessage->SetSharedData( state );
 
 		return std::move( replicationMessage );
 	}
@@ -119,16 +164,16 @@ namespace NetLib
 		NetworkEntityData& new_entity_data =
 		    SpawnNewNetworkEntity( entityType, _nextNetworkEntityId, controlledByPeerId, posX, posY );
 
-		// Prepare a Create replication message for interested clients
-		uint8* data = new uint8[ 8 ];
-		Buffer buffer( data, 8 );
-		buffer.WriteFloat( posX );
-		buffer.WriteFloat( posY );
-		std::unique_ptr< ReplicationMessage > createMessage =
-		    CreateCreateReplicationMessage( entityType, controlledByPeerId, _nextNetworkEntityId, buffer );
+		// With interest management, each remote peer gets its own Create once the entity enters its view
+		if ( !_isInterestManagementEnabled )
+		{
+			// Prepare a Create replication message for interested clients
+			std::unique_ptr< ReplicationMessage > createMessage =
+			    CreateCreateReplicationMessage( entityType, controlledByPeerId, _nextNetworkEntityId, posX, posY );
 
-		// Store it into queue before broadcasting it
-		_createDestroyReplicationMessages.push_back( std::move( createMessage ) );
+			// Store it into queue before broadcasting it
+			_createDestroyReplicationMessages.push_back( std::move( createMessage ) );
+		}
 
 		CalculateNextNetworkEntityId();
 
@@ -150,78 +195,520 @@ namespace NetLib
 		// Destroy object through its custom factory
 		_onNetworkEntityDestroy( gameEntity->inGameId );
 
+		auto controlledIt = _remotePeerIdToControlledNetworkEntityIdsMap.find( gameEntity->controlledByPeerId );
+		if ( controlledIt != _remotePeerIdToControlledNetworkEntityIdsMap.end() )
+		{
+			std::vector< uint32 >& controlledIds = controlledIt->second;
+			controlledIds.erase( std::remove( controlledIds.begin(), controlledIds.end(), networkEntityId ),
+			                     controlledIds.end() );
+			if ( controlledIds.empty() )
+			{
+				_remotePeerIdToControlledNetworkEntityIdsMap.erase( controlledIt );
+			}
+		}
+
+		_spatialGrid.RemoveEntity( networkEntityId );
+
+		auto remotePeerStateIt = _remotePeerIdToReplicationStateMap.begin();
+		for ( ; remotePeerStateIt != _remotePeerIdToReplicationStateMap.end(); ++remotePeerStateIt )
+		{
+			remotePeerStateIt->second.networkEntityIdToPriorityMap.erase( networkEntityId );
+		}
+
+		_networkEntityIdToNonOwnerStateMap.erase( networkEntityId );
+
 		// Remove network enttiy data
 		_networkEntitiesStorage.RemoveNetworkEntity( networkEntityId );
 
-		// Create destroy entity message for remote peers
-		std::unique_ptr< ReplicationMessage > destroyMessage = CreateDestroyReplicationMessage( networkEntityId );
+		// With interest management, the remote peers that know about this entity get their own Destroy once it is no
+		// longer relevant to them
+		if ( !_isInterestManagementEnabled )
+		{
+			// Create destroy entity message for remote peers
+			std::unique_ptr< ReplicationMessage > destroyMessage = CreateDestroyReplicationMessage( networkEntityId );
+
+			// Store it into queue before broadcasting it
+			_createDestroyReplicationMessages.push_back( std::move( destroyMessage ) );
+		}
+	}
 
-		// Store it into queue before broadcasting it
-		_createDestroyReplicationMessages.push_back( std::move( destroyMessage ) );
+	void ReplicationManager::SetNetworkEntityPosition( uint32 networkEntityId, float32 posX, float32 posY )
+	{
+		_spatialGrid.MoveEntity( networkEntityId, posX, posY );
+	}
+
+	void ReplicationManager::EnableInterestManagement( float32 viewRadius )
+	{
+		assert( viewRadius > 0.f );
+
+		// A view only overlaps a few cells when they are as big as the view radius
+		_viewRadius = viewRadius;
+		_spatialGrid.SetCellSize( viewRadius );
+		_isInterestManagementEnabled = true;
+	}
+
+	/// <summary>
+	/// An entity update waiting for its turn within the replication budget of a remote peer.
+	/// </summary>
+	struct PendingEntityUpdate
+	{
+			NetworkEntityData* networkEntityData;
+			std::shared_ptr< const std::vector< uint8 > > state;
+			std::shared_ptr< const std::vector< uint8 > > baselineState;
+			float32 priority;
+	};
+
+	void ReplicationManager::EnableParallelReplication( uint32 numberOfWorkers )
+	{
+		assert( numberOfWorkers > 0 );
+		_workerPool.Start( numberOfWorkers );
+		_workerSerializationBuffers.resize( numberOfWorkers, std::vector< uint8 >( SERIALIZATION_BUFFER_SIZE ) );
+		_workerDeltaCompressionBuffers.resize( numberOfWorkers );
 	}
 
 	void ReplicationManager::Server_ReplicateWorldState(
-	    uint32 remote_peer_id, std::vector< std::unique_ptr< ReplicationMessage > >& replication_messages )
+	    uint32 remote_peer_id, std::vector< std::unique_ptr< ReplicationMessage > >& replication_messages,
+	    uint32 budgetBytes )
 	{
-		MessageFactory& messageFactory = MessageFactory::GetInstance();
-		auto cit = _createDestroyReplicationMessages.cbegin();
-		for ( ; cit != _createDestroyReplicationMessages.cend(); ++cit )
-		{
-			const ReplicationMessage* source_replication_message = cit->get();
-
-			std::unique_ptr< Message > message = messageFactory.LendMessage( MessageType::Replication );
-			std::unique_ptr< ReplicationMessage > replicationMessage(
-			    static_cast< ReplicationMessage* >( message.release() ) );
-
-			// TODO Create an operator= or something like that to avoid this spaguetti code
-			replicationMessage->SetOrdered( source_replication_message->GetHeader().isOrdered );
-			replicationMessage->SetReliability( source_replication_message->GetHeader().isReliable );
-			replicationMessage->replicationAction = source_replication_message->replicationAction;
-			replicationMessage->networkEntityId = source_replication_message->networkEntityId;
-			replicationMessage->controlledByPeerId = source_replication_message->controlledByPeerId;
-			replicationMessage->replicatedClassId = source_replication_message->replicatedClassId;
-			replicationMessage->dataSize = source_replication_message->dataSize;
-			if ( replicationMessage->dataSize > 0 )
+		SerializeNonOwnerStates();
+		ReplicateWorldState( remote_peer_id, _remotePeerIdToReplicationStateMap[ remote_peer_id ],
+		                     replication_messages, budgetBytes, _workerSerializationBuffers[ 0 ],
+		                     _workerDeltaCompressionBuffers[ 0 ] );
+	}
+
+	void ReplicationManager::Server_ReplicateWorldStates(
+	    const std::vector< uint32 >& remotePeerIds, const std::vector< uint32 >& budgetsBytes,
+	    std::vector< std::vector< std::unique_ptr< ReplicationMessage > > >& replicationMessages )
+	{
+		assert( remotePeerIds.size() == budgetsBytes.size() );
+		const uint32 numberOfRemotePeers = static_cast< uint32 >( remotePeerIds.size() );
+		replicationMessages.resize( numberOfRemotePeers );
+		SerializeNonOwnerStates();
+
+		// Inserting into the map is not thread-safe, so every state is looked up before the workers start
+		std::vector< RemotePeerReplicationState* > remotePeerStates;
+		remotePeerStates.reserve( numberOfRemotePeers );
+		for ( uint32 i = 0; i < numberOfRemotePeers; ++i )
+		{
+			remotePeerStates.push_back( &_remotePeerIdToReplicationStateMap[ remotePeerIds[ i ] ] );
+		}
+
+		// Each remote peer only touches its own state, so they don't need any synchronization between them
+		_workerPool.ParallelFor( numberOfRemotePeers,
+		                         [ & ]( uint32 index, uint32 workerIndex )
+		                         {
+			                         ReplicateWorldState( remotePeerIds[ index ], *remotePeerStates[ index ],
+			                                              replicationMessages[ index ], budgetsBytes[ index ],
+			                                              _workerSerializationBuffers[ workerIndex ],
+			                                              _workerDeltaCompressionBuffers[ workerIndex ] );
+		                         } );
+	}
+
+	void ReplicationManager::SerializeNonOwnerStates()
+	{
+		if ( _areNonOwnerStatesSerialized )
+		{
+			return;
+		}
+
+		std::vector< uint8 >& serializationBuffer = _workerSerializationBuffers[ 0 ];
+		uint8* data = serializationBuffer.data();
+		Buffer buffer( data, static_cast< int32 >( serializationBuffer.size() ) );
+
+		auto network_entity_it = _networkEntitiesStorage.GetNetworkEntities();
+		auto itPastToEnd = _networkEntitiesStorage.GetPastToEndNetworkEntities();
+		for ( ; network_entity_it != itPastToEnd; ++network_entity_it )
+		{
+			NetworkEntityData& networkEntityData = network_entity_it->second;
+
+			networkEntityData.communicationCallbacks.OnSerializeEntityStateForNonOwner.Execute( buffer );
+			if ( buffer.HasOverflowed() )
+			{
+				LOG_ERROR( "Replication: The non owner state of network entity %u doesn't fit within %u bytes. It "
+				           "won't be replicated...",
+				           networkEntityData.id, SERIALIZATION_BUFFER_SIZE );
+				_networkEntityIdToNonOwnerStateMap.erase( networkEntityData.id );
+				buffer.Clear();
+				continue;
+			}
+
+			// Remote peers compare the pointers first, so an unchanged state keeps the one of the previous tick
+			std::shared_ptr< const std::vector< uint8 > >& state =
+			    _networkEntityIdToNonOwnerStateMap[ networkEntityData.id ];
+			const uint32 stateSize = buffer.GetAccessIndex();
+			if ( state == nullptr || state->size() != stateSize ||
+			     !std::equal( data, data + stateSize, state->cbegin() ) )
 			{
-				// TODO Figure out if I can improve this. So far, for large snapshot updates data this can
-				// become heavy and slow. Can I avoid the copy somehow?
-				uint8* data = new uint8[ replicationMessage->dataSize ];
-				std::memcpy( data, source_replication_message->data, replicationMessage->dataSize );
-				replicationMessage->data = data;
+				state = std::make_shared< std::vector< uint8 > >( data, data + stateSize );
 			}
 
-			replication_messages.push_back( std::move( replicationMessage ) );
+			buffer.Clear();
 		}
 
-		auto entity_it = _networkEntitiesStorage.GetNetworkEntities();
-		auto itPastToEnd = _networkEntitiesStorage.GetPastToEndNetworkEntities();
+		_areNonOwnerStatesSerialized = true;
+	}
 
-		// TODO Remove this hardcoded size
-		const uint32 serialization_buffer_size = 128;
-		uint8* data = new uint8[ serialization_buffer_size ];
-		Buffer buffer( data, serialization_buffer_size );
-		for ( ; entity_it != itPastToEnd; ++entity_it )
+	void ReplicationManager::ReplicateWorldState(
+	    uint32 remote_peer_id, RemotePeerReplicationState& remotePeerState,
+	    std::vector< std::unique_ptr< ReplicationMessage > >& replication_messages, uint32 budgetBytes,
+	    std::vector< uint8 >& serializationBuffer, std::vector< uint8 >& deltaCompressionBuffer )
+	{
+		std::vector< NetworkEntityData* > network_entities_to_replicate;
+		if ( _isInterestManagementEnabled )
 		{
-			NetworkEntityData& networkEntityData = entity_it->second;
+			// Creates and destroys are sent as entities enter and leave the relevant set of this remote peer
+			UpdateRelevantNetworkEntities( remote_peer_id, remotePeerState, replication_messages );
 
+			auto relevant_it = remotePeerState.relevantNetworkEntityIds.cbegin();
+			for ( ; relevant_it != remotePeerState.relevantNetworkEntityIds.cend(); ++relevant_it )
+			{
+				NetworkEntityData* networkEntityData =
+				    _networkEntitiesStorage.TryGetNetworkEntityFromId( *relevant_it );
+				assert( networkEntityData != nullptr );
+				network_entities_to_replicate.push_back( networkEntityData );
+			}
+		}
+		else
+		{
+			MessageFactory& messageFactory = MessageFactory::GetInstance();
+			auto cit = _createDestroyReplicationMessages.cbegin();
+			for ( ; cit != _createDestroyReplicationMessages.cend(); ++cit )
+			{
+				const ReplicationMessage* source_replication_message = cit->get();
+
+				std::unique_ptr< Message > message = messageFactory.LendMessage( MessageType::Replication );
+				std::unique_ptr< ReplicationMessage > replicationMessage(
+				    static_cast< ReplicationMessage* >( message.release() ) );
+
+				// TODO Create an operator= or something like that to avoid this spaguetti code
+				replicationMessage->SetOrdered( source_replication_message->GetHeader().isOrdered );
+				replicationMessage->SetReliability( source_replication_message->GetHeader().isReliable );
+				replicationMessage->replicationAction = source_replication_message->replicationAction;
+				replicationMessage->networkEntityId = source_replication_message->networkEntityId;
+				replicationMessage->controlledByPeerId = source_replication_message->controlledByPeerId;
+				replicationMessage->replicatedClassId = source_replication_message->replicatedClassId;
+				// Every remote peer gets the same data, so there is no need to copy it
+				replicationMessage->SetSharedData( source_replication_message->GetSharedData() );
+
+				replication_messages.push_back( std::move( replicationMessage ) );
+			}
+
+			auto entity_it = _networkEntitiesStorage.GetNetworkEntities();
+			auto itPastToEnd = _networkEntitiesStorage.GetPastToEndNetworkEntities();
+			for ( ; entity_it != itPastToEnd; ++entity_it )
+			{
+				network_entities_to_replicate.push_back( &entity_it->second );
+			}
+		}
+
+		const uint16 snapshotSequenceNumber = remotePeerState.nextSnapshotSequenceNumber;
+		const ReplicationSnapshot* baseline = TryGetBaselineSnapshot( remotePeerState );
+		ReplicationSnapshot& snapshot = remotePeerState.history.StartSnapshot( snapshotSequenceNumber );
+		std::vector< std::unique_ptr< ReplicationMessage > > update_messages;
+		std::vector< PendingEntityUpdate > pending_updates;
+
+		uint8* data = serializationBuffer.data();
+		Buffer buffer( data, static_cast< int32 >( serializationBuffer.size() ) );
+		auto network_entity_it = network_entities_to_replicate.begin();
+		for ( ; network_entity_it != network_entities_to_replicate.end(); ++network_entity_it )
+		{
+			NetworkEntityData& networkEntityData = **network_entity_it;
+
+			std::shared_ptr< const std::vector< uint8 > > state;
 			if ( networkEntityData.controlledByPeerId == remote_peer_id )
 			{
 				networkEntityData.communicationCallbacks.OnSerializeEntityStateForOwner.Execute( buffer );
+				if ( buffer.HasOverflowed() )
+				{
+					LOG_ERROR( "Replication: The owner state of network entity %u doesn't fit within %u bytes. It "
+					           "won't be replicated...",
+					           networkEntityData.id, static_cast< uint32 >( serializationBuffer.size() ) );
+					buffer.Clear();
+					continue;
+				}
+
+				state = std::make_shared< std::vector< uint8 > >( data, data + buffer.GetAccessIndex() );
+				buffer.Clear();
 			}
 			else
 			{
-				// TODO Here is an error
-				networkEntityData.communicationCallbacks.OnSerializeEntityStateForNonOwner.Execute( buffer );
+				// It is missing if it didn't fit within the serialization buffer
+				auto stateIt = _networkEntityIdToNonOwnerStateMap.find( networkEntityData.id );
+				if ( stateIt == _networkEntityIdToNonOwnerStateMap.cend() )
+				{
+					continue;
+				}
+
+				state = stateIt->second;
+			}
+
+			snapshot.entityStates[ networkEntityData.id ] = state;
+
+			std::shared_ptr< const std::vector< uint8 > > baselineState;
+			if ( baseline != nullptr )
+			{
+				auto baselineStateIt = baseline->entityStates.find( networkEntityData.id );
+				if ( baselineStateIt != baseline->entityStates.cend() )
+				{
+					baselineState = baselineStateIt->second;
+				}
 			}
 
+			// The remote peer already has this state. Unchanged non owner states share their pointer with the
+			// baseline, so their bytes only get compared after they have changed
+			if ( baselineState != nullptr && ( baselineState == state || *baselineState == *state ) )
+			{
+				remotePeerState.networkEntityIdToPriorityMap.erase( networkEntityData.id );
+				continue;
+			}
+
+			// The longer an update waits, the higher its priority gets
+			float32& priority = remotePeerState.networkEntityIdToPriorityMap[ networkEntityData.id ];
+			priority += GetPriorityIncrement( remote_peer_id, networkEntityData );
+			pending_updates.push_back( PendingEntityUpdate{ &networkEntityData, std::move( state ),
+			                                                std::move( baselineState ), priority } );
+		}
+
+		std::sort( pending_updates.begin(), pending_updates.end(),
+		           []( const PendingEntityUpdate& a, const PendingEntityUpdate& b )
+		           {
+			           return a.priority > b.priority;
+		           } );
+
+		// Creates and destroys are reliable, so they are always sent and take their part of the budget first
+		uint32 spentBytes = 0;
+		auto sent_it = replication_messages.cbegin();
+		for ( ; sent_it != replication_messages.cend(); ++sent_it )
+		{
+			spentBytes += ( *sent_it )->Size();
+		}
+
+		MessageFactory& messageFactory = MessageFactory::GetInstance();
+		auto pending_it = pending_updates.cbegin();
+		for ( ; pending_it != pending_updates.cend(); ++pending_it )
+		{
+			const NetworkEntityData& networkEntityData = *pending_it->networkEntityData;
 			std::unique_ptr< ReplicationMessage > message = CreateUpdateReplicationMessage(
-			    networkEntityData.entityType, networkEntityData.id, networkEntityData.controlledByPeerId, buffer );
-			replication_messages.push_back( std::move( message ) );
+			    networkEntityData.entityType, networkEntityData.id, networkEntityData.controlledByPeerId,
+			    pending_it->state, pending_it->baselineState.get(), deltaCompressionBuffer );
 
-			buffer.Clear();
+			const uint32 messageSize = message->Size();
+			if ( budgetBytes == UNLIMITED_REPLICATION_BUDGET || update_messages.empty() ||
+			     spentBytes + messageSize <= budgetBytes )
+			{
+				spentBytes += messageSize;
+				remotePeerState.networkEntityIdToPriorityMap.erase( networkEntityData.id );
+				update_messages.push_back( std::move( message ) );
+				continue;
+			}
+
+			// The remote peer won't get this state, so the snapshot keeps the one it is going to have
+			messageFactory.ReleaseMessage( std::move( message ) );
+			if ( pending_it->baselineState != nullptr )
+			{
+				snapshot.entityStates[ networkEntityData.id ] = pending_it->baselineState;
+			}
+			else
+			{
+				snapshot.entityStates.erase( networkEntityData.id );
+			}
+		}
+
+		// Nothing has changed since the baseline, so there is no need for a new snapshot
+		if ( update_messages.empty() )
+		{
+			return;
+		}
+
+		const uint8 baselineDistance =
+		    ( baseline != nullptr ) ? static_cast< uint8 >( snapshotSequenceNumber - baseline->sequenceNumber ) : 0;
+		auto update_it = update_messages.begin();
+		for ( ; update_it != update_messages.end(); ++update_it )
+		{
+			( *update_it )->snapshotSequenceNumber = snapshotSequenceNumber;
+			( *update_it )->snapshotBaselineDistance = baselineDistance;
+			( *update_it )->numberOfUpdatesInSnapshot = static_cast< uint32 >( update_messages.size() );
+			replication_messages.push_back( std::move( *update_it ) );
+		}
+
+		snapshot.isComplete = true;
+		++remotePeerState.nextSnapshotSequenceNumber;
+	}
+
+	void ReplicationManager::Server_ProcessSnapshotAck( uint32 remotePeerId, uint16 snapshotSequenceNumber )
+	{
+		auto it = _remotePeerIdToReplicationStateMap.find( remotePeerId );
+		if ( it == _remotePeerIdToReplicationStateMap.end() )
+		{
+			return;
+		}
+
+		RemotePeerReplicationState& remotePeerState = it->second;
+
+		// Acks can arrive out of order. Only a newer snapshot than the current baseline is worth it
+		if ( remotePeerState.hasAckedSnapshot &&
+		     static_cast< int16 >( snapshotSequenceNumber - remotePeerState.lastAckedSnapshotSequenceNumber ) <= 0 )
+		{
+			return;
+		}
+
+		if ( remotePeerState.history.TryGetSnapshot( snapshotSequenceNumber ) == nullptr )
+		{
+			LOG_INFO( "Replication: Ignoring the ack of snapshot %hu as it is no longer stored. Remote peer ID: %u",
+			          snapshotSequenceNumber, remotePeerId );
+			return;
+		}
+
+		remotePeerState.lastAckedSnapshotSequenceNumber = snapshotSequenceNumber;
+		remotePeerState.hasAckedSnapshot = true;
+	}
+
+	void ReplicationManager::UpdateRelevantNetworkEntities(
+	    uint32 remotePeerId, RemotePeerReplicationState& remotePeerState,
+	    std::vector< std::unique_ptr< ReplicationMessage > >& replicationMessages )
+	{
+		std::unordered_set< uint32 > relevantIds;
+
+		auto controlledIt = _remotePeerIdToControlledNetworkEntityIdsMap.find( remotePeerId );
+		if ( controlledIt != _remotePeerIdToControlledNetworkEntityIdsMap.cend() )
+		{
+			const float32 exitRadius = _viewRadius * VIEW_RADIUS_EXIT_FACTOR;
+			std::vector< uint32 > nearbyIds;
+
+			auto controlledIdIt = controlledIt->second.cbegin();
+			for ( ; controlledIdIt != controlledIt->second.cend(); ++controlledIdIt )
+			{
+				relevantIds.insert( *controlledIdIt );
+
+				float32 posX = 0.f;
+				float32 posY = 0.f;
+				if ( !_spatialGrid.TryGetEntityPosition( *controlledIdIt, posX, posY ) )
+				{
+					continue;
+				}
+
+				nearbyIds.clear();
+				_spatialGrid.GetEntitiesWithinRadius( posX, posY, _viewRadius, nearbyIds );
+				relevantIds.insert( nearbyIds.cbegin(), nearbyIds.cend() );
+
+				// Entities already known by the remote peer stay relevant until they go past the exit radius
+				nearbyIds.clear();
+				_spatialGrid.GetEntitiesWithinRadius( posX, posY, exitRadius, nearbyIds );
+				auto nearbyIt = nearbyIds.cbegin();
+				for ( ; nearbyIt != nearbyIds.cend(); ++nearbyIt )
+				{
+					if ( remotePeerState.relevantNetworkEntityIds.find( *nearbyIt ) !=
+					     remotePeerState.relevantNetworkEntityIds.cend() )
+					{
+						relevantIds.insert( *nearbyIt );
+					}
+				}
+			}
 		}
 
-		delete[] data;
+		// Destroy the entities that have left the view, including the ones removed from the world
+		auto previousIt = remotePeerState.relevantNetworkEntityIds.cbegin();
+		for ( ; previousIt != remotePeerState.relevantNetworkEntityIds.cend(); ++previousIt )
+		{
+			if ( relevantIds.find( *previousIt ) == relevantIds.cend() )
+			{
+				replicationMessages.push_back( CreateDestroyReplicationMessage( *previousIt ) );
+
+				// If it enters the view again, its first update must not be a delta against an old state
+				remotePeerState.history.RemoveEntity( *previousIt );
+				remotePeerState.networkEntityIdToPriorityMap.erase( *previousIt );
+			}
+		}
+
+		// Create the entities that have entered the view
+		auto relevantIt = relevantIds.cbegin();
+		for ( ; relevantIt != relevantIds.cend(); ++relevantIt )
+		{
+			if ( remotePeerState.relevantNetworkEntityIds.find( *relevantIt ) !=
+			     remotePeerState.relevantNetworkEntityIds.cend() )
+			{
+				continue;
+			}
+
+			const NetworkEntityData* networkEntityData =
+			    _networkEntitiesStorage.TryGetNetworkEntityFromId( *relevantIt );
+			assert( networkEntityData != nullptr );
+
+			float32 posX = 0.f;
+			float32 posY = 0.f;
+			_spatialGrid.TryGetEntityPosition( *relevantIt, posX, posY );
+
+			replicationMessages.push_back( CreateCreateReplicationMessage(
+			    networkEntityData->entityType, networkEntityData->controlledByPeerId, *relevantIt, posX, posY ) );
+		}
+
+		remotePeerState.relevantNetworkEntityIds = std::move( relevantIds );
+	}
+
+	float32 ReplicationManager::GetPriorityIncrement( uint32 remotePeerId,
+	                                                  const NetworkEntityData& networkEntityData ) const
+	{
+		if ( networkEntityData.controlledByPeerId == remotePeerId )
+		{
+			return CONTROLLED_ENTITY_PRIORITY_FACTOR;
+		}
+
+		// Remote peers without entities of their own have no point of view, so every entity is equally important
+		auto controlledIt = _remotePeerIdToControlledNetworkEntityIdsMap.find( remotePeerId );
+		float32 posX = 0.f;
+		float32 posY = 0.f;
+		if ( controlledIt == _remotePeerIdToControlledNetworkEntityIdsMap.cend() ||
+		     !_spatialGrid.TryGetEntityPosition( networkEntityData.id, posX, posY ) )
+		{
+			return 1.f;
+		}
+
+		float32 closestSquaredDistance = -1.f;
+		auto controlledIdIt = controlledIt->second.cbegin();
+		for ( ; controlledIdIt != controlledIt->second.cend(); ++controlledIdIt )
+		{
+			float32 controlledPosX = 0.f;
+			float32 controlledPosY = 0.f;
+			if ( !_spatialGrid.TryGetEntityPosition( *controlledIdIt, controlledPosX, controlledPosY ) )
+			{
+				continue;
+			}
+
+			const float32 distanceX = posX - controlledPosX;
+			const float32 distanceY = posY - controlledPosY;
+			const float32 squaredDistance = ( distanceX * distanceX ) + ( distanceY * distanceY );
+			if ( closestSquaredDistance < 0.f || squaredDistance < closestSquaredDistance )
+			{
+				closestSquaredDistance = squaredDistance;
+			}
+		}
+
+		if ( closestSquaredDistance < 0.f )
+		{
+			return 1.f;
+		}
+
+		// Entities at the view radius get half the priority of the closest ones
+		return 1.f / ( 1.f + ( std::sqrt( closestSquaredDistance ) / _viewRadius ) );
+	}
+
+	const ReplicationSnapshot* ReplicationManager::TryGetBaselineSnapshot(
+	    const RemotePeerReplicationState& remotePeerState ) const
+	{
+		if ( !remotePeerState.hasAckedSnapshot )
+		{
+			return nullptr;
+		}
+
+		// The next snapshot is stored within the same slot as the baseline once they are too far apart
+		const uint16 distance = static_cast< uint16 >( remotePeerState.nextSnapshotSequenceNumber -
+		                                               remotePeerState.lastAckedSnapshotSequenceNumber );
+		if ( distance == 0 || distance >= ReplicationSnapshotHistory::SIZE )
+		{
+			return nullptr;
+		}
+
+		return remotePeerState.history.TryGetSnapshot( remotePeerState.lastAckedSnapshotSequenceNumber );
 	}
 
 	void ReplicationManager::ClearReplicationMessages()
@@ -234,6 +721,8 @@ namespace NetLib
 			messageFactory.ReleaseMessage( std::move( *it ) );
 		}
 		_createDestroyReplicationMessages.clear();
+
+		_areNonOwnerStatesSerialized = false;
 	}
 
 	void ReplicationManager::RemoveNetworkEntitiesControllerByPeer( uint32 id )
@@ -259,6 +748,11 @@ namespace NetLib
 		}
 	}
 
+	void ReplicationManager::RemoveRemotePeer( uint32 remotePeerId )
+	{
+		_remotePeerIdToReplicationStateMap.erase( remotePeerId );
+	}
+
 	void ReplicationManager::CalculateNextNetworkEntityId()
 	{
 		++_nextNetworkEntityId;
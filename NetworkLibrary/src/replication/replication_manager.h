@@ -4,12 +4,19 @@
 
 #include <memory>
 #include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include "core/buffer.h"
 
 #include "communication/message.h"
 
 #include "replication/network_entity_storage.h"
+#include "replication/replication_snapshot_history.h"
+#include "replication/spatial_grid.h"
+
+#include "utils/worker_pool.h"
 
 namespace NetLib
 {
@@ -17,20 +24,97 @@ namespace NetLib
 
 	static constexpr uint32 INVALID_NETWORK_ENTITY_ID = 0;
 
+	/// <summary>
+	/// The snapshots sent to a remote peer and the newest of them that it has acknowledged, which is the baseline the
+	/// next updates are delta compressed against. It also keeps the accumulated priority of the entity updates that
+	/// are pending for the remote peer and, with interest management enabled, the network entities it knows about.
+	/// </summary>
+	struct RemotePeerReplicationState
+	{
+			RemotePeerReplicationState()
+			    : history()
+			    , nextSnapshotSequenceNumber( 0 )
+			    , lastAckedSnapshotSequenceNumber( 0 )
+			    , hasAckedSnapshot( false )
+			    , relevantNetworkEntityIds()
+			    , networkEntityIdToPriorityMap()
+			{
+			}
+
+			ReplicationSnapshotHistory history;
+			uint16 nextSnapshotSequenceNumber;
+			uint16 lastAckedSnapshotSequenceNumber;
+			bool hasAckedSnapshot;
+			std::unordered_set< uint32 > relevantNetworkEntityIds;
+			std::unordered_map< uint32, float32 > networkEntityIdToPriorityMap;
+	};
+
 	class ReplicationManager
 	{
 		public:
+			static constexpr float32 DEFAULT_VIEW_RADIUS = 50.f;
+			// Entities are kept relevant a bit further than the view radius so they don't get destroyed and created
+			// again while moving around its border
+			static constexpr float32 VIEW_RADIUS_EXIT_FACTOR = 1.25f;
+			static constexpr uint32 UNLIMITED_REPLICATION_BUDGET = 0;
+			// Remote peers reconcile their own entities against the server, so they need them more often
+			static constexpr float32 CONTROLLED_ENTITY_PRIORITY_FACTOR = 4.f;
+			// TODO Remove this hardcoded size
+			static constexpr uint32 SERIALIZATION_BUFFER_SIZE = 128;
+
 			ReplicationManager();
 
 			uint32 CreateNetworkEntity( uint32 entityType, uint32 controlledByPeerId, float32 posX, float32 posY );
 			void RemoveNetworkEntity( uint32 networkEntityId );
-
-			void Server_ReplicateWorldState(
-			    uint32 remote_peer_id, std::vector< std::unique_ptr< ReplicationMessage > >& replication_messages );
-
+			void SetNetworkEntityPosition( uint32 networkEntityId, float32 posX, float32 posY );
+
+			/// <summary>
+			/// Replicates to each remote peer only the network entities within the view radius of the ones it controls.
+			/// Entities are created and destroyed in a remote peer as they enter and leave its view. Enable it before
+			/// creating any network entity.
+			/// </summary>
+			void EnableInterestManagement( float32 viewRadius );
+			bool IsInterestManagementEnabled() const { return _isInterestManagementEnabled; }
+
+			/// <summary>
+			/// Lets Server_ReplicateWorldStates build the replication of several remote peers at the same time. The
+			/// entity serialization callbacks get called from the worker threads, so they must only read the game
+			/// state.
+			/// </summary>
+			/// <param name="numberOfWorkers">Threads used, the calling one included. One disables it</param>
+			void EnableParallelReplication( uint32 numberOfWorkers );
+			bool IsParallelReplicationEnabled() const { return _workerPool.GetNumberOfWorkers() > 1; }
+
+			/// <summary>
+			/// Creates the replication messages for a remote peer. Entity updates are delta compressed against the
+			/// newest snapshot acknowledged by the remote peer, and entities that haven't changed since then are not
+			/// sent. Every pending update accumulates priority each call, and updates are sent from the highest
+			/// priority down until the budget is spent. The rest wait for a later call with a higher priority. The
+			/// state every remote peer but the owner gets is serialized once per tick and shared by all their messages.
+			/// </summary>
+			/// <param name="budgetBytes">Maximum size of the replication messages. At least one update is sent so
+			/// a state bigger than the budget can't starve</param>
+			void Server_ReplicateWorldState( uint32 remote_peer_id,
+			                                 std::vector< std::unique_ptr< ReplicationMessage > >& replication_messages,
+			                                 uint32 budgetBytes = UNLIMITED_REPLICATION_BUDGET );
+			/// <summary>
+			/// Same as calling Server_ReplicateWorldState for each remote peer, but spread across the parallel
+			/// replication workers. The messages of each remote peer are stored at its same index, so the result
+			/// doesn't depend on how the work was spread.
+			/// </summary>
+			void Server_ReplicateWorldStates(
+			    const std::vector< uint32 >& remotePeerIds, const std::vector< uint32 >& budgetsBytes,
+			    std::vector< std::vector< std::unique_ptr< ReplicationMessage > > >& replicationMessages );
+			void Server_ProcessSnapshotAck( uint32 remotePeerId, uint16 snapshotSequenceNumber );
+
+			/// <summary>
+			/// Ends the replication tick. The next call to Server_ReplicateWorldState serializes the network entities
+			/// again.
+			/// </summary>
 			void ClearReplicationMessages();
 
 			void RemoveNetworkEntitiesControllerByPeer( uint32 id );
+			void RemoveRemotePeer( uint32 remotePeerId );
 
 			template < typename Functor >
 			uint32 SubscribeToOnNetworkEntityCreate( Functor&& functor );
@@ -44,20 +128,57 @@ namespace NetLib
 
 			std::unique_ptr< ReplicationMessage > CreateCreateReplicationMessage( uint32 entityType,
 			                                                                      uint32 controlledByPeerId,
-			                                                                      uint32 networkEntityId,
-			                                                                      const Buffer& dataBuffer );
-			std::unique_ptr< ReplicationMessage > CreateUpdateReplicationMessage( uint32 entityType,
-			                                                                      uint32 networkEntityId,
-			                                                                      uint32 controlledByPeerId,
-			                                                                      const Buffer& buffer );
+			                                                                      uint32 networkEntityId, float32 posX,
+			                                                                      float32 posY );
+			std::unique_ptr< ReplicationMessage > CreateUpdateReplicationMessage(
+			    uint32 entityType, uint32 networkEntityId, uint32 controlledByPeerId,
+			    const std::shared_ptr< const std::vector< uint8 > >& state, const std::vector< uint8 >* baselineState,
+			    std::vector< uint8 >& deltaCompressionBuffer );
 			std::unique_ptr< ReplicationMessage > CreateDestroyReplicationMessage( uint32 networkEntityId );
 
+			const ReplicationSnapshot* TryGetBaselineSnapshot(
+			    const RemotePeerReplicationState& remotePeerState ) const;
+
+			/// <summary>
+			/// Serializes the non owner state of every network entity, if it hasn't been done yet within this tick.
+			/// </summary>
+			void SerializeNonOwnerStates();
+			void ReplicateWorldState( uint32 remotePeerId, RemotePeerReplicationState& remotePeerState,
+			                          std::vector< std::unique_ptr< ReplicationMessage > >& replicationMessages,
+			                          uint32 budgetBytes, std::vector< uint8 >& serializationBuffer,
+			                          std::vector< uint8 >& deltaCompressionBuffer );
+
+			float32 GetPriorityIncrement( uint32 remotePeerId, const NetworkEntityData& networkEntityData ) const;
+
+			void UpdateRelevantNetworkEntities(
+			    uint32 remotePeerId, RemotePeerReplicationState& remotePeerState,
+			    std::vector< std::unique_ptr< ReplicationMessage > >& replicationMessages );
+
 			void CalculateNextNetworkEntityId();
 
 			NetworkEntityStorage _networkEntitiesStorage;
 
 			std::vector< std::unique_ptr< ReplicationMessage > > _createDestroyReplicationMessages;
 
+			std::unordered_map< uint32, RemotePeerReplicationState > _remotePeerIdToReplicationStateMap;
+
+			SpatialGrid _spatialGrid;
+			std::unordered_map< uint32, std::vector< uint32 > > _remotePeerIdToControlledNetworkEntityIdsMap;
+			bool _isInterestManagementEnabled;
+			float32 _viewRadius;
+
+			WorkerPool _workerPool;
+			// Each worker serializes the entity states within its own buffer
+			std::vector< std::vector< uint8 > > _workerSerializationBuffers;
+			// Deltas are compressed within them, so only the ones worth sending get their own allocation
+			std::vector< std::vector< uint8 > > _workerDeltaCompressionBuffers;
+
+			// Latest non owner states, shared by the replication messages and snapshots of every remote peer. A state
+			// keeps its same pointer for as long as it doesn't change
+			std::unordered_map< uint32, std::shared_ptr< const std::vector< uint8 > > >
+			    _networkEntityIdToNonOwnerStateMap;
+			bool _areNonOwnerStatesSerialized;
+
 			uint32 _nextNetworkEntityId;
 
 			std::function< uint32_t( const OnNetworkEntityCreateConfig& ) > _onNetworkEntityCreate;
@@ -7,6 +7,7 @@
 
 #include "communication/message.h"
 
+#include "replication/delta_compression.h"
 #include "replication/replication_action_type.h"
 #include "replication/network_entity_communication_callbacks.h"
 #include "replication/on_network_entity_create_config.h"
@@ -17,6 +18,13 @@ namespace NetLib
 {
 	ReplicationMessagesProcessor::ReplicationMessagesProcessor()
 	    : _networkEntitiesStorage()
+	    , _snapshotHistory()
+	    , _receivingSnapshot( nullptr )
+	    , _receivingSnapshotBaseline( nullptr )
+	    , _isReceivingSnapshotBaselineMissing( false )
+	    , _numberOfReceivedSnapshotUpdates( 0 )
+	    , _hasSnapshotToAck( false )
+	    , _snapshotToAck( 0 )
 	{
 	}
 
@@ -40,6 +48,28 @@ namespace NetLib
 		}
 	}
 
+	bool ReplicationMessagesProcessor::Client_TryGetSnapshotToAck( uint16& snapshotSequenceNumber )
+	{
+		if ( !_hasSnapshotToAck )
+		{
+			return false;
+		}
+
+		snapshotSequenceNumber = _snapshotToAck;
+		_hasSnapshotToAck = false;
+		return true;
+	}
+
+	void ReplicationMessagesProcessor::ClearSnapshots()
+	{
+		_snapshotHistory.Clear();
+		_receivingSnapshot = nullptr;
+		_receivingSnapshotBaseline = nullptr;
+		_isReceivingSnapshotBaselineMissing = false;
+		_numberOfReceivedSnapshotUpdates = 0;
+		_hasSnapshotToAck = false;
+	}
+
 	void ReplicationMessagesProcessor::ProcessReceivedCreateReplicationMessage(
 	    const ReplicationMessage& replicationMessage )
 	{
@@ -79,7 +109,32 @@ namespace NetLib
 	void ReplicationMessagesProcessor::ProcessReceivedUpdateReplicationMessage(
 	    const ReplicationMessage& replicationMessage )
 	{
+		if ( _receivingSnapshot == nullptr ||
+		     _receivingSnapshot->sequenceNumber != replicationMessage.snapshotSequenceNumber )
+		{
+			StartReceivingSnapshot( replicationMessage );
+		}
+
 		uint32 networkEntityId = replicationMessage.networkEntityId;
+		std::shared_ptr< std::vector< uint8 > > state = std::make_shared< std::vector< uint8 > >();
+		if ( !TryReadEntityState( replicationMessage, *state ) )
+		{
+			LOG_WARNING( "Replication: Can't read the state of network entity %u within snapshot %hu. Ignoring it...",
+			             networkEntityId, replicationMessage.snapshotSequenceNumber );
+			_receivingSnapshot->entityStates.erase( networkEntityId );
+			return;
+		}
+
+		_receivingSnapshot->entityStates[ networkEntityId ] = state;
+		++_numberOfReceivedSnapshotUpdates;
+		if ( _numberOfReceivedSnapshotUpdates == replicationMessage.numberOfUpdatesInSnapshot &&
+		     !_isReceivingSnapshotBaselineMissing )
+		{
+			_receivingSnapshot->isComplete = true;
+			_hasSnapshotToAck = true;
+			_snapshotToAck = _receivingSnapshot->sequenceNumber;
+		}
+
 		if ( !_networkEntitiesStorage.HasNetworkEntityId( networkEntityId ) )
 		{
 			LOG_INFO( "Replication: Trying to update a network entity that doesn't exist. Entity ID: %u. Creating a "
@@ -110,10 +165,72 @@ namespace NetLib
 		assert( entity_data != nullptr );
 
 		// TODO Pass entity state to target entity
-		Buffer buffer( replicationMessage.data, replicationMessage.dataSize );
+		Buffer buffer( state->data(), static_cast< int32 >( state->size() ) );
 		entity_data->communicationCallbacks.OnUnserializeEntityStateForOwner.Execute( buffer );
 	}
 
+	void ReplicationMessagesProcessor::StartReceivingSnapshot( const ReplicationMessage& replicationMessage )
+	{
+		const uint16 snapshotSequenceNumber = replicationMessage.snapshotSequenceNumber;
+		const uint8 baselineDistance = replicationMessage.snapshotBaselineDistance;
+
+		_receivingSnapshotBaseline = nullptr;
+		if ( baselineDistance != 0 && baselineDistance < ReplicationSnapshotHistory::SIZE )
+		{
+			_receivingSnapshotBaseline = _snapshotHistory.TryGetSnapshot(
+			    static_cast< uint16 >( snapshotSequenceNumber - baselineDistance ) );
+		}
+
+		// Updates that are not delta compressed can still be applied, but the snapshot can't be completed
+		_isReceivingSnapshotBaselineMissing = ( baselineDistance != 0 && _receivingSnapshotBaseline == nullptr );
+		if ( _isReceivingSnapshotBaselineMissing )
+		{
+			LOG_WARNING( "Replication: The baseline of snapshot %hu is not available. Its delta compressed updates "
+			             "will be ignored...",
+			             snapshotSequenceNumber );
+		}
+
+		_receivingSnapshot = &_snapshotHistory.StartSnapshot( snapshotSequenceNumber );
+		_numberOfReceivedSnapshotUpdates = 0;
+
+		if ( _receivingSnapshotBaseline != nullptr )
+		{
+			auto cit = _receivingSnapshotBaseline->entityStates.cbegin();
+			for ( ; cit != _receivingSnapshotBaseline->entityStates.cend(); ++cit )
+			{
+				// Skip destroyed entities
+				if ( _networkEntitiesStorage.HasNetworkEntityId( cit->first ) )
+				{
+					_receivingSnapshot->entityStates.insert( *cit );
+				}
+			}
+		}
+	}
+
+	bool ReplicationMessagesProcessor::TryReadEntityState( const ReplicationMessage& replicationMessage,
+	                                                       std::vector< uint8 >& state ) const
+	{
+		if ( !replicationMessage.isDeltaCompressed )
+		{
+			state.assign( replicationMessage.data, replicationMessage.data + replicationMessage.dataSize );
+			return true;
+		}
+
+		if ( _receivingSnapshotBaseline == nullptr )
+		{
+			return false;
+		}
+
+		auto baselineStateIt = _receivingSnapshotBaseline->entityStates.find( replicationMessage.networkEntityId );
+		if ( baselineStateIt == _receivingSnapshotBaseline->entityStates.cend() )
+		{
+			return false;
+		}
+
+		Buffer buffer( replicationMessage.data, replicationMessage.dataSize );
+		return DeltaCompression::Decompress( *baselineStateIt->second, buffer, state );
+	}
+
 	void ReplicationMessagesProcessor::ProcessReceivedDestroyReplicationMessage(
 	    const ReplicationMessage& replicationMessage )
 	{
@@ -135,5 +252,8 @@ namespace NetLib
 
 		// Destroy object
 		_onNetworkEntityDestroy( gameEntity->inGameId );
+
+		_networkEntitiesStorage.RemoveNetworkEntity( networkEntityId );
+		_snapshotHistory.RemoveEntity( networkEntityId );
 	}
 } // namespace NetLib
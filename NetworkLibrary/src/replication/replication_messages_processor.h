@@ -1,5 +1,8 @@
 #pragma once
+#include <vector>
+
 #include "replication/network_entity_storage.h"
+#include "replication/replication_snapshot_history.h"
 
 namespace NetLib
 {
@@ -13,6 +16,14 @@ namespace NetLib
 
 			void Client_ProcessReceivedReplicationMessage( const ReplicationMessage& replicationMessage );
 
+			/// <summary>
+			/// Returns True if all the updates of a snapshot have been received since the last call, along with the
+			/// newest of those snapshots. The server must be told about it in order to use it as a baseline.
+			/// </summary>
+			bool Client_TryGetSnapshotToAck( uint16& snapshotSequenceNumber );
+
+			void ClearSnapshots();
+
 			template < typename Functor >
 			uint32 SubscribeToOnNetworkEntityCreate( Functor&& functor );
 
@@ -24,9 +35,23 @@ namespace NetLib
 			void ProcessReceivedUpdateReplicationMessage( const ReplicationMessage& replicationMessage );
 			void ProcessReceivedDestroyReplicationMessage( const ReplicationMessage& replicationMessage );
 
+			void StartReceivingSnapshot( const ReplicationMessage& replicationMessage );
+			bool TryReadEntityState( const ReplicationMessage& replicationMessage, std::vector< uint8 >& state ) const;
+
 			void RemoveNetworkEntity( uint32 networkEntityId );
 
 			NetworkEntityStorage _networkEntitiesStorage;
+
+			ReplicationSnapshotHistory _snapshotHistory;
+			// Snapshot whose updates are being received. Entities without updates keep their baseline state
+			ReplicationSnapshot* _receivingSnapshot;
+			const ReplicationSnapshot* _receivingSnapshotBaseline;
+			bool _isReceivingSnapshotBaselineMissing;
+			uint32 _numberOfReceivedSnapshotUpdates;
+
+			bool _hasSnapshotToAck;
+			uint16 _snapshotToAck;
+
 			std::function< uint32_t( const OnNetworkEntityCreateConfig& ) > _onNetworkEntityCreate;
 			std::function< void( uint32 ) > _onNetworkEntityDestroy;
 	};
@@ -0,0 +1,42 @@
+#include "replication_snapshot_history.h"
+
+namespace NetLib
+{
+	ReplicationSnapshot& ReplicationSnapshotHistory::StartSnapshot( uint16 sequenceNumber )
+	{
+		ReplicationSnapshot& snapshot = _snapshots[ sequenceNumber % SIZE ];
+		snapshot.sequenceNumber = sequenceNumber;
+		snapshot.isComplete = false;
+		snapshot.entityStates.clear();
+		return snapshot;
+	}
+
+	const ReplicationSnapshot* ReplicationSnapshotHistory::TryGetSnapshot( uint16 sequenceNumber ) const
+	{
+		const ReplicationSnapshot& snapshot = _snapshots[ sequenceNumber % SIZE ];
+		if ( !snapshot.isComplete || snapshot.sequenceNumber != sequenceNumber )
+		{
+			return nullptr;
+		}
+
+		return &snapshot;
+	}
+
+	void ReplicationSnapshotHistory::RemoveEntity( uint32 networkEntityId )
+	{
+		for ( ReplicationSnapshot& snapshot : _snapshots )
+		{
+			snapshot.entityStates.erase( networkEntityId );
+		}
+	}
+
+	void ReplicationSnapshotHistory::Clear()
+	{
+		for ( ReplicationSnapshot& snapshot : _snapshots )
+		{
+			snapshot.sequenceNumber = 0;
+			snapshot.isComplete = false;
+			snapshot.entityStates.clear();
+		}
+	}
+} // namespace NetLib
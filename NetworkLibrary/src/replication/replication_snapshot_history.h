@@ -0,0 +1,58 @@
+#pragma once
+#include "numeric_types.h"
+
+#include <array>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace NetLib
+{
+	/// <summary>
+	/// The serialized state of every network entity sent to a client within a single replication tick.
+	/// </summary>
+	struct ReplicationSnapshot
+	{
+			ReplicationSnapshot()
+			    : sequenceNumber( 0 )
+			    , isComplete( false )
+			    , entityStates()
+			{
+			}
+
+			uint16 sequenceNumber;
+			// Server side, it is complete as soon as it is sent. Client side, once all its updates have been received
+			bool isComplete;
+			// States are immutable once stored, so consecutive snapshots and replication messages share them
+			std::unordered_map< uint32, std::shared_ptr< const std::vector< uint8 > > > entityStates;
+	};
+
+	/// <summary>
+	/// Ring of the most recent snapshots, indexed by their sequence number. It is used on both ends of the connection
+	/// in order to find the baseline that an update is delta compressed against.
+	/// </summary>
+	class ReplicationSnapshotHistory
+	{
+		public:
+			static constexpr uint32 SIZE = 32;
+
+			ReplicationSnapshotHistory() = default;
+
+			/// <summary>
+			/// Returns an empty snapshot with the given sequence number, replacing the one that was stored in the
+			/// same slot.
+			/// </summary>
+			ReplicationSnapshot& StartSnapshot( uint16 sequenceNumber );
+
+			/// <summary>
+			/// Returns the snapshot with the given sequence number if it is complete and has not been replaced yet.
+			/// </summary>
+			const ReplicationSnapshot* TryGetSnapshot( uint16 sequenceNumber ) const;
+
+			void RemoveEntity( uint32 networkEntityId );
+			void Clear();
+
+		private:
+			std::array< ReplicationSnapshot, SIZE > _snapshots;
+	};
+} // namespace NetLib
@@ -0,0 +1,153 @@
+#include "spatial_grid.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace NetLib
+{
+	SpatialGrid::SpatialGrid( float32 cellSize )
+	    : _cellSize( cellSize )
+	    , _cellKeyToEntityIdsMap()
+	    , _entityIdToLocationMap()
+	{
+		assert( cellSize > 0.f );
+	}
+
+	void SpatialGrid::SetCellSize( float32 cellSize )
+	{
+		assert( cellSize > 0.f );
+		_cellSize = cellSize;
+		_cellKeyToEntityIdsMap.clear();
+
+		auto it = _entityIdToLocationMap.begin();
+		for ( ; it != _entityIdToLocationMap.end(); ++it )
+		{
+			EntityLocation& location = it->second;
+			location.cellKey = GetCellKey( GetCellCoordinate( location.posX ), GetCellCoordinate( location.posY ) );
+			AddToCell( it->first, location.cellKey );
+		}
+	}
+
+	void SpatialGrid::AddEntity( uint32 networkEntityId, float32 posX, float32 posY )
+	{
+		assert( _entityIdToLocationMap.find( networkEntityId ) == _entityIdToLocationMap.cend() );
+
+		const uint64 cellKey = GetCellKey( GetCellCoordinate( posX ), GetCellCoordinate( posY ) );
+		_entityIdToLocationMap[ networkEntityId ] = EntityLocation{ posX, posY, cellKey };
+		AddToCell( networkEntityId, cellKey );
+	}
+
+	void SpatialGrid::MoveEntity( uint32 networkEntityId, float32 posX, float32 posY )
+	{
+		auto it = _entityIdToLocationMap.find( networkEntityId );
+		if ( it == _entityIdToLocationMap.end() )
+		{
+			return;
+		}
+
+		EntityLocation& location = it->second;
+		location.posX = posX;
+		location.posY = posY;
+
+		const uint64 cellKey = GetCellKey( GetCellCoordinate( posX ), GetCellCoordinate( posY ) );
+		if ( cellKey != location.cellKey )
+		{
+			RemoveFromCell( networkEntityId, location.cellKey );
+			AddToCell( networkEntityId, cellKey );
+			location.cellKey = cellKey;
+		}
+	}
+
+	void SpatialGrid::RemoveEntity( uint32 networkEntityId )
+	{
+		auto it = _entityIdToLocationMap.find( networkEntityId );
+		if ( it == _entityIdToLocationMap.end() )
+		{
+			return;
+		}
+
+		RemoveFromCell( networkEntityId, it->second.cellKey );
+		_entityIdToLocationMap.erase( it );
+	}
+
+	bool SpatialGrid::TryGetEntityPosition( uint32 networkEntityId, float32& posX, float32& posY ) const
+	{
+		auto it = _entityIdToLocationMap.find( networkEntityId );
+		if ( it == _entityIdToLocationMap.cend() )
+		{
+			return false;
+		}
+
+		posX = it->second.posX;
+		posY = it->second.posY;
+		return true;
+	}
+
+	void SpatialGrid::GetEntitiesWithinRadius( float32 posX, float32 posY, float32 radius,
+	                                           std::vector< uint32 >& result ) const
+	{
+		const int32 minCellX = GetCellCoordinate( posX - radius );
+		const int32 maxCellX = GetCellCoordinate( posX + radius );
+		const int32 minCellY = GetCellCoordinate( posY - radius );
+		const int32 maxCellY = GetCellCoordinate( posY + radius );
+		const float32 squaredRadius = radius * radius;
+
+		for ( int32 cellX = minCellX; cellX <= maxCellX; ++cellX )
+		{
+			for ( int32 cellY = minCellY; cellY <= maxCellY; ++cellY )
+			{
+				auto cellIt = _cellKeyToEntityIdsMap.find( GetCellKey( cellX, cellY ) );
+				if ( cellIt == _cellKeyToEntityIdsMap.cend() )
+				{
+					continue;
+				}
+
+				auto entityIdIt = cellIt->second.cbegin();
+				for ( ; entityIdIt != cellIt->second.cend(); ++entityIdIt )
+				{
+					const EntityLocation& location = _entityIdToLocationMap.find( *entityIdIt )->second;
+					const float32 distanceX = location.posX - posX;
+					const float32 distanceY = location.posY - posY;
+					if ( ( distanceX * distanceX ) + ( distanceY * distanceY ) <= squaredRadius )
+					{
+						result.push_back( *entityIdIt );
+					}
+				}
+			}
+		}
+	}
+
+	int32 SpatialGrid::GetCellCoordinate( float32 position ) const
+	{
+		return static_cast< int32 >( std::floor( position / _cellSize ) );
+	}
+
+	uint64 SpatialGrid::GetCellKey( int32 cellX, int32 cellY )
+	{
+		return ( static_cast< uint64 >( static_cast< uint32 >( cellX ) ) << 32 ) | static_cast< uint32 >( cellY );
+	}
+
+	void SpatialGrid::AddToCell( uint32 networkEntityId, uint64 cellKey )
+	{
+		_cellKeyToEntityIdsMap[ cellKey ].push_back( networkEntityId );
+	}
+
+	void SpatialGrid::RemoveFromCell( uint32 networkEntityId, uint64 cellKey )
+	{
+		auto cellIt = _cellKeyToEntityIdsMap.find( cellKey );
+		assert( cellIt != _cellKeyToEntityIdsMap.end() );
+
+		std::vector< uint32 >& entityIds = cellIt->second;
+		auto entityIdIt = std::find( entityIds.begin(), entityIds.end(), networkEntityId );
+		assert( entityIdIt != entityIds.end() );
+
+		// The order within a cell doesn't matter
+		*entityIdIt = entityIds.back();
+		entityIds.pop_back();
+		if ( entityIds.empty() )
+		{
+			_cellKeyToEntityIdsMap.erase( cellIt );
+		}
+	}
+} // namespace NetLib
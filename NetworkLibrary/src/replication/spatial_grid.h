@@ -0,0 +1,53 @@
+#pragma once
+#include "numeric_types.h"
+
+#include <unordered_map>
+#include <vector>
+
+namespace NetLib
+{
+	/// <summary>
+	/// Uniform grid of square cells, stored as a spatial hash so only cells with network entities take memory. Moving
+	/// an entity only touches the grid if it crosses to another cell.
+	/// </summary>
+	class SpatialGrid
+	{
+		public:
+			SpatialGrid( float32 cellSize );
+
+			/// <summary>
+			/// Places every entity again within cells of the new size.
+			/// </summary>
+			void SetCellSize( float32 cellSize );
+			float32 GetCellSize() const { return _cellSize; }
+
+			void AddEntity( uint32 networkEntityId, float32 posX, float32 posY );
+			void MoveEntity( uint32 networkEntityId, float32 posX, float32 posY );
+			void RemoveEntity( uint32 networkEntityId );
+			bool TryGetEntityPosition( uint32 networkEntityId, float32& posX, float32& posY ) const;
+
+			/// <summary>
+			/// Appends the entities within the circle to result. Only the cells overlapped by the circle are visited,
+			/// so the cost doesn't depend on the number of entities within the world.
+			/// </summary>
+			void GetEntitiesWithinRadius( float32 posX, float32 posY, float32 radius,
+			                              std::vector< uint32 >& result ) const;
+
+		private:
+			struct EntityLocation
+			{
+					float32 posX;
+					float32 posY;
+					uint64 cellKey;
+			};
+
+			int32 GetCellCoordinate( float32 position ) const;
+			static uint64 GetCellKey( int32 cellX, int32 cellY );
+			void AddToCell( uint32 networkEntityId, uint64 cellKey );
+			void RemoveFromCell( uint32 networkEntityId, uint64 cellKey );
+
+			float32 _cellSize;
+			std::unordered_map< uint64, std::vector< uint32 > > _cellKeyToEntityIdsMap;
+			std::unordered_map< uint32, EntityLocation > _entityIdToLocationMap;
+	};
+} // namespace NetLib
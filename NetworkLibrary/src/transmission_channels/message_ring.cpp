@@ -0,0 +1,118 @@
+#include "message_ring.h"
+
+#include <cassert>
+
+#include "communication/message.h"
+#include "communication/message_factory.h"
+
+namespace NetLib
+{
+	MessageRing::MessageRing( uint32 initialCapacity )
+	    : _entries()
+	    , _head( 0 )
+	    , _count( 0 )
+	{
+		uint32 capacity = 1;
+		while ( capacity < initialCapacity )
+		{
+			capacity *= 2;
+		}
+
+		_entries.resize( capacity );
+	}
+
+	MessageRing::MessageRing( MessageRing&& other ) noexcept
+	    : _entries( std::move( other._entries ) )
+	    , _head( other._head )
+	    , _count( other._count )
+	{
+		other._head = 0;
+		other._count = 0;
+	}
+
+	MessageRing& MessageRing::operator=( MessageRing&& other ) noexcept
+	{
+		_entries = std::move( other._entries );
+		_head = other._head;
+		_count = other._count;
+
+		other._head = 0;
+		other._count = 0;
+		return *this;
+	}
+
+	void MessageRing::PushBack( std::unique_ptr< Message > message )
+	{
+		PushBack( QueuedMessage( std::move( message ) ) );
+	}
+
+	void MessageRing::PushBack( const InlineMessage& message )
+	{
+		PushBack( QueuedMessage( message ) );
+	}
+
+	void MessageRing::PushBack( QueuedMessage message )
+	{
+		assert( !message.IsEmpty() );
+
+		if ( _count == _entries.size() )
+		{
+			Grow();
+		}
+
+		_entries[ ( _head + _count ) & ( _entries.size() - 1 ) ] = std::move( message );
+		++_count;
+	}
+
+	QueuedMessage MessageRing::PopFront()
+	{
+		assert( !IsEmpty() );
+
+		QueuedMessage message = std::move( _entries[ _head ] );
+		assert( message.IsInline() || message.GetSize() == message.GetMessage().Size() );
+
+		_head = ( _head + 1 ) & ( _entries.size() - 1 );
+		--_count;
+		return message;
+	}
+
+	const QueuedMessage& MessageRing::GetFront() const
+	{
+		assert( !IsEmpty() );
+		return _entries[ _head ];
+	}
+
+	uint32 MessageRing::GetFrontMessageSize() const
+	{
+		assert( !IsEmpty() );
+		return _entries[ _head ].GetSize();
+	}
+
+	void MessageRing::ReleaseAll( MessageFactory& messageFactory )
+	{
+		while ( !IsEmpty() )
+		{
+			PopFront().Release( messageFactory );
+		}
+
+		_head = 0;
+	}
+
+	MessageRing::~MessageRing()
+	{
+	}
+
+	void MessageRing::Grow()
+	{
+		// Unwrap the entries so they start at the beginning of the bigger ring
+		const uint32 capacity = static_cast< uint32 >( _entries.size() );
+		std::vector< QueuedMessage > entries( ( capacity == 0 ) ? 1 : capacity * 2 );
+		for ( uint32 i = 0; i < _count; ++i )
+		{
+			entries[ i ] = std::move( _entries[ ( _head + i ) & ( capacity - 1 ) ] );
+		}
+
+		_entries = std::move( entries );
+		_head = 0;
+	}
+} // namespace NetLib
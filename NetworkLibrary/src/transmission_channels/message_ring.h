@@ -0,0 +1,58 @@
+#pragma once
+#include "numeric_types.h"
+
+#include <memory>
+#include <vector>
+
+#include "transmission_channels/queued_message.h"
+
+namespace NetLib
+{
+	class Message;
+	class InlineMessage;
+	class MessageFactory;
+
+	/// <summary>
+	/// FIFO of queued messages stored back to back within a ring that doubles its capacity when full. Pushing and
+	/// popping never allocate once the ring is big enough. Fixed-size messages live within the ring itself, and the
+	/// size of every message is kept next to it so it can be checked without touching a heap message.
+	/// </summary>
+	class MessageRing
+	{
+		public:
+			MessageRing( uint32 initialCapacity );
+			MessageRing( const MessageRing& ) = delete;
+			MessageRing( MessageRing&& other ) noexcept;
+
+			MessageRing& operator=( const MessageRing& ) = delete;
+			MessageRing& operator=( MessageRing&& other ) noexcept;
+
+			bool IsEmpty() const { return _count == 0; }
+			uint32 GetCount() const { return _count; }
+
+			/// <summary>
+			/// The message must not change its size while it is within the ring.
+			/// </summary>
+			void PushBack( std::unique_ptr< Message > message );
+			void PushBack( const InlineMessage& message );
+			void PushBack( QueuedMessage message );
+			QueuedMessage PopFront();
+			const QueuedMessage& GetFront() const;
+			uint32 GetFrontMessageSize() const;
+
+			/// <summary>
+			/// Gives every message back to the message factory and keeps the memory for later reuse
+			/// </summary>
+			void ReleaseAll( MessageFactory& messageFactory );
+
+			~MessageRing();
+
+		private:
+			void Grow();
+
+			// Its size is always a power of two, so the indices wrap around with a mask
+			std::vector< QueuedMessage > _entries;
+			uint32 _head;
+			uint32 _count;
+	};
+} // namespace NetLib
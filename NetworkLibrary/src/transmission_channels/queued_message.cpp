@@ -0,0 +1,103 @@
+#include "queued_message.h"
+
+#include <cassert>
+
+#include "communication/message.h"
+#include "communication/message_factory.h"
+
+namespace NetLib
+{
+	QueuedMessage::QueuedMessage()
+	    : _message( nullptr )
+	    , _inlineMessage()
+	    , _isInline( false )
+	    , _size( 0 )
+	{
+	}
+
+	QueuedMessage::QueuedMessage( std::unique_ptr< Message > message )
+	    : _message( std::move( message ) )
+	    , _inlineMessage()
+	    , _isInline( false )
+	    , _size( 0 )
+	{
+		assert( _message != nullptr );
+		_size = _message->Size();
+	}
+
+	QueuedMessage::QueuedMessage( const InlineMessage& message )
+	    : _message( nullptr )
+	    , _inlineMessage( message )
+	    , _isInline( true )
+	    , _size( message.Size() )
+	{
+	}
+
+	QueuedMessage::QueuedMessage( QueuedMessage&& other ) noexcept
+	    : _message( std::move( other._message ) )
+	    , _inlineMessage( other._inlineMessage )
+	    , _isInline( other._isInline )
+	    , _size( other._size )
+	{
+		other._isInline = false;
+		other._size = 0;
+	}
+
+	QueuedMessage& QueuedMessage::operator=( QueuedMessage&& other ) noexcept
+	{
+		_message = std::move( other._message );
+		_inlineMessage = other._inlineMessage;
+		_isInline = other._isInline;
+		_size = other._size;
+
+		other._isInline = false;
+		other._size = 0;
+		return *this;
+	}
+
+	MessageHeader QueuedMessage::GetHeader() const
+	{
+		assert( !IsEmpty() );
+		return _isInline ? _inlineMessage.GetHeader() : _message->GetHeader();
+	}
+
+	void QueuedMessage::SetHeaderPacketSequenceNumber( uint16 packetSequenceNumber )
+	{
+		assert( !IsEmpty() );
+		if ( _isInline )
+		{
+			_inlineMessage.SetHeaderPacketSequenceNumber( packetSequenceNumber );
+		}
+		else
+		{
+			_message->SetHeaderPacketSequenceNumber( packetSequenceNumber );
+		}
+	}
+
+	const Message& QueuedMessage::GetMessage() const
+	{
+		assert( _message != nullptr );
+		return *_message;
+	}
+
+	const InlineMessage& QueuedMessage::GetInlineMessage() const
+	{
+		assert( _isInline );
+		return _inlineMessage;
+	}
+
+	void QueuedMessage::Release( MessageFactory& messageFactory )
+	{
+		if ( _message != nullptr )
+		{
+			messageFactory.ReleaseMessage( std::move( _message ) );
+		}
+
+		_isInline = false;
+		_size = 0;
+	}
+
+	QueuedMessage::~QueuedMessage()
+	{
+	}
+} // namespace NetLib
@@ -0,0 +1,60 @@
+#pragma once
+#include "numeric_types.h"
+
+#include <memory>
+
+#include "communication/inline_message.h"
+
+namespace NetLib
+{
+	class Message;
+	class MessageFactory;
+
+	/// <summary>
+	/// Message held by a transmission channel. Fixed-size types are stored inline as an InlineMessage value, so moving
+	/// them through the channel rings copies a few bytes instead of chasing a pointer. The rest are pooled heap
+	/// messages. Its size is cached when it is created, so it must not change afterwards.
+	/// </summary>
+	class QueuedMessage
+	{
+		public:
+			QueuedMessage();
+			explicit QueuedMessage( std::unique_ptr< Message > message );
+			explicit QueuedMessage( const InlineMessage& message );
+			QueuedMessage( const QueuedMessage& ) = delete;
+			QueuedMessage( QueuedMessage&& other ) noexcept;
+
+			QueuedMessage& operator=( const QueuedMessage& ) = delete;
+			QueuedMessage& operator=( QueuedMessage&& other ) noexcept;
+
+			bool IsEmpty() const { return !_isInline && _message == nullptr; }
+			bool IsInline() const { return _isInline; }
+
+			MessageHeader GetHeader() const;
+			void SetHeaderPacketSequenceNumber( uint16 packetSequenceNumber );
+			uint32 GetSize() const { return _size; }
+
+			/// <summary>
+			/// Only valid if it is not inline
+			/// </summary>
+			const Message& GetMessage() const;
+			/// <summary>
+			/// Only valid if it is inline
+			/// </summary>
+			const InlineMessage& GetInlineMessage() const;
+
+			/// <summary>
+			/// Gives the heap message back to the message factory, if any, and leaves it empty
+			/// </summary>
+			void Release( MessageFactory& messageFactory );
+
+			~QueuedMessage();
+
+		private:
+			// Null if it is inline
+			std::unique_ptr< Message > _message;
+			InlineMessage _inlineMessage;
+			bool _isInline;
+			uint32 _size;
+	};
+} // namespace NetLib
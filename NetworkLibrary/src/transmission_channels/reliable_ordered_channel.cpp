@@ -1,5 +1,6 @@
 #include "reliable_ordered_channel.h"
 
+#include <cassert>
 #include <memory>
 
 #include "communication/message.h"
@@ -16,11 +17,21 @@ namespace NetLib
 {
 	ReliableOrderedChannel::ReliableOrderedChannel()
 	    : TransmissionChannel( TransmissionChannelType::ReliableOrdered )
+	    , _unackedReliableMessages( INITIAL_UNACKED_MESSAGE_BUFFER_SIZE )
+	    , _unackedReliableMessageTransmissions()
+	    , _timedOutReliableMessageTransmissions()
+	    , _nextTransmissionId( 0 )
+	    , _elapsedTime( 0.0 )
+	    , _areUnsentACKs( false )
 	    , _lastMessageSequenceNumberAcked( 0 )
-	    , _nextOrderedMessageSequenceNumber( 1 )
+	    , _reliableMessageEntries()
 	    , _reliableMessageEntriesBufferSize( 1024 )
-	    , _areUnsentACKs( false )
+	    , _messagesRTTToProcess()
 	    , _rttMilliseconds( 0 )
+	    , _ackedBytes( 0 )
+	    , _numberOfTimedOutMessages( 0 )
+	    , _orderedMessagesWaitingForPrevious( INITIAL_REORDER_BUFFER_SIZE )
+	    , _nextOrderedMessageSequenceNumber( 1 )
 	{
 		_reliableMessageEntries.reserve( _reliableMessageEntriesBufferSize );
 		for ( uint32 i = 0; i < _reliableMessageEntriesBufferSize; ++i )
@@ -31,22 +42,25 @@ namespace NetLib
 
 	ReliableOrderedChannel::ReliableOrderedChannel( ReliableOrderedChannel&& other ) noexcept
 	    : TransmissionChannel( std::move( other ) )
-	    , _lastMessageSequenceNumberAcked( std::move( other._lastMessageSequenceNumberAcked ) )
+	    , _unackedReliableMessages( std::move( other._unackedReliableMessages ) )
+	    , _unackedReliableMessageTransmissions( std::move( other._unackedReliableMessageTransmissions ) )
+	    , _timedOutReliableMessageTransmissions( std::move( other._timedOutReliableMessageTransmissions ) )
+	    , _nextTransmissionId( other._nextTransmissionId )
+	    , _elapsedTime( other._elapsedTime )
 	    , // unnecessary move, just in case I change that type
-	    _nextOrderedMessageSequenceNumber( std::move( other._nextOrderedMessageSequenceNumber ) )
+	    _areUnsentACKs( std::move( other._areUnsentACKs ) )
+	    , _lastMessageSequenceNumberAcked( std::move( other._lastMessageSequenceNumberAcked ) )
+	    , _reliableMessageEntries( std::move( other._reliableMessageEntries ) )
 	    , // unnecessary move, just in case I change that type
 	    _reliableMessageEntriesBufferSize( std::move( other._reliableMessageEntriesBufferSize ) )
-	    , // unnecessary move, just in case I change that type
-	    _areUnsentACKs( std::move( other._areUnsentACKs ) )
+	    , _messagesRTTToProcess( std::move( other._messagesRTTToProcess ) )
 	    , // unnecessary move, just in case I change that type
 	    _rttMilliseconds( std::move( other._rttMilliseconds ) )
-	    , // unnecessary move, just in case I change that type
-	    _unackedReliableMessages( std::move( other._unackedReliableMessages ) )
-	    , _unackedReliableMessageTimeouts( std::move( other._unackedReliableMessageTimeouts ) )
-	    , _reliableMessageEntries( std::move( other._reliableMessageEntries ) )
-	    , _unackedMessagesSendTimes( std::move( other._unackedMessagesSendTimes ) )
-	    , _messagesRTTToProcess( std::move( other._messagesRTTToProcess ) )
+	    , _ackedBytes( other._ackedBytes )
+	    , _numberOfTimedOutMessages( other._numberOfTimedOutMessages )
 	    , _orderedMessagesWaitingForPrevious( std::move( other._orderedMessagesWaitingForPrevious ) )
+	    , // unnecessary move, just in case I change that type
+	    _nextOrderedMessageSequenceNumber( std::move( other._nextOrderedMessageSequenceNumber ) )
 	{
 	}
 
@@ -64,10 +78,14 @@ namespace NetLib
 		    std::move( other._reliableMessageEntriesBufferSize ); // unnecessary move, just in case I change that type
 		_areUnsentACKs = std::move( other._areUnsentACKs );       // unnecessary move, just in case I change that type
 		_rttMilliseconds = std::move( other._rttMilliseconds );   // unnecessary move, just in case I change that type
+		_ackedBytes = other._ackedBytes;
+		_numberOfTimedOutMessages = other._numberOfTimedOutMessages;
 		_unackedReliableMessages = std::move( other._unackedReliableMessages );
-		_unackedReliableMessageTimeouts = std::move( other._unackedReliableMessageTimeouts );
+		_unackedReliableMessageTransmissions = std::move( other._unackedReliableMessageTransmissions );
+		_timedOutReliableMessageTransmissions = std::move( other._timedOutReliableMessageTransmissions );
+		_nextTransmissionId = other._nextTransmissionId;
+		_elapsedTime = other._elapsedTime;
 		_reliableMessageEntries = std::move( other._reliableMessageEntries );
-		_unackedMessagesSendTimes = std::move( other._unackedMessagesSendTimes );
 		_messagesRTTToProcess = std::move( other._messagesRTTToProcess );
 		_orderedMessagesWaitingForPrevious = std::move( other._orderedMessagesWaitingForPrevious );
 
@@ -77,36 +95,40 @@ namespace NetLib
 
 	void ReliableOrderedChannel::AddMessageToSend( std::unique_ptr< Message > message )
 	{
-		_unsentMessages.push_back( std::move( message ) );
+		_unsentMessages.PushBack( std::move( message ) );
+	}
+
+	void ReliableOrderedChannel::AddMessageToSend( const InlineMessage& message )
+	{
+		_unsentMessages.PushBack( message );
 	}
 
 	bool ReliableOrderedChannel::ArePendingMessagesToSend() const
 	{
-		return ( !_unsentMessages.empty() || AreUnackedMessagesToResend() );
+		return ( !_unsentMessages.IsEmpty() || AreUnackedMessagesToResend() );
 	}
 
-	std::unique_ptr< Message > ReliableOrderedChannel::GetMessageToSend()
+	QueuedMessage ReliableOrderedChannel::GetMessageToSend()
 	{
-		std::unique_ptr< Message > message = nullptr;
-		if ( !_unsentMessages.empty() )
+		QueuedMessage message;
+		if ( !_unsentMessages.IsEmpty() )
 		{
-			message = std::move( _unsentMessages[ 0 ] );
-			_unsentMessages.erase( _unsentMessages.begin() );
+			message = _unsentMessages.PopFront();
 
 			uint16 sequenceNumber = GetNextMessageSequenceNumber();
 			IncreaseMessageSequenceNumber();
 
-			message->SetHeaderPacketSequenceNumber( sequenceNumber );
+			message.SetHeaderPacketSequenceNumber( sequenceNumber );
 		}
 		else
 		{
 			message = GetUnackedMessageToResend();
 		}
 
-		// TODO Check that this is not called when message == nullptr. GetUnackedMessageToResend could return a nullptr
-		// (Although it would be an error tbh)
+		// TODO Check that this is not called when message is empty. GetUnackedMessageToResend could return an empty
+		// one (Although it would be an error tbh)
 
-		return std::move( message );
+		return message;
 	}
 
 	uint32 ReliableOrderedChannel::GetSizeOfNextUnsentMessage() const
@@ -116,19 +138,15 @@ namespace NetLib
 			return 0;
 		}
 
-		if ( !_unsentMessages.empty() )
+		if ( !_unsentMessages.IsEmpty() )
 		{
-			return _unsentMessages.front()->Size();
+			return _unsentMessages.GetFrontMessageSize();
 		}
 		else
 		{
 			// Get next unacked message's size
-			int32 index = GetNextUnackedMessageIndexToResend();
-
-			std::list< std::unique_ptr< Message > >::const_iterator cit = _unackedReliableMessages.cbegin();
-			std::advance( cit, index );
-
-			return ( *cit )->Size();
+			const uint16 sequenceNumber = _timedOutReliableMessageTransmissions.front().sequenceNumber;
+			return _unackedReliableMessages[ GetUnackedReliableMessageIndex( sequenceNumber ) ].message.GetSize();
 		}
 	}
 
@@ -149,32 +167,18 @@ namespace NetLib
 			AckReliableMessage( messageSequenceNumber );
 			if ( messageSequenceNumber == _nextOrderedMessageSequenceNumber )
 			{
-				_readyToProcessMessages.push( std::move( message ) );
+				AddReadyToProcessMessage( std::move( message ) );
 				++_nextOrderedMessageSequenceNumber;
 
-				bool continueProcessing = true;
-				uint32 index = 0;
-				while ( continueProcessing )
+				// Deliver the ones that were only waiting for this message
+				uint32 index = GetOrderedMessageWaitingIndex( _nextOrderedMessageSequenceNumber );
+				while ( _orderedMessagesWaitingForPrevious[ index ] != nullptr &&
+				        _orderedMessagesWaitingForPrevious[ index ]->GetHeader().messageSequenceNumber ==
+				            _nextOrderedMessageSequenceNumber )
 				{
-					if ( _orderedMessagesWaitingForPrevious.empty() )
-					{
-						continueProcessing = false;
-					}
-					else if ( DoesUnorderedMessagesContainsSequence( _nextOrderedMessageSequenceNumber, index ) )
-					{
-						std::list< std::unique_ptr< Message > >::iterator it =
-						    _orderedMessagesWaitingForPrevious.begin();
-						std::advance( it, index );
-
-						std::unique_ptr< Message > readyToProcessMessage( std::move( *it ) );
-						_readyToProcessMessages.push( std::move( readyToProcessMessage ) );
-						_orderedMessagesWaitingForPrevious.erase( it );
-						++_nextOrderedMessageSequenceNumber;
-					}
-					else
-					{
-						continueProcessing = false;
-					}
+					AddReadyToProcessMessage( std::move( _orderedMessagesWaitingForPrevious[ index ] ) );
+					++_nextOrderedMessageSequenceNumber;
+					index = GetOrderedMessageWaitingIndex( _nextOrderedMessageSequenceNumber );
 				}
 			}
 			else
@@ -186,7 +190,7 @@ namespace NetLib
 
 	bool ReliableOrderedChannel::ArePendingReadyToProcessMessages() const
 	{
-		return !_readyToProcessMessages.empty();
+		return !_readyToProcessMessages.IsEmpty();
 	}
 
 	const Message* ReliableOrderedChannel::GetReadyToProcessMessage()
@@ -196,81 +200,97 @@ namespace NetLib
 			return nullptr;
 		}
 
-		std::unique_ptr< Message > message( std::move( _readyToProcessMessages.front() ) );
-		_readyToProcessMessages.pop();
+		QueuedMessage message = _readyToProcessMessages.PopFront();
 
-		Message* messageToReturn = message.get();
-		_processedMessages.push( std::move( message ) );
+		const Message* messageToReturn = &message.GetMessage();
+		_processedMessages.PushBack( std::move( message ) );
 
 		return messageToReturn;
 	}
 
 	bool ReliableOrderedChannel::AreUnackedMessagesToResend() const
 	{
-		std::list< float32 >::const_iterator cit = _unackedReliableMessageTimeouts.cbegin();
-		bool found = false;
-		while ( cit != _unackedReliableMessageTimeouts.cend() && !found )
-		{
-			float32 timeout = *cit;
-			if ( timeout <= 0 )
-			{
-				found = true;
-			}
+		return !_timedOutReliableMessageTransmissions.empty();
+	}
 
-			++cit;
+	QueuedMessage ReliableOrderedChannel::GetUnackedMessageToResend()
+	{
+		if ( !AreUnackedMessagesToResend() )
+		{
+			return QueuedMessage();
 		}
 
-		return found;
+		const uint16 sequenceNumber = _timedOutReliableMessageTransmissions.front().sequenceNumber;
+		_timedOutReliableMessageTransmissions.pop();
+
+		// It gets back to its slot with a new transmission once it has been sent
+		const uint32 index = GetUnackedReliableMessageIndex( sequenceNumber );
+		QueuedMessage message = std::move( _unackedReliableMessages[ index ].message );
+		DiscardAckedTimedOutTransmissions();
+
+		return message;
 	}
 
-	std::unique_ptr< Message > ReliableOrderedChannel::GetUnackedMessageToResend()
+	void ReliableOrderedChannel::AddUnackedReliableMessage( QueuedMessage message )
 	{
-		int32 index = GetNextUnackedMessageIndexToResend();
-		if ( index == -1 )
+		const uint16 sequenceNumber = message.GetHeader().messageSequenceNumber;
+		uint32 index = GetUnackedReliableMessageIndex( sequenceNumber );
+		while ( !_unackedReliableMessages[ index ].message.IsEmpty() )
 		{
-			return nullptr;
+			// A message in flight for too long already takes this slot
+			assert( _unackedReliableMessages[ index ].message.GetHeader().messageSequenceNumber != sequenceNumber );
+			GrowUnackedReliableMessages();
+			index = GetUnackedReliableMessageIndex( sequenceNumber );
 		}
 
-		std::unique_ptr< Message > message = DeleteUnackedReliableMessageAtIndex( index );
+		const TimeClock& timeClock = TimeClock::GetInstance();
+		LOG_INFO( "Retransmission Timeout: %f", GetRetransmissionTimeout() );
 
-		return std::move( message );
+		UnackedReliableMessageEntry& entry = _unackedReliableMessages[ index ];
+		entry.message = std::move( message );
+		entry.sendTimeMilliseconds = timeClock.GetLocalTimeMilliseconds();
+		entry.timeoutTime = _elapsedTime + GetRetransmissionTimeout();
+		entry.transmissionId = _nextTransmissionId;
+		++_nextTransmissionId;
+
+		_unackedReliableMessageTransmissions.push( { sequenceNumber, entry.transmissionId } );
 	}
 
-	int32 ReliableOrderedChannel::GetNextUnackedMessageIndexToResend() const
+	bool ReliableOrderedChannel::IsTransmissionPending( const UnackedReliableMessageTransmission& transmission ) const
 	{
-		int32 index = 0;
-		std::list< float32 >::const_iterator cit = _unackedReliableMessageTimeouts.cbegin();
-		bool found = false;
-		while ( cit != _unackedReliableMessageTimeouts.cend() && !found )
-		{
-			float32 timeout = *cit;
-			if ( timeout <= 0 )
-			{
-				found = true;
-			}
-			else
-			{
-				++index;
-				++cit;
-			}
-		}
+		const UnackedReliableMessageEntry& entry =
+		    _unackedReliableMessages[ GetUnackedReliableMessageIndex( transmission.sequenceNumber ) ];
+		return !entry.message.IsEmpty() &&
+		       entry.message.GetHeader().messageSequenceNumber == transmission.sequenceNumber &&
+		       entry.transmissionId == transmission.transmissionId;
+	}
 
-		if ( !found )
+	void ReliableOrderedChannel::DiscardAckedTimedOutTransmissions()
+	{
+		while ( !_timedOutReliableMessageTransmissions.empty() &&
+		        !IsTransmissionPending( _timedOutReliableMessageTransmissions.front() ) )
 		{
-			index = -1;
+			_timedOutReliableMessageTransmissions.pop();
 		}
-
-		return index;
 	}
 
-	void ReliableOrderedChannel::AddUnackedReliableMessage( std::unique_ptr< Message > message )
+	void ReliableOrderedChannel::GrowUnackedReliableMessages()
 	{
-		const TimeClock& timeClock = TimeClock::GetInstance();
-		_unackedMessagesSendTimes[ message->GetHeader().messageSequenceNumber ] = timeClock.GetLocalTimeMilliseconds();
+		std::vector< UnackedReliableMessageEntry > oldEntries = std::move( _unackedReliableMessages );
+		_unackedReliableMessages = std::vector< UnackedReliableMessageEntry >( oldEntries.size() * 2 );
 
-		_unackedReliableMessages.push_back( std::move( message ) );
-		LOG_INFO( "Retransmission Timeout: %f", GetRetransmissionTimeout() );
-		_unackedReliableMessageTimeouts.push_back( GetRetransmissionTimeout() );
+		// Sequence numbers in different slots before doubling the size keep being in different slots
+		for ( UnackedReliableMessageEntry& entry : oldEntries )
+		{
+			if ( !entry.message.IsEmpty() )
+			{
+				const uint32 index = GetUnackedReliableMessageIndex( entry.message.GetHeader().messageSequenceNumber );
+				_unackedReliableMessages[ index ] = std::move( entry );
+			}
+		}
+
+		LOG_INFO( "Unacked reliable messages buffer grown to %u slots",
+		          static_cast< uint32 >( _unackedReliableMessages.size() ) );
 	}
 
 	void ReliableOrderedChannel::AckReliableMessage( uint16 messageSequenceNumber )
@@ -286,120 +306,77 @@ namespace NetLib
 		_areUnsentACKs = true;
 	}
 
-	bool ReliableOrderedChannel::DoesUnorderedMessagesContainsSequence( uint16 sequence, uint32& index ) const
+	void ReliableOrderedChannel::AddOrderedMessage( std::unique_ptr< Message > message )
 	{
-		const Message* message = nullptr;
-		uint32 idx = 0;
-		for ( std::list< std::unique_ptr< Message > >::const_iterator cit = _orderedMessagesWaitingForPrevious.cbegin();
-		      cit != _orderedMessagesWaitingForPrevious.cend(); ++cit )
+		MessageFactory& messageFactory = MessageFactory::GetInstance();
+		const uint16 sequenceNumber = message->GetHeader().messageSequenceNumber;
+
+		// Already delivered, even if its entry is not around anymore to tell that it is duplicated
+		if ( static_cast< int16 >( sequenceNumber - _nextOrderedMessageSequenceNumber ) < 0 )
+		{
+			messageFactory.ReleaseMessage( std::move( message ) );
+			return;
+		}
+
+		uint32 index = GetOrderedMessageWaitingIndex( sequenceNumber );
+		while ( _orderedMessagesWaitingForPrevious[ index ] != nullptr )
 		{
-			message = ( *cit ).get();
-			if ( message->GetHeader().messageSequenceNumber == sequence )
+			if ( _orderedMessagesWaitingForPrevious[ index ]->GetHeader().messageSequenceNumber == sequenceNumber )
 			{
-				index = idx;
-				return true;
+				messageFactory.ReleaseMessage( std::move( message ) );
+				return;
 			}
 
-			++idx;
+			GrowOrderedMessagesWaitingForPrevious();
+			index = GetOrderedMessageWaitingIndex( sequenceNumber );
 		}
 
-		return false;
+		_orderedMessagesWaitingForPrevious[ index ] = std::move( message );
 	}
 
-	bool ReliableOrderedChannel::AddOrderedMessage( std::unique_ptr< Message > message )
+	void ReliableOrderedChannel::GrowOrderedMessagesWaitingForPrevious()
 	{
-		_orderedMessagesWaitingForPrevious.push_back( std::move( message ) );
-		return true;
+		std::vector< std::unique_ptr< Message > > oldMessages = std::move( _orderedMessagesWaitingForPrevious );
+		_orderedMessagesWaitingForPrevious = std::vector< std::unique_ptr< Message > >( oldMessages.size() * 2 );
 
-		// TODO Ver para qu es esto de abajo y por qu este return de aqu arriba
-		std::list< std::unique_ptr< Message > >::iterator it = _orderedMessagesWaitingForPrevious.begin();
-		if ( _orderedMessagesWaitingForPrevious.empty() )
+		for ( std::unique_ptr< Message >& message : oldMessages )
 		{
-			_orderedMessagesWaitingForPrevious.insert( it, std::move( message ) );
-			return true;
-		}
-
-		bool found = false;
-		while ( it != _orderedMessagesWaitingForPrevious.end() && !found )
-		{
-			uint16 sequenceNumber = ( *it )->GetHeader().messageSequenceNumber;
-			if ( sequenceNumber > message->GetHeader().messageSequenceNumber )
-			{
-				found = true;
-			}
-			else
+			if ( message != nullptr )
 			{
-				++it;
+				const uint32 index = GetOrderedMessageWaitingIndex( message->GetHeader().messageSequenceNumber );
+				_orderedMessagesWaitingForPrevious[ index ] = std::move( message );
 			}
 		}
 
-		_orderedMessagesWaitingForPrevious.insert( it, std::move( message ) );
-
-		return found;
+		LOG_INFO( "Ordered messages buffer grown to %u slots",
+		          static_cast< uint32 >( _orderedMessagesWaitingForPrevious.size() ) );
 	}
 
 	bool ReliableOrderedChannel::TryRemoveUnackedReliableMessageFromSequence( uint16 sequence )
 	{
 		bool result = false;
 
-		int32 index = GetPendingUnackedReliableMessageIndexFromSequence( sequence );
-		if ( index != -1 )
+		UnackedReliableMessageEntry& entry = _unackedReliableMessages[ GetUnackedReliableMessageIndex( sequence ) ];
+		if ( !entry.message.IsEmpty() && entry.message.GetHeader().messageSequenceNumber == sequence )
 		{
-			std::unique_ptr< Message > message = DeleteUnackedReliableMessageAtIndex( index );
+			QueuedMessage message = std::move( entry.message );
 
 			// Calculate RTT of acked message
 			const TimeClock& timeClock = TimeClock::GetInstance();
 			uint64 currentElapsedTime = timeClock.GetLocalTimeMilliseconds();
-			uint16 messageRTT = currentElapsedTime - _unackedMessagesSendTimes[ sequence ];
-			std::unordered_map< uint16, uint16 >::iterator it = _unackedMessagesSendTimes.find( sequence );
-			_unackedMessagesSendTimes.erase( it );
+			uint16 messageRTT = static_cast< uint16 >( currentElapsedTime - entry.sendTimeMilliseconds );
 			AddMessageRTTValueToProcess( messageRTT );
+			_ackedBytes += message.GetSize();
 
 			// Release acked message since we no longer need it
 			MessageFactory& messageFactory = MessageFactory::GetInstance();
-			messageFactory.ReleaseMessage( std::move( message ) );
+			message.Release( messageFactory );
 			result = true;
 		}
 
 		return result;
 	}
 
-	int32 ReliableOrderedChannel::GetPendingUnackedReliableMessageIndexFromSequence( uint16 sequence ) const
-	{
-		int32 resultIndex = -1;
-		uint32 currentIndex = 0;
-		for ( std::list< std::unique_ptr< Message > >::const_iterator it = _unackedReliableMessages.cbegin();
-		      it != _unackedReliableMessages.cend(); ++it )
-		{
-			if ( ( *it )->GetHeader().messageSequenceNumber == sequence )
-			{
-				resultIndex = currentIndex;
-				break;
-			}
-
-			++currentIndex;
-		}
-
-		return resultIndex;
-	}
-
-	std::unique_ptr< Message > ReliableOrderedChannel::DeleteUnackedReliableMessageAtIndex( uint32 index )
-	{
-		assert( index < _unackedReliableMessages.size() );
-
-		std::list< std::unique_ptr< Message > >::iterator it = _unackedReliableMessages.begin();
-		std::advance( it, index );
-		std::unique_ptr< Message > message( std::move( *it ) );
-
-		_unackedReliableMessages.erase( it );
-
-		std::list< float32 >::iterator it2 = _unackedReliableMessageTimeouts.begin();
-		std::advance( it2, index );
-		_unackedReliableMessageTimeouts.erase( it2 );
-
-		return std::move( message );
-	}
-
 	const ReliableMessageEntry& ReliableOrderedChannel::GetReliableMessageEntry( uint16 sequenceNumber ) const
 	{
 		uint32 index = GetRollingBufferIndex( sequenceNumber );
@@ -446,31 +423,21 @@ namespace NetLib
 	{
 		MessageFactory& messageFactory = MessageFactory::GetInstance();
 
-		std::list< std::unique_ptr< Message > >::iterator it = _unackedReliableMessages.begin();
-		while ( it != _unackedReliableMessages.end() )
+		for ( UnackedReliableMessageEntry& entry : _unackedReliableMessages )
 		{
-			std::unique_ptr< Message > message( std::move( *it ) );
-			messageFactory.ReleaseMessage( std::move( message ) );
-
-			++it;
+			entry.message.Release( messageFactory );
 		}
 
-		_unackedReliableMessages.clear();
-
-		_unackedReliableMessageTimeouts.clear();
-
-		_unackedMessagesSendTimes.clear();
+		_unackedReliableMessageTransmissions = std::queue< UnackedReliableMessageTransmission >();
+		_timedOutReliableMessageTransmissions = std::queue< UnackedReliableMessageTransmission >();
 
-		it = _orderedMessagesWaitingForPrevious.begin();
-		while ( it != _orderedMessagesWaitingForPrevious.end() )
+		for ( std::unique_ptr< Message >& message : _orderedMessagesWaitingForPrevious )
 		{
-			std::unique_ptr< Message > message( std::move( *it ) );
-			messageFactory.ReleaseMessage( std::move( message ) );
-
-			++it;
+			if ( message != nullptr )
+			{
+				messageFactory.ReleaseMessage( std::move( message ) );
+			}
 		}
-
-		_orderedMessagesWaitingForPrevious.clear();
 	}
 
 	void ReliableOrderedChannel::SeUnsentACKsToFalse()
@@ -515,6 +482,8 @@ namespace NetLib
 				TryRemoveUnackedReliableMessageFromSequence( firstAckSequence - i );
 			}
 		}
+
+		DiscardAckedTimedOutTransmissions();
 	}
 
 	bool ReliableOrderedChannel::IsMessageDuplicated( uint16 messageSequenceNumber ) const
@@ -533,21 +502,28 @@ namespace NetLib
 
 	void ReliableOrderedChannel::Update( float32 deltaTime )
 	{
-		// Update unacked message timeouts
-		std::list< float32 >::iterator it = _unackedReliableMessageTimeouts.begin();
-		while ( it != _unackedReliableMessageTimeouts.end() )
-		{
-			float32 timeout = *it;
-			timeout -= deltaTime;
+		_elapsedTime += deltaTime;
 
-			if ( timeout < 0 )
+		// Move the timed out transmissions to the resend queue. The retransmission timeout changes slowly, so the
+		// oldest transmissions are the first ones to time out. Acked ones are dropped
+		while ( !_unackedReliableMessageTransmissions.empty() )
+		{
+			const UnackedReliableMessageTransmission& transmission = _unackedReliableMessageTransmissions.front();
+			if ( IsTransmissionPending( transmission ) )
 			{
-				timeout = 0;
-			}
+				const UnackedReliableMessageEntry& entry =
+				    _unackedReliableMessages[ GetUnackedReliableMessageIndex( transmission.sequenceNumber ) ];
+				if ( entry.timeoutTime > _elapsedTime )
+				{
+					break;
+				}
 
-			*it = timeout;
+				// The message is considered lost
+				++_numberOfTimedOutMessages;
+				_timedOutReliableMessageTransmissions.push( transmission );
+			}
 
-			++it;
+			_unackedReliableMessageTransmissions.pop();
 		}
 
 		// Update RTT
@@ -567,6 +543,10 @@ namespace NetLib
 		_nextOrderedMessageSequenceNumber = 1;
 		_areUnsentACKs = false;
 		_rttMilliseconds = 0;
+		_ackedBytes = 0;
+		_numberOfTimedOutMessages = 0;
+		_nextTransmissionId = 0;
+		_elapsedTime = 0.0;
 
 		while ( !_messagesRTTToProcess.empty() )
 		{
@@ -584,12 +564,20 @@ namespace NetLib
 		return _rttMilliseconds;
 	}
 
+	void ReliableOrderedChannel::TakeCongestionSignals( uint32& ackedBytes, uint32& numberOfTimedOutMessages )
+	{
+		ackedBytes = _ackedBytes;
+		numberOfTimedOutMessages = _numberOfTimedOutMessages;
+		_ackedBytes = 0;
+		_numberOfTimedOutMessages = 0;
+	}
+
 	ReliableOrderedChannel::~ReliableOrderedChannel()
 	{
 		ClearMessages();
 	}
 
-	void ReliableOrderedChannel::FreeSentMessage( MessageFactory& messageFactory, std::unique_ptr< Message > message )
+	void ReliableOrderedChannel::FreeSentMessage( MessageFactory& messageFactory, QueuedMessage message )
 	{
 		AddUnackedReliableMessage( std::move( message ) );
 	}
@@ -1,6 +1,6 @@
 #pragma once
-#include <list>
-#include <unordered_map>
+#include <queue>
+#include <vector>
 
 #include "transmission_channels/transmission_channel.h"
 
@@ -8,6 +8,10 @@ namespace NetLib
 {
 	class Message;
 
+	// Sequence-indexed buffers grow on demand, this only avoids growing them with the usual traffic. Powers of two
+	constexpr uint32 INITIAL_UNACKED_MESSAGE_BUFFER_SIZE = 256;
+	constexpr uint32 INITIAL_REORDER_BUFFER_SIZE = 256;
+
 	struct ReliableMessageEntry
 	{
 			ReliableMessageEntry()
@@ -37,8 +41,9 @@ namespace NetLib
 			ReliableOrderedChannel& operator=( ReliableOrderedChannel&& other ) noexcept;
 
 			void AddMessageToSend( std::unique_ptr< Message > message ) override;
+			void AddMessageToSend( const InlineMessage& message ) override;
 			bool ArePendingMessagesToSend() const override;
-			std::unique_ptr< Message > GetMessageToSend() override;
+			QueuedMessage GetMessageToSend() override;
 			uint32 GetSizeOfNextUnsentMessage() const override;
 
 			void AddReceivedMessage( std::unique_ptr< Message > message ) override;
@@ -59,17 +64,45 @@ namespace NetLib
 
 			uint32 GetRTTMilliseconds() const override;
 
+			void TakeCongestionSignals( uint32& ackedBytes, uint32& numberOfTimedOutMessages ) override;
+
 			~ReliableOrderedChannel();
 
 		protected:
-			void FreeSentMessage( MessageFactory& messageFactory, std::unique_ptr< Message > message ) override;
+			void FreeSentMessage( MessageFactory& messageFactory, QueuedMessage message ) override;
 
 		private:
+			// Slot of a reliable message that has been sent and not acked yet
+			struct UnackedReliableMessageEntry
+			{
+					// Empty if the slot is free. Fixed-size messages are kept inline until they are acked
+					QueuedMessage message;
+					// Local time in milliseconds of its last transmission (For RTT purposes)
+					uint64 sendTimeMilliseconds;
+					// Channel time after which its last transmission is considered lost
+					float64 timeoutTime;
+					// Identifies its last transmission, so older transmissions still queued can be told apart
+					uint32 transmissionId;
+			};
+
+			// Transmission of an unacked message, in the order they are waiting to time out or to be resent
+			struct UnackedReliableMessageTransmission
+			{
+					uint16 sequenceNumber;
+					uint32 transmissionId;
+			};
+
 			// RELIABLE RELATED
-			// Collection of reliable messages that have not already been acked
-			std::list< std::unique_ptr< Message > > _unackedReliableMessages;
-			// Timeouts of _unackedReliableMessages
-			std::list< float32 > _unackedReliableMessageTimeouts;
+			// Reliable messages that have not already been acked, indexed by their sequence number. Its size is always
+			// a power of two
+			std::vector< UnackedReliableMessageEntry > _unackedReliableMessages;
+			// Transmissions waiting for their timeout, oldest first. Acked ones are skipped once they are in front
+			std::queue< UnackedReliableMessageTransmission > _unackedReliableMessageTransmissions;
+			// Transmissions that timed out and whose messages are waiting to be resent. The front one is never acked
+			std::queue< UnackedReliableMessageTransmission > _timedOutReliableMessageTransmissions;
+			uint32 _nextTransmissionId;
+			// Accumulated delta time of the channel updates
+			float64 _elapsedTime;
 			// Retransmission timeout when RTT is zero
 			const float32 _initialTimeout = 0.5f;
 			// Flag to check if are there pending ACKs to send
@@ -79,8 +112,6 @@ namespace NetLib
 			// Collection of reliable message entries to handle ACKs
 			std::vector< ReliableMessageEntry > _reliableMessageEntries;
 			uint32 _reliableMessageEntriesBufferSize;
-			// Elapsed time since start of the program that each reliable message was sent (For RTT purposes)
-			std::unordered_map< uint16, uint16 > _unackedMessagesSendTimes;
 
 			// RTT RELATED
 			// Message RTT values waiting to be added to the current RTT value
@@ -88,23 +119,38 @@ namespace NetLib
 			// Current RTT value in milliseconds
 			uint16 _rttMilliseconds;
 
+			// CONGESTION RELATED
+			// Signals observed since they were last taken
+			uint32 _ackedBytes;
+			uint32 _numberOfTimedOutMessages;
+
 			// ORDERED RELATED
-			// Collection of messages waiting for a previous message in order to guarantee ordered delivery
-			std::list< std::unique_ptr< Message > > _orderedMessagesWaitingForPrevious;
+			// Messages waiting for a previous message in order to guarantee ordered delivery, indexed by their
+			// sequence number. Its size is always a power of two
+			std::vector< std::unique_ptr< Message > > _orderedMessagesWaitingForPrevious;
 			// Next message sequence number expected to guarantee ordered transmission
-			uint32 _nextOrderedMessageSequenceNumber;
+			uint16 _nextOrderedMessageSequenceNumber;
 
 			bool AreUnackedMessagesToResend() const;
-			std::unique_ptr< Message > GetUnackedMessageToResend();
-			int32 GetNextUnackedMessageIndexToResend() const;
-			void AddUnackedReliableMessage( std::unique_ptr< Message > message );
+			QueuedMessage GetUnackedMessageToResend();
+			void AddUnackedReliableMessage( QueuedMessage message );
+			bool IsTransmissionPending( const UnackedReliableMessageTransmission& transmission ) const;
+			void DiscardAckedTimedOutTransmissions();
+			void GrowUnackedReliableMessages();
 
 			void AckReliableMessage( uint16 messageSequenceNumber );
-			bool DoesUnorderedMessagesContainsSequence( uint16 sequence, uint32& index ) const;
-			bool AddOrderedMessage( std::unique_ptr< Message > message );
+			void AddOrderedMessage( std::unique_ptr< Message > message );
+			void GrowOrderedMessagesWaitingForPrevious();
 			bool TryRemoveUnackedReliableMessageFromSequence( uint16 sequence );
-			int32 GetPendingUnackedReliableMessageIndexFromSequence( uint16 sequence ) const;
-			std::unique_ptr< Message > DeleteUnackedReliableMessageAtIndex( uint32 index );
+
+			uint32 GetUnackedReliableMessageIndex( uint16 sequenceNumber ) const
+			{
+				return sequenceNumber & ( _unackedReliableMessages.size() - 1 );
+			}
+			uint32 GetOrderedMessageWaitingIndex( uint16 sequenceNumber ) const
+			{
+				return sequenceNumber & ( _orderedMessagesWaitingForPrevious.size() - 1 );
+			}
 
 			const ReliableMessageEntry& GetReliableMessageEntry( uint16 sequenceNumber ) const;
 			uint32 GetRollingBufferIndex( uint16 index ) const { return index % _reliableMessageEntriesBufferSize; };
@@ -2,26 +2,32 @@
 
 #include <cassert>
 
+#include "communication/message.h"
 #include "communication/message_factory.h"
 
 namespace NetLib
 {
 	TransmissionChannel::TransmissionChannel( TransmissionChannelType type )
-	    : _type( type )
+	    : _unsentMessages( INITIAL_MESSAGE_RING_CAPACITY )
+	    , _sentMessages( INITIAL_MESSAGE_RING_CAPACITY )
+	    , _readyToProcessMessages( INITIAL_MESSAGE_RING_CAPACITY )
+	    , _processedMessages( INITIAL_MESSAGE_RING_CAPACITY )
+	    , _type( type )
 	    , _nextMessageSequenceNumber( 1 )
+	    , _fragmentReassembler()
 	{
-		_unsentMessages.reserve( 5 );
 	}
 
 	TransmissionChannel::TransmissionChannel( TransmissionChannel&& other ) noexcept
-	    : _type( std::move( other._type ) )
-	    , // unnecessary move, just in case I change that type
-	    _nextMessageSequenceNumber( std::move( other._nextMessageSequenceNumber ) )
-	    , // unnecessary move, just in case I change that type
-	    _unsentMessages( std::move( other._unsentMessages ) )
+	    : _unsentMessages( std::move( other._unsentMessages ) )
 	    , _sentMessages( std::move( other._sentMessages ) )
 	    , _readyToProcessMessages( std::move( other._readyToProcessMessages ) )
 	    , _processedMessages( std::move( other._processedMessages ) )
+	    , _type( std::move( other._type ) )
+	    , // unnecessary move, just in case I change that type
+	    _nextMessageSequenceNumber( std::move( other._nextMessageSequenceNumber ) )
+	    , // unnecessary move, just in case I change that type
+	    _fragmentReassembler( std::move( other._fragmentReassembler ) )
 	{
 	}
 
@@ -38,37 +44,45 @@ namespace NetLib
 		_sentMessages = std::move( other._sentMessages );
 		_readyToProcessMessages = std::move( other._readyToProcessMessages );
 		_processedMessages = std::move( other._processedMessages );
+		_fragmentReassembler = std::move( other._fragmentReassembler );
 		return *this;
 	}
 
-	void TransmissionChannel::AddSentMessage( std::unique_ptr< Message > message )
+	void TransmissionChannel::AddSentMessage( QueuedMessage message )
 	{
-		_sentMessages.push( std::move( message ) );
+		_sentMessages.PushBack( std::move( message ) );
 	}
 
 	void TransmissionChannel::FreeSentMessages()
 	{
 		MessageFactory& messageFactory = MessageFactory::GetInstance();
 
-		while ( !_sentMessages.empty() )
+		while ( !_sentMessages.IsEmpty() )
 		{
-			std::unique_ptr< Message > message( std::move( _sentMessages.front() ) );
-			_sentMessages.pop();
-
-			FreeSentMessage( messageFactory, std::move( message ) );
+			FreeSentMessage( messageFactory, _sentMessages.PopFront() );
 		}
 	}
 
 	void TransmissionChannel::FreeProcessedMessages()
 	{
-		MessageFactory& messageFactory = MessageFactory::GetInstance();
+		_processedMessages.ReleaseAll( MessageFactory::GetInstance() );
+	}
 
-		while ( !_processedMessages.empty() )
+	void TransmissionChannel::AddReadyToProcessMessage( std::unique_ptr< Message > message )
+	{
+		if ( message->GetHeader().type != MessageType::Fragment )
 		{
-			std::unique_ptr< Message > message( std::move( _processedMessages.front() ) );
-			_processedMessages.pop();
+			_readyToProcessMessages.PushBack( std::move( message ) );
+			return;
+		}
+
+		std::unique_ptr< Message > reassembledMessage =
+		    _fragmentReassembler.AddFragment( static_cast< const FragmentMessage& >( *message ) );
+		MessageFactory::GetInstance().ReleaseMessage( std::move( message ) );
 
-			messageFactory.ReleaseMessage( std::move( message ) );
+		if ( reassembledMessage != nullptr )
+		{
+			_readyToProcessMessages.PushBack( std::move( reassembledMessage ) );
 		}
 	}
 
@@ -76,6 +90,13 @@ namespace NetLib
 	{
 		ClearMessages();
 		_nextMessageSequenceNumber = 1;
+		_fragmentReassembler.Clear();
+	}
+
+	void TransmissionChannel::TakeCongestionSignals( uint32& ackedBytes, uint32& numberOfTimedOutMessages )
+	{
+		ackedBytes = 0;
+		numberOfTimedOutMessages = 0;
 	}
 
 	TransmissionChannel::~TransmissionChannel()
@@ -87,38 +108,9 @@ namespace NetLib
 	{
 		MessageFactory& messageFactory = MessageFactory::GetInstance();
 
-		while ( !_sentMessages.empty() )
-		{
-			std::unique_ptr< Message > message( std::move( _sentMessages.front() ) );
-			_sentMessages.pop();
-
-			messageFactory.ReleaseMessage( std::move( message ) );
-		}
-
-		while ( !_readyToProcessMessages.empty() )
-		{
-			std::unique_ptr< Message > message( std::move( _readyToProcessMessages.front() ) );
-			_readyToProcessMessages.pop();
-
-			messageFactory.ReleaseMessage( std::move( message ) );
-		}
-
-		while ( !_processedMessages.empty() )
-		{
-			std::unique_ptr< Message > message( std::move( _processedMessages.front() ) );
-			_processedMessages.pop();
-
-			messageFactory.ReleaseMessage( std::move( message ) );
-		}
-
-		for ( std::vector< std::unique_ptr< Message > >::iterator it = _unsentMessages.begin();
-		      it != _unsentMessages.end(); ++it )
-		{
-			std::unique_ptr< Message > message( std::move( *it ) );
-			messageFactory.ReleaseMessage( std::move( message ) );
-			*it = nullptr;
-		}
-
-		_unsentMessages.clear();
+		_sentMessages.ReleaseAll( messageFactory );
+		_readyToProcessMessages.ReleaseAll( messageFactory );
+		_processedMessages.ReleaseAll( messageFactory );
+		_unsentMessages.ReleaseAll( messageFactory );
 	}
 } // namespace NetLib
@@ -1,15 +1,21 @@
 #pragma once
 #include "numeric_types.h"
 
-#include <queue>
-#include <vector>
 #include <memory>
 
+#include "communication/fragment_reassembler.h"
+
+#include "transmission_channels/message_ring.h"
+
 namespace NetLib
 {
 	class Message;
+	class InlineMessage;
 	class MessageFactory;
 
+	// Rings grow on demand, this only avoids growing them during the first ticks
+	constexpr uint32 INITIAL_MESSAGE_RING_CAPACITY = 8;
+
 	enum TransmissionChannelType : uint8
 	{
 		UnreliableOrdered = 0,
@@ -30,10 +36,18 @@ namespace NetLib
 			TransmissionChannelType GetType() { return _type; }
 
 			virtual void AddMessageToSend( std::unique_ptr< Message > message ) = 0;
+			/// <summary>
+			/// Stores the message inline within the unsent messages ring, so it doesn't need a message from the
+			/// message factory
+			/// </summary>
+			virtual void AddMessageToSend( const InlineMessage& message ) = 0;
 			virtual bool ArePendingMessagesToSend() const = 0;
-			virtual std::unique_ptr< Message > GetMessageToSend() = 0;
+			/// <summary>
+			/// Returns an empty message if there are none pending
+			/// </summary>
+			virtual QueuedMessage GetMessageToSend() = 0;
 			virtual uint32 GetSizeOfNextUnsentMessage() const = 0;
-			void AddSentMessage( std::unique_ptr< Message > message );
+			void AddSentMessage( QueuedMessage message );
 			void FreeSentMessages();
 
 			virtual void AddReceivedMessage( std::unique_ptr< Message > message ) = 0;
@@ -56,21 +70,33 @@ namespace NetLib
 
 			virtual uint32 GetRTTMilliseconds() const = 0;
 
+			/// <summary>
+			/// Returns the congestion signals observed since the last call: bytes of messages acked by the remote peer
+			/// and messages whose retransmission timeout expired. Only reliable channels observe them.
+			/// </summary>
+			virtual void TakeCongestionSignals( uint32& ackedBytes, uint32& numberOfTimedOutMessages );
+
 			virtual ~TransmissionChannel();
 
 		protected:
 			// Collection of messages that are waiting to be sent.
-			std::vector< std::unique_ptr< Message > > _unsentMessages;
+			MessageRing _unsentMessages;
 			// Collection of messages that have been sent and are waiting to be released (Used for memory management
 			// purposes)
-			std::queue< std::unique_ptr< Message > > _sentMessages;
+			MessageRing _sentMessages;
 			// Collection of received messages ready to be processed
-			std::queue< std::unique_ptr< Message > > _readyToProcessMessages;
+			MessageRing _readyToProcessMessages;
 			// Collection of messages that have been processed and are waiting to be released (Used for memory
 			// management purposes)
-			std::queue< std::unique_ptr< Message > > _processedMessages;
+			MessageRing _processedMessages;
+
+			virtual void FreeSentMessage( MessageFactory& messageFactory, QueuedMessage message ) = 0;
 
-			virtual void FreeSentMessage( MessageFactory& messageFactory, std::unique_ptr< Message > message ) = 0;
+			/// <summary>
+			/// Adds a received message to the ready to process collection. Fragments are stored until their message
+			/// is complete, and then the reassembled message is added instead.
+			/// </summary>
+			void AddReadyToProcessMessage( std::unique_ptr< Message > message );
 
 			uint16 GetNextMessageSequenceNumber() const { return _nextMessageSequenceNumber; }
 			void IncreaseMessageSequenceNumber() { ++_nextMessageSequenceNumber; };
@@ -78,6 +104,7 @@ namespace NetLib
 		private:
 			TransmissionChannelType _type;
 			uint16 _nextMessageSequenceNumber;
+			FragmentReassembler _fragmentReassembler;
 
 			void ClearMessages();
 	};
@@ -31,30 +31,34 @@ namespace NetLib
 
 	void UnreliableOrderedTransmissionChannel::AddMessageToSend( std::unique_ptr< Message > message )
 	{
-		_unsentMessages.push_back( std::move( message ) );
+		_unsentMessages.PushBack( std::move( message ) );
+	}
+
+	void UnreliableOrderedTransmissionChannel::AddMessageToSend( const InlineMessage& message )
+	{
+		_unsentMessages.PushBack( message );
 	}
 
 	bool UnreliableOrderedTransmissionChannel::ArePendingMessagesToSend() const
 	{
-		return ( !_unsentMessages.empty() );
+		return ( !_unsentMessages.IsEmpty() );
 	}
 
-	std::unique_ptr< Message > UnreliableOrderedTransmissionChannel::GetMessageToSend()
+	QueuedMessage UnreliableOrderedTransmissionChannel::GetMessageToSend()
 	{
 		if ( !ArePendingMessagesToSend() )
 		{
-			return nullptr;
+			return QueuedMessage();
 		}
 
-		std::unique_ptr< Message > message( std::move( _unsentMessages[ 0 ] ) );
-		_unsentMessages.erase( _unsentMessages.begin() );
+		QueuedMessage message = _unsentMessages.PopFront();
 
 		uint16 sequenceNumber = GetNextMessageSequenceNumber();
 		IncreaseMessageSequenceNumber();
 
-		message->SetHeaderPacketSequenceNumber( sequenceNumber );
+		message.SetHeaderPacketSequenceNumber( sequenceNumber );
 
-		return std::move( message );
+		return message;
 	}
 
 	uint32 UnreliableOrderedTransmissionChannel::GetSizeOfNextUnsentMessage() const
@@ -64,7 +68,7 @@ namespace NetLib
 			return 0;
 		}
 
-		return _unsentMessages.front()->Size();
+		return _unsentMessages.GetFrontMessageSize();
 	}
 
 	void UnreliableOrderedTransmissionChannel::AddReceivedMessage( std::unique_ptr< Message > message )
@@ -77,12 +81,12 @@ namespace NetLib
 		}
 
 		_lastMessageSequenceNumberReceived = message->GetHeader().messageSequenceNumber;
-		_readyToProcessMessages.push( std::move( message ) );
+		AddReadyToProcessMessage( std::move( message ) );
 	}
 
 	bool UnreliableOrderedTransmissionChannel::ArePendingReadyToProcessMessages() const
 	{
-		return ( !_readyToProcessMessages.empty() );
+		return ( !_readyToProcessMessages.IsEmpty() );
 	}
 
 	const Message* UnreliableOrderedTransmissionChannel::GetReadyToProcessMessage()
@@ -92,11 +96,10 @@ namespace NetLib
 			return nullptr;
 		}
 
-		std::unique_ptr< Message > message( std::move( _readyToProcessMessages.front() ) );
-		_readyToProcessMessages.pop();
+		QueuedMessage message = _readyToProcessMessages.PopFront();
 
-		Message* messageToReturn = message.get();
-		_processedMessages.push( std::move( message ) );
+		const Message* messageToReturn = &message.GetMessage();
+		_processedMessages.PushBack( std::move( message ) );
 
 		return messageToReturn;
 	}
@@ -149,10 +152,9 @@ namespace NetLib
 	{
 	}
 
-	void UnreliableOrderedTransmissionChannel::FreeSentMessage( MessageFactory& messageFactory,
-	                                                            std::unique_ptr< Message > message )
+	void UnreliableOrderedTransmissionChannel::FreeSentMessage( MessageFactory& messageFactory, QueuedMessage message )
 	{
-		messageFactory.ReleaseMessage( std::move( message ) );
+		message.Release( messageFactory );
 	}
 
 	bool UnreliableOrderedTransmissionChannel::IsSequenceNumberNewerThanLastReceived( uint32 sequenceNumber ) const
@@ -16,8 +16,9 @@ namespace NetLib
 			UnreliableOrderedTransmissionChannel& operator=( UnreliableOrderedTransmissionChannel&& other ) noexcept;
 
 			void AddMessageToSend( std::unique_ptr< Message > message ) override;
+			void AddMessageToSend( const InlineMessage& message ) override;
 			bool ArePendingMessagesToSend() const override;
-			std::unique_ptr< Message > GetMessageToSend() override;
+			QueuedMessage GetMessageToSend() override;
 			uint32 GetSizeOfNextUnsentMessage() const override;
 
 			void AddReceivedMessage( std::unique_ptr< Message > message ) override;
@@ -41,7 +42,7 @@ namespace NetLib
 			~UnreliableOrderedTransmissionChannel();
 
 		protected:
-			void FreeSentMessage( MessageFactory& messageFactory, std::unique_ptr< Message > message ) override;
+			void FreeSentMessage( MessageFactory& messageFactory, QueuedMessage message ) override;
 
 		private:
 			uint32 _lastMessageSequenceNumberReceived;
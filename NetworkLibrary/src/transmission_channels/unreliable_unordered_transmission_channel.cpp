@@ -24,29 +24,31 @@ namespace NetLib
 
 	void UnreliableUnorderedTransmissionChannel::AddMessageToSend( std::unique_ptr< Message > message )
 	{
-		_unsentMessages.push_back( std::move( message ) );
+		_unsentMessages.PushBack( std::move( message ) );
+	}
+
+	void UnreliableUnorderedTransmissionChannel::AddMessageToSend( const InlineMessage& message )
+	{
+		_unsentMessages.PushBack( message );
 	}
 
 	bool UnreliableUnorderedTransmissionChannel::ArePendingMessagesToSend() const
 	{
-		return ( !_unsentMessages.empty() );
+		return ( !_unsentMessages.IsEmpty() );
 	}
 
-	std::unique_ptr< Message > UnreliableUnorderedTransmissionChannel::GetMessageToSend()
+	QueuedMessage UnreliableUnorderedTransmissionChannel::GetMessageToSend()
 	{
 		if ( !ArePendingMessagesToSend() )
 		{
-			return nullptr;
+			return QueuedMessage();
 		}
 
-		// TODO Check this. This is not a linked list so if you always get and delete the first element you could not
-		// have access to the rest in cse there are more
-		std::unique_ptr< Message > message( std::move( _unsentMessages[ 0 ] ) );
-		_unsentMessages.erase( _unsentMessages.begin() );
+		QueuedMessage message = _unsentMessages.PopFront();
 
-		message->SetHeaderPacketSequenceNumber( 0 );
+		message.SetHeaderPacketSequenceNumber( 0 );
 
-		return std::move( message );
+		return message;
 	}
 
 	uint32 UnreliableUnorderedTransmissionChannel::GetSizeOfNextUnsentMessage() const
@@ -56,17 +58,17 @@ namespace NetLib
 			return 0;
 		}
 
-		return _unsentMessages.front()->Size();
+		return _unsentMessages.GetFrontMessageSize();
 	}
 
 	void UnreliableUnorderedTransmissionChannel::AddReceivedMessage( std::unique_ptr< Message > message )
 	{
-		_readyToProcessMessages.push( std::move( message ) );
+		AddReadyToProcessMessage( std::move( message ) );
 	}
 
 	bool UnreliableUnorderedTransmissionChannel::ArePendingReadyToProcessMessages() const
 	{
-		return ( !_readyToProcessMessages.empty() );
+		return ( !_readyToProcessMessages.IsEmpty() );
 	}
 
 	const Message* UnreliableUnorderedTransmissionChannel::GetReadyToProcessMessage()
@@ -76,11 +78,10 @@ namespace NetLib
 			return nullptr;
 		}
 
-		std::unique_ptr< Message > message( std::move( _readyToProcessMessages.front() ) );
-		_readyToProcessMessages.pop();
+		QueuedMessage message = _readyToProcessMessages.PopFront();
 
-		Message* messageToReturn = message.get();
-		_processedMessages.push( std::move( message ) );
+		const Message* messageToReturn = &message.GetMessage();
+		_processedMessages.PushBack( std::move( message ) );
 
 		return messageToReturn;
 	}
@@ -127,8 +128,8 @@ namespace NetLib
 	}
 
 	void UnreliableUnorderedTransmissionChannel::FreeSentMessage( MessageFactory& messageFactory,
-	                                                              std::unique_ptr< Message > message )
+	                                                              QueuedMessage message )
 	{
-		messageFactory.ReleaseMessage( std::move( message ) );
+		message.Release( messageFactory );
 	}
 } // namespace NetLib
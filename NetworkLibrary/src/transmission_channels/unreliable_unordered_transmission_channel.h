@@ -21,8 +21,9 @@ namespace NetLib
 			    UnreliableUnorderedTransmissionChannel&& other ) noexcept;
 
 			void AddMessageToSend( std::unique_ptr< Message > message ) override;
+			void AddMessageToSend( const InlineMessage& message ) override;
 			bool ArePendingMessagesToSend() const override;
-			std::unique_ptr< Message > GetMessageToSend() override;
+			QueuedMessage GetMessageToSend() override;
 			uint32 GetSizeOfNextUnsentMessage() const override;
 
 			void AddReceivedMessage( std::unique_ptr< Message > message ) override;
@@ -43,7 +44,7 @@ namespace NetLib
 			~UnreliableUnorderedTransmissionChannel();
 
 		protected:
-			void FreeSentMessage( MessageFactory& messageFactory, std::unique_ptr< Message > message ) override;
+			void FreeSentMessage( MessageFactory& messageFactory, QueuedMessage message ) override;
 
 		private:
 	};
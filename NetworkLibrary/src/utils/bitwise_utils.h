@@ -31,5 +31,20 @@ namespace NetLib
 				assert( ( index >= 0 && index < 32 ) );
 				return ( byte >> index ) & 0x1;
 			}
+
+			/// <summary>
+			/// Returns the number of bits needed to store any value within [0, maxValue]
+			/// </summary>
+			static uint32 GetNumberOfBitsRequired( uint32 maxValue )
+			{
+				uint32 numberOfBits = 0;
+				while ( maxValue > 0 )
+				{
+					++numberOfBits;
+					maxValue >>= 1;
+				}
+
+				return numberOfBits;
+			}
 	};
 } // namespace NetLib
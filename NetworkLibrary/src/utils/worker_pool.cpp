@@ -0,0 +1,125 @@
+#include "worker_pool.h"
+
+#include <cassert>
+
+namespace NetLib
+{
+	WorkerPool::WorkerPool()
+	    : _threads()
+	    , _mutex()
+	    , _startCondition()
+	    , _doneCondition()
+	    , _job( nullptr )
+	    , _jobCount( 0 )
+	    , _nextJobIndex( 0 )
+	    , _numberOfBusyWorkers( 0 )
+	    , _generation( 0 )
+	    , _isStopping( false )
+	{
+	}
+
+	void WorkerPool::Start( uint32 numberOfWorkers )
+	{
+		assert( numberOfWorkers > 0 );
+		Stop();
+
+		_threads.reserve( numberOfWorkers - 1 );
+		for ( uint32 i = 1; i < numberOfWorkers; ++i )
+		{
+			_threads.emplace_back( &WorkerPool::WorkerLoop, this, i, _generation );
+		}
+	}
+
+	void WorkerPool::Stop()
+	{
+		if ( _threads.empty() )
+		{
+			return;
+		}
+
+		{
+			std::lock_guard< std::mutex > lock( _mutex );
+			_isStopping = true;
+		}
+
+		_startCondition.notify_all();
+		for ( uint32 i = 0; i < _threads.size(); ++i )
+		{
+			_threads[ i ].join();
+		}
+
+		_threads.clear();
+		_isStopping = false;
+	}
+
+	void WorkerPool::ParallelFor( uint32 count, const std::function< void( uint32, uint32 ) >& job )
+	{
+		if ( _threads.empty() || count <= 1 )
+		{
+			for ( uint32 i = 0; i < count; ++i )
+			{
+				job( i, 0 );
+			}
+
+			return;
+		}
+
+		{
+			std::lock_guard< std::mutex > lock( _mutex );
+			_job = &job;
+			_jobCount = count;
+			_nextJobIndex = 0;
+			_numberOfBusyWorkers = static_cast< uint32 >( _threads.size() );
+			++_generation;
+		}
+
+		_startCondition.notify_all();
+		RunJobs( 0 );
+
+		std::unique_lock< std::mutex > lock( _mutex );
+		_doneCondition.wait( lock, [ this ]() { return _numberOfBusyWorkers == 0; } );
+		_job = nullptr;
+	}
+
+	WorkerPool::~WorkerPool()
+	{
+		Stop();
+	}
+
+	void WorkerPool::WorkerLoop( uint32 workerIndex, uint64 generation )
+	{
+		while ( true )
+		{
+			{
+				std::unique_lock< std::mutex > lock( _mutex );
+				_startCondition.wait( lock,
+				                      [ this, generation ]() { return _isStopping || _generation != generation; } );
+				if ( _isStopping )
+				{
+					return;
+				}
+
+				generation = _generation;
+			}
+
+			RunJobs( workerIndex );
+
+			std::lock_guard< std::mutex > lock( _mutex );
+			--_numberOfBusyWorkers;
+			if ( _numberOfBusyWorkers == 0 )
+			{
+				_doneCondition.notify_one();
+			}
+		}
+	}
+
+	void WorkerPool::RunJobs( uint32 workerIndex )
+	{
+		uint32 jobIndex = _nextJobIndex.fetch_add( 1 );
+		while ( jobIndex < _jobCount )
+		{
+			( *_job )( jobIndex, workerIndex );
+			jobIndex = _nextJobIndex.fetch_add( 1 );
+		}
+	}
+} // namespace NetLib
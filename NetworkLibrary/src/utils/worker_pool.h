@@ -0,0 +1,60 @@
+#pragma once
+#include "numeric_types.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace NetLib
+{
+	/// <summary>
+	/// Fixed set of threads that run the iterations of a parallel loop. The calling thread takes part in every loop as
+	/// worker 0, so a pool of a single worker runs everything inline without any thread.
+	/// </summary>
+	class WorkerPool
+	{
+		public:
+			WorkerPool();
+			WorkerPool( const WorkerPool& ) = delete;
+
+			WorkerPool& operator=( const WorkerPool& ) = delete;
+
+			/// <summary>
+			/// Stops the current threads, if any, and starts numberOfWorkers - 1 new ones
+			/// </summary>
+			void Start( uint32 numberOfWorkers );
+			void Stop();
+
+			uint32 GetNumberOfWorkers() const { return static_cast< uint32 >( _threads.size() ) + 1; }
+
+			/// <summary>
+			/// Runs job for every index within [0, count) and returns once all of them are done. Indices are handed out
+			/// one by one to the first worker that is free, so the job must not depend on which worker runs each index.
+			/// </summary>
+			/// <param name="job">Gets the index and the worker running it, in [0, GetNumberOfWorkers())</param>
+			void ParallelFor( uint32 count, const std::function< void( uint32, uint32 ) >& job );
+
+			~WorkerPool();
+
+		private:
+			void WorkerLoop( uint32 workerIndex, uint64 generation );
+			void RunJobs( uint32 workerIndex );
+
+			std::vector< std::thread > _threads;
+
+			// Shared between the calling thread and the workers
+			std::mutex _mutex;
+			std::condition_variable _startCondition;
+			std::condition_variable _doneCondition;
+			const std::function< void( uint32, uint32 ) >* _job;
+			uint32 _jobCount;
+			std::atomic< uint32 > _nextJobIndex;
+			uint32 _numberOfBusyWorkers;
+			// Increased for every loop so the workers know there is a new one
+			uint64 _generation;
+			bool _isStopping;
+	};
+} // namespace NetLib
@@ -0,0 +1,125 @@
+#pragma once
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+
+#include "Buffer.h"
+#include "bit_reader.h"
+#include "bit_writer.h"
+#include "LogTestUtils.h"
+
+namespace Tests
+{
+	class BitStreamTests
+	{
+    public:
+        bool static ExecuteAll()
+        {
+            LogTestUtils::LogTestResult(Test_BitReader_CheckItReadsBackWhatBitWriterWrote());
+            LogTestUtils::LogTestResult(Test_BitReader_CheckItFailsWhenReadingPastTheEnd());
+            return true;
+        }
+
+        bool static Test_BitReader_CheckItReadsBackWhatBitWriterWrote()
+        {
+            LogTestUtils::LogTestName("Test_BitReader_CheckItReadsBackWhatBitWriterWrote");
+
+            //Arrange
+            uint8_t data[64] = {};
+            NetLib::Buffer buffer(data, sizeof(data));
+
+            const float quantizedMin = -10.f;
+            const float quantizedMax = 10.f;
+            const float resolution = 0.01f;
+            const float quantizedValue = 3.14159f;
+            const float rawValue = -1234.5678f;
+            const uint16_t valueAfterBits = 0xBEEF;
+
+            //Act
+            uint32_t numberOfBytesWritten = 0;
+            {
+                NetLib::BitWriter writer(buffer);
+                writer.WriteBool(true);
+                writer.WriteBool(false);
+                //Goes across the first word boundary
+                writer.WriteBits(0x1ABCDEF, 25);
+                writer.WriteBits(0x5, 3);
+                writer.WriteInteger(-7, -10, 10);
+                writer.WriteFloat(rawValue);
+                writer.WriteQuantizedFloat(quantizedValue, quantizedMin, quantizedMax, resolution);
+                writer.WriteQuantizedFloat(100.f, quantizedMin, quantizedMax, resolution);
+                writer.WriteBits(0xFFFFFFFF, 32);
+                writer.Flush();
+                numberOfBytesWritten = writer.GetNumberOfBytesWritten();
+            }
+            buffer.WriteShort(valueAfterBits);
+
+            const uint32_t quantizedBits = NetLib::BitWriter::GetNumberOfBitsRequired(quantizedMin, quantizedMax, resolution);
+            const uint32_t expectedNumberOfBits =
+                1 + 1 + 25 + 3 + NetLib::BitWriter::GetNumberOfBitsRequired(-10, 10) + 32 + (2 * quantizedBits) + 32;
+            const uint32_t accessIndexAfterWrite = buffer.GetAccessIndex();
+
+            buffer.ResetAccessIndex();
+            NetLib::BitReader reader(buffer);
+            const bool firstBool = reader.ReadBool();
+            const bool secondBool = reader.ReadBool();
+            const uint32_t bits25 = reader.ReadBits(25);
+            const uint32_t bits3 = reader.ReadBits(3);
+            const int32_t integer = reader.ReadInteger(-10, 10);
+            const float raw = reader.ReadFloat();
+            const float quantized = reader.ReadQuantizedFloat(quantizedMin, quantizedMax, resolution);
+            const float clamped = reader.ReadQuantizedFloat(quantizedMin, quantizedMax, resolution);
+            const uint32_t bits32 = reader.ReadBits(32);
+            reader.Finish();
+            const uint16_t shortAfterBits = buffer.ReadShort();
+
+            //Assert
+            assert(numberOfBytesWritten == (expectedNumberOfBits + 7) / 8);
+            assert(accessIndexAfterWrite == numberOfBytesWritten + sizeof(uint16_t));
+            assert(firstBool);
+            assert(!secondBool);
+            assert(bits25 == 0x1ABCDEF);
+            assert(bits3 == 0x5);
+            assert(integer == -7);
+            assert(raw == rawValue);
+            assert(std::fabs(quantized - quantizedValue) <= resolution / 2.f);
+            assert(clamped == quantizedMax);
+            assert(bits32 == 0xFFFFFFFF);
+            assert(!reader.HasFailed());
+            assert(shortAfterBits == valueAfterBits);
+
+            return true;
+        }
+
+        bool static Test_BitReader_CheckItFailsWhenReadingPastTheEnd()
+        {
+            LogTestUtils::LogTestName("Test_BitReader_CheckItFailsWhenReadingPastTheEnd");
+
+            //Arrange
+            uint8_t data[3] = {};
+            NetLib::Buffer buffer(data, sizeof(data));
+            {
+                NetLib::BitWriter writer(buffer);
+                writer.WriteBits(0x3FFFF, 18);
+                writer.Flush();
+            }
+            buffer.ResetAccessIndex();
+
+            //Act
+            NetLib::BitReader reader(buffer);
+            const uint32_t bits18 = reader.ReadBits(18);
+            const bool hasFailedBeforeEnd = reader.HasFailed();
+            const uint32_t bitsPastTheEnd = reader.ReadBits(8);
+            reader.Finish();
+
+            //Assert
+            assert(bits18 == 0x3FFFF);
+            assert(!hasFailedBeforeEnd);
+            assert(bitsPastTheEnd == 0);
+            assert(reader.HasFailed());
+            assert(buffer.GetAccessIndex() == 3);
+
+            return true;
+        }
+	};
+}
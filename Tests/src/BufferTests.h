@@ -0,0 +1,106 @@
+#pragma once
+#include <cassert>
+#include <cstdint>
+
+#include "Buffer.h"
+#include "LogTestUtils.h"
+
+namespace Tests
+{
+	class BufferTests
+	{
+    public:
+        bool static ExecuteAll()
+        {
+            LogTestUtils::LogTestResult(Test_BufferWrite_CheckValuesAreStoredInLittleEndianAtUnalignedOffsets());
+            LogTestUtils::LogTestResult(Test_BufferTryRead_CheckItFailsWithoutMovingWhenReadingPastTheEnd());
+            return true;
+        }
+
+        bool static Test_BufferWrite_CheckValuesAreStoredInLittleEndianAtUnalignedOffsets()
+        {
+            LogTestUtils::LogTestName("Test_BufferWrite_CheckValuesAreStoredInLittleEndianAtUnalignedOffsets");
+
+            //Arrange
+            uint8_t data[32] = {};
+            NetLib::Buffer buffer(data, sizeof(data));
+            const uint8_t bytes[3] = { 0xAA, 0xBB, 0xCC };
+            uint8_t bytesRead[3] = {};
+
+            //Act
+            buffer.WriteByte(0x01);
+            buffer.WriteShort(0x0302);
+            buffer.WriteInteger(0x07060504);
+            buffer.WriteLong(0x0F0E0D0C0B0A0908);
+            buffer.WriteBytes(bytes, sizeof(bytes));
+            buffer.WriteZeros(2);
+            buffer.WriteFloat(-2.5f);
+            const uint32_t accessIndexAfterWrite = buffer.GetAccessIndex();
+
+            buffer.ResetAccessIndex();
+            const uint8_t byteValue = buffer.ReadByte();
+            const uint16_t shortValue = buffer.ReadShort();
+            const uint32_t integerValue = buffer.ReadInteger();
+            const uint64_t longValue = buffer.ReadLong();
+            buffer.ReadBytes(bytesRead, sizeof(bytesRead));
+            const uint16_t zeros = buffer.ReadShort();
+            const float floatValue = buffer.ReadFloat();
+
+            //Assert
+            assert(accessIndexAfterWrite == 1 + 2 + 4 + 8 + 3 + 2 + 4);
+            for (uint8_t i = 0; i < 15; ++i)
+            {
+                assert(data[i] == i + 1);
+            }
+
+            assert(byteValue == 0x01);
+            assert(shortValue == 0x0302);
+            assert(integerValue == 0x07060504);
+            assert(longValue == 0x0F0E0D0C0B0A0908);
+            assert(bytesRead[0] == 0xAA && bytesRead[1] == 0xBB && bytesRead[2] == 0xCC);
+            assert(zeros == 0);
+            assert(floatValue == -2.5f);
+
+            return true;
+        }
+
+        bool static Test_BufferTryRead_CheckItFailsWithoutMovingWhenReadingPastTheEnd()
+        {
+            LogTestUtils::LogTestName("Test_BufferTryRead_CheckItFailsWithoutMovingWhenReadingPastTheEnd");
+
+            //Arrange
+            uint8_t data[7] = {};
+            NetLib::Buffer buffer(data, sizeof(data));
+            buffer.WriteShort(0x1234);
+            buffer.WriteInteger(0x89ABCDEF);
+            buffer.WriteByte(0x56);
+            buffer.ResetAccessIndex();
+
+            //Act
+            uint16_t shortValue = 0;
+            uint32_t integerValue = 0;
+            uint64_t longValue = 0;
+            uint8_t* view = nullptr;
+            uint8_t byteValue = 0;
+            const bool isShortRead = buffer.TryReadShort(shortValue);
+            const bool isIntegerRead = buffer.TryReadInteger(integerValue);
+            const bool isLongRead = buffer.TryReadLong(longValue);
+            const bool isViewRead = buffer.TryReadDataView(2, view);
+            const uint32_t accessIndexAfterFailedReads = buffer.GetAccessIndex();
+            const bool isByteRead = buffer.TryReadByte(byteValue);
+            const bool isByteReadPastTheEnd = buffer.TryReadByte(byteValue);
+
+            //Assert
+            assert(isShortRead && shortValue == 0x1234);
+            assert(isIntegerRead && integerValue == 0x89ABCDEF);
+            assert(!isLongRead && longValue == 0);
+            assert(!isViewRead && view == nullptr);
+            assert(accessIndexAfterFailedReads == 6);
+            assert(isByteRead && byteValue == 0x56);
+            assert(!isByteReadPastTheEnd);
+            assert(buffer.GetRemainingSize() == 0);
+
+            return true;
+        }
+	};
+}
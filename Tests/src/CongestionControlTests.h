@@ -0,0 +1,113 @@
+#pragma once
+#include <cassert>
+#include <cstdint>
+
+#include "core/aimd_congestion_controller.h"
+#include "core/send_pacer.h"
+#include "LogTestUtils.h"
+
+namespace Tests
+{
+	class CongestionControlTests
+	{
+    public:
+        bool static ExecuteAll()
+        {
+            LogTestUtils::LogTestResult(
+                Test_AIMDCongestionController_CheckItGrowsWithAcksAndHalvesOncePerRTTWithLosses());
+            LogTestUtils::LogTestResult(Test_SendPacer_CheckDatagramsAreSpreadAcrossTicks());
+            return true;
+        }
+
+        bool static Test_AIMDCongestionController_CheckItGrowsWithAcksAndHalvesOncePerRTTWithLosses()
+        {
+            LogTestUtils::LogTestName(
+                "Test_AIMDCongestionController_CheckItGrowsWithAcksAndHalvesOncePerRTTWithLosses");
+
+            //Arrange
+            const float initialWindow =
+                NetLib::INITIAL_CONGESTION_WINDOW_SEGMENTS * NetLib::CONGESTION_CONTROL_SEGMENT_SIZE_BYTES;
+            const float minWindow =
+                NetLib::MIN_CONGESTION_WINDOW_SEGMENTS * NetLib::CONGESTION_CONTROL_SEGMENT_SIZE_BYTES;
+            NetLib::AIMDCongestionController congestionController;
+
+            //Act
+            //Acking a whole window adds a segment to it
+            congestionController.OnAck(static_cast<uint32_t>(initialWindow), 200);
+            const float windowAfterAck = congestionController.GetCongestionWindowBytes();
+            const float sendRateAfterAck = congestionController.GetSendRateBytesPerSecond();
+
+            //Losses within the same RTT only halve the window once
+            congestionController.OnLoss();
+            const float windowAfterFirstLoss = congestionController.GetCongestionWindowBytes();
+            congestionController.Update(0.1f);
+            congestionController.OnLoss();
+            const float windowAfterLossWithinRTT = congestionController.GetCongestionWindowBytes();
+
+            //Keeps dropping until the minimum window
+            for (uint32_t i = 0; i < 10; ++i)
+            {
+                congestionController.Update(0.2f);
+                congestionController.OnLoss();
+            }
+            const float windowAfterManyLosses = congestionController.GetCongestionWindowBytes();
+
+            congestionController.Reset();
+            const float windowAfterReset = congestionController.GetCongestionWindowBytes();
+
+            //Assert
+            assert(windowAfterAck == initialWindow + NetLib::CONGESTION_CONTROL_SEGMENT_SIZE_BYTES);
+            assert(sendRateAfterAck == windowAfterAck / 0.2f);
+            assert(windowAfterFirstLoss == windowAfterAck / 2);
+            assert(windowAfterLossWithinRTT == windowAfterFirstLoss);
+            assert(windowAfterManyLosses == minWindow);
+            assert(windowAfterReset == initialWindow);
+
+            return true;
+        }
+
+        bool static Test_SendPacer_CheckDatagramsAreSpreadAcrossTicks()
+        {
+            LogTestUtils::LogTestName("Test_SendPacer_CheckDatagramsAreSpreadAcrossTicks");
+
+            //Arrange
+            //A datagram every two ticks
+            const uint32_t datagramSize = 1000;
+            const float sendRate = 30000.f;
+            const float tickTime = 1.f / 60.f;
+            NetLib::SendPacer sendPacer;
+
+            //Act
+            uint32_t numberOfDatagramsSent = 0;
+            for (uint32_t i = 0; i < 60; ++i)
+            {
+                sendPacer.Update(tickTime, sendRate, datagramSize);
+                //Always more data to send than the rate allows
+                while (sendPacer.CanSendDatagram())
+                {
+                    sendPacer.OnDatagramSent(datagramSize);
+                    ++numberOfDatagramsSent;
+                }
+            }
+
+            //Being idle doesn't allow a burst afterwards
+            for (uint32_t i = 0; i < 60; ++i)
+            {
+                sendPacer.Update(tickTime, sendRate, datagramSize);
+            }
+            uint32_t numberOfDatagramsSentAfterIdle = 0;
+            while (sendPacer.CanSendDatagram())
+            {
+                sendPacer.OnDatagramSent(datagramSize);
+                ++numberOfDatagramsSentAfterIdle;
+            }
+
+            //Assert
+            //A second at the send rate, plus the first datagram that goes right away
+            assert(numberOfDatagramsSent >= 30 && numberOfDatagramsSent <= 32);
+            assert(numberOfDatagramsSentAfterIdle == 2);
+
+            return true;
+        }
+	};
+}
@@ -0,0 +1,183 @@
+#pragma once
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "Buffer.h"
+#include "Initializer.h"
+#include "communication/message.h"
+#include "communication/message_factory.h"
+#include "replication/delta_compression.h"
+#include "replication/network_entity_communication_callbacks.h"
+#include "replication/on_network_entity_create_config.h"
+#include "replication/replication_manager.h"
+#include "replication/replication_messages_processor.h"
+#include "LogTestUtils.h"
+
+namespace Tests
+{
+	class DeltaReplicationTests
+	{
+    public:
+        bool static ExecuteAll()
+        {
+            LogTestUtils::LogTestResult(Test_DeltaCompression_CheckUnchangedWordsTakeABitAndTheStateIsRebuilt());
+            LogTestUtils::LogTestResult(Test_ReplicationManager_CheckOnlyChangesSinceTheAckedSnapshotAreSent());
+            return true;
+        }
+
+        bool static Test_DeltaCompression_CheckUnchangedWordsTakeABitAndTheStateIsRebuilt()
+        {
+            LogTestUtils::LogTestName("Test_DeltaCompression_CheckUnchangedWordsTakeABitAndTheStateIsRebuilt");
+
+            //Arrange
+            //The last word is shorter than a whole word
+            const std::vector<uint8_t> baseline = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14 };
+            std::vector<uint8_t> state = baseline;
+            state[5] = 60;
+            state[13] = 140;
+
+            uint8_t data[32] = {};
+            NetLib::Buffer buffer(data, sizeof(data));
+
+            //Act
+            NetLib::DeltaCompression::Compress(baseline, state.data(), static_cast<uint32_t>(state.size()), buffer);
+            const uint32_t deltaSize = buffer.GetAccessIndex();
+
+            buffer.ResetAccessIndex();
+            std::vector<uint8_t> stateRead;
+            const bool isDeltaRead = NetLib::DeltaCompression::Decompress(baseline, buffer, stateRead);
+
+            uint8_t truncatedData[2] = {};
+            std::memcpy(truncatedData, data, sizeof(truncatedData));
+            NetLib::Buffer truncatedBuffer(truncatedData, sizeof(truncatedData));
+            std::vector<uint8_t> truncatedStateRead;
+            const bool isTruncatedDeltaRead =
+                NetLib::DeltaCompression::Decompress(baseline, truncatedBuffer, truncatedStateRead);
+
+            //Assert
+            //Four words, two of them changed and the last one only has two bytes
+            assert(deltaSize == (4 + 32 + 16 + 7) / 8);
+            assert(deltaSize <= NetLib::DeltaCompression::GetMaxCompressedSize(static_cast<uint32_t>(state.size())));
+            assert(isDeltaRead);
+            assert(stateRead == state);
+            assert(buffer.GetAccessIndex() == deltaSize);
+            assert(!isTruncatedDeltaRead);
+
+            return true;
+        }
+
+        bool static Test_ReplicationManager_CheckOnlyChangesSinceTheAckedSnapshotAreSent()
+        {
+            LogTestUtils::LogTestName("Test_ReplicationManager_CheckOnlyChangesSinceTheAckedSnapshotAreSent");
+
+            //Set up
+            NetLib::Initializer::Initialize();
+
+            //Arrange
+            const uint32_t remotePeerId = 5;
+            const uint32_t stateSize = 16;
+            uint8_t serverStates[2][stateSize] = {};
+            uint8_t clientStates[2][stateSize] = {};
+            for (uint32_t i = 0; i < stateSize; ++i)
+            {
+                serverStates[0][i] = static_cast<uint8_t>(i);
+                serverStates[1][i] = static_cast<uint8_t>(100 + i);
+            }
+
+            NetLib::ReplicationManager replicationManager;
+            replicationManager.SubscribeToOnNetworkEntityCreate(
+                [&serverStates](const NetLib::OnNetworkEntityCreateConfig& config)
+                {
+                    const uint8_t* state = serverStates[config.entityId - 1];
+                    config.communicationCallbacks->OnSerializeEntityStateForNonOwner.AddSubscriber(
+                        [state](NetLib::Buffer& buffer) { buffer.WriteBytes(state, stateSize); });
+                    return config.entityId;
+                });
+            replicationManager.SubscribeToOnNetworkEntityDestroy([](uint32_t) {});
+
+            NetLib::ReplicationMessagesProcessor replicationMessagesProcessor;
+            replicationMessagesProcessor.SubscribeToOnNetworkEntityCreate(
+                [&clientStates](const NetLib::OnNetworkEntityCreateConfig& config)
+                {
+                    uint8_t* state = clientStates[config.entityId - 1];
+                    config.communicationCallbacks->OnUnserializeEntityStateForOwner.AddSubscriber(
+                        [state](NetLib::Buffer& buffer) { buffer.ReadBytes(state, stateSize); });
+                    return config.entityId;
+                });
+            replicationMessagesProcessor.SubscribeToOnNetworkEntityDestroy([](uint32_t) {});
+
+            replicationManager.CreateNetworkEntity(1, 0, 0.f, 0.f);
+            replicationManager.CreateNetworkEntity(1, 0, 0.f, 0.f);
+
+            //Act
+            //Without a baseline, every entity state is sent in full
+            std::vector<std::unique_ptr<NetLib::ReplicationMessage>> firstMessages;
+            replicationManager.Server_ReplicateWorldState(remotePeerId, firstMessages);
+            replicationManager.ClearReplicationMessages();
+            ProcessAndReleaseMessages(replicationMessagesProcessor, firstMessages);
+
+            uint16_t firstSnapshotToAck = 0;
+            const bool isFirstSnapshotAcked =
+                replicationMessagesProcessor.Client_TryGetSnapshotToAck(firstSnapshotToAck);
+            replicationManager.Server_ProcessSnapshotAck(remotePeerId, firstSnapshotToAck);
+            const bool areStatesEqualAfterFirstSnapshot =
+                std::memcmp(serverStates, clientStates, sizeof(serverStates)) == 0;
+
+            //Only the changed word of the changed entity is sent
+            serverStates[1][5] = 255;
+            std::vector<std::unique_ptr<NetLib::ReplicationMessage>> secondMessages;
+            replicationManager.Server_ReplicateWorldState(remotePeerId, secondMessages);
+            const bool isSecondSnapshotSentAsDelta = secondMessages.size() == 1 &&
+                secondMessages[0]->networkEntityId == 2 && secondMessages[0]->isDeltaCompressed &&
+                secondMessages[0]->snapshotBaselineDistance == 1 && secondMessages[0]->numberOfUpdatesInSnapshot == 1;
+            const uint16_t secondDataSize = isSecondSnapshotSentAsDelta ? secondMessages[0]->dataSize : 0;
+            ProcessAndReleaseMessages(replicationMessagesProcessor, secondMessages);
+
+            uint16_t secondSnapshotToAck = 0;
+            const bool isSecondSnapshotAcked =
+                replicationMessagesProcessor.Client_TryGetSnapshotToAck(secondSnapshotToAck);
+            replicationManager.Server_ProcessSnapshotAck(remotePeerId, secondSnapshotToAck);
+            const bool areStatesEqualAfterSecondSnapshot =
+                std::memcmp(serverStates, clientStates, sizeof(serverStates)) == 0;
+
+            //Nothing has changed since the acked snapshot
+            std::vector<std::unique_ptr<NetLib::ReplicationMessage>> thirdMessages;
+            replicationManager.Server_ReplicateWorldState(remotePeerId, thirdMessages);
+            const bool isThirdSnapshotEmpty = thirdMessages.empty();
+            ProcessAndReleaseMessages(replicationMessagesProcessor, thirdMessages);
+
+            //Assert
+            assert(firstMessages.size() == 4);
+            assert(isFirstSnapshotAcked);
+            assert(firstSnapshotToAck == 0);
+            assert(areStatesEqualAfterFirstSnapshot);
+            assert(isSecondSnapshotSentAsDelta);
+            //Four words, only one of them changed
+            assert(secondDataSize == (4 + 32 + 7) / 8);
+            assert(isSecondSnapshotAcked);
+            assert(secondSnapshotToAck == 1);
+            assert(areStatesEqualAfterSecondSnapshot);
+            assert(isThirdSnapshotEmpty);
+
+            //Tear down
+            NetLib::Initializer::Finalize();
+
+            return true;
+        }
+
+    private:
+        void static ProcessAndReleaseMessages(NetLib::ReplicationMessagesProcessor& replicationMessagesProcessor,
+            std::vector<std::unique_ptr<NetLib::ReplicationMessage>>& messages)
+        {
+            NetLib::MessageFactory& messageFactory = NetLib::MessageFactory::GetInstance();
+            for (std::unique_ptr<NetLib::ReplicationMessage>& message : messages)
+            {
+                replicationMessagesProcessor.Client_ProcessReceivedReplicationMessage(*message);
+                messageFactory.ReleaseMessage(std::move(message));
+            }
+        }
+	};
+}
@@ -0,0 +1,159 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Buffer.h"
+#include "Initializer.h"
+#include "communication/message.h"
+#include "communication/message_factory.h"
+#include "replication/network_entity_communication_callbacks.h"
+#include "replication/on_network_entity_create_config.h"
+#include "replication/replication_action_type.h"
+#include "replication/replication_manager.h"
+#include "replication/spatial_grid.h"
+#include "LogTestUtils.h"
+
+namespace Tests
+{
+	class InterestManagementTests
+	{
+    public:
+        bool static ExecuteAll()
+        {
+            LogTestUtils::LogTestResult(Test_SpatialGrid_CheckOnlyEntitiesWithinTheRadiusAreFound());
+            LogTestUtils::LogTestResult(
+                Test_ReplicationManager_CheckEntitiesAreCreatedAndDestroyedAsTheyEnterAndLeaveTheView());
+            return true;
+        }
+
+        bool static Test_SpatialGrid_CheckOnlyEntitiesWithinTheRadiusAreFound()
+        {
+            LogTestUtils::LogTestName("Test_SpatialGrid_CheckOnlyEntitiesWithinTheRadiusAreFound");
+
+            //Arrange
+            NetLib::SpatialGrid spatialGrid(10.f);
+            spatialGrid.AddEntity(1, 0.f, 0.f);
+            spatialGrid.AddEntity(2, -9.f, 0.f);
+            //Within a cell overlapped by the radius but outside of it
+            spatialGrid.AddEntity(3, 8.f, 8.f);
+            spatialGrid.AddEntity(4, 50.f, 50.f);
+
+            //Act
+            std::vector<uint32_t> entitiesFound;
+            spatialGrid.GetEntitiesWithinRadius(0.f, 0.f, 10.f, entitiesFound);
+            std::sort(entitiesFound.begin(), entitiesFound.end());
+
+            spatialGrid.MoveEntity(4, 1.f, -1.f);
+            spatialGrid.RemoveEntity(2);
+            std::vector<uint32_t> entitiesFoundAfterChanges;
+            spatialGrid.GetEntitiesWithinRadius(0.f, 0.f, 10.f, entitiesFoundAfterChanges);
+            std::sort(entitiesFoundAfterChanges.begin(), entitiesFoundAfterChanges.end());
+
+            spatialGrid.SetCellSize(3.f);
+            std::vector<uint32_t> entitiesFoundAfterResize;
+            spatialGrid.GetEntitiesWithinRadius(0.f, 0.f, 10.f, entitiesFoundAfterResize);
+            std::sort(entitiesFoundAfterResize.begin(), entitiesFoundAfterResize.end());
+
+            //Assert
+            assert((entitiesFound == std::vector<uint32_t>{ 1, 2 }));
+            assert((entitiesFoundAfterChanges == std::vector<uint32_t>{ 1, 4 }));
+            assert(entitiesFoundAfterResize == entitiesFoundAfterChanges);
+
+            return true;
+        }
+
+        bool static Test_ReplicationManager_CheckEntitiesAreCreatedAndDestroyedAsTheyEnterAndLeaveTheView()
+        {
+            LogTestUtils::LogTestName(
+                "Test_ReplicationManager_CheckEntitiesAreCreatedAndDestroyedAsTheyEnterAndLeaveTheView");
+
+            //Set up
+            NetLib::Initializer::Initialize();
+
+            //Arrange
+            const uint32_t remotePeerId = 5;
+            NetLib::ReplicationManager replicationManager;
+            replicationManager.SubscribeToOnNetworkEntityCreate(
+                [](const NetLib::OnNetworkEntityCreateConfig& config)
+                {
+                    config.communicationCallbacks->OnSerializeEntityStateForOwner.AddSubscriber(
+                        [](NetLib::Buffer& buffer) { buffer.WriteInteger(1); });
+                    config.communicationCallbacks->OnSerializeEntityStateForNonOwner.AddSubscriber(
+                        [](NetLib::Buffer& buffer) { buffer.WriteInteger(2); });
+                    return config.entityId;
+                });
+            replicationManager.SubscribeToOnNetworkEntityDestroy([](uint32_t) {});
+            replicationManager.EnableInterestManagement(10.f);
+
+            const uint32_t playerId = replicationManager.CreateNetworkEntity(1, remotePeerId, 0.f, 0.f);
+            const uint32_t otherId = replicationManager.CreateNetworkEntity(1, 0, 100.f, 0.f);
+
+            //Act
+            //Only the entity controlled by the remote peer is within its view. It is created in the first replication
+            const std::vector<uint8_t> firstActions =
+                ReplicateActionsOfEntity(replicationManager, remotePeerId, otherId);
+            const std::vector<uint8_t> playerActions =
+                ReplicateActionsOfEntity(replicationManager, remotePeerId, playerId);
+
+            replicationManager.SetNetworkEntityPosition(otherId, 5.f, 0.f);
+            const std::vector<uint8_t> enterActions =
+                ReplicateActionsOfEntity(replicationManager, remotePeerId, otherId);
+
+            //Past the view radius but not past the exit radius
+            replicationManager.SetNetworkEntityPosition(otherId, 11.f, 0.f);
+            const std::vector<uint8_t> borderActions =
+                ReplicateActionsOfEntity(replicationManager, remotePeerId, otherId);
+
+            replicationManager.SetNetworkEntityPosition(otherId, 20.f, 0.f);
+            const std::vector<uint8_t> leaveActions =
+                ReplicateActionsOfEntity(replicationManager, remotePeerId, otherId);
+
+            replicationManager.RemoveNetworkEntity(playerId);
+            const std::vector<uint8_t> removeActions =
+                ReplicateActionsOfEntity(replicationManager, remotePeerId, playerId);
+
+            //Assert
+            const uint8_t createAction = static_cast<uint8_t>(NetLib::ReplicationActionType::CREATE);
+            const uint8_t updateAction = static_cast<uint8_t>(NetLib::ReplicationActionType::UPDATE);
+            const uint8_t destroyAction = static_cast<uint8_t>(NetLib::ReplicationActionType::DESTROY);
+            assert(firstActions.empty());
+            assert((playerActions == std::vector<uint8_t>{ updateAction }));
+            assert((enterActions == std::vector<uint8_t>{ createAction, updateAction }));
+            assert((borderActions == std::vector<uint8_t>{ updateAction }));
+            assert((leaveActions == std::vector<uint8_t>{ destroyAction }));
+            assert((removeActions == std::vector<uint8_t>{ destroyAction }));
+
+            //Tear down
+            NetLib::Initializer::Finalize();
+
+            return true;
+        }
+
+    private:
+        //Replicates the world state and returns the replication actions sent about a single network entity
+        std::vector<uint8_t> static ReplicateActionsOfEntity(NetLib::ReplicationManager& replicationManager,
+            uint32_t remotePeerId, uint32_t networkEntityId)
+        {
+            std::vector<std::unique_ptr<NetLib::ReplicationMessage>> messages;
+            replicationManager.Server_ReplicateWorldState(remotePeerId, messages);
+            replicationManager.ClearReplicationMessages();
+
+            std::vector<uint8_t> actions;
+            NetLib::MessageFactory& messageFactory = NetLib::MessageFactory::GetInstance();
+            for (std::unique_ptr<NetLib::ReplicationMessage>& message : messages)
+            {
+                if (message->networkEntityId == networkEntityId)
+                {
+                    actions.push_back(message->replicationAction);
+                }
+
+                messageFactory.ReleaseMessage(std::move(message));
+            }
+
+            return actions;
+        }
+	};
+}
@@ -0,0 +1,136 @@
+#pragma once
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Initializer.h"
+#include "communication/message.h"
+#include "communication/message_factory.h"
+#include "utils/worker_pool.h"
+#include "LogTestUtils.h"
+
+namespace Tests
+{
+	class MessageFactoryTests
+	{
+    public:
+        bool static ExecuteAll()
+        {
+            LogTestUtils::LogTestResult(Test_MessageFactory_CheckStatsKeepTheHighWaterMarkOfLentMessages());
+            LogTestUtils::LogTestResult(Test_MessageFactory_CheckMessagesCanBeLentAndReleasedFromSeveralThreads());
+            return true;
+        }
+
+        bool static Test_MessageFactory_CheckStatsKeepTheHighWaterMarkOfLentMessages()
+        {
+            LogTestUtils::LogTestName("Test_MessageFactory_CheckStatsKeepTheHighWaterMarkOfLentMessages");
+
+            //Set up
+            NetLib::Initializer::Initialize(2);
+
+            //Arrange
+            NetLib::MessageFactory& messageFactory = NetLib::MessageFactory::GetInstance();
+            std::vector<std::unique_ptr<NetLib::Message>> messages;
+
+            //Act
+            for (uint32_t i = 0; i < 5; ++i)
+            {
+                messages.push_back(messageFactory.LendMessage(NetLib::MessageType::Replication));
+            }
+            const NetLib::MessagePoolStats statsWhileLent =
+                messageFactory.GetPoolStats(NetLib::MessageType::Replication);
+
+            //Released messages are lent again instead of creating new ones
+            for (uint32_t loop = 0; loop < 2; ++loop)
+            {
+                for (std::unique_ptr<NetLib::Message>& message : messages)
+                {
+                    messageFactory.ReleaseMessage(std::move(message));
+                }
+                messages.clear();
+
+                for (uint32_t i = 0; i < 4; ++i)
+                {
+                    messages.push_back(messageFactory.LendMessage(NetLib::MessageType::Replication));
+                }
+            }
+            for (std::unique_ptr<NetLib::Message>& message : messages)
+            {
+                messageFactory.ReleaseMessage(std::move(message));
+            }
+            const NetLib::MessagePoolStats statsAfterRelease =
+                messageFactory.GetPoolStats(NetLib::MessageType::Replication);
+            const NetLib::MessagePoolStats otherTypeStats = messageFactory.GetPoolStats(NetLib::MessageType::Inputs);
+
+            //Assert
+            assert(statsWhileLent.initialSize == 2);
+            assert(statsWhileLent.numberOfLentMessages == 5);
+            assert(statsWhileLent.maxNumberOfLentMessages == 5);
+            assert(statsWhileLent.numberOfCreatedMessages == 3);
+            assert(statsAfterRelease.numberOfLentMessages == 0);
+            assert(statsAfterRelease.maxNumberOfLentMessages == 5);
+            assert(statsAfterRelease.numberOfCreatedMessages == 3);
+            assert(otherTypeStats.maxNumberOfLentMessages == 0);
+
+            //Tear down
+            NetLib::Initializer::Finalize();
+
+            return true;
+        }
+
+        bool static Test_MessageFactory_CheckMessagesCanBeLentAndReleasedFromSeveralThreads()
+        {
+            LogTestUtils::LogTestName("Test_MessageFactory_CheckMessagesCanBeLentAndReleasedFromSeveralThreads");
+
+            //Set up
+            NetLib::Initializer::Initialize();
+
+            //Arrange
+            const NetLib::MessageType messageTypes[] = { NetLib::MessageType::Replication, NetLib::MessageType::Inputs,
+                NetLib::MessageType::SnapshotAck };
+            NetLib::MessageFactory& messageFactory = NetLib::MessageFactory::GetInstance();
+            std::atomic<uint32_t> numberOfWrongMessages(0);
+
+            //Act
+            {
+                NetLib::WorkerPool workerPool;
+                workerPool.Start(4);
+                workerPool.ParallelFor(2000, [&](uint32_t index, uint32_t)
+                {
+                    //Enough of them to go past the thread caches
+                    std::vector<std::unique_ptr<NetLib::Message>> messages;
+                    for (uint32_t i = 0; i < 100; ++i)
+                    {
+                        const NetLib::MessageType messageType = messageTypes[(index + i) % 3];
+                        messages.push_back(messageFactory.LendMessage(messageType));
+                        if (messages.back() == nullptr || messages.back()->GetHeader().type != messageType)
+                        {
+                            ++numberOfWrongMessages;
+                        }
+                    }
+
+                    for (std::unique_ptr<NetLib::Message>& message : messages)
+                    {
+                        messageFactory.ReleaseMessage(std::move(message));
+                    }
+                });
+            }
+
+            //Assert
+            assert(numberOfWrongMessages == 0);
+            for (const NetLib::MessageType messageType : messageTypes)
+            {
+                const NetLib::MessagePoolStats stats = messageFactory.GetPoolStats(messageType);
+                assert(stats.numberOfLentMessages == 0);
+                assert(stats.maxNumberOfLentMessages >= 34);
+            }
+
+            //Tear down
+            NetLib::Initializer::Finalize();
+
+            return true;
+        }
+	};
+}
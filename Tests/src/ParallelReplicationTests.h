@@ -0,0 +1,285 @@
+#pragma once
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Buffer.h"
+#include "Initializer.h"
+#include "communication/message.h"
+#include "communication/message_factory.h"
+#include "replication/network_entity_communication_callbacks.h"
+#include "replication/on_network_entity_create_config.h"
+#include "replication/replication_action_type.h"
+#include "replication/replication_manager.h"
+#include "utils/worker_pool.h"
+#include "LogTestUtils.h"
+
+namespace Tests
+{
+	class ParallelReplicationTests
+	{
+    public:
+        bool static ExecuteAll()
+        {
+            LogTestUtils::LogTestResult(Test_WorkerPool_CheckEveryIndexRunsOnce());
+            LogTestUtils::LogTestResult(Test_ReplicationManager_CheckParallelReplicationMatchesSerialReplication());
+            LogTestUtils::LogTestResult(Test_ReplicationManager_CheckNonOwnerStatesAreSerializedOncePerTick());
+            return true;
+        }
+
+        bool static Test_WorkerPool_CheckEveryIndexRunsOnce()
+        {
+            LogTestUtils::LogTestName("Test_WorkerPool_CheckEveryIndexRunsOnce");
+
+            //Arrange
+            const uint32_t numberOfWorkers = 4;
+            const uint32_t count = 1000;
+            NetLib::WorkerPool workerPool;
+            workerPool.Start(numberOfWorkers);
+            std::vector<std::atomic<uint32_t>> timesRun(count);
+
+            //Act
+            std::atomic<uint32_t> numberOfInvalidWorkerIndices(0);
+            //Several loops in a row reuse the same threads
+            for (uint32_t loop = 0; loop < 10; ++loop)
+            {
+                workerPool.ParallelFor(count, [&](uint32_t index, uint32_t workerIndex)
+                {
+                    ++timesRun[index];
+                    if (workerIndex >= numberOfWorkers)
+                    {
+                        ++numberOfInvalidWorkerIndices;
+                    }
+                });
+            }
+            const bool isWorkerIndexAlwaysValid = numberOfInvalidWorkerIndices == 0;
+
+            bool hasEveryIndexRunOncePerLoop = true;
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                hasEveryIndexRunOncePerLoop &= timesRun[i] == 10;
+            }
+
+            workerPool.Stop();
+
+            //Assert
+            assert(hasEveryIndexRunOncePerLoop);
+            assert(isWorkerIndexAlwaysValid);
+            assert(workerPool.GetNumberOfWorkers() == 1);
+
+            return true;
+        }
+
+        bool static Test_ReplicationManager_CheckParallelReplicationMatchesSerialReplication()
+        {
+            LogTestUtils::LogTestName("Test_ReplicationManager_CheckParallelReplicationMatchesSerialReplication");
+
+            //Set up
+            NetLib::Initializer::Initialize();
+
+            //Arrange
+            const uint32_t numberOfRemotePeers = 8;
+            uint32_t tick = 0;
+            NetLib::ReplicationManager serialReplicationManager;
+            NetLib::ReplicationManager parallelReplicationManager;
+            SetUpWorld(serialReplicationManager, numberOfRemotePeers, tick);
+            SetUpWorld(parallelReplicationManager, numberOfRemotePeers, tick);
+            parallelReplicationManager.EnableParallelReplication(4);
+
+            std::vector<uint32_t> remotePeerIds;
+            std::vector<uint32_t> budgetsBytes;
+            for (uint32_t i = 1; i <= numberOfRemotePeers; ++i)
+            {
+                remotePeerIds.push_back(i);
+                //Some remote peers can't take every update
+                budgetsBytes.push_back((i % 2 == 0) ? NetLib::ReplicationManager::UNLIMITED_REPLICATION_BUDGET : 64);
+            }
+
+            //Act
+            bool areOutputsEqual = true;
+            for (; tick < 10; ++tick)
+            {
+                std::vector<std::vector<uint8_t>> serialOutputs;
+                for (uint32_t i = 0; i < numberOfRemotePeers; ++i)
+                {
+                    std::vector<std::unique_ptr<NetLib::ReplicationMessage>> messages;
+                    serialReplicationManager.Server_ReplicateWorldState(remotePeerIds[i], messages, budgetsBytes[i]);
+                    serialOutputs.push_back(
+                        WriteAndAckMessages(serialReplicationManager, remotePeerIds[i], messages));
+                }
+
+                std::vector<std::vector<std::unique_ptr<NetLib::ReplicationMessage>>> parallelMessages;
+                parallelReplicationManager.Server_ReplicateWorldStates(remotePeerIds, budgetsBytes, parallelMessages);
+                for (uint32_t i = 0; i < numberOfRemotePeers; ++i)
+                {
+                    areOutputsEqual &= serialOutputs[i] ==
+                        WriteAndAckMessages(parallelReplicationManager, remotePeerIds[i], parallelMessages[i]);
+                }
+
+                serialReplicationManager.ClearReplicationMessages();
+                parallelReplicationManager.ClearReplicationMessages();
+            }
+
+            //Assert
+            assert(parallelReplicationManager.IsParallelReplicationEnabled());
+            assert(areOutputsEqual);
+
+            //Tear down
+            NetLib::Initializer::Finalize();
+
+            return true;
+        }
+
+        bool static Test_ReplicationManager_CheckNonOwnerStatesAreSerializedOncePerTick()
+        {
+            LogTestUtils::LogTestName("Test_ReplicationManager_CheckNonOwnerStatesAreSerializedOncePerTick");
+
+            //Set up
+            NetLib::Initializer::Initialize();
+
+            //Arrange
+            const uint32_t numberOfRemotePeers = 5;
+            const uint32_t numberOfEntities = 3;
+            uint32_t numberOfSerializations = 0;
+            NetLib::ReplicationManager replicationManager;
+            replicationManager.SubscribeToOnNetworkEntityCreate(
+                [&numberOfSerializations](const NetLib::OnNetworkEntityCreateConfig& config)
+                {
+                    config.communicationCallbacks->OnSerializeEntityStateForNonOwner.AddSubscriber(
+                        [&numberOfSerializations](NetLib::Buffer& buffer)
+                        {
+                            ++numberOfSerializations;
+                            buffer.WriteInteger(numberOfSerializations);
+                        });
+                    return config.entityId;
+                });
+            replicationManager.SubscribeToOnNetworkEntityDestroy([](uint32_t) {});
+
+            //Controlled by the server, so no remote peer is the owner
+            std::vector<uint32_t> remotePeerIds;
+            std::vector<uint32_t> budgetsBytes;
+            for (uint32_t i = 0; i < numberOfEntities; ++i)
+            {
+                replicationManager.CreateNetworkEntity(1, 0, 0.f, 0.f);
+            }
+            for (uint32_t i = 1; i <= numberOfRemotePeers; ++i)
+            {
+                remotePeerIds.push_back(i);
+                budgetsBytes.push_back(NetLib::ReplicationManager::UNLIMITED_REPLICATION_BUDGET);
+            }
+
+            //Act
+            std::vector<std::vector<std::unique_ptr<NetLib::ReplicationMessage>>> messages;
+            replicationManager.Server_ReplicateWorldStates(remotePeerIds, budgetsBytes, messages);
+            const uint32_t serializationsAfterFirstTick = numberOfSerializations;
+
+            //Every remote peer got the same Creates and updates, in the same order
+            bool isDataShared = true;
+            for (uint32_t i = 1; i < numberOfRemotePeers; ++i)
+            {
+                isDataShared &= messages[i].size() == messages[0].size();
+                for (uint32_t j = 0; j < messages[0].size() && j < messages[i].size(); ++j)
+                {
+                    isDataShared &= messages[i][j]->GetSharedData() != nullptr &&
+                        messages[i][j]->GetSharedData() == messages[0][j]->GetSharedData();
+                }
+            }
+            ReleaseMessages(messages);
+            replicationManager.ClearReplicationMessages();
+
+            //The single remote peer version shares them within the tick too
+            for (uint32_t i = 0; i < numberOfRemotePeers; ++i)
+            {
+                std::vector<std::unique_ptr<NetLib::ReplicationMessage>> remotePeerMessages;
+                replicationManager.Server_ReplicateWorldState(remotePeerIds[i], remotePeerMessages);
+                for (std::unique_ptr<NetLib::ReplicationMessage>& message : remotePeerMessages)
+                {
+                    NetLib::MessageFactory::GetInstance().ReleaseMessage(std::move(message));
+                }
+            }
+            replicationManager.ClearReplicationMessages();
+            const uint32_t serializationsAfterSecondTick = numberOfSerializations;
+
+            //Assert
+            assert(serializationsAfterFirstTick == numberOfEntities);
+            assert(isDataShared);
+            assert(serializationsAfterSecondTick == numberOfEntities * 2);
+
+            //Tear down
+            NetLib::Initializer::Finalize();
+
+            return true;
+        }
+
+    private:
+        void static ReleaseMessages(std::vector<std::vector<std::unique_ptr<NetLib::ReplicationMessage>>>& messages)
+        {
+            NetLib::MessageFactory& messageFactory = NetLib::MessageFactory::GetInstance();
+            for (std::vector<std::unique_ptr<NetLib::ReplicationMessage>>& remotePeerMessages : messages)
+            {
+                for (std::unique_ptr<NetLib::ReplicationMessage>& message : remotePeerMessages)
+                {
+                    messageFactory.ReleaseMessage(std::move(message));
+                }
+            }
+        }
+
+        //Two entities per remote peer, each with a different state for the owner and for the rest
+        void static SetUpWorld(NetLib::ReplicationManager& replicationManager, uint32_t numberOfRemotePeers,
+            const uint32_t& tick)
+        {
+            replicationManager.SubscribeToOnNetworkEntityCreate(
+                [&tick](const NetLib::OnNetworkEntityCreateConfig& config)
+                {
+                    const uint32_t entityId = config.entityId;
+                    config.communicationCallbacks->OnSerializeEntityStateForOwner.AddSubscriber(
+                        [&tick, entityId](NetLib::Buffer& buffer)
+                        {
+                            buffer.WriteInteger(entityId);
+                            buffer.WriteInteger(tick);
+                        });
+                    //Only half of the entities change every tick for the rest
+                    config.communicationCallbacks->OnSerializeEntityStateForNonOwner.AddSubscriber(
+                        [&tick, entityId](NetLib::Buffer& buffer)
+                        {
+                            buffer.WriteInteger(entityId);
+                            buffer.WriteInteger((entityId % 2 == 0) ? tick : 0);
+                        });
+                    return entityId;
+                });
+            replicationManager.SubscribeToOnNetworkEntityDestroy([](uint32_t) {});
+
+            for (uint32_t i = 1; i <= numberOfRemotePeers; ++i)
+            {
+                replicationManager.CreateNetworkEntity(1, i, static_cast<float>(i * 10), 0.f);
+                replicationManager.CreateNetworkEntity(1, i, 0.f, static_cast<float>(i * 10));
+            }
+        }
+
+        //Writes the messages one after another, acks the snapshot they belong to and gives them back to the factory
+        std::vector<uint8_t> static WriteAndAckMessages(NetLib::ReplicationManager& replicationManager,
+            uint32_t remotePeerId, std::vector<std::unique_ptr<NetLib::ReplicationMessage>>& messages)
+        {
+            std::vector<uint8_t> output;
+            NetLib::MessageFactory& messageFactory = NetLib::MessageFactory::GetInstance();
+            for (std::unique_ptr<NetLib::ReplicationMessage>& message : messages)
+            {
+                std::vector<uint8_t> data(message->Size());
+                NetLib::Buffer buffer(data.data(), static_cast<int32_t>(data.size()));
+                message->Write(buffer);
+                output.insert(output.end(), data.begin(), data.end());
+
+                if (message->replicationAction == static_cast<uint8_t>(NetLib::ReplicationActionType::UPDATE))
+                {
+                    replicationManager.Server_ProcessSnapshotAck(remotePeerId, message->snapshotSequenceNumber);
+                }
+
+                messageFactory.ReleaseMessage(std::move(message));
+            }
+
+            return output;
+        }
+	};
+}
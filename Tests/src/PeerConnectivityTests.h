@@ -1,11 +1,18 @@
 #pragma once
 #include <cassert>
 #include <chrono>
+#include <memory>
 #include <thread>
+#include <vector>
 
 #include "Server.h"
 #include "Client.h"
 #include "Initializer.h"
+#include "Buffer.h"
+#include "emulated_transport.h"
+#include "inputs/i_input_state.h"
+#include "inputs/i_input_state_factory.h"
+#include "loopback_transport.h"
 #include "LogTestUtils.h"
 
 namespace Tests
@@ -13,6 +20,53 @@ namespace Tests
     const unsigned int FIXED_FRAMES_PER_SECOND = 50;
     const float FIXED_FRAME_TARGET_DURATION = 1.0f / FIXED_FRAMES_PER_SECOND;
 
+    //Input state bigger than a datagram, so it has to be fragmented
+    class LargeTestInputState final : public NetLib::IInputState
+    {
+    public:
+        static const int32_t SIZE = 4000;
+
+        LargeTestInputState() : _bytes(SIZE, 0) {}
+
+        int32_t GetSize() const override { return SIZE; }
+
+        void Serialize(NetLib::Buffer& buffer) const override
+        {
+            for (uint8_t byte : _bytes)
+            {
+                buffer.WriteByte(byte);
+            }
+        }
+
+        void Deserialize(NetLib::Buffer& buffer) override
+        {
+            for (uint8_t& byte : _bytes)
+            {
+                byte = buffer.ReadByte();
+            }
+        }
+
+        void Fill()
+        {
+            for (int32_t i = 0; i < SIZE; ++i)
+            {
+                _bytes[i] = static_cast<uint8_t>(i * 7 + 3);
+            }
+        }
+
+        bool IsEqual(const LargeTestInputState& other) const { return _bytes == other._bytes; }
+
+    private:
+        std::vector<uint8_t> _bytes;
+    };
+
+    class LargeTestInputStateFactory : public NetLib::IInputStateFactory
+    {
+    public:
+        NetLib::IInputState* Create() override { return new LargeTestInputState(); }
+        void Destroy(NetLib::IInputState* inputToDestroy) override { delete static_cast<LargeTestInputState*>(inputToDestroy); }
+    };
+
 	class PeerConnectivityTests
 	{
     private:
@@ -67,6 +121,32 @@ namespace Tests
 
             //Test remote peer disconnection
             LogTestUtils::LogTestResult(Test_ClientOnRemotePeerDisconnectDelegate_CheckItIsCalledOnlyOnceWhenServerStops());
+            std::this_thread::sleep_for(duration);
+
+            //Test waiting for incoming data
+            LogTestUtils::LogTestResult(Test_ServerWaitForIncomingData_CheckItWakesUpWhenDataArrives());
+            std::this_thread::sleep_for(duration);
+
+            //Test socket I/O modes
+            LogTestUtils::LogTestResult(Test_ServerOnRemotePeerConnectDelegate_CheckItIsCalledOnlyOnceUsingIoUring());
+            std::this_thread::sleep_for(duration);
+            LogTestUtils::LogTestResult(Test_ServerOnRemotePeerConnectDelegate_CheckItIsCalledOnlyOnceUsingSegmentationOffload());
+            std::this_thread::sleep_for(duration);
+
+            //Test socket shards
+            LogTestUtils::LogTestResult(Test_ServerOnRemotePeerConnectDelegate_CheckItIsCalledOncePerClientUsingSocketShards());
+            std::this_thread::sleep_for(duration);
+
+            //Test loopback transport. Each test uses its own loopback network so they don't need any break in between
+            LogTestUtils::LogTestResult(Test_ServerOnRemotePeerConnectDelegate_CheckItIsCalledOncePerClientUsingLoopbackTransport());
+            LogTestUtils::LogTestResult(Test_ClientOnLocalPeerConnectDelegate_CheckItIsCalledOnceForEachLoopbackNetworkUsingSamePort());
+            LogTestUtils::LogTestResult(Test_ClientOnLocalPeerConnectDelegate_CheckItIsCalledOnlyOnceUsingLossyEmulatedTransport());
+
+            //Test fragmentation
+            LogTestUtils::LogTestResult(Test_ServerGetInputFromRemotePeer_CheckInputBiggerThanADatagramArrivesComplete());
+
+            //Test path MTU discovery
+            LogTestUtils::LogTestResult(Test_ServerGetRemotePeerDatagramMaxSize_CheckItFitsWithinTheEmulatedPathMTU());
 
             return true;
         }
@@ -679,7 +759,7 @@ namespace Tests
             int numberOfTimesCalled = 0;
             bool isRunning = true;
 
-            auto callback = [&isRunning, &numberOfTimesCalled]()
+            auto callback = [&isRunning, &numberOfTimesCalled](uint32_t remotePeerId)
             {
                 isRunning = false;
                 ++numberOfTimesCalled;
@@ -740,5 +820,674 @@ namespace Tests
 
             return true;
         }
+
+        bool static Test_ServerWaitForIncomingData_CheckItWakesUpWhenDataArrives()
+        {
+            LogTestUtils::LogTestName("Test_ServerWaitForIncomingData_CheckItWakesUpWhenDataArrives");
+
+            //Set up
+            SetUp();
+
+            //Arrange
+            const float clientServerInactivityTimeout = 5;
+            const unsigned int serverMaxConnections = 1;
+            const float idleWaitTimeout = 0.05f;
+            const float dataWaitTimeout = 2;
+
+            NetLib::Peer* serverPeer = new NetLib::Server(serverMaxConnections);
+            NetLib::Peer* clientPeer = new NetLib::Client(clientServerInactivityTimeout);
+
+            NetLib::TimeClock& timeClock = NetLib::TimeClock::GetInstance();
+
+            //Act
+            serverPeer->Start();
+
+            double idleWaitStartTime = timeClock.GetLocalTimeSeconds();
+            bool isDataAvailableWhileIdle = serverPeer->WaitForIncomingData(idleWaitTimeout);
+            double idleWaitDuration = timeClock.GetLocalTimeSeconds() - idleWaitStartTime;
+
+            //The client sends its connection request during its first tick
+            clientPeer->Start();
+            TickPeer(*clientPeer, FIXED_FRAME_TARGET_DURATION);
+
+            double dataWaitStartTime = timeClock.GetLocalTimeSeconds();
+            bool isDataAvailableAfterClientSends = serverPeer->WaitForIncomingData(dataWaitTimeout);
+            double dataWaitDuration = timeClock.GetLocalTimeSeconds() - dataWaitStartTime;
+
+            clientPeer->Stop();
+            serverPeer->Stop();
+
+            delete serverPeer;
+            serverPeer = nullptr;
+            delete clientPeer;
+            clientPeer = nullptr;
+
+            //Assert
+            assert(!isDataAvailableWhileIdle);
+            assert(idleWaitDuration >= idleWaitTimeout * 0.9f);
+            assert(isDataAvailableAfterClientSends);
+            assert(dataWaitDuration < dataWaitTimeout);
+
+            //Tear down
+            TearDown();
+
+            return true;
+        }
+
+        bool static Test_ServerOnRemotePeerConnectDelegate_CheckItIsCalledOnlyOnceUsingIoUring()
+        {
+            LogTestUtils::LogTestName("Test_ServerOnRemotePeerConnectDelegate_CheckItIsCalledOnlyOnceUsingIoUring");
+
+            //Set up
+            SetUp();
+
+            //Arrange
+            const float clientServerInactivityTimeout = 5;
+            const unsigned int serverMaxConnections = 1;
+            const float testTimeout = 2;
+
+            NetLib::Peer* serverPeer = new NetLib::Server(serverMaxConnections);
+            NetLib::Peer* clientPeer = new NetLib::Client(clientServerInactivityTimeout);
+
+            int numberOfTimesCalled = 0;
+            bool isRunning = true;
+
+            auto callback = [&isRunning, &numberOfTimesCalled](uint32_t remotePeerId)
+            {
+                isRunning = false;
+                ++numberOfTimesCalled;
+            };
+
+            NetLib::TimeClock& timeClock = NetLib::TimeClock::GetInstance();
+            double accumulator = 0.0;
+            float testTimeLeft = testTimeout;
+
+            unsigned int subscriberId = 0;
+
+            //Act
+            //If io_uring is not supported, peers fall back to the default I/O mode so the result must be the same
+            subscriberId = serverPeer->SubscribeToOnRemotePeerConnect(callback);
+            serverPeer->Start(NetLib::SocketIOMode::IO_URING);
+            clientPeer->Start(NetLib::SocketIOMode::IO_URING);
+
+            while (isRunning)
+            {
+                timeClock.UpdateLocalTime();
+                accumulator += timeClock.GetElapsedTimeSeconds();
+
+                while (accumulator >= FIXED_FRAME_TARGET_DURATION)
+                {
+                    TickPeer(*serverPeer, FIXED_FRAME_TARGET_DURATION);
+                    TickPeer(*clientPeer, FIXED_FRAME_TARGET_DURATION);
+
+                    accumulator -= FIXED_FRAME_TARGET_DURATION;
+                    testTimeLeft -= FIXED_FRAME_TARGET_DURATION;
+                    if (testTimeLeft <= 0.f)
+                    {
+                        isRunning = false;
+                    }
+                }
+            }
+
+            serverPeer->Stop();
+            clientPeer->Stop();
+            serverPeer->UnsubscribeToOnRemotePeerConnect(subscriberId);
+
+            delete serverPeer;
+            serverPeer = nullptr;
+            delete clientPeer;
+            clientPeer = nullptr;
+
+            //Assert
+            assert(numberOfTimesCalled == 1);
+
+            //Tear down
+            TearDown();
+
+            return true;
+        }
+
+        bool static Test_ServerOnRemotePeerConnectDelegate_CheckItIsCalledOnlyOnceUsingSegmentationOffload()
+        {
+            LogTestUtils::LogTestName("Test_ServerOnRemotePeerConnectDelegate_CheckItIsCalledOnlyOnceUsingSegmentationOffload");
+
+            //Set up
+            SetUp();
+
+            //Arrange
+            const float clientServerInactivityTimeout = 5;
+            const unsigned int serverMaxConnections = 1;
+            const float testTimeout = 2;
+
+            NetLib::Peer* serverPeer = new NetLib::Server(serverMaxConnections);
+            NetLib::Peer* clientPeer = new NetLib::Client(clientServerInactivityTimeout);
+
+            int numberOfTimesCalled = 0;
+            bool isRunning = true;
+
+            auto callback = [&isRunning, &numberOfTimesCalled](uint32_t remotePeerId)
+            {
+                isRunning = false;
+                ++numberOfTimesCalled;
+            };
+
+            NetLib::TimeClock& timeClock = NetLib::TimeClock::GetInstance();
+            double accumulator = 0.0;
+            float testTimeLeft = testTimeout;
+
+            unsigned int subscriberId = 0;
+
+            //Act
+            //If segmentation offload is not supported, peers fall back to the default I/O mode so the result must be the same
+            subscriberId = serverPeer->SubscribeToOnRemotePeerConnect(callback);
+            serverPeer->Start(NetLib::SocketIOMode::SEGMENTATION_OFFLOAD);
+            clientPeer->Start(NetLib::SocketIOMode::SEGMENTATION_OFFLOAD);
+
+            while (isRunning)
+            {
+                timeClock.UpdateLocalTime();
+                accumulator += timeClock.GetElapsedTimeSeconds();
+
+                while (accumulator >= FIXED_FRAME_TARGET_DURATION)
+                {
+                    TickPeer(*serverPeer, FIXED_FRAME_TARGET_DURATION);
+                    TickPeer(*clientPeer, FIXED_FRAME_TARGET_DURATION);
+
+                    accumulator -= FIXED_FRAME_TARGET_DURATION;
+                    testTimeLeft -= FIXED_FRAME_TARGET_DURATION;
+                    if (testTimeLeft <= 0.f)
+                    {
+                        isRunning = false;
+                    }
+                }
+            }
+
+            serverPeer->Stop();
+            clientPeer->Stop();
+            serverPeer->UnsubscribeToOnRemotePeerConnect(subscriberId);
+
+            delete serverPeer;
+            serverPeer = nullptr;
+            delete clientPeer;
+            clientPeer = nullptr;
+
+            //Assert
+            assert(numberOfTimesCalled == 1);
+
+            //Tear down
+            TearDown();
+
+            return true;
+        }
+
+        bool static Test_ServerOnRemotePeerConnectDelegate_CheckItIsCalledOncePerClientUsingSocketShards()
+        {
+            LogTestUtils::LogTestName("Test_ServerOnRemotePeerConnectDelegate_CheckItIsCalledOncePerClientUsingSocketShards");
+
+            //Set up
+            SetUp();
+
+            //Arrange
+            const float clientServerInactivityTimeout = 5;
+            const unsigned int serverMaxConnections = 2;
+            const unsigned int serverNumberOfSocketShards = 4;
+            const float testTimeout = 2;
+
+            NetLib::Peer* serverPeer = new NetLib::Server(serverMaxConnections, serverNumberOfSocketShards);
+            NetLib::Peer* firstClientPeer = new NetLib::Client(clientServerInactivityTimeout);
+            NetLib::Peer* secondClientPeer = new NetLib::Client(clientServerInactivityTimeout);
+
+            int numberOfTimesCalled = 0;
+            bool isRunning = true;
+
+            auto callback = [&numberOfTimesCalled](uint32_t remotePeerId) { ++numberOfTimesCalled; };
+
+            NetLib::TimeClock& timeClock = NetLib::TimeClock::GetInstance();
+            double accumulator = 0.0;
+            float testTimeLeft = testTimeout;
+
+            unsigned int subscriberId = 0;
+
+            //Act
+            //If socket shards are not supported, the server falls back to a single socket so the result must be the same
+            subscriberId = serverPeer->SubscribeToOnRemotePeerConnect(callback);
+            serverPeer->Start();
+            firstClientPeer->Start();
+            secondClientPeer->Start();
+
+            while (isRunning)
+            {
+                timeClock.UpdateLocalTime();
+                accumulator += timeClock.GetElapsedTimeSeconds();
+
+                while (accumulator >= FIXED_FRAME_TARGET_DURATION)
+                {
+                    TickPeer(*serverPeer, FIXED_FRAME_TARGET_DURATION);
+                    TickPeer(*firstClientPeer, FIXED_FRAME_TARGET_DURATION);
+                    TickPeer(*secondClientPeer, FIXED_FRAME_TARGET_DURATION);
+
+                    accumulator -= FIXED_FRAME_TARGET_DURATION;
+                    testTimeLeft -= FIXED_FRAME_TARGET_DURATION;
+
+                    //The shard workers send the connection approvals after the server tick, so wait for the clients too
+                    const bool areBothClientsConnected =
+                        firstClientPeer->GetConnectionState() == NetLib::PeerConnectionState::PCS_Connected &&
+                        secondClientPeer->GetConnectionState() == NetLib::PeerConnectionState::PCS_Connected;
+                    if ((numberOfTimesCalled == 2 && areBothClientsConnected) || testTimeLeft <= 0.f)
+                    {
+                        isRunning = false;
+                    }
+                }
+            }
+
+            const bool areBothClientsConnected =
+                firstClientPeer->GetConnectionState() == NetLib::PeerConnectionState::PCS_Connected &&
+                secondClientPeer->GetConnectionState() == NetLib::PeerConnectionState::PCS_Connected;
+
+            serverPeer->Stop();
+            firstClientPeer->Stop();
+            secondClientPeer->Stop();
+            serverPeer->UnsubscribeToOnRemotePeerConnect(subscriberId);
+
+            delete serverPeer;
+            serverPeer = nullptr;
+            delete firstClientPeer;
+            firstClientPeer = nullptr;
+            delete secondClientPeer;
+            secondClientPeer = nullptr;
+
+            //Assert
+            assert(numberOfTimesCalled == 2);
+            assert(areBothClientsConnected);
+
+            //Tear down
+            TearDown();
+
+            return true;
+        }
+
+        bool static Test_ServerOnRemotePeerConnectDelegate_CheckItIsCalledOncePerClientUsingLoopbackTransport()
+        {
+            LogTestUtils::LogTestName("Test_ServerOnRemotePeerConnectDelegate_CheckItIsCalledOncePerClientUsingLoopbackTransport");
+
+            //Set up
+            SetUp();
+
+            //Arrange
+            const float clientServerInactivityTimeout = 5;
+            const unsigned int numberOfClients = 64;
+            const unsigned int maxNumberOfFrames = 250;
+
+            NetLib::LoopbackNetwork network;
+            NetLib::Peer* serverPeer = new NetLib::Server(numberOfClients);
+            std::vector<NetLib::Peer*> clientPeers;
+            for (unsigned int i = 0; i < numberOfClients; ++i)
+            {
+                clientPeers.push_back(new NetLib::Client(clientServerInactivityTimeout));
+            }
+
+            unsigned int numberOfTimesCalled = 0;
+            auto callback = [&numberOfTimesCalled](uint32_t remotePeerId)
+            {
+                ++numberOfTimesCalled;
+            };
+
+            unsigned int subscriberId = 0;
+
+            //Act
+            //No sockets are involved, so peers are ticked as fast as possible instead of waiting for each frame
+            subscriberId = serverPeer->SubscribeToOnRemotePeerConnect(callback);
+            serverPeer->Start(std::make_unique<NetLib::LoopbackTransport>(network));
+            for (NetLib::Peer* clientPeer : clientPeers)
+            {
+                clientPeer->Start(std::make_unique<NetLib::LoopbackTransport>(network));
+            }
+
+            for (unsigned int frame = 0; frame < maxNumberOfFrames && numberOfTimesCalled < numberOfClients; ++frame)
+            {
+                TickPeer(*serverPeer, FIXED_FRAME_TARGET_DURATION);
+                for (NetLib::Peer* clientPeer : clientPeers)
+                {
+                    TickPeer(*clientPeer, FIXED_FRAME_TARGET_DURATION);
+                }
+            }
+
+            unsigned int numberOfClientsConnected = 0;
+            for (NetLib::Peer* clientPeer : clientPeers)
+            {
+                if (clientPeer->GetConnectionState() == NetLib::PeerConnectionState::PCS_Connected)
+                {
+                    ++numberOfClientsConnected;
+                }
+            }
+
+            serverPeer->Stop();
+            serverPeer->UnsubscribeToOnRemotePeerConnect(subscriberId);
+            delete serverPeer;
+            serverPeer = nullptr;
+
+            for (NetLib::Peer* clientPeer : clientPeers)
+            {
+                clientPeer->Stop();
+                delete clientPeer;
+            }
+
+            clientPeers.clear();
+
+            //Assert
+            assert(numberOfTimesCalled == numberOfClients);
+            assert(numberOfClientsConnected == numberOfClients);
+
+            //Tear down
+            TearDown();
+
+            return true;
+        }
+
+        bool static Test_ClientOnLocalPeerConnectDelegate_CheckItIsCalledOnceForEachLoopbackNetworkUsingSamePort()
+        {
+            LogTestUtils::LogTestName("Test_ClientOnLocalPeerConnectDelegate_CheckItIsCalledOnceForEachLoopbackNetworkUsingSamePort");
+
+            //Set up
+            SetUp();
+
+            //Arrange
+            const float clientServerInactivityTimeout = 5;
+            const unsigned int serverMaxConnections = 1;
+            const unsigned int maxNumberOfFrames = 250;
+
+            //Both servers bind the same port, each one within its own network
+            NetLib::LoopbackNetwork firstNetwork;
+            NetLib::LoopbackNetwork secondNetwork;
+            NetLib::Peer* firstServerPeer = new NetLib::Server(serverMaxConnections);
+            NetLib::Peer* secondServerPeer = new NetLib::Server(serverMaxConnections);
+            NetLib::Peer* firstClientPeer = new NetLib::Client(clientServerInactivityTimeout);
+            NetLib::Peer* secondClientPeer = new NetLib::Client(clientServerInactivityTimeout);
+
+            int numberOfTimesCalled = 0;
+            auto callback = [&numberOfTimesCalled]()
+            {
+                ++numberOfTimesCalled;
+            };
+
+            unsigned int firstSubscriberId = 0;
+            unsigned int secondSubscriberId = 0;
+
+            //Act
+            firstSubscriberId = firstClientPeer->SubscribeToOnLocalPeerConnect(callback);
+            secondSubscriberId = secondClientPeer->SubscribeToOnLocalPeerConnect(callback);
+            const bool isFirstServerStarted = firstServerPeer->Start(std::make_unique<NetLib::LoopbackTransport>(firstNetwork));
+            const bool isSecondServerStarted = secondServerPeer->Start(std::make_unique<NetLib::LoopbackTransport>(secondNetwork));
+            firstClientPeer->Start(std::make_unique<NetLib::LoopbackTransport>(firstNetwork));
+            secondClientPeer->Start(std::make_unique<NetLib::LoopbackTransport>(secondNetwork));
+
+            for (unsigned int frame = 0; frame < maxNumberOfFrames && numberOfTimesCalled < 2; ++frame)
+            {
+                TickPeer(*firstServerPeer, FIXED_FRAME_TARGET_DURATION);
+                TickPeer(*secondServerPeer, FIXED_FRAME_TARGET_DURATION);
+                TickPeer(*firstClientPeer, FIXED_FRAME_TARGET_DURATION);
+                TickPeer(*secondClientPeer, FIXED_FRAME_TARGET_DURATION);
+            }
+
+            firstServerPeer->Stop();
+            secondServerPeer->Stop();
+            firstClientPeer->Stop();
+            secondClientPeer->Stop();
+            firstClientPeer->UnsubscribeToOnPeerConnected(firstSubscriberId);
+            secondClientPeer->UnsubscribeToOnPeerConnected(secondSubscriberId);
+
+            delete firstServerPeer;
+            firstServerPeer = nullptr;
+            delete secondServerPeer;
+            secondServerPeer = nullptr;
+            delete firstClientPeer;
+            firstClientPeer = nullptr;
+            delete secondClientPeer;
+            secondClientPeer = nullptr;
+
+            //Assert
+            assert(isFirstServerStarted);
+            assert(isSecondServerStarted);
+            assert(numberOfTimesCalled == 2);
+
+            //Tear down
+            TearDown();
+
+            return true;
+        }
+
+        bool static Test_ClientOnLocalPeerConnectDelegate_CheckItIsCalledOnlyOnceUsingLossyEmulatedTransport()
+        {
+            LogTestUtils::LogTestName("Test_ClientOnLocalPeerConnectDelegate_CheckItIsCalledOnlyOnceUsingLossyEmulatedTransport");
+
+            //Set up
+            SetUp();
+
+            //Arrange
+            const float clientServerInactivityTimeout = 5;
+            const unsigned int serverMaxConnections = 1;
+            const unsigned int maxNumberOfFrames = 250;
+            const unsigned int seed = 1234;
+
+            NetLib::NetworkConditions conditions;
+            conditions.latencySeconds = 0.03f;
+            conditions.jitterSeconds = 0.01f;
+            conditions.lossModel = NetLib::NetworkLossModel::UNIFORM;
+            conditions.lossProbability = 0.2f;
+            conditions.duplicationProbability = 0.1f;
+            conditions.reorderProbability = 0.1f;
+            conditions.reorderDelaySeconds = 0.02f;
+
+            NetLib::LoopbackNetwork network;
+            NetLib::Peer* serverPeer = new NetLib::Server(serverMaxConnections);
+            NetLib::Peer* clientPeer = new NetLib::Client(clientServerInactivityTimeout);
+
+            int numberOfTimesCalled = 0;
+            auto callback = [&numberOfTimesCalled]()
+            {
+                ++numberOfTimesCalled;
+            };
+
+            unsigned int subscriberId = 0;
+
+            //Act
+            //Only the client link is emulated, so the conditions apply once in each direction
+            subscriberId = clientPeer->SubscribeToOnLocalPeerConnect(callback);
+            serverPeer->Start(std::make_unique<NetLib::LoopbackTransport>(network));
+            clientPeer->Start(std::make_unique<NetLib::EmulatedTransport>(
+                std::make_unique<NetLib::LoopbackTransport>(network), conditions, conditions, seed));
+
+            //The emulated latency is real time, so frames have to last their target duration
+            const std::chrono::milliseconds frameDuration(static_cast<long long>(FIXED_FRAME_TARGET_DURATION * 1000));
+            for (unsigned int frame = 0; frame < maxNumberOfFrames && numberOfTimesCalled == 0; ++frame)
+            {
+                TickPeer(*serverPeer, FIXED_FRAME_TARGET_DURATION);
+                TickPeer(*clientPeer, FIXED_FRAME_TARGET_DURATION);
+                std::this_thread::sleep_for(frameDuration);
+            }
+
+            const bool isClientConnected = clientPeer->GetConnectionState() == NetLib::PeerConnectionState::PCS_Connected;
+
+            clientPeer->Stop();
+            serverPeer->Stop();
+            clientPeer->UnsubscribeToOnPeerConnected(subscriberId);
+
+            delete clientPeer;
+            clientPeer = nullptr;
+            delete serverPeer;
+            serverPeer = nullptr;
+
+            //Assert
+            assert(numberOfTimesCalled == 1);
+            assert(isClientConnected);
+
+            //Tear down
+            TearDown();
+
+            return true;
+        }
+
+        bool static Test_ServerGetInputFromRemotePeer_CheckInputBiggerThanADatagramArrivesComplete()
+        {
+            LogTestUtils::LogTestName("Test_ServerGetInputFromRemotePeer_CheckInputBiggerThanADatagramArrivesComplete");
+
+            //Set up
+            SetUp();
+
+            //Arrange
+            const float clientServerInactivityTimeout = 5;
+            const unsigned int serverMaxConnections = 1;
+            const unsigned int maxNumberOfFrames = 250;
+
+            NetLib::LoopbackNetwork network;
+            LargeTestInputStateFactory inputStateFactory;
+            NetLib::Server* serverPeer = new NetLib::Server(serverMaxConnections);
+            NetLib::Client* clientPeer = new NetLib::Client(clientServerInactivityTimeout);
+            serverPeer->RegisterInputStateFactory(&inputStateFactory);
+
+            uint32_t connectedRemotePeerId = 0;
+            bool isRemotePeerConnected = false;
+            auto callback = [&connectedRemotePeerId, &isRemotePeerConnected](uint32_t remotePeerId)
+            {
+                connectedRemotePeerId = remotePeerId;
+                isRemotePeerConnected = true;
+            };
+
+            unsigned int subscriberId = 0;
+
+            LargeTestInputState sentInputState;
+            sentInputState.Fill();
+
+            //Act
+            subscriberId = serverPeer->SubscribeToOnRemotePeerConnect(callback);
+            serverPeer->Start(std::make_unique<NetLib::LoopbackTransport>(network));
+            clientPeer->Start(std::make_unique<NetLib::LoopbackTransport>(network));
+
+            unsigned int frame = 0;
+            for (; frame < maxNumberOfFrames && clientPeer->GetConnectionState() != NetLib::PeerConnectionState::PCS_Connected; ++frame)
+            {
+                TickPeer(*serverPeer, FIXED_FRAME_TARGET_DURATION);
+                TickPeer(*clientPeer, FIXED_FRAME_TARGET_DURATION);
+            }
+
+            clientPeer->SendInputs(sentInputState);
+
+            const NetLib::IInputState* receivedInputState = nullptr;
+            for (; frame < maxNumberOfFrames && receivedInputState == nullptr; ++frame)
+            {
+                TickPeer(*clientPeer, FIXED_FRAME_TARGET_DURATION);
+                TickPeer(*serverPeer, FIXED_FRAME_TARGET_DURATION);
+                if (isRemotePeerConnected)
+                {
+                    receivedInputState = serverPeer->GetInputFromRemotePeer(connectedRemotePeerId);
+                }
+            }
+
+            const bool isInputStateReceived = receivedInputState != nullptr;
+            const bool isInputStateEqual = isInputStateReceived &&
+                static_cast<const LargeTestInputState*>(receivedInputState)->IsEqual(sentInputState);
+
+            if (isInputStateReceived)
+            {
+                inputStateFactory.Destroy(const_cast<NetLib::IInputState*>(receivedInputState));
+                receivedInputState = nullptr;
+            }
+
+            clientPeer->Stop();
+            serverPeer->Stop();
+            serverPeer->UnsubscribeToOnRemotePeerConnect(subscriberId);
+
+            delete clientPeer;
+            clientPeer = nullptr;
+            delete serverPeer;
+            serverPeer = nullptr;
+
+            //Assert
+            assert(isInputStateReceived);
+            assert(isInputStateEqual);
+
+            //Tear down
+            TearDown();
+
+            return true;
+        }
+
+        bool static Test_ServerGetRemotePeerDatagramMaxSize_CheckItFitsWithinTheEmulatedPathMTU()
+        {
+            LogTestUtils::LogTestName("Test_ServerGetRemotePeerDatagramMaxSize_CheckItFitsWithinTheEmulatedPathMTU");
+
+            //Set up
+            SetUp();
+
+            //Arrange
+            const float clientServerInactivityTimeout = 5;
+            const unsigned int serverMaxConnections = 1;
+            const unsigned int maxNumberOfFrames = 250;
+            //Enough for the whole search, even if every failed probe has to time out
+            const unsigned int numberOfDiscoveryFrames = 500;
+            const unsigned int seed = 1234;
+            const uint32_t pathMTU = 1300;
+
+            //Only the datagrams going from the server to the client are limited
+            NetLib::NetworkConditions incomingConditions;
+            incomingConditions.maxDatagramSize = pathMTU;
+            NetLib::NetworkConditions outgoingConditions;
+
+            NetLib::LoopbackNetwork network;
+            NetLib::Server* serverPeer = new NetLib::Server(serverMaxConnections);
+            NetLib::Client* clientPeer = new NetLib::Client(clientServerInactivityTimeout);
+
+            uint32_t connectedRemotePeerId = 0;
+            bool isRemotePeerConnected = false;
+            auto callback = [&connectedRemotePeerId, &isRemotePeerConnected](uint32_t remotePeerId)
+            {
+                connectedRemotePeerId = remotePeerId;
+                isRemotePeerConnected = true;
+            };
+
+            unsigned int subscriberId = 0;
+
+            //Act
+            subscriberId = serverPeer->SubscribeToOnRemotePeerConnect(callback);
+            serverPeer->Start(std::make_unique<NetLib::LoopbackTransport>(network));
+            clientPeer->Start(std::make_unique<NetLib::EmulatedTransport>(
+                std::make_unique<NetLib::LoopbackTransport>(network), outgoingConditions, incomingConditions, seed));
+
+            for (unsigned int frame = 0; frame < maxNumberOfFrames && clientPeer->GetConnectionState() != NetLib::PeerConnectionState::PCS_Connected; ++frame)
+            {
+                TickPeer(*serverPeer, FIXED_FRAME_TARGET_DURATION);
+                TickPeer(*clientPeer, FIXED_FRAME_TARGET_DURATION);
+            }
+
+            const uint32_t datagramMaxSizeBeforeDiscovery = serverPeer->GetRemotePeerDatagramMaxSize(connectedRemotePeerId);
+
+            for (unsigned int frame = 0; frame < numberOfDiscoveryFrames; ++frame)
+            {
+                TickPeer(*serverPeer, FIXED_FRAME_TARGET_DURATION);
+                TickPeer(*clientPeer, FIXED_FRAME_TARGET_DURATION);
+            }
+
+            const uint32_t datagramMaxSizeAfterDiscovery = serverPeer->GetRemotePeerDatagramMaxSize(connectedRemotePeerId);
+
+            clientPeer->Stop();
+            serverPeer->Stop();
+            serverPeer->UnsubscribeToOnRemotePeerConnect(subscriberId);
+
+            delete clientPeer;
+            clientPeer = nullptr;
+            delete serverPeer;
+            serverPeer = nullptr;
+
+            //Assert
+            assert(isRemotePeerConnected);
+            assert(datagramMaxSizeBeforeDiscovery == NetLib::MIN_PATH_DATAGRAM_SIZE_BYTES);
+            assert(datagramMaxSizeAfterDiscovery <= pathMTU);
+            assert(datagramMaxSizeAfterDiscovery + NetLib::PATH_MTU_SEARCH_PRECISION_BYTES > pathMTU);
+
+            //Tear down
+            TearDown();
+
+            return true;
+        }
 	};
 }
@@ -0,0 +1,126 @@
+#pragma once
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Buffer.h"
+#include "Initializer.h"
+#include "communication/message.h"
+#include "communication/message_factory.h"
+#include "replication/network_entity_communication_callbacks.h"
+#include "replication/on_network_entity_create_config.h"
+#include "replication/replication_action_type.h"
+#include "replication/replication_manager.h"
+#include "LogTestUtils.h"
+
+namespace Tests
+{
+	class ReplicationPriorityTests
+	{
+    public:
+        bool static ExecuteAll()
+        {
+            LogTestUtils::LogTestResult(
+                Test_ReplicationManager_CheckTheBudgetIsFilledByPriorityWithoutStarvingEntities());
+            return true;
+        }
+
+        bool static Test_ReplicationManager_CheckTheBudgetIsFilledByPriorityWithoutStarvingEntities()
+        {
+            LogTestUtils::LogTestName(
+                "Test_ReplicationManager_CheckTheBudgetIsFilledByPriorityWithoutStarvingEntities");
+
+            //Set up
+            NetLib::Initializer::Initialize();
+
+            //Arrange
+            const uint32_t remotePeerId = 5;
+            uint32_t tick = 0;
+            NetLib::ReplicationManager replicationManager;
+            replicationManager.SubscribeToOnNetworkEntityCreate(
+                [&tick](const NetLib::OnNetworkEntityCreateConfig& config)
+                {
+                    //Every entity changes every tick
+                    auto serialize = [&tick](NetLib::Buffer& buffer)
+                    {
+                        for (uint32_t i = 0; i < 4; ++i)
+                        {
+                            buffer.WriteInteger(tick);
+                        }
+                    };
+                    config.communicationCallbacks->OnSerializeEntityStateForOwner.AddSubscriber(serialize);
+                    config.communicationCallbacks->OnSerializeEntityStateForNonOwner.AddSubscriber(serialize);
+                    return config.entityId;
+                });
+            replicationManager.SubscribeToOnNetworkEntityDestroy([](uint32_t) {});
+
+            const uint32_t playerId = replicationManager.CreateNetworkEntity(1, remotePeerId, 0.f, 0.f);
+            //Near the entity controlled by the remote peer
+            replicationManager.CreateNetworkEntity(1, 0, 10.f, 0.f);
+            const uint32_t farId = replicationManager.CreateNetworkEntity(1, 0, 500.f, 0.f);
+
+            std::vector<uint32_t> firstUpdatedIds;
+            std::vector<uint32_t> firstUpdateSizes;
+            ReplicateUpdates(replicationManager, remotePeerId,
+                NetLib::ReplicationManager::UNLIMITED_REPLICATION_BUDGET, firstUpdatedIds, firstUpdateSizes);
+            const uint32_t budgetBytes = firstUpdateSizes[0] * 2;
+
+            //Act
+            bool isBudgetAlwaysRespected = true;
+            bool isPlayerAlwaysUpdated = true;
+            uint32_t ticksUntilFarIsUpdated = 0;
+            for (uint32_t i = 1; i <= 20 && ticksUntilFarIsUpdated == 0; ++i)
+            {
+                ++tick;
+                std::vector<uint32_t> updatedIds;
+                std::vector<uint32_t> updateSizes;
+                ReplicateUpdates(replicationManager, remotePeerId, budgetBytes, updatedIds, updateSizes);
+
+                isBudgetAlwaysRespected &= updatedIds.size() == 2 && updateSizes[0] + updateSizes[1] <= budgetBytes;
+                isPlayerAlwaysUpdated &= !updatedIds.empty() && updatedIds[0] == playerId;
+                for (uint32_t updatedId : updatedIds)
+                {
+                    if (updatedId == farId)
+                    {
+                        ticksUntilFarIsUpdated = i;
+                    }
+                }
+            }
+
+            //Assert
+            assert(firstUpdatedIds.size() == 3);
+            assert(isBudgetAlwaysRespected);
+            assert(isPlayerAlwaysUpdated);
+            //The far entity needs ten ticks to accumulate more priority than the near one gets in a single tick
+            assert(ticksUntilFarIsUpdated == 10);
+
+            //Tear down
+            NetLib::Initializer::Finalize();
+
+            return true;
+        }
+
+    private:
+        //Replicates the world state and returns the entity updates sent, in order, together with their sizes
+        void static ReplicateUpdates(NetLib::ReplicationManager& replicationManager, uint32_t remotePeerId,
+            uint32_t budgetBytes, std::vector<uint32_t>& updatedIds, std::vector<uint32_t>& updateSizes)
+        {
+            std::vector<std::unique_ptr<NetLib::ReplicationMessage>> messages;
+            replicationManager.Server_ReplicateWorldState(remotePeerId, messages, budgetBytes);
+            replicationManager.ClearReplicationMessages();
+
+            NetLib::MessageFactory& messageFactory = NetLib::MessageFactory::GetInstance();
+            for (std::unique_ptr<NetLib::ReplicationMessage>& message : messages)
+            {
+                if (message->replicationAction == static_cast<uint8_t>(NetLib::ReplicationActionType::UPDATE))
+                {
+                    updatedIds.push_back(message->networkEntityId);
+                    updateSizes.push_back(message->Size());
+                }
+
+                messageFactory.ReleaseMessage(std::move(message));
+            }
+        }
+	};
+}
@@ -0,0 +1,300 @@
+#pragma once
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Initializer.h"
+#include "communication/inline_message.h"
+#include "communication/message.h"
+#include "communication/message_factory.h"
+#include "transmission_channels/message_ring.h"
+#include "transmission_channels/reliable_ordered_channel.h"
+#include "LogTestUtils.h"
+
+namespace Tests
+{
+	class TransmissionChannelTests
+	{
+    public:
+        bool static ExecuteAll()
+        {
+            LogTestUtils::LogTestResult(Test_MessageRing_CheckMessagesKeepTheirOrderWhileTheRingWrapsAndGrows());
+            LogTestUtils::LogTestResult(Test_ReliableOrderedChannel_CheckReceivedMessagesAreDeliveredInOrder());
+            LogTestUtils::LogTestResult(Test_ReliableOrderedChannel_CheckOnlyTimedOutUnackedMessagesAreResent());
+            LogTestUtils::LogTestResult(Test_ReliableOrderedChannel_CheckInlineMessagesAreSentAndResent());
+            return true;
+        }
+
+        bool static Test_MessageRing_CheckMessagesKeepTheirOrderWhileTheRingWrapsAndGrows()
+        {
+            LogTestUtils::LogTestName("Test_MessageRing_CheckMessagesKeepTheirOrderWhileTheRingWrapsAndGrows");
+
+            //Set up
+            NetLib::Initializer::Initialize();
+
+            //Arrange
+            NetLib::MessageFactory& messageFactory = NetLib::MessageFactory::GetInstance();
+            NetLib::MessageRing messageRing(4);
+            uint32_t nextTime = 0;
+
+            //Act
+            for (uint32_t i = 0; i < 3; ++i)
+            {
+                messageRing.PushBack(CreateTimeRequestMessage(messageFactory, nextTime++));
+            }
+
+            std::vector<uint32_t> times;
+            for (uint32_t i = 0; i < 2; ++i)
+            {
+                times.push_back(PopTime(messageFactory, messageRing));
+            }
+
+            //The first ones wrap around the end of the ring and the rest need a bigger one
+            for (uint32_t i = 0; i < 5; ++i)
+            {
+                messageRing.PushBack(CreateTimeRequestMessage(messageFactory, nextTime++));
+            }
+
+            const uint32_t countBeforePopping = messageRing.GetCount();
+            const uint32_t frontSize = messageRing.GetFrontMessageSize();
+            const uint32_t expectedFrontSize = messageRing.GetFront().GetMessage().Size();
+            while (!messageRing.IsEmpty())
+            {
+                times.push_back(PopTime(messageFactory, messageRing));
+            }
+
+            messageRing.PushBack(CreateTimeRequestMessage(messageFactory, nextTime++));
+            messageRing.ReleaseAll(messageFactory);
+
+            //Assert
+            assert(countBeforePopping == 6);
+            assert(frontSize == expectedFrontSize);
+            assert((times == std::vector<uint32_t>{ 0, 1, 2, 3, 4, 5, 6, 7 }));
+            assert(messageRing.IsEmpty());
+
+            //Tear down
+            NetLib::Initializer::Finalize();
+
+            return true;
+        }
+
+        bool static Test_ReliableOrderedChannel_CheckReceivedMessagesAreDeliveredInOrder()
+        {
+            LogTestUtils::LogTestName("Test_ReliableOrderedChannel_CheckReceivedMessagesAreDeliveredInOrder");
+
+            //Set up
+            NetLib::Initializer::Initialize();
+
+            //Arrange
+            NetLib::MessageFactory& messageFactory = NetLib::MessageFactory::GetInstance();
+            //Sequence number 2 arrives twice
+            const uint16_t receivedSequenceNumbers[] = { 3, 2, 5, 2, 1, 4 };
+
+            //Act
+            std::vector<uint32_t> times;
+            uint16_t lastMessageSequenceNumberAcked = 0;
+            //The channel gives its messages back to the factory before the tear down
+            {
+                NetLib::ReliableOrderedChannel channel;
+                for (const uint16_t sequenceNumber : receivedSequenceNumbers)
+                {
+                    std::unique_ptr<NetLib::Message> message =
+                        CreateTimeRequestMessage(messageFactory, sequenceNumber);
+                    message->SetHeaderPacketSequenceNumber(sequenceNumber);
+                    channel.AddReceivedMessage(std::move(message));
+
+                    while (channel.ArePendingReadyToProcessMessages())
+                    {
+                        const NetLib::Message* readyMessage = channel.GetReadyToProcessMessage();
+                        times.push_back(static_cast<const NetLib::TimeRequestMessage*>(readyMessage)->remoteTime);
+                    }
+                }
+                channel.FreeProcessedMessages();
+                lastMessageSequenceNumberAcked = channel.GetLastMessageSequenceNumberAcked();
+            }
+
+            //Assert
+            assert((times == std::vector<uint32_t>{ 1, 2, 3, 4, 5 }));
+            assert(lastMessageSequenceNumberAcked == 4);
+
+            //Tear down
+            NetLib::Initializer::Finalize();
+
+            return true;
+        }
+
+        bool static Test_ReliableOrderedChannel_CheckOnlyTimedOutUnackedMessagesAreResent()
+        {
+            LogTestUtils::LogTestName("Test_ReliableOrderedChannel_CheckOnlyTimedOutUnackedMessagesAreResent");
+
+            //Set up
+            NetLib::Initializer::Initialize();
+
+            //Arrange
+            NetLib::MessageFactory& messageFactory = NetLib::MessageFactory::GetInstance();
+
+            //Act
+            uint32_t messageSize = 0;
+            bool isAnyMessageToResendBeforeTimeout = true;
+            uint32_t ackedBytes = 0;
+            uint32_t numberOfTimedOutMessages = 0;
+            uint32_t sizeOfMessageToResend = 0;
+            std::vector<uint32_t> resentTimes;
+            bool isTimedOutMessageToResend = false;
+            bool isAckedMessageToResend = true;
+            //The channel gives its messages back to the factory before the tear down
+            {
+                NetLib::ReliableOrderedChannel channel;
+                for (uint32_t i = 1; i <= 3; ++i)
+                {
+                    channel.AddMessageToSend(CreateTimeRequestMessage(messageFactory, i));
+                }
+                messageSize = channel.GetSizeOfNextUnsentMessage();
+
+                SendPendingMessages(channel);
+                channel.Update(0.1f);
+                isAnyMessageToResendBeforeTimeout = channel.ArePendingMessagesToSend();
+
+                //Acks 3 and 1, leaving 2 unacked
+                channel.ProcessACKs(1u << 1, 3);
+                channel.Update(0.5f);
+                channel.TakeCongestionSignals(ackedBytes, numberOfTimedOutMessages);
+
+                sizeOfMessageToResend = channel.GetSizeOfNextUnsentMessage();
+                resentTimes = SendPendingMessages(channel);
+                channel.ProcessACKs(0, 2);
+
+                //A message acked after timing out is not resent
+                channel.AddMessageToSend(CreateTimeRequestMessage(messageFactory, 4));
+                SendPendingMessages(channel);
+                channel.Update(1.f);
+                isTimedOutMessageToResend = channel.ArePendingMessagesToSend();
+                channel.ProcessACKs(0, 4);
+                isAckedMessageToResend = channel.ArePendingMessagesToSend();
+            }
+
+            //Assert
+            assert(!isAnyMessageToResendBeforeTimeout);
+            assert(ackedBytes == messageSize * 2);
+            assert(numberOfTimedOutMessages == 1);
+            assert(sizeOfMessageToResend == messageSize);
+            assert((resentTimes == std::vector<uint32_t>{ 2 }));
+            assert(isTimedOutMessageToResend);
+            assert(!isAckedMessageToResend);
+
+            //Tear down
+            NetLib::Initializer::Finalize();
+
+            return true;
+        }
+
+        bool static Test_ReliableOrderedChannel_CheckInlineMessagesAreSentAndResent()
+        {
+            LogTestUtils::LogTestName("Test_ReliableOrderedChannel_CheckInlineMessagesAreSentAndResent");
+
+            //Set up
+            NetLib::Initializer::Initialize();
+
+            //Arrange
+            NetLib::MessageFactory& messageFactory = NetLib::MessageFactory::GetInstance();
+            NetLib::InlineMessage inlineMessage(NetLib::MessageType::TimeRequest);
+
+            //Act
+            std::vector<uint32_t> sentTimes;
+            std::vector<bool> areSentMessagesInline;
+            bool isResentMessageInline = false;
+            uint32_t inlineMessageSize = 0;
+            uint32_t ackedBytes = 0;
+            uint32_t numberOfTimedOutMessages = 0;
+            //The channel gives its messages back to the factory before the tear down
+            {
+                NetLib::ReliableOrderedChannel channel;
+                for (uint32_t i = 1; i <= 4; ++i)
+                {
+                    if (i % 2 == 0)
+                    {
+                        inlineMessage.timeRequest.remoteTime = i;
+                        channel.AddMessageToSend(inlineMessage);
+                    }
+                    else
+                    {
+                        channel.AddMessageToSend(CreateTimeRequestMessage(messageFactory, i));
+                    }
+                }
+
+                while (channel.ArePendingMessagesToSend())
+                {
+                    NetLib::QueuedMessage message = channel.GetMessageToSend();
+                    sentTimes.push_back(GetTime(message));
+                    areSentMessagesInline.push_back(message.IsInline());
+                    channel.AddSentMessage(std::move(message));
+                }
+                channel.FreeSentMessages();
+
+                //Acks all of them but 4, which is inline
+                channel.ProcessACKs((1u << 0) | (1u << 1), 3);
+                channel.Update(1.f);
+                channel.TakeCongestionSignals(ackedBytes, numberOfTimedOutMessages);
+
+                inlineMessageSize = channel.GetSizeOfNextUnsentMessage();
+                isResentMessageInline = channel.GetMessageToSend().IsInline();
+            }
+
+            //Assert
+            assert((sentTimes == std::vector<uint32_t>{ 1, 2, 3, 4 }));
+            assert((areSentMessagesInline == std::vector<bool>{ false, true, false, true }));
+            assert(numberOfTimedOutMessages == 1);
+            assert(ackedBytes == inlineMessageSize * 3);
+            assert(isResentMessageInline);
+
+            //Tear down
+            NetLib::Initializer::Finalize();
+
+            return true;
+        }
+
+    private:
+        std::unique_ptr<NetLib::Message> static CreateTimeRequestMessage(NetLib::MessageFactory& messageFactory,
+            uint32_t time)
+        {
+            std::unique_ptr<NetLib::Message> message = messageFactory.LendMessage(NetLib::MessageType::TimeRequest);
+            static_cast<NetLib::TimeRequestMessage&>(*message).remoteTime = time;
+            return message;
+        }
+
+        //Sends every pending message as if they went in a packet and returns their times
+        std::vector<uint32_t> static SendPendingMessages(NetLib::ReliableOrderedChannel& channel)
+        {
+            std::vector<uint32_t> times;
+            while (channel.ArePendingMessagesToSend())
+            {
+                NetLib::QueuedMessage message = channel.GetMessageToSend();
+                times.push_back(GetTime(message));
+                channel.AddSentMessage(std::move(message));
+            }
+            channel.FreeSentMessages();
+
+            return times;
+        }
+
+        uint32_t static PopTime(NetLib::MessageFactory& messageFactory, NetLib::MessageRing& messageRing)
+        {
+            NetLib::QueuedMessage message = messageRing.PopFront();
+            const uint32_t time = GetTime(message);
+            message.Release(messageFactory);
+            return time;
+        }
+
+        //Time requests can be either pooled heap messages or inline ones
+        uint32_t static GetTime(const NetLib::QueuedMessage& message)
+        {
+            if (message.IsInline())
+            {
+                return message.GetInlineMessage().timeRequest.remoteTime;
+            }
+
+            return static_cast<const NetLib::TimeRequestMessage&>(message.GetMessage()).remoteTime;
+        }
+	};
+}
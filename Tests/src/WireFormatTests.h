@@ -0,0 +1,365 @@
+#pragma once
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+#include "Buffer.h"
+#include "core/packet_buffer_pool.h"
+#include "Initializer.h"
+#include "communication/message.h"
+#include "communication/inline_message.h"
+#include "communication/message_factory.h"
+#include "communication/message_utils.h"
+#include "communication/network_packet.h"
+#include "replication/replication_action_type.h"
+#include "LogTestUtils.h"
+
+namespace Tests
+{
+	class WireFormatTests
+	{
+    public:
+        bool static ExecuteAll()
+        {
+            LogTestUtils::LogTestResult(Test_BufferVarInteger_CheckItReadsBackWhatWasWrittenUsingOnlyTheBytesNeeded());
+            LogTestUtils::LogTestResult(Test_ReplicationMessage_CheckUpdateElidesTheFieldsItDoesNotUse());
+            LogTestUtils::LogTestResult(Test_ReplicationMessage_CheckOnlyPayloadViewsCopyTheDatagram());
+            LogTestUtils::LogTestResult(Test_NetworkPacketHeader_CheckACKsAreElidedOrCompactedAndReadBack());
+            LogTestUtils::LogTestResult(Test_NetworkDatagramHeader_CheckAnotherWireFormatVersionIsRejected());
+            LogTestUtils::LogTestResult(Test_InlineMessage_CheckItIsReadBackAsItsMessageClass());
+            return true;
+        }
+
+        bool static Test_BufferVarInteger_CheckItReadsBackWhatWasWrittenUsingOnlyTheBytesNeeded()
+        {
+            LogTestUtils::LogTestName("Test_BufferVarInteger_CheckItReadsBackWhatWasWrittenUsingOnlyTheBytesNeeded");
+
+            //Arrange
+            uint8_t data[32] = {};
+            NetLib::Buffer buffer(data, sizeof(data));
+            const uint32_t values[5] = { 0, 127, 128, 16384, 0xFFFFFFFF };
+            const uint32_t expectedSizes[5] = { 1, 1, 2, 3, 5 };
+
+            //Act
+            for (uint32_t value : values)
+            {
+                buffer.WriteVarInteger(value);
+            }
+            const uint32_t accessIndexAfterWrite = buffer.GetAccessIndex();
+
+            buffer.ResetAccessIndex();
+            uint32_t valuesRead[5] = {};
+            bool areAllRead = true;
+            for (uint32_t& value : valuesRead)
+            {
+                areAllRead = areAllRead && buffer.TryReadVarInteger(value);
+            }
+
+            //A var integer that never ends must fail instead of reading forever
+            uint8_t unterminated[6] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x01 };
+            NetLib::Buffer unterminatedBuffer(unterminated, sizeof(unterminated));
+            uint32_t unterminatedValue = 0;
+            const bool isUnterminatedRead = unterminatedBuffer.TryReadVarInteger(unterminatedValue);
+
+            //Assert
+            uint32_t expectedAccessIndex = 0;
+            for (uint32_t i = 0; i < 5; ++i)
+            {
+                assert(NetLib::Buffer::GetVarIntegerSize(values[i]) == expectedSizes[i]);
+                assert(valuesRead[i] == values[i]);
+                expectedAccessIndex += expectedSizes[i];
+            }
+
+            assert(areAllRead);
+            assert(accessIndexAfterWrite == expectedAccessIndex);
+            assert(!isUnterminatedRead);
+            assert(unterminatedBuffer.GetAccessIndex() == 0);
+
+            return true;
+        }
+
+        bool static Test_ReplicationMessage_CheckUpdateElidesTheFieldsItDoesNotUse()
+        {
+            LogTestUtils::LogTestName("Test_ReplicationMessage_CheckUpdateElidesTheFieldsItDoesNotUse");
+
+            //Set up
+            NetLib::Initializer::Initialize();
+
+            //Arrange
+            const uint16_t stateSize = 9;
+            NetLib::ReplicationMessage updateMessage;
+            updateMessage.SetOrdered(true);
+            updateMessage.SetReliability(false);
+            updateMessage.SetHeaderPacketSequenceNumber(40000);
+            updateMessage.replicationAction = static_cast<uint8_t>(NetLib::ReplicationActionType::UPDATE);
+            updateMessage.networkEntityId = 300;
+            updateMessage.controlledByPeerId = 2;
+            //Not used by updates, so it must not be sent
+            updateMessage.replicatedClassId = 77;
+            updateMessage.snapshotSequenceNumber = 513;
+            updateMessage.snapshotBaselineDistance = 3;
+            updateMessage.numberOfUpdatesInSnapshot = 200;
+            updateMessage.isDeltaCompressed = true;
+            updateMessage.dataSize = stateSize;
+            updateMessage.data = new uint8_t[stateSize];
+            for (uint16_t i = 0; i < stateSize; ++i)
+            {
+                updateMessage.data[i] = static_cast<uint8_t>(i);
+            }
+
+            uint8_t data[64] = {};
+            NetLib::Buffer buffer(data, sizeof(data));
+
+            //Act
+            updateMessage.Write(buffer);
+            const uint32_t numberOfBytesWritten = buffer.GetAccessIndex();
+
+            buffer.ResetAccessIndex();
+            std::unique_ptr<NetLib::Message> message = NetLib::MessageUtils::ReadMessage(buffer);
+            const uint32_t numberOfBytesRead = buffer.GetAccessIndex();
+
+            //Assert
+            //Type and flags, sequence number, action and fields, entity ID, snapshot sequence number, baseline
+            //distance, number of updates in snapshot, controlled by peer ID, data size and data
+            assert(numberOfBytesWritten == 1 + 2 + 1 + 2 + 2 + 1 + 2 + 1 + 1 + stateSize);
+            assert(numberOfBytesWritten == updateMessage.Size());
+            assert(numberOfBytesRead == numberOfBytesWritten);
+            assert(message != nullptr);
+
+            const NetLib::ReplicationMessage& messageRead = static_cast<const NetLib::ReplicationMessage&>(*message);
+            assert(messageRead.GetHeader().type == NetLib::MessageType::Replication);
+            assert(messageRead.GetHeader().isOrdered && !messageRead.GetHeader().isReliable);
+            assert(messageRead.GetHeader().messageSequenceNumber == 40000);
+            assert(messageRead.replicationAction == updateMessage.replicationAction);
+            assert(messageRead.networkEntityId == 300);
+            assert(messageRead.controlledByPeerId == 2);
+            assert(messageRead.replicatedClassId == 0);
+            assert(messageRead.snapshotSequenceNumber == 513);
+            assert(messageRead.snapshotBaselineDistance == 3);
+            assert(messageRead.numberOfUpdatesInSnapshot == 200);
+            assert(messageRead.isDeltaCompressed);
+            assert(messageRead.dataSize == stateSize);
+            for (uint16_t i = 0; i < stateSize; ++i)
+            {
+                assert(messageRead.data[i] == i);
+            }
+
+            //Tear down
+            NetLib::MessageFactory::GetInstance().ReleaseMessage(std::move(message));
+            NetLib::Initializer::Finalize();
+
+            return true;
+        }
+
+        bool static Test_ReplicationMessage_CheckOnlyPayloadViewsCopyTheDatagram()
+        {
+            LogTestUtils::LogTestName("Test_ReplicationMessage_CheckOnlyPayloadViewsCopyTheDatagram");
+
+            //Set up
+            NetLib::Initializer::Initialize();
+
+            //Arrange
+            const uint16_t stateSize = 4;
+            NetLib::ReplicationMessage destroyMessage;
+            destroyMessage.replicationAction = static_cast<uint8_t>(NetLib::ReplicationActionType::DESTROY);
+            destroyMessage.networkEntityId = 8;
+
+            NetLib::ReplicationMessage updateMessage;
+            updateMessage.replicationAction = static_cast<uint8_t>(NetLib::ReplicationActionType::UPDATE);
+            updateMessage.networkEntityId = 9;
+            updateMessage.dataSize = stateSize;
+            updateMessage.data = new uint8_t[stateSize];
+            for (uint16_t i = 0; i < stateSize; ++i)
+            {
+                updateMessage.data[i] = static_cast<uint8_t>(i + 1);
+            }
+
+            //Both messages stand for datagrams that land in receive memory reused by the next receive
+            uint8_t destroyData[32] = {};
+            NetLib::Buffer destroyWriteBuffer(destroyData, sizeof(destroyData));
+            destroyMessage.Write(destroyWriteBuffer);
+            uint8_t updateData[32] = {};
+            NetLib::Buffer updateWriteBuffer(updateData, sizeof(updateData));
+            updateMessage.Write(updateWriteBuffer);
+
+            NetLib::PacketBufferPool& packetBufferPool = NetLib::PacketBufferPool::GetInstance();
+            const uint32_t numberOfAvailablePacketBuffers = packetBufferPool.GetNumberOfAvailablePacketBuffers();
+
+            //Act
+            NetLib::Buffer destroyBuffer(destroyData, sizeof(destroyData));
+            destroyBuffer.EnablePacketBufferOnDemand();
+            std::unique_ptr<NetLib::Message> destroyMessageRead = NetLib::MessageUtils::ReadMessage(destroyBuffer);
+            const uint32_t numberOfAvailablePacketBuffersAfterDestroy =
+                packetBufferPool.GetNumberOfAvailablePacketBuffers();
+
+            NetLib::Buffer updateBuffer(updateData, sizeof(updateData));
+            updateBuffer.EnablePacketBufferOnDemand();
+            std::unique_ptr<NetLib::Message> updateMessageRead = NetLib::MessageUtils::ReadMessage(updateBuffer);
+            const uint32_t numberOfAvailablePacketBuffersAfterUpdate =
+                packetBufferPool.GetNumberOfAvailablePacketBuffers();
+
+            //The datagram is done, so the next receive overwrites its memory
+            updateBuffer.GetPacketBuffer()->RemoveReference();
+            std::memset(updateData, 0, sizeof(updateData));
+
+            //Assert
+            assert(destroyMessageRead != nullptr);
+            assert(destroyBuffer.GetPacketBuffer() == nullptr);
+            assert(numberOfAvailablePacketBuffersAfterDestroy == numberOfAvailablePacketBuffers);
+
+            assert(updateMessageRead != nullptr);
+            assert(numberOfAvailablePacketBuffersAfterUpdate == numberOfAvailablePacketBuffers - 1);
+            const NetLib::ReplicationMessage& messageRead =
+                static_cast<const NetLib::ReplicationMessage&>(*updateMessageRead);
+            assert(messageRead.dataSize == stateSize);
+            for (uint16_t i = 0; i < stateSize; ++i)
+            {
+                assert(messageRead.data[i] == i + 1);
+            }
+
+            //Tear down
+            NetLib::MessageFactory& messageFactory = NetLib::MessageFactory::GetInstance();
+            messageFactory.ReleaseMessage(std::move(destroyMessageRead));
+            messageFactory.ReleaseMessage(std::move(updateMessageRead));
+            assert(packetBufferPool.GetNumberOfAvailablePacketBuffers() == numberOfAvailablePacketBuffers);
+            NetLib::Initializer::Finalize();
+
+            return true;
+        }
+
+        bool static Test_NetworkPacketHeader_CheckACKsAreElidedOrCompactedAndReadBack()
+        {
+            LogTestUtils::LogTestName("Test_NetworkPacketHeader_CheckACKsAreElidedOrCompactedAndReadBack");
+
+            //Arrange
+            const NetLib::NetworkPacketHeader headerWithoutACKs(0, 0, 2);
+            const NetLib::NetworkPacketHeader headerWithoutLosses(1234, 0xFFFFFFFF, 1);
+            const NetLib::NetworkPacketHeader headerWithLosses(65535, 0x7FFFFFFE, 1);
+            uint8_t data[32] = {};
+            NetLib::Buffer buffer(data, sizeof(data));
+
+            //Act
+            headerWithoutACKs.Write(buffer);
+            const uint32_t sizeWithoutACKs = buffer.GetAccessIndex();
+            headerWithoutLosses.Write(buffer);
+            const uint32_t sizeWithoutLosses = buffer.GetAccessIndex() - sizeWithoutACKs;
+            headerWithLosses.Write(buffer);
+
+            buffer.ResetAccessIndex();
+            NetLib::NetworkPacketHeader headersRead[3];
+            bool areAllRead = true;
+            for (NetLib::NetworkPacketHeader& header : headersRead)
+            {
+                areAllRead = areAllRead && header.Read(buffer);
+            }
+
+            //Assert
+            assert(areAllRead);
+            assert(sizeWithoutACKs == 1 && sizeWithoutACKs == headerWithoutACKs.Size());
+            assert(sizeWithoutLosses == 4 && sizeWithoutLosses == headerWithoutLosses.Size());
+            assert(headersRead[0].channelType == 2 && !headersRead[0].HasACKs());
+            assert(headersRead[1].channelType == 1);
+            assert(headersRead[1].lastAckedSequenceNumber == 1234 && headersRead[1].ackBits == 0xFFFFFFFF);
+            assert(headersRead[2].lastAckedSequenceNumber == 65535 && headersRead[2].ackBits == 0x7FFFFFFE);
+
+            return true;
+        }
+
+        bool static Test_NetworkDatagramHeader_CheckAnotherWireFormatVersionIsRejected()
+        {
+            LogTestUtils::LogTestName("Test_NetworkDatagramHeader_CheckAnotherWireFormatVersionIsRejected");
+
+            //Arrange
+            uint8_t data[2] = {};
+            NetLib::Buffer buffer(data, sizeof(data));
+            const NetLib::NetworkDatagramHeader header(3);
+            header.Write(buffer);
+            //Previous wire format, where the first byte was just the number of sections
+            buffer.WriteByte(3);
+            buffer.ResetAccessIndex();
+
+            //Act
+            NetLib::NetworkDatagramHeader headerRead;
+            const bool isCurrentVersionRead = headerRead.Read(buffer);
+            const uint8_t numberOfSectionsRead = headerRead.numberOfSections;
+            const bool isPreviousVersionRead = headerRead.Read(buffer);
+
+            //Assert
+            assert(isCurrentVersionRead);
+            assert(numberOfSectionsRead == 3);
+            assert(!isPreviousVersionRead);
+
+            return true;
+        }
+
+        bool static Test_InlineMessage_CheckItIsReadBackAsItsMessageClass()
+        {
+            LogTestUtils::LogTestName("Test_InlineMessage_CheckItIsReadBackAsItsMessageClass");
+
+            //Set up
+            NetLib::Initializer::Initialize();
+
+            //Arrange
+            NetLib::MessageFactory& messageFactory = NetLib::MessageFactory::GetInstance();
+            NetLib::InlineMessage acceptedMessage(NetLib::MessageType::ConnectionAccepted);
+            acceptedMessage.SetReliability(true);
+            acceptedMessage.SetOrdered(true);
+            acceptedMessage.SetHeaderPacketSequenceNumber(513);
+            acceptedMessage.connectionAccepted.prefix = 0x0123456789ABCDEF;
+            acceptedMessage.connectionAccepted.clientIndexAssigned = 7;
+            NetLib::InlineMessage timeResponseMessage(NetLib::MessageType::TimeResponse);
+            timeResponseMessage.SetOrdered(true);
+            timeResponseMessage.timeResponse.remoteTime = 1000;
+            timeResponseMessage.timeResponse.serverTime = 2000;
+            NetLib::InlineMessage probeMessage(NetLib::MessageType::PathMTUProbe);
+            probeMessage.pathMTUProbe.probeId = 3;
+            probeMessage.pathMTUProbe.paddingSize = 5;
+            uint8_t data[64] = {};
+            NetLib::Buffer buffer(data, sizeof(data));
+
+            //Act
+            acceptedMessage.Write(buffer);
+            timeResponseMessage.Write(buffer);
+            probeMessage.Write(buffer);
+            const uint32_t writtenSize = buffer.GetAccessIndex();
+
+            buffer.ResetAccessIndex();
+            std::unique_ptr<NetLib::Message> acceptedMessageRead = NetLib::MessageUtils::ReadMessage(buffer);
+            std::unique_ptr<NetLib::Message> timeResponseMessageRead = NetLib::MessageUtils::ReadMessage(buffer);
+            std::unique_ptr<NetLib::Message> probeMessageRead = NetLib::MessageUtils::ReadMessage(buffer);
+            const uint32_t readSize = buffer.GetAccessIndex();
+
+            //Assert
+            assert(acceptedMessageRead != nullptr && timeResponseMessageRead != nullptr && probeMessageRead != nullptr);
+            assert(writtenSize == acceptedMessage.Size() + timeResponseMessage.Size() + probeMessage.Size());
+            assert(readSize == writtenSize);
+
+            const NetLib::ConnectionAcceptedMessage& accepted =
+                static_cast<const NetLib::ConnectionAcceptedMessage&>(*acceptedMessageRead);
+            assert(accepted.GetHeader().isReliable && accepted.GetHeader().isOrdered);
+            assert(accepted.GetHeader().messageSequenceNumber == 513);
+            assert(accepted.prefix == 0x0123456789ABCDEF && accepted.clientIndexAssigned == 7);
+            assert(accepted.Size() == acceptedMessage.Size());
+
+            const NetLib::TimeResponseMessage& timeResponse =
+                static_cast<const NetLib::TimeResponseMessage&>(*timeResponseMessageRead);
+            assert(!timeResponse.GetHeader().isReliable && timeResponse.GetHeader().isOrdered);
+            assert(timeResponse.remoteTime == 1000 && timeResponse.serverTime == 2000);
+            assert(timeResponse.Size() == timeResponseMessage.Size());
+
+            const NetLib::PathMTUProbeMessage& probe =
+                static_cast<const NetLib::PathMTUProbeMessage&>(*probeMessageRead);
+            assert(probe.probeId == 3 && probe.paddingSize == 5);
+            assert(probe.Size() == probeMessage.Size());
+
+            //Tear down
+            messageFactory.ReleaseMessage(std::move(acceptedMessageRead));
+            messageFactory.ReleaseMessage(std::move(timeResponseMessageRead));
+            messageFactory.ReleaseMessage(std::move(probeMessageRead));
+            NetLib::Initializer::Finalize();
+
+            return true;
+        }
+	};
+}
@@ -1,9 +1,29 @@
+#include "BitStreamTests.h"
+#include "BufferTests.h"
+#include "CongestionControlTests.h"
+#include "DeltaReplicationTests.h"
+#include "InterestManagementTests.h"
+#include "MessageFactoryTests.h"
+#include "ParallelReplicationTests.h"
 #include "PeerConnectivityTests.h"
+#include "ReplicationPriorityTests.h"
 #include "ReplicationTests.h"
+#include "TransmissionChannelTests.h"
+#include "WireFormatTests.h"
 #include "LogTestUtils.h"
 
 int main()
 {
+    Tests::BufferTests::ExecuteAll();
+    Tests::BitStreamTests::ExecuteAll();
+    Tests::WireFormatTests::ExecuteAll();
+    Tests::MessageFactoryTests::ExecuteAll();
+    Tests::TransmissionChannelTests::ExecuteAll();
+    Tests::DeltaReplicationTests::ExecuteAll();
+    Tests::InterestManagementTests::ExecuteAll();
+    Tests::ReplicationPriorityTests::ExecuteAll();
+    Tests::CongestionControlTests::ExecuteAll();
+    Tests::ParallelReplicationTests::ExecuteAll();
     Tests::PeerConnectivityTests::ExecuteAll();
     //Tests::ReplicationTests::ExecuteAll();
     return EXIT_SUCCESS;